@@ -52,6 +52,10 @@ namespace QuickFAST{
         , packetHeaderBigEndian_(true)
         , packetHeaderPrefixCount_(0)
         , packetHeaderSuffixCount_(0)
+        , packetHeaderSequenceOffset_(0)
+        , packetHeaderSequenceBytes_(0)
+        , reorderWindow_(0)
+        , reorderTimeout_(50)
         , messageHeaderType_(NO_HEADER)
         , messageHeaderMessageSizeBytes_(0)
         , messageHeaderBigEndian_(true)
@@ -68,6 +72,8 @@ namespace QuickFAST{
         , nonstandard_(0)
         , privateIOService_(false)
         , testSkip_(0)
+        , mapFastFile_(false)
+        , journalBackpressure_(false)
       {
       }
 
@@ -90,6 +96,10 @@ namespace QuickFAST{
         , packetHeaderBigEndian_(rhs.packetHeaderBigEndian_)
         , packetHeaderPrefixCount_(rhs.packetHeaderPrefixCount_)
         , packetHeaderSuffixCount_(rhs.packetHeaderSuffixCount_)
+        , packetHeaderSequenceOffset_(rhs.packetHeaderSequenceOffset_)
+        , packetHeaderSequenceBytes_(rhs.packetHeaderSequenceBytes_)
+        , reorderWindow_(rhs.reorderWindow_)
+        , reorderTimeout_(rhs.reorderTimeout_)
         , messageHeaderType_(rhs.messageHeaderType_)
         , messageHeaderMessageSizeBytes_(rhs.messageHeaderMessageSizeBytes_)
         , messageHeaderBigEndian_(rhs.messageHeaderBigEndian_)
@@ -108,6 +118,9 @@ namespace QuickFAST{
         , nonstandard_(rhs.nonstandard_)
         , privateIOService_(rhs.privateIOService_)
         , testSkip_(rhs.testSkip_)
+        , mapFastFile_(rhs.mapFastFile_)
+        , journalFileName_(rhs.journalFileName_)
+        , journalBackpressure_(rhs.journalBackpressure_)
         , extras_(rhs.extras_)
       {
       }
@@ -216,6 +229,30 @@ namespace QuickFAST{
         return packetHeaderSuffixCount_;
       }
 
+      /// @brief For FIXED_HEADER byte offset of the sequence number; for FAST_HEADER its field index
+      size_t packetHeaderSequenceOffset()const
+      {
+        return packetHeaderSequenceOffset_;
+      }
+
+      /// @brief For FIXED_HEADER size of the sequence number; for FAST_HEADER nonzero if present
+      size_t packetHeaderSequenceBytes()const
+      {
+        return packetHeaderSequenceBytes_;
+      }
+
+      /// @brief How many out-of-order packets to hold.  Zero disables packet sequencing.
+      size_t reorderWindow()const
+      {
+        return reorderWindow_;
+      }
+
+      /// @brief How long (milliseconds) to wait for a missing packet
+      unsigned long reorderTimeout()const
+      {
+        return reorderTimeout_;
+      }
+
       /// @brief What type of header is expected for each message.
       HeaderType messageHeaderType()const
       {
@@ -327,6 +364,24 @@ namespace QuickFAST{
         return testSkip_;
       }
 
+      /// @brief Memory map the FAST data file rather than reading it through a stream.
+      bool mapFastFile()const
+      {
+        return mapFastFile_;
+      }
+
+      /// @brief Record received packets in this PCap file (empty for none).
+      const std::string & journalFileName()const
+      {
+        return journalFileName_;
+      }
+
+      /// @brief Should the receiver wait for the journal rather than drop packets from it.
+      bool journalBackpressure()const
+      {
+        return journalBackpressure_;
+      }
+
       /// @brief Process the first "head" messages then stop.
       void setHead(size_t head)
       {
@@ -477,6 +532,25 @@ namespace QuickFAST{
         packetHeaderSuffixCount_ = headerSuffixCount;
 
       }
+
+      /// @brief Locate the sequence number in the packet header.
+      /// @param offset For FIXED_HEADER byte offset of the sequence number; for FAST_HEADER its field index
+      /// @param bytes For FIXED_HEADER size of the sequence number; for FAST_HEADER nonzero if present
+      void setPacketHeaderSequence(size_t offset, size_t bytes)
+      {
+        packetHeaderSequenceOffset_ = offset;
+        packetHeaderSequenceBytes_ = bytes;
+      }
+
+      /// @brief Deliver packets in sequence order (MessagePerPacketAssembler only)
+      /// @param window is how many out-of-order packets to hold.  Zero disables.
+      /// @param timeout is how long (milliseconds) to wait for a missing packet
+      void setReorder(size_t window, unsigned long timeout)
+      {
+        reorderWindow_ = window;
+        reorderTimeout_ = timeout;
+      }
+
       /// @brief What type of header is expected for each message.
       void setMessageHeaderType(HeaderType headerType)
       {
@@ -590,6 +664,24 @@ namespace QuickFAST{
         testSkip_ = testSkip;
       }
 
+      /// @brief Memory map the FAST data file rather than reading it through a stream.
+      void setMapFastFile(bool mapFastFile)
+      {
+        mapFastFile_ = mapFastFile;
+      }
+
+      /// @brief Record received packets in this PCap file.
+      void setJournalFileName(const std::string & journalFileName)
+      {
+        journalFileName_ = journalFileName;
+      }
+
+      /// @brief Should the receiver wait for the journal rather than drop packets from it.
+      void setJournalBackpressure(bool journalBackpressure)
+      {
+        journalBackpressure_ = journalBackpressure;
+      }
+
       void setExtra(const std::string & name, const std::string value)
       {
         extras_[name] = value;
@@ -642,6 +734,14 @@ namespace QuickFAST{
       size_t packetHeaderPrefixCount_;
       /// @brief For FIXED_HEADER byte count after size; for FAST_HEADER field count after size
       size_t packetHeaderSuffixCount_;
+      /// @brief For FIXED_HEADER byte offset of the sequence number; for FAST_HEADER its field index
+      size_t packetHeaderSequenceOffset_;
+      /// @brief For FIXED_HEADER size of the sequence number; for FAST_HEADER nonzero if present
+      size_t packetHeaderSequenceBytes_;
+      /// @brief How many out-of-order packets to hold. Zero disables packet sequencing.
+      size_t reorderWindow_;
+      /// @brief How long (milliseconds) to wait for a missing packet
+      unsigned long reorderTimeout_;
 
       /// @brief What type of header is expected for each message
       HeaderType messageHeaderType_;
@@ -693,6 +793,12 @@ namespace QuickFAST{
       bool privateIOService_;
 
       size_t testSkip_;
+      /// @brief Memory map the FAST data file.
+      bool mapFastFile_;
+      /// @brief Record received packets in this PCap file.
+      std::string journalFileName_;
+      /// @brief Wait for the journal rather than dropping packets from it.
+      bool journalBackpressure_;
 
       typedef std::map<std::string, std::string> NameValuePairs;
       NameValuePairs extras_;
@@ -20,6 +20,7 @@
 #include <Communication/PCapFileReceiver.h>
 #include <Communication/BufferReceiver.h>
 #include <Communication/AsioService.h>
+#include <Communication/PacketJournal.h>
 
 using namespace QuickFAST;
 using namespace Application;
@@ -61,7 +62,9 @@ DecoderConnection::configure(
   Messages::ValueMessageBuilder & builder,
   Application::DecoderConfiguration &configuration)
 {
-  if(!configuration.fastFileName().empty())
+  bool mapFastFile = configuration.mapFastFile()
+    && configuration.fastFileName() != "cin";
+  if(!configuration.fastFileName().empty() && !mapFastFile)
   {
     if(configuration.fastFileName() == "cin")
     {
@@ -157,65 +160,8 @@ DecoderConnection::configure(
     registry_->display(std::cout, 0);
   }
 
-  switch(configuration.packetHeaderType())
-  {
-  case Application::DecoderConfiguration::NO_HEADER:
-    {
-      Codecs::NoHeaderAnalyzer * analyzer = new Codecs::NoHeaderAnalyzer;
-      analyzer->setTestSkip(configuration.testSkip());
-      packetHeaderAnalyzer_.reset(analyzer);
-      break;
-    }
-  case Application::DecoderConfiguration::FIXED_HEADER:
-    {
-      Codecs::FixedSizeHeaderAnalyzer * fixedSizeHeaderAnalyzer = new Codecs::FixedSizeHeaderAnalyzer(
-        configuration.packetHeaderMessageSizeBytes(),
-        configuration.packetHeaderBigEndian(),
-        configuration.packetHeaderPrefixCount(),
-        configuration.packetHeaderSuffixCount());
-      fixedSizeHeaderAnalyzer->setTestSkip(configuration.testSkip());
-      packetHeaderAnalyzer_.reset(fixedSizeHeaderAnalyzer);
-      break;
-    }
-  case Application::DecoderConfiguration::FAST_HEADER:
-    {
-      packetHeaderAnalyzer_.reset(new Codecs::FastEncodedHeaderAnalyzer(
-        configuration.packetHeaderPrefixCount(),
-        configuration.packetHeaderSuffixCount(),
-        configuration.packetHeaderMessageSizeBytes() != 0)); // true if header contains message size
-      break;
-    }
-  }
-
-  switch(configuration.messageHeaderType())
-  {
-  case Application::DecoderConfiguration::NO_HEADER:
-    {
-      Codecs::NoHeaderAnalyzer * analyzer = new Codecs::NoHeaderAnalyzer;
-      analyzer->setTestSkip(configuration.testSkip());
-      messageHeaderAnalyzer_.reset(analyzer);
-      break;
-    }
-  case Application::DecoderConfiguration::FIXED_HEADER:
-    {
-      Codecs::FixedSizeHeaderAnalyzer * fixedSizeHeaderAnalyzer = new Codecs::FixedSizeHeaderAnalyzer(
-        configuration.messageHeaderMessageSizeBytes(),
-        configuration.messageHeaderBigEndian(),
-        configuration.messageHeaderPrefixCount(),
-        configuration.messageHeaderSuffixCount());
-      fixedSizeHeaderAnalyzer->setTestSkip(configuration.testSkip());
-      messageHeaderAnalyzer_.reset(fixedSizeHeaderAnalyzer);
-      break;
-    }
-  case Application::DecoderConfiguration::FAST_HEADER:
-    {
-      messageHeaderAnalyzer_.reset(new Codecs::FastEncodedHeaderAnalyzer(
-        configuration.messageHeaderPrefixCount(),
-        configuration.messageHeaderSuffixCount(),
-        configuration.messageHeaderMessageSizeBytes() != 0)); // true if header contains message size
-      break;
-    }
-  }
+  packetHeaderAnalyzer_.reset(createPacketHeaderAnalyzer(configuration));
+  messageHeaderAnalyzer_.reset(createMessageHeaderAnalyzer(configuration));
 
   switch(configuration.assemblerType())
   {
@@ -233,6 +179,10 @@ DecoderConnection::configure(
         configuration.echoMessage(),
         configuration.echoField());
       pAssembler->setMessageLimit(configuration.head());
+      if(configuration.reorderWindow() != 0)
+      {
+        pAssembler->setPacketSequencing(configuration.reorderWindow(), configuration.reorderTimeout());
+      }
       break;
     }
   case Application::DecoderConfiguration::STREAMING_ASSEMBLER:
@@ -262,8 +212,8 @@ DecoderConnection::configure(
         {
           Codecs::MessagePerPacketAssembler * pAssembler = new Codecs::MessagePerPacketAssembler(
             registry_,
-            *messageHeaderAnalyzer_,
             *packetHeaderAnalyzer_,
+            *messageHeaderAnalyzer_,
             builder);
           assembler_.reset(pAssembler);
           pAssembler->setEcho(
@@ -272,6 +222,10 @@ DecoderConnection::configure(
             configuration.echoMessage(),
             configuration.echoField());
           pAssembler->setMessageLimit(configuration.head());
+          if(configuration.reorderWindow() != 0)
+          {
+            pAssembler->setPacketSequencing(configuration.reorderWindow(), configuration.reorderTimeout());
+          }
           break;
         }
       case Application::DecoderConfiguration::TCP_RECEIVER:
@@ -346,8 +300,16 @@ DecoderConnection::configure(
     }
   case Application::DecoderConfiguration::RAWFILE_RECEIVER:
     {
-      receiver_.reset(new Communication::RawFileReceiver(
-        *fastFile_));
+      if(mapFastFile)
+      {
+        receiver_.reset(new Communication::RawFileReceiver(
+          configuration.fastFileName()));
+      }
+      else
+      {
+        receiver_.reset(new Communication::RawFileReceiver(
+          *fastFile_));
+      }
       break;
     }
   case Application::DecoderConfiguration::PCAPFILE_RECEIVER:
@@ -370,8 +332,112 @@ DecoderConnection::configure(
     }
   }
 
-  receiver_->start(*assembler_, configuration.bufferSize(), configuration.bufferCount());
+  if(!configuration.journalFileName().empty())
+  {
+    journal_.reset(new Communication::PacketJournal(
+      1024 * 1024,
+      8,
+      configuration.journalBackpressure()
+        ? Communication::PacketJournal::BACKPRESSURE
+        : Communication::PacketJournal::DROP));
+    if(configuration.receiverType() == Application::DecoderConfiguration::MULTICAST_RECEIVER)
+    {
+      journal_->setDestination(configuration.multicastGroupIP(), configuration.portNumber());
+    }
+    if(!journal_->open(configuration.journalFileName(), true))
+    {
+      std::stringstream msg;
+      msg << "Can't open journal file: " << configuration.journalFileName();
+      throw std::invalid_argument(msg.str());
+    }
+    receiver_->setJournal(journal_.get());
+  }
+
+  // packets held for reordering tie up buffers, so allow for them.
+  receiver_->start(
+    *assembler_,
+    configuration.bufferSize(),
+    configuration.bufferCount() + configuration.reorderWindow());
+
+}
 
+Codecs::HeaderAnalyzer *
+DecoderConnection::createPacketHeaderAnalyzer(const Application::DecoderConfiguration & configuration)
+{
+  switch(configuration.packetHeaderType())
+  {
+  case Application::DecoderConfiguration::NO_HEADER:
+    {
+      Codecs::NoHeaderAnalyzer * analyzer = new Codecs::NoHeaderAnalyzer;
+      analyzer->setTestSkip(configuration.testSkip());
+      return analyzer;
+    }
+  case Application::DecoderConfiguration::FIXED_HEADER:
+    {
+      Codecs::FixedSizeHeaderAnalyzer * fixedSizeHeaderAnalyzer = new Codecs::FixedSizeHeaderAnalyzer(
+        configuration.packetHeaderMessageSizeBytes(),
+        configuration.packetHeaderBigEndian(),
+        configuration.packetHeaderPrefixCount(),
+        configuration.packetHeaderSuffixCount());
+      fixedSizeHeaderAnalyzer->setTestSkip(configuration.testSkip());
+      if(configuration.packetHeaderSequenceBytes() != 0)
+      {
+        fixedSizeHeaderAnalyzer->setSequenceNumberLocation(
+          configuration.packetHeaderSequenceOffset(),
+          configuration.packetHeaderSequenceBytes());
+      }
+      return fixedSizeHeaderAnalyzer;
+    }
+  case Application::DecoderConfiguration::FAST_HEADER:
+    {
+      Codecs::FastEncodedHeaderAnalyzer * fastHeaderAnalyzer = new Codecs::FastEncodedHeaderAnalyzer(
+        configuration.packetHeaderPrefixCount(),
+        configuration.packetHeaderSuffixCount(),
+        configuration.packetHeaderMessageSizeBytes() != 0); // true if header contains message size
+      if(configuration.packetHeaderSequenceBytes() != 0)
+      {
+        fastHeaderAnalyzer->setSequenceNumberField(configuration.packetHeaderSequenceOffset());
+      }
+      return fastHeaderAnalyzer;
+    }
+  }
+  std::stringstream msg;
+  msg << "DecoderConnection: Unknown packet header type.";
+  throw std::invalid_argument(msg.str());
+}
+
+Codecs::HeaderAnalyzer *
+DecoderConnection::createMessageHeaderAnalyzer(const Application::DecoderConfiguration & configuration)
+{
+  switch(configuration.messageHeaderType())
+  {
+  case Application::DecoderConfiguration::NO_HEADER:
+    {
+      Codecs::NoHeaderAnalyzer * analyzer = new Codecs::NoHeaderAnalyzer;
+      analyzer->setTestSkip(configuration.testSkip());
+      return analyzer;
+    }
+  case Application::DecoderConfiguration::FIXED_HEADER:
+    {
+      Codecs::FixedSizeHeaderAnalyzer * fixedSizeHeaderAnalyzer = new Codecs::FixedSizeHeaderAnalyzer(
+        configuration.messageHeaderMessageSizeBytes(),
+        configuration.messageHeaderBigEndian(),
+        configuration.messageHeaderPrefixCount(),
+        configuration.messageHeaderSuffixCount());
+      fixedSizeHeaderAnalyzer->setTestSkip(configuration.testSkip());
+      return fixedSizeHeaderAnalyzer;
+    }
+  case Application::DecoderConfiguration::FAST_HEADER:
+    {
+      return new Codecs::FastEncodedHeaderAnalyzer(
+        configuration.messageHeaderPrefixCount(),
+        configuration.messageHeaderSuffixCount(),
+        configuration.messageHeaderMessageSizeBytes() != 0); // true if header contains message size
+    }
+  }
+  std::stringstream msg;
+  msg << "DecoderConnection: Unknown message header type.";
+  throw std::invalid_argument(msg.str());
 }
 
 Codecs::Decoder &
@@ -13,6 +13,7 @@
 #include <Codecs/Decoder_fwd.h>
 #include <Communication/Assembler_fwd.h>
 #include <Communication/Receiver_fwd.h>
+#include <Communication/PacketJournal_fwd.h>
 #include <Communication/AsioService_fwd.h>
 #include <Application/DecoderConfiguration.h>
 
@@ -79,6 +80,18 @@ namespace QuickFAST{
 
       Codecs::Decoder & decoder() const;
 
+      /// @brief Create the packet header analyzer described by a configuration
+      /// @param configuration describes the packet header
+      /// @returns a new analyzer.  Caller takes ownership.
+      static Codecs::HeaderAnalyzer * createPacketHeaderAnalyzer(
+        const Application::DecoderConfiguration & configuration);
+
+      /// @brief Create the message header analyzer described by a configuration
+      /// @param configuration describes the message header
+      /// @returns a new analyzer.  Caller takes ownership.
+      static Codecs::HeaderAnalyzer * createMessageHeaderAnalyzer(
+        const Application::DecoderConfiguration & configuration);
+
     private:
       std::istream * fastFile_;
       std::ostream * echoFile_;
@@ -90,6 +103,7 @@ namespace QuickFAST{
       boost::scoped_ptr<boost::asio::io_service> ioService_;
       boost::scoped_ptr<Codecs::HeaderAnalyzer> packetHeaderAnalyzer_;
       boost::scoped_ptr<Codecs::HeaderAnalyzer> messageHeaderAnalyzer_;
+      boost::scoped_ptr<Communication::PacketJournal> journal_;
       boost::scoped_ptr<Communication::Assembler> assembler_;
       boost::scoped_ptr<Communication::Receiver> receiver_;
 
@@ -0,0 +1,402 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "MultiChannelConnection.h"
+#include <Application/DecoderConnection.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/TemplateCache.h>
+#include <Codecs/HeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Communication/MulticastReceiver.h>
+#include <Communication/BufferSlab.h>
+#include <Messages/ValueMessageBuilder.h>
+
+using namespace QuickFAST;
+using namespace Application;
+
+/// @brief Everything needed to receive and decode one channel.
+struct MultiChannelConnection::Channel
+{
+  explicit Channel(const DecoderConfiguration & configuration)
+    : configuration_(configuration)
+  {
+  }
+  std::string name_;
+  DecoderConfiguration configuration_;
+  Codecs::TemplateRegistryPtr registry_;
+  boost::scoped_ptr<Codecs::HeaderAnalyzer> packetHeaderAnalyzer_;
+  boost::scoped_ptr<Codecs::HeaderAnalyzer> messageHeaderAnalyzer_;
+  boost::scoped_ptr<Codecs::MessagePerPacketAssembler> assembler_;
+  boost::scoped_ptr<Communication::MulticastReceiver> receiver_;
+};
+
+namespace
+{
+  bool readYesNo(std::istream & tokens, bool defaultValue)
+  {
+    std::string value;
+    if(tokens >> value)
+    {
+      return value != "no";
+    }
+    return defaultValue;
+  }
+
+  template<typename VALUE>
+  VALUE readValue(std::istream & tokens, const std::string & keyword, size_t lineNumber)
+  {
+    std::string value;
+    if(!(tokens >> value))
+    {
+      std::stringstream msg;
+      msg << "Channel file line " << lineNumber << ": missing value for " << keyword;
+      throw std::invalid_argument(msg.str());
+    }
+    try
+    {
+      return boost::lexical_cast<VALUE>(value);
+    }
+    catch(const boost::bad_lexical_cast &)
+    {
+      std::stringstream msg;
+      msg << "Channel file line " << lineNumber << ": invalid value for " << keyword << ": " << value;
+      throw std::invalid_argument(msg.str());
+    }
+  }
+}
+
+MultiChannelConnection::MultiChannelConnection(Codecs::TemplateRegistryPtr registry)
+  : registry_(registry)
+  , threads_(ioService_)
+{
+}
+
+MultiChannelConnection::~MultiChannelConnection()
+{
+  stop();
+  threads_.joinThreads();
+}
+
+size_t
+MultiChannelConnection::readChannels(
+  std::istream & channelFile,
+  std::vector<DecoderConfiguration> & channels,
+  const DecoderConfiguration & defaults)
+{
+  DecoderConfiguration current(defaults);
+  current.setReceiverType(DecoderConfiguration::MULTICAST_RECEIVER);
+  current.setAssemblerType(DecoderConfiguration::MESSAGE_PER_PACKET_ASSEMBLER);
+  size_t count = 0;
+  size_t lineNumber = 0;
+  std::string line;
+  while(std::getline(channelFile, line))
+  {
+    ++lineNumber;
+    std::string::size_type comment = line.find('#');
+    if(comment != std::string::npos)
+    {
+      line.erase(comment);
+    }
+    std::istringstream tokens(line);
+    std::string keyword;
+    if(!(tokens >> keyword))
+    {
+      continue;
+    }
+    if(keyword == "channel")
+    {
+      std::string name = readValue<std::string>(tokens, keyword, lineNumber);
+      std::string address = readValue<std::string>(tokens, keyword, lineNumber);
+      std::string::size_type colon = address.find(':');
+      if(colon == std::string::npos)
+      {
+        std::stringstream msg;
+        msg << "Channel file line " << lineNumber << ": expecting ip:port, found " << address;
+        throw std::invalid_argument(msg.str());
+      }
+      std::istringstream port(address.substr(colon + 1));
+      DecoderConfiguration channel(current);
+      channel.setMulticastGroupIP(address.substr(0, colon));
+      channel.setPortNumber(readValue<unsigned short>(port, keyword, lineNumber));
+      channel.setExtra("channel", name);
+      channels.push_back(channel);
+      ++count;
+    }
+    else if(keyword == "template")
+    {
+      current.setTemplateFileName(readValue<std::string>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "interface")
+    {
+      current.setListenInterfaceIP(readValue<std::string>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "buffersize")
+    {
+      current.setBufferSize(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "buffers")
+    {
+      current.setBufferCount(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "reset")
+    {
+      current.setReset(readYesNo(tokens, true));
+    }
+    else if(keyword == "strict")
+    {
+      current.setStrict(readYesNo(tokens, true));
+    }
+    else if(keyword == "pnone")
+    {
+      current.setPacketHeaderType(DecoderConfiguration::NO_HEADER);
+    }
+    else if(keyword == "pfix")
+    {
+      current.setPacketHeaderType(DecoderConfiguration::FIXED_HEADER);
+      current.setPacketHeaderMessageSizeBytes(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "pfast")
+    {
+      current.setPacketHeaderType(DecoderConfiguration::FAST_HEADER);
+    }
+    else if(keyword == "pprefix")
+    {
+      current.setPacketHeaderPrefixCount(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "psuffix")
+    {
+      current.setPacketHeaderSuffixCount(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "pbig")
+    {
+      current.setPacketHeaderBigEndian(readYesNo(tokens, true));
+    }
+    else if(keyword == "pseq")
+    {
+      size_t offset = readValue<size_t>(tokens, keyword, lineNumber);
+      current.setPacketHeaderSequence(offset, readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "reorder")
+    {
+      size_t window = readValue<size_t>(tokens, keyword, lineNumber);
+      current.setReorder(window, readValue<unsigned long>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "hnone")
+    {
+      current.setMessageHeaderType(DecoderConfiguration::NO_HEADER);
+    }
+    else if(keyword == "hfix")
+    {
+      current.setMessageHeaderType(DecoderConfiguration::FIXED_HEADER);
+      current.setMessageHeaderMessageSizeBytes(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "hfast")
+    {
+      current.setMessageHeaderType(DecoderConfiguration::FAST_HEADER);
+    }
+    else if(keyword == "hprefix")
+    {
+      current.setMessageHeaderPrefixCount(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "hsuffix")
+    {
+      current.setMessageHeaderSuffixCount(readValue<size_t>(tokens, keyword, lineNumber));
+    }
+    else if(keyword == "hbig")
+    {
+      current.setMessageHeaderBigEndian(readYesNo(tokens, true));
+    }
+    else
+    {
+      std::stringstream msg;
+      msg << "Channel file line " << lineNumber << ": unknown keyword " << keyword;
+      throw std::invalid_argument(msg.str());
+    }
+  }
+  return count;
+}
+
+void
+MultiChannelConnection::configure(std::istream & channelFile, Messages::ValueMessageBuilder & builder)
+{
+  std::vector<DecoderConfiguration> channels;
+  readChannels(channelFile, channels);
+  for(size_t nChannel = 0; nChannel < channels.size(); ++nChannel)
+  {
+    addChannel(channels[nChannel], builder);
+  }
+}
+
+size_t
+MultiChannelConnection::addChannel(
+  const DecoderConfiguration & configuration,
+  Messages::ValueMessageBuilder & builder)
+{
+  if(slab_)
+  {
+    throw UsageError("Coding Error", "MultiChannelConnection: can't add a channel after start().");
+  }
+  ChannelPtr channel(new Channel(configuration));
+  channel->registry_ = registry_;
+  if(!channel->registry_)
+  {
+    if(configuration.templateFileName().empty())
+    {
+      throw UsageError("Coding Error", "MultiChannelConnection: no template registry.");
+    }
+    channel->registry_ = loadTemplates(configuration.templateFileName());
+  }
+  if(!channel->configuration_.getExtra("channel", channel->name_))
+  {
+    channel->name_ = configuration.multicastGroupIP() + ':'
+      + boost::lexical_cast<std::string>(configuration.portNumber());
+  }
+  channel->packetHeaderAnalyzer_.reset(DecoderConnection::createPacketHeaderAnalyzer(configuration));
+  channel->messageHeaderAnalyzer_.reset(DecoderConnection::createMessageHeaderAnalyzer(configuration));
+  channel->assembler_.reset(new Codecs::MessagePerPacketAssembler(
+    channel->registry_,
+    *channel->packetHeaderAnalyzer_,
+    *channel->messageHeaderAnalyzer_,
+    builder));
+  channel->assembler_->setReset(configuration.reset());
+  channel->assembler_->setStrict(configuration.strict());
+  channel->assembler_->setMessageLimit(configuration.head());
+  if(configuration.reorderWindow() != 0)
+  {
+    channel->assembler_->setPacketSequencing(configuration.reorderWindow(), configuration.reorderTimeout());
+  }
+  channel->receiver_.reset(new Communication::MulticastReceiver(
+    ioService_,
+    configuration.multicastGroupIP(),
+    configuration.listenInterfaceIP(),
+    configuration.portNumber()));
+  channels_.push_back(channel);
+  return channels_.size() - 1;
+}
+
+Codecs::TemplateRegistryPtr
+MultiChannelConnection::loadTemplates(const std::string & templateFileName)
+{
+  TemplateFiles::const_iterator it = templateFiles_.find(templateFileName);
+  if(it != templateFiles_.end())
+  {
+    return it->second;
+  }
+  std::ifstream templates(templateFileName.c_str(), std::ios::in | std::ios::binary);
+  if(!templates.good())
+  {
+    std::stringstream msg;
+    msg << "Can't open template file: " << templateFileName;
+    throw std::invalid_argument(msg.str());
+  }
+  // accept either XML or a precompiled TemplateCache
+  uchar signature[16];
+  templates.read(reinterpret_cast<char *>(signature), sizeof(signature));
+  Codecs::TemplateRegistryPtr registry;
+  if(Codecs::TemplateCache::isCache(signature, size_t(templates.gcount())))
+  {
+    registry = Codecs::TemplateCache::readFile(templateFileName);
+  }
+  else
+  {
+    templates.clear();
+    templates.seekg(0);
+    Codecs::XMLTemplateParser parser;
+    registry = parser.parse(templates);
+  }
+  templateFiles_[templateFileName] = registry;
+  return registry;
+}
+
+void
+MultiChannelConnection::start()
+{
+  if(slab_)
+  {
+    throw UsageError("Coding Error", "MultiChannelConnection: start() called twice.");
+  }
+  size_t bufferSize = 0;
+  size_t bufferCount = 0;
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    const DecoderConfiguration & configuration = channels_[nChannel]->configuration_;
+    bufferSize = std::max(bufferSize, configuration.bufferSize());
+    bufferCount += configuration.bufferCount() + configuration.reorderWindow();
+  }
+  slab_.reset(new Communication::BufferSlab(bufferSize, bufferCount));
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    Channel & channel = *channels_[nChannel];
+    slab_->assign(
+      *channel.receiver_,
+      channel.configuration_.bufferCount() + channel.configuration_.reorderWindow());
+    // all buffers come from the slab.
+    channel.receiver_->start(*channel.assembler_, slab_->bufferSize(), 0);
+  }
+}
+
+void
+MultiChannelConnection::run()
+{
+  ioService_.run();
+}
+
+void
+MultiChannelConnection::runThreads(size_t threadCount, bool useThisThread)
+{
+  threads_.runThreads(threadCount, useThisThread);
+}
+
+void
+MultiChannelConnection::joinThreads()
+{
+  threads_.joinThreads();
+}
+
+void
+MultiChannelConnection::setThreadAffinity(const std::vector<int> & cpus)
+{
+  threads_.setThreadAffinity(cpus);
+}
+
+size_t
+MultiChannelConnection::poll()
+{
+  return ioService_.poll();
+}
+
+void
+MultiChannelConnection::stop()
+{
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    channels_[nChannel]->receiver_->stop();
+  }
+}
+
+size_t
+MultiChannelConnection::channelCount() const
+{
+  return channels_.size();
+}
+
+const std::string &
+MultiChannelConnection::channelName(size_t channel) const
+{
+  return channels_.at(channel)->name_;
+}
+
+Codecs::MessagePerPacketAssembler &
+MultiChannelConnection::assembler(size_t channel)
+{
+  return *channels_.at(channel)->assembler_;
+}
+
+Communication::Receiver &
+MultiChannelConnection::receiver(size_t channel)
+{
+  return *channels_.at(channel)->receiver_;
+}
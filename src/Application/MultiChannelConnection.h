@@ -0,0 +1,162 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef MULTICHANNELCONNECTION_H
+#define MULTICHANNELCONNECTION_H
+#include "MultiChannelConnection_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Messages/ValueMessageBuilder_fwd.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/MessagePerPacketAssembler_fwd.h>
+#include <Communication/Receiver_fwd.h>
+#include <Communication/BufferSlab_fwd.h>
+#include <Communication/AsioService.h>
+#include <Application/DecoderConfiguration.h>
+#include <boost/asio.hpp>
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief Receive and decode many multicast channels on a single thread.
+    ///
+    /// Each channel has its own socket, MessagePerPacketAssembler and Decoder (so each
+    /// channel keeps its own dictionary) but all channels share:
+    ///  - one TemplateRegistry per template file,
+    ///  - one io_service -- and therefore one event demultiplexer (epoll on Linux) -- and
+    ///  - one BufferSlab from which every channel's buffers are allocated.
+    ///
+    /// Calling run() from a single thread services every channel with no locking contention.
+    ///
+    /// To decode channels in parallel, call runThreads() instead.  Every thread waits on the
+    /// shared io_service, so an idle thread picks up whichever channel has data ready.
+    /// A channel is never decoded by more than one thread at a time, so each channel's
+    /// messages are still delivered in order.  A builder shared by several channels must
+    /// be thread-safe when more than one thread is used.
+    ///
+    /// Channels may be added programatically via addChannel(), or from a channel file:
+    /// <pre>
+    ///   # comments start with '#'
+    ///   template  templates.xml
+    ///   interface 10.0.0.5
+    ///   buffersize 1500
+    ///   buffers 8
+    ///   pfix 4
+    ///   channel  OPT_A  239.1.1.1:30001
+    ///   channel  OPT_B  239.1.1.2:30002
+    /// </pre>
+    /// Keywords match the options of the InterpretApplication example (without the '-'):
+    /// template, interface, buffersize, buffers, reset, strict,
+    /// pnone, pfix n, pfast, pprefix n, psuffix n, pbig [yes|no], pseq n size, reorder window ms,
+    /// hnone, hfix n, hfast, hprefix n, hsuffix n, hbig [yes|no].
+    /// Settings apply to all channels that follow them, so channels may use different
+    /// template files.  Template files may be XML or a Codecs::TemplateCache.
+    class QuickFAST_Export MultiChannelConnection
+    {
+    public:
+      /// @brief Construct
+      /// @param registry contains the templates shared by all channels.  If it is
+      /// not supplied here, each channel's templates are loaded from the template file named
+      /// in its configuration.  Channels that name the same file share one registry.
+      explicit MultiChannelConnection(
+        Codecs::TemplateRegistryPtr registry = Codecs::TemplateRegistryPtr());
+
+      ~MultiChannelConnection();
+
+      /// @brief Read channel definitions.
+      ///
+      /// Each channel's name is stored in its configuration as the extra value "channel".
+      /// @param channelFile contains the channel definitions
+      /// @param[out] channels receives one configuration per channel.
+      /// @param defaults is the starting point for every channel's configuration.
+      /// @returns the number of channels read.
+      static size_t readChannels(
+        std::istream & channelFile,
+        std::vector<DecoderConfiguration> & channels,
+        const DecoderConfiguration & defaults = DecoderConfiguration());
+
+      /// @brief Read a channel file and add all of its channels.
+      /// @param channelFile contains the channel definitions
+      /// @param builder receives decoded messages from every channel.
+      void configure(std::istream & channelFile, Messages::ValueMessageBuilder & builder);
+
+      /// @brief Add a multicast channel
+      /// @param configuration describes the channel (multicast group, headers, buffers, etc.)
+      /// @param builder receives the decoded messages for this channel.
+      /// @returns the index of the new channel.
+      size_t addChannel(
+        const DecoderConfiguration & configuration,
+        Messages::ValueMessageBuilder & builder);
+
+      /// @brief Allocate the buffer slab and start receiving on every channel.
+      void start();
+
+      /// @brief Run the event loop in this thread until stop() is called.
+      void run();
+
+      /// @brief Run the event loop in this thread plus additional threads until stop() is called.
+      /// @param threadCount is the number of additional threads.
+      /// @param useThisThread if false, start the threads and return immediately (see joinThreads())
+      void runThreads(size_t threadCount, bool useThisThread = true);
+
+      /// @brief Wait for the threads started by runThreads() to exit after stop() is called.
+      void joinThreads();
+
+      /// @brief Pin the threads started by runThreads() to specific CPUs
+      /// @param cpus is a list of zero-based CPU numbers.  Thread n uses cpus[n % cpus.size()]
+      void setThreadAffinity(const std::vector<int> & cpus);
+
+      /// @brief Handle any ready events then return.
+      /// @returns the number of events handled.
+      size_t poll();
+
+      /// @brief Stop receiving on every channel.
+      void stop();
+
+      /// @brief How many channels have been added
+      size_t channelCount() const;
+
+      /// @brief The name of a channel
+      /// @param channel is the index of the channel
+      const std::string & channelName(size_t channel) const;
+
+      /// @brief Access a channel's assembler (and, via the assembler, its decoder)
+      /// @param channel is the index of the channel
+      Codecs::MessagePerPacketAssembler & assembler(size_t channel);
+
+      /// @brief Access a channel's receiver (for statistics)
+      /// @param channel is the index of the channel
+      Communication::Receiver & receiver(size_t channel);
+
+      /// @brief Access the template registry supplied to the constructor (if any).
+      Codecs::TemplateRegistryPtr & registry()
+      {
+        return registry_;
+      }
+
+      /// @brief Access the io_service shared by all channels.
+      boost::asio::io_service & ioService()
+      {
+        return ioService_;
+      }
+
+    private:
+      MultiChannelConnection(const MultiChannelConnection &);
+      MultiChannelConnection & operator=(const MultiChannelConnection &);
+      Codecs::TemplateRegistryPtr loadTemplates(const std::string & templateFileName);
+
+    private:
+      struct Channel;
+      typedef boost::shared_ptr<Channel> ChannelPtr;
+
+      Codecs::TemplateRegistryPtr registry_;
+      typedef std::map<std::string, Codecs::TemplateRegistryPtr> TemplateFiles;
+      TemplateFiles templateFiles_;
+      boost::asio::io_service ioService_;
+      Communication::AsioService threads_;
+      /// declared before channels_ so the buffers outlive the receivers.
+      boost::scoped_ptr<Communication::BufferSlab> slab_;
+      std::vector<ChannelPtr> channels_;
+    };
+  }
+}
+#endif // MULTICHANNELCONNECTION_H
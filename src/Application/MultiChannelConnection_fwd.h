@@ -0,0 +1,14 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef MULTICHANNELCONNECTION_FWD_H
+#define MULTICHANNELCONNECTION_FWD_H
+namespace QuickFAST
+{
+  namespace Application
+  {
+    class MultiChannelConnection;
+  }
+}
+#endif // MULTICHANNELCONNECTION_FWD_H
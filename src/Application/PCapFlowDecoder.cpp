@@ -0,0 +1,293 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "PCapFlowDecoder.h"
+#include <Application/DecoderConnection.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/HeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/Message.h>
+#include <queue>
+
+using namespace QuickFAST;
+using namespace Application;
+
+/// @brief Hold one flow's decoded messages until they are merged.
+///
+/// Log messages and errors are passed through to the real consumer
+/// one at a time.
+struct PCapFlowDecoder::FlowCollector : public Codecs::MessageConsumer
+{
+  FlowCollector(Codecs::MessageConsumer & consumer, boost::mutex & consumerMutex)
+    : consumer_(consumer)
+    , consumerMutex_(consumerMutex)
+    , timestamp_(0)
+  {
+  }
+
+  virtual bool consumeMessage(Messages::Message & message)
+  {
+    // the builder discards the message after this call, so take its fields rather than copying them.
+    Messages::MessagePtr saved(new Messages::Message(0));
+    saved->swap(message);
+    messages_.push_back(TimedMessage(timestamp_, saved));
+    return true;
+  }
+
+  virtual bool wantLog(unsigned short level)
+  {
+    boost::mutex::scoped_lock lock(consumerMutex_);
+    return consumer_.wantLog(level);
+  }
+
+  virtual bool logMessage(unsigned short level, const std::string & logMessage)
+  {
+    boost::mutex::scoped_lock lock(consumerMutex_);
+    return consumer_.logMessage(level, logMessage);
+  }
+
+  virtual bool reportDecodingError(const std::string & errorMessage)
+  {
+    boost::mutex::scoped_lock lock(consumerMutex_);
+    return consumer_.reportDecodingError(errorMessage);
+  }
+
+  virtual bool reportCommunicationError(const std::string & errorMessage)
+  {
+    boost::mutex::scoped_lock lock(consumerMutex_);
+    return consumer_.reportCommunicationError(errorMessage);
+  }
+
+  virtual void decodingStarted()
+  {
+  }
+
+  virtual void decodingStopped()
+  {
+  }
+
+  typedef std::pair<uint64, Messages::MessagePtr> TimedMessage;
+  Codecs::MessageConsumer & consumer_;
+  boost::mutex & consumerMutex_;
+  /// the capture time of the packet being decoded.
+  uint64 timestamp_;
+  std::vector<TimedMessage> messages_;
+};
+
+namespace
+{
+  /// @brief The next undelivered message in one flow.
+  struct MergeCursor
+  {
+    MergeCursor(uint64 timestamp, size_t flow, size_t position)
+      : timestamp_(timestamp)
+      , flow_(flow)
+      , position_(position)
+    {
+    }
+
+    /// reversed so the priority_queue delivers the earliest message first
+    bool operator<(const MergeCursor & rhs) const
+    {
+      if(timestamp_ != rhs.timestamp_)
+      {
+        return timestamp_ > rhs.timestamp_;
+      }
+      return flow_ > rhs.flow_;
+    }
+
+    uint64 timestamp_;
+    size_t flow_;
+    size_t position_;
+  };
+}
+
+PCapFlowDecoder::PCapFlowDecoder(
+  Codecs::TemplateRegistryPtr registry,
+  const DecoderConfiguration & configuration)
+: registry_(registry)
+, configuration_(configuration)
+, nextFlow_(0)
+{
+}
+
+PCapFlowDecoder::~PCapFlowDecoder()
+{
+}
+
+size_t
+PCapFlowDecoder::open(const std::string & pcapFile)
+{
+  flows_.clear();
+  if(!reader_.open(pcapFile.c_str()))
+  {
+    throw std::runtime_error("PCapFlowDecoder: can't read PCap file: " + pcapFile);
+  }
+  typedef std::map<uint64, size_t> FlowIndex;
+  FlowIndex index;
+  Packet packet;
+  while(reader_.read(packet.data_, packet.size_))
+  {
+    packet.timestamp_ = reader_.timestamp();
+    uint32 address = reader_.destinationAddress();
+    uint16 port = reader_.destinationPort();
+    uint64 key = (uint64(address) << 16) | port;
+    FlowIndex::iterator it = index.find(key);
+    if(it == index.end())
+    {
+      std::stringstream name;
+      name << ((address >> 24) & 0xFF) << '.'
+        << ((address >> 16) & 0xFF) << '.'
+        << ((address >> 8) & 0xFF) << '.'
+        << (address & 0xFF) << ':'
+        << port;
+      flows_.push_back(Flow());
+      flows_.back().name_ = name.str();
+      flows_.back().address_ = address;
+      flows_.back().port_ = port;
+      it = index.insert(FlowIndex::value_type(key, flows_.size() - 1)).first;
+    }
+    flows_[it->second].packets_.push_back(packet);
+  }
+  return flows_.size();
+}
+
+void
+PCapFlowDecoder::decode(const std::vector<Messages::ValueMessageBuilder *> & builders, size_t threadCount)
+{
+  if(builders.size() < flows_.size())
+  {
+    throw UsageError("Coding Error", "PCapFlowDecoder: one builder per flow is required.");
+  }
+  decodeFlows(builders, 0, threadCount);
+}
+
+size_t
+PCapFlowDecoder::decodeMerged(Codecs::MessageConsumer & consumer, size_t threadCount)
+{
+  boost::mutex consumerMutex;
+  std::vector<boost::shared_ptr<FlowCollector> > collectorPtrs;
+  std::vector<boost::shared_ptr<Codecs::GenericMessageBuilder> > builderPtrs;
+  std::vector<FlowCollector *> collectors;
+  std::vector<Messages::ValueMessageBuilder *> builders;
+  for(size_t nFlow = 0; nFlow < flows_.size(); ++nFlow)
+  {
+    collectorPtrs.push_back(boost::shared_ptr<FlowCollector>(new FlowCollector(consumer, consumerMutex)));
+    builderPtrs.push_back(boost::shared_ptr<Codecs::GenericMessageBuilder>(
+      new Codecs::GenericMessageBuilder(*collectorPtrs.back())));
+    collectors.push_back(collectorPtrs.back().get());
+    builders.push_back(builderPtrs.back().get());
+  }
+
+  consumer.decodingStarted();
+  decodeFlows(builders, &collectors, threadCount);
+
+  // k-way merge: one cursor per flow, earliest first.
+  std::priority_queue<MergeCursor> cursors;
+  for(size_t nFlow = 0; nFlow < collectors.size(); ++nFlow)
+  {
+    if(!collectors[nFlow]->messages_.empty())
+    {
+      cursors.push(MergeCursor(collectors[nFlow]->messages_[0].first, nFlow, 0));
+    }
+  }
+  size_t delivered = 0;
+  bool more = true;
+  while(more && !cursors.empty())
+  {
+    MergeCursor cursor = cursors.top();
+    cursors.pop();
+    std::vector<FlowCollector::TimedMessage> & messages = collectors[cursor.flow_]->messages_;
+    more = consumer.consumeMessage(*messages[cursor.position_].second);
+    // release each message as soon as it is delivered.
+    messages[cursor.position_].second.reset();
+    ++delivered;
+    ++cursor.position_;
+    if(cursor.position_ < messages.size())
+    {
+      cursor.timestamp_ = messages[cursor.position_].first;
+      cursors.push(cursor);
+    }
+  }
+  consumer.decodingStopped();
+  return delivered;
+}
+
+void
+PCapFlowDecoder::decodeFlows(
+  const std::vector<Messages::ValueMessageBuilder *> & builders,
+  std::vector<FlowCollector *> * collectors,
+  size_t threadCount)
+{
+  if(threadCount == 0)
+  {
+    threadCount = boost::thread::hardware_concurrency();
+  }
+  threadCount = std::max(size_t(1), std::min(threadCount, flows_.size()));
+  nextFlow_ = 0;
+  boost::thread_group threads;
+  for(size_t nThread = 1; nThread < threadCount; ++nThread)
+  {
+    threads.create_thread(boost::bind(
+      &PCapFlowDecoder::decodeWorker, this, boost::cref(builders), collectors));
+  }
+  decodeWorker(builders, collectors);
+  threads.join_all();
+}
+
+void
+PCapFlowDecoder::decodeWorker(
+  const std::vector<Messages::ValueMessageBuilder *> & builders,
+  std::vector<FlowCollector *> * collectors)
+{
+  // Hand out whole flows until there are none left.  A thread that finishes a
+  // short flow picks up the next one, so long flows don't leave threads idle.
+  for(;;)
+  {
+    size_t flow = 0;
+    {
+      boost::mutex::scoped_lock lock(nextFlowMutex_);
+      if(nextFlow_ >= flows_.size())
+      {
+        return;
+      }
+      flow = nextFlow_++;
+    }
+    decodeFlow(flow, *builders[flow], collectors == 0 ? 0 : (*collectors)[flow]);
+  }
+}
+
+void
+PCapFlowDecoder::decodeFlow(
+  size_t flow,
+  Messages::ValueMessageBuilder & builder,
+  FlowCollector * collector)
+{
+  boost::scoped_ptr<Codecs::HeaderAnalyzer> packetHeaderAnalyzer(
+    DecoderConnection::createPacketHeaderAnalyzer(configuration_));
+  boost::scoped_ptr<Codecs::HeaderAnalyzer> messageHeaderAnalyzer(
+    DecoderConnection::createMessageHeaderAnalyzer(configuration_));
+  Codecs::MessagePerPacketAssembler assembler(
+    registry_,
+    *packetHeaderAnalyzer,
+    *messageHeaderAnalyzer,
+    builder);
+  assembler.setReset(configuration_.reset());
+  assembler.setStrict(configuration_.strict());
+  assembler.setMessageLimit(configuration_.head());
+
+  const std::vector<Packet> & packets = flows_[flow].packets_;
+  bool more = true;
+  for(size_t nPacket = 0; more && nPacket < packets.size(); ++nPacket)
+  {
+    const Packet & packet = packets[nPacket];
+    if(collector != 0)
+    {
+      collector->timestamp_ = packet.timestamp_;
+    }
+    more = assembler.consumeBuffer(packet.data_, packet.size_, packet.timestamp_);
+  }
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef PCAPFLOWDECODER_H
+#define PCAPFLOWDECODER_H
+#include "PCapFlowDecoder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Messages/ValueMessageBuilder_fwd.h>
+#include <Codecs/MessageConsumer_fwd.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Communication/PCapReader.h>
+#include <Application/DecoderConfiguration.h>
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief Decode the multicast flows in a PCap file in parallel.
+    ///
+    /// open() scans the (memory mapped) capture once and builds an index of the
+    /// packets sent to each destination address and port.  Each flow is an independent
+    /// FAST stream with its own dictionary, so the flows can be decoded at the same time.
+    ///
+    /// decode() hands each flow to one of a pool of worker threads.  Every flow gets its
+    /// own MessagePerPacketAssembler and Decoder; the TemplateRegistry is shared.
+    /// A flow is decoded from start to finish by a single thread so its messages are
+    /// delivered in order, but messages from different flows are delivered concurrently.
+    ///
+    /// decodeMerged() decodes in parallel the same way, then uses a k-way merge to deliver
+    /// every message to a single consumer in capture-timestamp order.  Packets with
+    /// the same timestamp are delivered in flow order.  The decoded messages are held in
+    /// memory until the merge, so this is intended for captures that fit comfortably in memory.
+    class QuickFAST_Export PCapFlowDecoder
+    {
+    public:
+      /// @brief One packet in the capture.  The data points into the mapped file.
+      struct Packet
+      {
+        /// the UDP payload
+        const unsigned char * data_;
+        /// the size of the payload
+        size_t size_;
+        /// capture time in nanoseconds since the epoch
+        uint64 timestamp_;
+      };
+
+      /// @brief The packets sent to one destination address and port.
+      struct Flow
+      {
+        /// "address:port"
+        std::string name_;
+        /// destination address in host byte order
+        uint32 address_;
+        /// destination UDP port
+        uint16 port_;
+        /// the packets in capture order.
+        std::vector<Packet> packets_;
+      };
+
+      /// @brief Construct
+      /// @param registry contains the templates shared by all flows.
+      /// @param configuration supplies the header, reset and strict settings for every flow.
+      explicit PCapFlowDecoder(
+        Codecs::TemplateRegistryPtr registry,
+        const DecoderConfiguration & configuration = DecoderConfiguration());
+
+      ~PCapFlowDecoder();
+
+      /// @brief Access the PCap reader to set the word size or add flow filters before open()
+      Communication::PCapReader & reader()
+      {
+        return reader_;
+      }
+
+      /// @brief Map the file and index the packets by flow.
+      /// @param pcapFile names the file.
+      /// @returns the number of flows found.
+      /// @throws std::runtime_error if the file can not be read.
+      size_t open(const std::string & pcapFile);
+
+      /// @brief How many flows were found by open()
+      size_t flowCount() const
+      {
+        return flows_.size();
+      }
+
+      /// @brief Access a flow
+      /// @param flow is the index of the flow [0, flowCount())
+      const Flow & flow(size_t flow) const
+      {
+        return flows_[flow];
+      }
+
+      /// @brief Decode every flow.
+      ///
+      /// Returns after all flows are decoded.
+      /// @param builders contains one builder per flow.  builders[n] receives the messages from flow(n).
+      ///        A builder may appear more than once only if it is thread-safe.
+      /// @param threadCount is the number of threads to use (including this one).
+      ///        Zero means one per CPU.  More threads than flows are not useful.
+      void decode(const std::vector<Messages::ValueMessageBuilder *> & builders, size_t threadCount);
+
+      /// @brief Decode every flow in parallel and deliver the messages in timestamp order.
+      ///
+      /// Messages are delivered to the consumer on the calling thread after all flows are decoded.
+      /// Log messages and errors may arrive from any thread during decoding but are
+      /// serialized so the consumer sees one at a time.
+      /// @param consumer receives all messages.
+      /// @param threadCount is the number of threads to use for decoding (including this one).
+      /// @returns the number of messages delivered.
+      size_t decodeMerged(Codecs::MessageConsumer & consumer, size_t threadCount);
+
+    private:
+      PCapFlowDecoder(const PCapFlowDecoder &);
+      PCapFlowDecoder & operator=(const PCapFlowDecoder &);
+
+      struct FlowCollector;
+      void decodeFlows(
+        const std::vector<Messages::ValueMessageBuilder *> & builders,
+        std::vector<FlowCollector *> * collectors,
+        size_t threadCount);
+      void decodeWorker(
+        const std::vector<Messages::ValueMessageBuilder *> & builders,
+        std::vector<FlowCollector *> * collectors);
+      void decodeFlow(
+        size_t flow,
+        Messages::ValueMessageBuilder & builder,
+        FlowCollector * collector);
+
+    private:
+      Codecs::TemplateRegistryPtr registry_;
+      DecoderConfiguration configuration_;
+      Communication::PCapReader reader_;
+      std::vector<Flow> flows_;
+      boost::mutex nextFlowMutex_;
+      size_t nextFlow_;
+    };
+  }
+}
+#endif // PCAPFLOWDECODER_H
@@ -5,12 +5,58 @@
 
 #include "Context.h"
 #include <Codecs/TemplateRegistry.h>
+#include <Codecs/DictionarySnapshot.h>
 #include <Common/Exceptions.h>
 #include <Messages/FieldIdentity.h>
 
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
+/// @brief A registry and its dictionary, prepared to be swapped into a Context.
+///
+/// After installation it holds the registry and dictionary that were replaced.
+class Context::Replacement
+{
+public:
+  Replacement(TemplateRegistryCPtr registry, TemplateRegistryCPtr base)
+    : registry_(registry)
+    , base_(base)
+    , size_(registry->dictionarySize())
+    , dictionary_(new Value[size_])
+    , next_(0)
+  {
+  }
+
+  static const size_t noSource = size_t(-1);
+
+  /// The registry to be installed
+  TemplateRegistryCPtr registry_;
+  /// The registry to which sources_ refers
+  TemplateRegistryCPtr base_;
+  size_t size_;
+  IndexedDictionary dictionary_;
+  /// For each entry in dictionary_: the base_ entry with the same key, or noSource
+  std::vector<size_t> sources_;
+  /// Links retired replacements
+  Replacement * next_;
+};
+
+const size_t Context::Replacement::noSource;
+
+namespace
+{
+  template<typename Target>
+  Target * takePointer(AtomicPointer<Target> & pointer)
+  {
+    Target * result = pointer.get();
+    while(!pointer.CAS(result, 0))
+    {
+      result = pointer.get();
+    }
+    return result;
+  }
+}
+
 Context::Context(Codecs::TemplateRegistryCPtr registry)
 : verboseOut_(0)
 , logOut_(0)
@@ -20,11 +66,16 @@ Context::Context(Codecs::TemplateRegistryCPtr registry)
 , indexedDictionarySize_(registry->dictionarySize())
 //, indexedDictionary_(new Messages::FieldCPtr[indexedDictionarySize_])
 , indexedDictionary_(new Value[indexedDictionarySize_])
+, requestedRegistry_(registry)
+, replacements_(0)
 {
 }
 
 Context::~Context()
 {
+  delete takePointer(pendingAtMessage_);
+  delete takePointer(pendingAtReset_);
+  releaseRetiredRegistries();
 }
 
 void
@@ -40,6 +91,149 @@ Context::reset(bool resetTemplateId /*= true*/)
   }
 }
 
+void
+Context::replaceTemplateRegistry(TemplateRegistryCPtr registry, RegistryReplacement when)
+{
+  if(!registry)
+  {
+    throw UsageError("Coding error", "Replacement Template Registry not defined.");
+  }
+  boost::mutex::scoped_lock lock(replaceMutex_);
+  releaseRetiredRegistries();
+
+  // Reclaim a replacement the Xcoder has not installed (there is at most one).
+  // The Xcoder is still using the registry that replacement would have replaced.
+  TemplateRegistryCPtr base = requestedRegistry_;
+  boost::scoped_ptr<Replacement> stale(takePointer(pendingAtMessage_));
+  if(stale.get() == 0)
+  {
+    stale.reset(takePointer(pendingAtReset_));
+  }
+  if(stale.get() != 0)
+  {
+    base = stale->base_;
+  }
+
+  std::vector<size_t> sources;
+  if(when == REPLACE_AT_MESSAGE)
+  {
+    typedef std::map<std::string, size_t> KeyToIndex;
+    KeyToIndex baseIndexes;
+    const std::vector<std::string> & baseKeys = base->dictionaryKeys();
+    for(size_t nKey = 0; nKey < baseKeys.size(); ++nKey)
+    {
+      baseIndexes[baseKeys[nKey]] = nKey;
+    }
+    const std::vector<std::string> & keys = registry->dictionaryKeys();
+    sources.resize(registry->dictionarySize(), Replacement::noSource);
+    for(size_t nKey = 0; nKey < keys.size() && nKey < sources.size(); ++nKey)
+    {
+      KeyToIndex::const_iterator it = baseIndexes.find(keys[nKey]);
+      if(it != baseIndexes.end())
+      {
+        sources[nKey] = it->second;
+      }
+    }
+  }
+  Replacement * replacement = new Replacement(registry, base);
+  replacement->sources_.swap(sources);
+  requestedRegistry_ = registry;
+  // Only the Xcoder changes a pending pointer while we hold the lock, and only to zero.
+  AtomicPointer<Replacement> & pending = (when == REPLACE_AT_MESSAGE) ? pendingAtMessage_ : pendingAtReset_;
+  pending.CAS(0, replacement);
+}
+
+bool
+Context::installPendingReplacement(bool atReset)
+{
+  Replacement * replacement = takePointer(pendingAtMessage_);
+  if(replacement == 0 && atReset)
+  {
+    replacement = takePointer(pendingAtReset_);
+  }
+  if(replacement == 0)
+  {
+    return false;
+  }
+
+  // If the dictionary was just reset there is nothing worth carrying over.
+  if(!atReset && replacement->base_ == templateRegistry_)
+  {
+    for(size_t nDict = 0; nDict < replacement->sources_.size(); ++nDict)
+    {
+      size_t source = replacement->sources_[nDict];
+      if(source != Replacement::noSource && source < indexedDictionarySize_)
+      {
+        replacement->dictionary_[nDict].swap(indexedDictionary_[source]);
+      }
+    }
+  }
+
+  // Swap rather than assign so the old registry is released by the retiring thread.
+  templateRegistry_.swap(replacement->registry_);
+  indexedDictionary_.swap(replacement->dictionary_);
+  std::swap(indexedDictionarySize_, replacement->size_);
+  ++replacements_;
+
+  Replacement * retired = retired_.get();
+  replacement->next_ = retired;
+  while(!retired_.CAS(retired, replacement))
+  {
+    retired = retired_.get();
+    replacement->next_ = retired;
+  }
+  return true;
+}
+
+size_t
+Context::releaseRetiredRegistries()
+{
+  size_t count = 0;
+  Replacement * retired = takePointer(retired_);
+  while(retired != 0)
+  {
+    Replacement * next = retired->next_;
+    delete retired;
+    retired = next;
+    ++count;
+  }
+  return count;
+}
+
+void
+Context::saveDictionary(DictionarySnapshot & snapshot) const
+{
+  if(snapshot.fingerprint() != templateRegistry_->fingerprint()
+    || snapshot.size() != indexedDictionarySize_)
+  {
+    throw std::runtime_error("Dictionary snapshot is for different templates.");
+  }
+  for(size_t nDict = 0; nDict < indexedDictionarySize_; ++nDict)
+  {
+    snapshot.entries_[nDict] = indexedDictionary_[nDict];
+  }
+  snapshot.templateId_ = templateId_;
+  snapshot.valid_ = true;
+}
+
+void
+Context::restoreDictionary(const DictionarySnapshot & snapshot)
+{
+  if(snapshot.fingerprint() != templateRegistry_->fingerprint()
+    || snapshot.size() != indexedDictionarySize_)
+  {
+    throw std::runtime_error("Dictionary snapshot is for different templates.");
+  }
+  if(!snapshot.isValid())
+  {
+    throw std::runtime_error("Dictionary snapshot is empty.");
+  }
+  for(size_t nDict = 0; nDict < indexedDictionarySize_; ++nDict)
+  {
+    indexedDictionary_[nDict] = snapshot.entries_[nDict];
+  }
+  templateId_ = snapshot.templateId_;
+}
 
 bool
 Context::findTemplate(const std::string & name, const std::string & nameSpace, TemplateCPtr & result) const
@@ -11,8 +11,10 @@
 #include <Common/Value.h>
 #include <Common/Exceptions.h>
 #include <Common/WorkingBuffer.h>
+#include <Common/AtomicPointer.h>
 #include <Codecs/TemplateRegistry_fwd.h>
 #include <Codecs/Template_fwd.h>
+#include <Codecs/DictionarySnapshot_fwd.h>
 #include <Messages/FieldIdentity_fwd.h>
 
 namespace QuickFAST
@@ -31,6 +33,14 @@ namespace QuickFAST
       };
       /// @brief Template ID defined in SCP to mean: reset the xcoder.
       static const template_id_t SCPResetTemplateId = 120;
+
+      /// @brief When may replaceTemplateRegistry() switch to the new templates.
+      enum RegistryReplacement{
+        /// At the next message boundary.  Dictionary entries are carried over by key.
+        REPLACE_AT_MESSAGE,
+        /// At the next reset: a template with reset="Y" or an SCP reset message.
+        REPLACE_AT_RESET
+      };
     public:
       /// @brief Construct with a TemplateRegistry containing all templates to be used.
       /// @param registry A registry containing all templates to be used to decode messages.
@@ -80,6 +90,51 @@ namespace QuickFAST
         return templateRegistry_;
       }
 
+      /// @brief Switch to a new set of templates without stopping the Xcoder.
+      ///
+      /// May be called from any thread.  The new registry must already be finalized;
+      /// the dictionary for it is built here so the Xcoding thread never blocks or
+      /// allocates to install it.  The Xcoding thread picks up the new registry at the
+      /// point requested by when.  The registry it replaces is released by the next
+      /// call to replaceTemplateRegistry() or releaseRetiredRegistries(), never on
+      /// the Xcoding thread.
+      ///
+      /// If a previous replacement has not been installed yet it is discarded.
+      /// @param registry contains the new templates.
+      /// @param when selects the point at which the registry will be switched.
+      void replaceTemplateRegistry(TemplateRegistryCPtr registry, RegistryReplacement when = REPLACE_AT_RESET);
+
+      /// @brief For the Xcoder: install a pending replacement registry.
+      ///
+      /// Called on the Xcoding thread between messages by Decoder::decodeMessage()
+      /// and Encoder::encodeMessage().  Never blocks.
+      /// @param atReset is true if the dictionary has just been reset.
+      /// @returns true if the template registry has changed.
+      bool installReplacement(bool atReset)
+      {
+        if(pendingAtMessage_.get() == 0 && (!atReset || pendingAtReset_.get() == 0))
+        {
+          return false;
+        }
+        return installPendingReplacement(atReset);
+      }
+
+      /// @brief Release registries that have been replaced.
+      /// @returns the number of registries released.
+      size_t releaseRetiredRegistries();
+
+      /// @brief Has a replacement been requested but not yet installed?
+      bool replacementPending()const
+      {
+        return pendingAtMessage_.get() != 0 || pendingAtReset_.get() != 0;
+      }
+
+      /// @brief How many times has the registry been replaced?
+      size_t registryReplacements()const
+      {
+        return replacements_;
+      }
+
       /// @brief Find a template in the TemplateRepository used by this Context
       /// @param name of the template being sought
       /// @param nameSpace that qualifies name
@@ -189,6 +244,22 @@ namespace QuickFAST
         return OK_VALUE;
       }
 
+      /// @brief Capture the dictionary and the current template id.
+      ///
+      /// A Context restored from the snapshot continues Xcoding exactly
+      /// where this one was when the snapshot was taken.
+      /// Call between messages on the thread doing the Xcoding.
+      /// @param snapshot was constructed using the same templates as this Context.
+      /// @throws std::runtime_error if the snapshot is for different templates.
+      void saveDictionary(DictionarySnapshot & snapshot) const;
+
+      /// @brief Restore the state captured by saveDictionary().
+      ///
+      /// Call between messages on the thread doing the Xcoding.
+      /// @param snapshot was captured using the same templates as this Context.
+      /// @throws std::runtime_error if the snapshot is for different templates.
+      void restoreDictionary(const DictionarySnapshot & snapshot);
+
       /// @brief Report a warning
       /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
       ///                  i.e [R123]
@@ -335,6 +406,7 @@ namespace QuickFAST
     private:
       Context(const Context &);
       Context & operator = (const Context &);
+      bool installPendingReplacement(bool atReset);
 
     protected:
       /// if an ostream is supplied make the Xcoder noisy
@@ -355,6 +427,17 @@ namespace QuickFAST
       typedef boost::scoped_array<Value> IndexedDictionary;
       IndexedDictionary indexedDictionary_;
       WorkingBuffer workingBuffer_;
+
+      class Replacement;
+      /// Serializes replaceTemplateRegistry().  Never locked by the Xcoding thread.
+      boost::mutex replaceMutex_;
+      /// The registry that will be in use when all requests have been installed.
+      TemplateRegistryCPtr requestedRegistry_;
+      AtomicPointer<Replacement> pendingAtMessage_;
+      AtomicPointer<Replacement> pendingAtReset_;
+      /// Replaced registries waiting to be released.
+      AtomicPointer<Replacement> retired_;
+      volatile size_t replacements_;
     };
   }
 }
@@ -93,14 +93,19 @@ namespace QuickFAST{
         {
           byte = buffer_[position_++];
         }
-        else if(getBuffer(buffer_, size_))
-        {
-          position_ = 0;
-          byte = buffer_[position_++];
-        }
         else
         {
-          ok = false;
+          size_t used = size_;
+          if(getBuffer(buffer_, size_))
+          {
+            consumed_ += used;
+            position_ = 0;
+            byte = buffer_[position_++];
+          }
+          else
+          {
+            ok = false;
+          }
         }
 
         if(echo_)
@@ -153,15 +158,38 @@ namespace QuickFAST{
         return echo_;
       }
 
+      /// @brief How many bytes have been read from this DataSource.
+      ///
+      /// Taken between messages this is the offset of the next message in the input.
+      uint64 bytesConsumed()const
+      {
+        return consumed_ + position_;
+      }
+
       /// @brief Discard any remaining contents and prepare for new data.
       void reset()
       {
+        consumed_ += position_;
         size_ = 0;
         position_ = 0;
         buffer_ = 0;
       }
 
     protected:
+      /// @brief Discard any remaining contents after the source has been repositioned.
+      /// @param consumed is the position of the next byte in the input, as reported by bytesConsumed().
+      void repositioned(uint64 consumed)
+      {
+        reset();
+        consumed_ = consumed;
+      }
+
+      /// @brief How many bytes of the current buffer have been consumed.
+      size_t bufferPosition()const
+      {
+        return position_;
+      }
+
       /// @brief Honor the echo parameters
       /// @param ok the result about to be returned from getByte
       /// @param byte the byte found by getByte
@@ -182,6 +210,8 @@ namespace QuickFAST{
       size_t size_;
       /// position within current buffer
       size_t position_;
+      /// bytes in previous buffers
+      uint64 consumed_;
 
       std::ostream * echo_;
       bool verboseMessages_;
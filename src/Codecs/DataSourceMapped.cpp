@@ -0,0 +1,90 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "DataSourceMapped.h"
+#include "Common/Constants.h"
+using namespace QuickFAST;
+using namespace QuickFAST::Codecs;
+
+DataSourceMapped::DataSourceMapped(const std::string & filename, bool blocked)
+: blocked_(blocked)
+, pos_(0)
+{
+  if(!file_.open(filename.c_str()))
+  {
+    std::stringstream msg;
+    msg << "Can't open FAST data file: " << filename;
+    throw std::invalid_argument(msg.str());
+  }
+}
+
+DataSourceMapped::~DataSourceMapped()
+{
+}
+
+bool
+DataSourceMapped::getBuffer(const uchar *& buffer, size_t & size)
+{
+  const uchar * data = file_.data();
+  size_t fileSize = file_.size();
+  if(!blocked_)
+  {
+    // the whole file is one buffer.
+    if(pos_ >= fileSize)
+    {
+      return false;
+    }
+    buffer = data + pos_;
+    size = fileSize - pos_;
+    pos_ = fileSize;
+    return true;
+  }
+
+  size_t blockSize = 0;
+  while(blockSize == 0)
+  {
+    if(pos_ >= fileSize)
+    {
+      return false;
+    }
+    uchar b = data[pos_++];
+    while((b & stopBit) == 0 && pos_ < fileSize)
+    {
+      blockSize <<= dataShift;
+      blockSize += b;
+      b = data[pos_++];
+    }
+    blockSize <<= dataShift;
+    blockSize += (b & dataBits);
+  }
+  if(pos_ >= fileSize)
+  {
+    return false;
+  }
+  if(blockSize > fileSize - pos_)
+  {
+    // truncated file: deliver what is there.
+    blockSize = fileSize - pos_;
+  }
+  file_.readAhead(pos_);
+  buffer = data + pos_;
+  size = blockSize;
+  pos_ += blockSize;
+  return true;
+}
+
+void
+DataSourceMapped::seek(size_t offset)
+{
+  if(blocked_)
+  {
+    throw UsageError("Coding Error", "Can not seek in a blocked FAST data file.");
+  }
+  if(offset > file_.size())
+  {
+    throw std::invalid_argument("Seek past end of FAST data file.");
+  }
+  pos_ = offset;
+  repositioned(offset);
+}
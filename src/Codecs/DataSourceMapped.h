@@ -0,0 +1,61 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DATASOURCEMAPPED_H
+#define DATASOURCEMAPPED_H
+#include "DataSource.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/MappedFile.h>
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief A data source that decodes directly from a memory mapped file.
+    ///
+    /// Unlike DataSourceStream and DataSourceBlockedStream no data is copied:
+    /// the buffers handed to the decoder point into the mapped file.
+    /// The file may contain raw FAST records or FAST records divided into
+    /// blocks by stop-bit encoded block sizes (as read by DataSourceBlockedStream).
+    class QuickFAST_Export DataSourceMapped : public DataSource
+    {
+    public:
+      /// @brief Map a file into a DataSource
+      ///
+      /// @param filename names the file containing FAST encoded data
+      /// @param blocked true if the data is preceded by block headers.
+      /// @throws std::invalid_argument if the file can not be opened.
+      explicit DataSourceMapped(const std::string & filename, bool blocked = false);
+
+      /// @brief a typical virtual destructor.
+      virtual ~DataSourceMapped();
+
+      virtual bool getBuffer(const uchar *& buffer, size_t & size);
+
+      /// @brief The number of bytes in the file.
+      size_t fileSize()const
+      {
+        return file_.size();
+      }
+
+      /// @brief Position the source so the next byte decoded is at offset.
+      ///
+      /// Only raw (unblocked) files can be positioned.  For a raw file bytesConsumed()
+      /// is the offset in the file, so between messages it is the offset of the next message.
+      /// @param offset is an offset in the file; usually one returned by bytesConsumed().
+      /// @throws UsageError for a blocked file.
+      /// @throws std::invalid_argument if offset is past the end of the file.
+      void seek(size_t offset);
+
+    private:
+      DataSourceMapped();
+      DataSourceMapped(const DataSourceMapped & );
+      DataSourceMapped & operator =(const DataSourceMapped & );
+    private:
+      Common::MappedFile file_;
+      bool blocked_;
+      size_t pos_;
+    };
+  }
+}
+#endif // DATASOURCEMAPPED_H
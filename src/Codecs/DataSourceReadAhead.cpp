@@ -0,0 +1,131 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "DataSourceReadAhead.h"
+#include <boost/bind.hpp>
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+DataSourceReadAhead::DataSourceReadAhead(
+  std::istream & stream,
+  size_t bufferSize,
+  size_t bufferCount)
+: stream_(stream)
+, bufferSize_(bufferSize)
+, bufferCount_(bufferCount)
+, fillCount_(0)
+, drainCount_(0)
+, endOfData_(false)
+, stopping_(false)
+, holding_(false)
+, decoderWaits_(0)
+, bytesDelivered_(0)
+, readerWaits_(0)
+{
+  if(bufferSize_ == 0 || bufferCount_ < 2)
+  {
+    throw std::invalid_argument("DataSourceReadAhead needs at least two non-empty buffers.");
+  }
+  storage_.reset(new uchar[bufferSize_ * bufferCount_]);
+  used_.reset(new size_t[bufferCount_]);
+  thread_.reset(new boost::thread(boost::bind(&DataSourceReadAhead::readLoop, this)));
+}
+
+DataSourceReadAhead::~DataSourceReadAhead()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stopping_ = true;
+    emptied_.notify_all();
+  }
+  // If the reader is blocked in the stream (i.e. an idle pipe) this waits for it.
+  thread_->join();
+}
+
+bool
+DataSourceReadAhead::getBuffer(const uchar *& buffer, size_t & size)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if(holding_)
+  {
+    // the decoder is finished with the previous buffer
+    holding_ = false;
+    ++drainCount_;
+    emptied_.notify_all();
+  }
+  if(fillCount_ == drainCount_ && !endOfData_)
+  {
+    ++decoderWaits_;
+    while(fillCount_ == drainCount_ && !endOfData_)
+    {
+      filled_.wait(lock);
+    }
+  }
+  if(fillCount_ == drainCount_)
+  {
+    return false;
+  }
+  size_t slot = drainCount_ % bufferCount_;
+  holding_ = true;
+  buffer = storage_.get() + slot * bufferSize_;
+  size = used_[slot];
+  bytesDelivered_ += size;
+  return true;
+}
+
+void
+DataSourceReadAhead::readLoop()
+{
+  bool reading = true;
+  while(reading)
+  {
+    size_t slot = 0;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if(fillCount_ - drainCount_ >= bufferCount_ && !stopping_)
+      {
+        // every buffer is full or held by the decoder
+        ++readerWaits_;
+        while(fillCount_ - drainCount_ >= bufferCount_ && !stopping_)
+        {
+          emptied_.wait(lock);
+        }
+      }
+      if(stopping_)
+      {
+        return;
+      }
+      slot = fillCount_ % bufferCount_;
+    }
+
+    // read outside the lock; the decoder never touches an unfilled buffer.
+    size_t size = 0;
+    try
+    {
+      if(stream_.good())
+      {
+        stream_.read(reinterpret_cast<char *>(storage_.get() + slot * bufferSize_), bufferSize_);
+        size = size_t(stream_.gcount());
+      }
+    }
+    catch(const std::exception &)
+    {
+      // treat a stream that throws like end of data.
+      size = 0;
+    }
+
+    boost::mutex::scoped_lock lock(mutex_);
+    if(size > 0)
+    {
+      used_[slot] = size;
+      ++fillCount_;
+    }
+    if(size < bufferSize_)
+    {
+      endOfData_ = true;
+      reading = false;
+    }
+    filled_.notify_all();
+  }
+}
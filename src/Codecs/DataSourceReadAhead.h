@@ -0,0 +1,102 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DATASOURCEREADAHEAD_H
+#define DATASOURCEREADAHEAD_H
+#include <Common/QuickFAST_Export.h>
+#include <Codecs/DataSource.h>
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief A data source that reads an istream on a background thread.
+    ///
+    /// The reader thread fills a ring of buffers while the decoder drains the
+    /// current one, so decoding overlaps with I/O.  Use this for inputs that can't
+    /// be memory mapped (see DataSourceMapped) such as pipes, decompressing streams
+    /// or files on network file systems.
+    ///
+    /// The stream is read sequentially; it is never positioned, so it need not be seekable.
+    /// The decoder and the reader only synchronize when a buffer changes hands.
+    class QuickFAST_Export DataSourceReadAhead : public DataSource
+    {
+    public:
+      /// @brief Start reading a standard istream into a DataSource
+      ///
+      /// The input stream should be opened in binary mode
+      /// if that option is available/needed on your operating
+      /// system and stream type.
+      /// @param stream supplies the data.  It must not be used by anyone else until this object is destroyed.
+      /// @param bufferSize is the size of each buffer.
+      /// @param bufferCount is the number of buffers: 2 for double buffering, 3 (the default) for triple buffering.
+      explicit DataSourceReadAhead(
+        std::istream & stream,
+        size_t bufferSize = 256 * 1024,
+        size_t bufferCount = 3);
+
+      /// @brief Stops the reader thread.
+      virtual ~DataSourceReadAhead();
+
+      ///////////////////////
+      // Implement DataSource
+      virtual bool getBuffer(const uchar *& buffer, size_t & size);
+
+      /// @brief How many times the decoder had to wait for the reader.
+      ///
+      /// If this is close to the number of buffers delivered, decoding is I/O bound.
+      size_t decoderWaits()const
+      {
+        return decoderWaits_;
+      }
+
+      /// @brief How many times the reader had to wait for a free buffer.
+      ///
+      /// If this is close to the number of buffers delivered, decoding is CPU bound.
+      size_t readerWaits()const
+      {
+        return readerWaits_;
+      }
+
+      /// @brief How many bytes have been delivered to the decoder.
+      unsigned long long bytesDelivered()const
+      {
+        return bytesDelivered_;
+      }
+
+    private:
+      DataSourceReadAhead();
+      DataSourceReadAhead(const DataSourceReadAhead &);
+      DataSourceReadAhead & operator=(const DataSourceReadAhead &);
+
+      void readLoop();
+
+    private:
+      std::istream & stream_;
+      size_t bufferSize_;
+      size_t bufferCount_;
+      boost::scoped_array<uchar> storage_;
+      boost::scoped_array<size_t> used_;
+
+      boost::mutex mutex_;
+      boost::condition_variable filled_;
+      boost::condition_variable emptied_;
+      /// Buffers are filled and drained in order.  Guarded by mutex_:
+      size_t fillCount_;   // buffers filled by the reader (ever)
+      size_t drainCount_;  // buffers released by the decoder (ever)
+      bool endOfData_;
+      bool stopping_;
+
+      /// Belong to the decoder:
+      bool holding_;       // the decoder holds buffer drainCount_ % bufferCount_
+      size_t decoderWaits_;
+      unsigned long long bytesDelivered_;
+
+      /// Belongs to the reader:
+      size_t readerWaits_;
+
+      boost::scoped_ptr<boost::thread> thread_;
+    };
+  }
+}
+#endif // DATASOURCEREADAHEAD_H
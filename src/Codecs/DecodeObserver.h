@@ -0,0 +1,35 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DECODEOBSERVER_H
+#define DECODEOBSERVER_H
+#include <Common/Types.h>
+#include <Codecs/DataSource_fwd.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief interface to be implemented by an observer of each message decoded by a SynchronousDecoder.
+    ///
+    /// i.e. to time each message.
+    class DecodeObserver
+    {
+    public:
+      virtual ~DecodeObserver(){}
+
+      /// @brief A message is about to be decoded.
+      ///
+      /// Called after any header bytes have been skipped.
+      /// @param source is positioned at the start of the message.
+      virtual void messageStarting(const DataSource & source) = 0;
+
+      /// @brief A message has been decoded.
+      /// @param templateId identifies the template used to decode the message.
+      /// @param messageNumber counts messages from zero.
+      virtual void messageDecoded(template_id_t templateId, size_t messageNumber) = 0;
+    };
+  }
+}
+#endif /* DECODEOBSERVER_H */
@@ -10,6 +10,7 @@
 #include <Codecs/FieldInstruction.h>
 #include <Messages/ValueMessageBuilder.h>
 #include <Common/Profiler.h>
+#include <Common/AllocationCounter.h>
 
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
@@ -30,7 +31,10 @@ Decoder::decodeMessage(
    Messages::ValueMessageBuilder & messageBuilder)
 {
   PROFILE_POINT("decode");
+  Common::AllocationPhase allocationPhase(Common::AllocationCounter::DECODER);
   source.beginMessage();
+  // A message boundary: pick up new templates if any are waiting.
+  installReplacement(false);
 
   Codecs::PresenceMap pmap(getTemplateRegistry()->presenceMapBits());
   if(this->verboseOut_)
@@ -55,12 +59,17 @@ Decoder::decodeMessage(
     (*verboseOut_) << "Template ID: " << getTemplateId() << std::endl;
   }
   Codecs::TemplateCPtr templatePtr;
-  if(getTemplateRegistry()->getTemplate(templateId_, templatePtr))
+  bool found = getTemplateRegistry()->getTemplate(templateId_, templatePtr);
+  if(found && templatePtr->getReset())
   {
-    if(templatePtr->getReset())
+    reset(false);
+    if(installReplacement(true))
     {
-      reset(false);
+      found = getTemplateRegistry()->getTemplate(templateId_, templatePtr);
     }
+  }
+  if(found)
+  {
     Messages::ValueMessageBuilder & bodyBuilder(
       messageBuilder.startMessage(
         templatePtr->getApplicationType(),
@@ -80,6 +89,7 @@ Decoder::decodeMessage(
   else if(templateId_ == SCPResetTemplateId)
   {
     reset(false);
+    installReplacement(true);
   }
   else
   {
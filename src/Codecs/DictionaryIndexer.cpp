@@ -35,30 +35,34 @@ DictionaryIndexer::getIndex(
   {
     return getDictionaryIndex(
       globalNames_,
+      "global\t",
       keyNamespace + '\t' + key);
   }
   else if(dictionaryName == "type")
   {
     return getDictionaryIndex(
       typeNames_,
+      "type\t",
       typeNamespace + '\t' +typeName + '\t' + keyNamespace + '\t' + key);
   }
   else if(dictionaryName == "template")
   {
     return getDictionaryIndex(
       templateNames_,
+      "template\t",
       keyNamespace + '\t' + key);
   }
   else
   {
     return getDictionaryIndex(
       qualifiedNames_,
+      "\t",
       dictionaryName + '\t' + keyNamespace + '\t' + key);
   }
 }
 
 size_t
-DictionaryIndexer::getDictionaryIndex(NameToIndex & nameToIndex, const std::string & key)
+DictionaryIndexer::getDictionaryIndex(NameToIndex & nameToIndex, const char * scope, const std::string & key)
 {
   size_t result = 0;
   NameToIndex::const_iterator it = nameToIndex.find(key);
@@ -70,6 +74,7 @@ DictionaryIndexer::getDictionaryIndex(NameToIndex & nameToIndex, const std::stri
   {
     result = index_++;
     nameToIndex[key] = result;
+    keys_.push_back(scope + key);
   }
   return result;
 }
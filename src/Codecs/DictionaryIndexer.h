@@ -47,15 +47,26 @@ namespace QuickFAST{
       /// @returns a count of dictionary entries.
       size_t size()const;
 
+      /// @brief Identify every dictionary entry.
+      ///
+      /// The same field in two sets of templates has the same key, so the keys can
+      /// be used to match dictionary entries when the templates are replaced.
+      /// @returns a key for each entry, indexed by dictionary index.
+      const std::vector<std::string> & keys()const
+      {
+        return keys_;
+      }
+
     private:
       typedef std::map<std::string, size_t> NameToIndex;
-      size_t getDictionaryIndex(NameToIndex & nameToIndex, const std::string & key);
+      size_t getDictionaryIndex(NameToIndex & nameToIndex, const char * scope, const std::string & key);
 
       NameToIndex globalNames_;
       NameToIndex templateNames_;
       NameToIndex typeNames_;
       NameToIndex qualifiedNames_;
       size_t index_;
+      std::vector<std::string> keys_;
     };
   }
 }
@@ -0,0 +1,269 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "DictionarySnapshot.h"
+#include <Codecs/TemplateRegistry.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  const char snapshotMagic[4] = {'Q', 'F', 'D', 'S'};
+  const uchar snapshotVersion = 1;
+
+  // tags for dictionary entries.
+  enum SnapshotTag
+  {
+    SNAPSHOT_UNDEFINED, // followed by a count of consecutive undefined entries
+    SNAPSHOT_NULL,
+    SNAPSHOT_SIGNED,
+    SNAPSHOT_UNSIGNED,
+    SNAPSHOT_DECIMAL,
+    SNAPSHOT_STRING
+  };
+
+  /// seven bits per byte, low order first, high bit set on all but the last byte.
+  void appendVarint(std::string & out, uint64 value)
+  {
+    while(value >= 0x80)
+    {
+      out += char((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out += char(value);
+  }
+
+  void appendSigned(std::string & out, int64 value)
+  {
+    // zigzag so small negative numbers are small too.
+    appendVarint(out, (uint64(value) << 1) ^ uint64(value >> 63));
+  }
+
+  class Reader
+  {
+  public:
+    Reader(const uchar * data, size_t length)
+      : data_(data)
+      , length_(length)
+      , pos_(0)
+    {
+    }
+
+    void need(size_t bytes)
+    {
+      if(length_ - pos_ < bytes)
+      {
+        throw std::runtime_error("Dictionary snapshot is truncated.");
+      }
+    }
+
+    uchar byte()
+    {
+      need(1);
+      return data_[pos_++];
+    }
+
+    const uchar * bytes(size_t count)
+    {
+      need(count);
+      const uchar * result = data_ + pos_;
+      pos_ += count;
+      return result;
+    }
+
+    uint64 varint()
+    {
+      uint64 value = 0;
+      size_t shift = 0;
+      uchar b = 0;
+      do
+      {
+        if(shift > 63)
+        {
+          throw std::runtime_error("Dictionary snapshot is corrupt.");
+        }
+        b = byte();
+        value |= uint64(b & 0x7F) << shift;
+        shift += 7;
+      } while((b & 0x80) != 0);
+      return value;
+    }
+
+    int64 signedVarint()
+    {
+      uint64 value = varint();
+      return int64(value >> 1) ^ -int64(value & 1);
+    }
+
+    bool atEnd()const
+    {
+      return pos_ == length_;
+    }
+
+  private:
+    const uchar * data_;
+    size_t length_;
+    size_t pos_;
+  };
+}
+
+DictionarySnapshot::DictionarySnapshot(TemplateRegistryCPtr registry)
+: fingerprint_(registry->fingerprint())
+, size_(registry->dictionarySize())
+, templateId_(~0)
+, entries_(new Value[size_])
+, valid_(false)
+{
+}
+
+DictionarySnapshot::~DictionarySnapshot()
+{
+}
+
+void
+DictionarySnapshot::write(std::string & out)const
+{
+  out.erase();
+  out.append(snapshotMagic, sizeof(snapshotMagic));
+  out += char(snapshotVersion);
+  uint64 fingerprint = fingerprint_;
+  for(size_t nByte = 0; nByte < 8; ++nByte)
+  {
+    out += char(fingerprint & 0xFF);
+    fingerprint >>= 8;
+  }
+  appendVarint(out, size_);
+  appendVarint(out, templateId_);
+
+  size_t nEntry = 0;
+  while(nEntry < size_)
+  {
+    const Value & entry = entries_[nEntry];
+    if(!entry.isDefined() || entry.isCompound())
+    {
+      size_t run = 1;
+      while(nEntry + run < size_
+        && (!entries_[nEntry + run].isDefined() || entries_[nEntry + run].isCompound()))
+      {
+        ++run;
+      }
+      out += char(SNAPSHOT_UNDEFINED);
+      appendVarint(out, run);
+      nEntry += run;
+      continue;
+    }
+    if(entry.isNull())
+    {
+      out += char(SNAPSHOT_NULL);
+    }
+    else if(entry.isSignedInteger())
+    {
+      out += char(SNAPSHOT_SIGNED);
+      appendSigned(out, entry.getSignedInteger());
+    }
+    else if(entry.isUnsignedInteger())
+    {
+      out += char(SNAPSHOT_UNSIGNED);
+      appendVarint(out, entry.getUnsignedInteger());
+    }
+    else if(entry.isString())
+    {
+      const uchar * value = 0;
+      size_t length = 0;
+      entry.getValue(value, length);
+      out += char(SNAPSHOT_STRING);
+      appendVarint(out, length);
+      out.append(reinterpret_cast<const char *>(value), length);
+    }
+    else
+    {
+      out += char(SNAPSHOT_DECIMAL);
+      appendSigned(out, entry.getMantissa());
+      out += char(entry.getExponent());
+    }
+    ++nEntry;
+  }
+}
+
+void
+DictionarySnapshot::read(const uchar * data, size_t length)
+{
+  valid_ = false;
+  Reader reader(data, length);
+  const uchar * magic = reader.bytes(sizeof(snapshotMagic));
+  if(std::memcmp(magic, snapshotMagic, sizeof(snapshotMagic)) != 0)
+  {
+    throw std::runtime_error("Not a dictionary snapshot.");
+  }
+  if(reader.byte() != snapshotVersion)
+  {
+    throw std::runtime_error("Unsupported dictionary snapshot version.");
+  }
+  uint64 fingerprint = 0;
+  const uchar * fingerprintBytes = reader.bytes(8);
+  for(size_t nByte = 8; nByte > 0; --nByte)
+  {
+    fingerprint = (fingerprint << 8) | fingerprintBytes[nByte - 1];
+  }
+  if(fingerprint != fingerprint_ || reader.varint() != size_)
+  {
+    throw std::runtime_error("Dictionary snapshot was taken using different templates.");
+  }
+  template_id_t templateId = template_id_t(reader.varint());
+
+  size_t nEntry = 0;
+  while(nEntry < size_)
+  {
+    uchar tag = reader.byte();
+    if(tag == SNAPSHOT_UNDEFINED)
+    {
+      uint64 run = reader.varint();
+      if(run == 0 || run > size_ - nEntry)
+      {
+        throw std::runtime_error("Dictionary snapshot is corrupt.");
+      }
+      for(size_t end = nEntry + size_t(run); nEntry < end; ++nEntry)
+      {
+        entries_[nEntry].erase();
+      }
+      continue;
+    }
+    Value & entry = entries_[nEntry];
+    switch(tag)
+    {
+    case SNAPSHOT_NULL:
+      entry.setNull();
+      break;
+    case SNAPSHOT_SIGNED:
+      entry.setValue(reader.signedVarint());
+      break;
+    case SNAPSHOT_UNSIGNED:
+      entry.setValue(reader.varint());
+      break;
+    case SNAPSHOT_DECIMAL:
+      {
+        mantissa_t mantissa = reader.signedVarint();
+        exponent_t exponent = exponent_t(reader.byte());
+        entry.setValue(Decimal(mantissa, exponent));
+        break;
+      }
+    case SNAPSHOT_STRING:
+      {
+        size_t stringLength = size_t(reader.varint());
+        entry.setValue(reader.bytes(stringLength), stringLength);
+        break;
+      }
+    default:
+      throw std::runtime_error("Dictionary snapshot is corrupt.");
+    }
+    ++nEntry;
+  }
+  if(!reader.atEnd())
+  {
+    throw std::runtime_error("Dictionary snapshot is corrupt.");
+  }
+  templateId_ = templateId;
+  valid_ = true;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DICTIONARYSNAPSHOT_H
+#define DICTIONARYSNAPSHOT_H
+#include "DictionarySnapshot_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Common/Value.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    class Context;
+    /// @brief A copy of the state of a Decoder or Encoder dictionary.
+    ///
+    /// Use Context::saveDictionary() to capture the state of a Decoder or Encoder and
+    /// Context::restoreDictionary() to put it back -- in the same Context or a different
+    /// one that uses the same templates.  This supports checkpointing long replays,
+    /// recovering after a gap and handing a feed over to another process.
+    ///
+    /// The storage is allocated when the snapshot is constructed and reused by every
+    /// capture, so capturing is a copy of the dictionary entries with no allocation
+    /// (unless a string value grows).  It is cheap enough to do periodically on the decoding
+    /// thread between messages.  The slower write() can then be done on any thread.
+    ///
+    /// The snapshot is tied to the TemplateRegistry::fingerprint() of the templates in use.
+    /// State from different templates is rejected rather than silently misapplied.
+    class QuickFAST_Export DictionarySnapshot
+    {
+    public:
+      /// @brief Allocate storage for the dictionary used by these templates.
+      /// @param registry contains the templates.
+      explicit DictionarySnapshot(TemplateRegistryCPtr registry);
+      ~DictionarySnapshot();
+
+      /// @brief The fingerprint of the templates this snapshot belongs to.
+      uint64 fingerprint()const
+      {
+        return fingerprint_;
+      }
+
+      /// @brief The number of dictionary entries
+      size_t size()const
+      {
+        return size_;
+      }
+
+      /// @brief The template id that was current when the snapshot was taken.
+      template_id_t templateId()const
+      {
+        return templateId_;
+      }
+
+      /// @brief Does the snapshot contain state (captured or read)?
+      bool isValid()const
+      {
+        return valid_;
+      }
+
+      /// @brief Serialize the snapshot in a compact binary format.
+      /// @param out receives the data (replacing any previous contents)
+      void write(std::string & out)const;
+
+      /// @brief Replace the contents with data produced by write()
+      /// @param data points to the serialized snapshot
+      /// @param length is the number of bytes of data
+      /// @throws std::runtime_error if the data is not a snapshot of
+      ///         a dictionary for the same templates.
+      void read(const uchar * data, size_t length);
+
+      /// @brief Replace the contents with data produced by write()
+      /// @param data is the serialized snapshot
+      /// @throws std::runtime_error if the data is not a snapshot of
+      ///         a dictionary for the same templates.
+      void read(const std::string & data)
+      {
+        read(reinterpret_cast<const uchar *>(data.data()), data.size());
+      }
+
+    private:
+      DictionarySnapshot(const DictionarySnapshot &);
+      DictionarySnapshot & operator=(const DictionarySnapshot &);
+      friend class Context;
+
+    private:
+      uint64 fingerprint_;
+      size_t size_;
+      template_id_t templateId_;
+      boost::scoped_array<Value> entries_;
+      bool valid_;
+    };
+  }
+}
+#endif // DICTIONARYSNAPSHOT_H
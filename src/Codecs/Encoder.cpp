@@ -9,6 +9,7 @@
 #include <Codecs/PresenceMap.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/FieldInstruction.h>
+#include <Common/AllocationCounter.h>
 
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
@@ -36,7 +37,10 @@ Encoder::encodeMessage(
   template_id_t templateId,
   const Messages::MessageAccessor & accessor)
 {
+  Common::AllocationPhase allocationPhase(Common::AllocationCounter::ENCODER);
   destination.startMessage(templateId);
+  // A message boundary: pick up new templates if any are waiting.
+  installReplacement(false);
   encodeSegment(destination, templateId, accessor);
   destination.endMessage();
 }
@@ -48,13 +52,18 @@ Encoder::encodeSegment(
   const Messages::MessageAccessor & accessor)
 {
   Codecs::TemplateCPtr templatePtr;
-  if(getTemplateRegistry()->getTemplate(templateId, templatePtr))
+  bool found = getTemplateRegistry()->getTemplate(templateId, templatePtr);
+  if(found && templatePtr->getReset())
   {
-    if(templatePtr->getReset())
+    reset(true);
+    // The decoder switches templates at the same point.
+    if(installReplacement(true))
     {
-      reset(true);
+      found = getTemplateRegistry()->getTemplate(templateId, templatePtr);
     }
-
+  }
+  if(found)
+  {
     Codecs::PresenceMap pmap(templatePtr->presenceMapBitCount());
 
     DataDestination::BufferHandle header = destination.startBuffer();
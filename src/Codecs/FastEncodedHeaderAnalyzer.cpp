@@ -20,13 +20,56 @@ FastEncodedHeaderAnalyzer::FastEncodedHeaderAnalyzer(
 , hasBlockSize_(hasBlockSize)
 , blockSize_(0)
 , fieldCount_(0)
+, hasSequence_(false)
+, sequenceField_(0)
+, sequenceNumber_(0)
+, sequenceValid_(false)
 {
 }
 
+FastEncodedHeaderAnalyzer::~FastEncodedHeaderAnalyzer()
+{
+}
 
+void
+FastEncodedHeaderAnalyzer::setSequenceNumberField(size_t fieldIndex)
+{
+  if(fieldIndex >= prefixCount_ + suffixCount_)
+  {
+    throw std::invalid_argument("Sequence number field is not in FAST encoded header.");
+  }
+  hasSequence_ = true;
+  sequenceField_ = fieldIndex;
+  sequenceValid_ = false;
+}
 
-FastEncodedHeaderAnalyzer::~FastEncodedHeaderAnalyzer()
+bool
+FastEncodedHeaderAnalyzer::getSequenceNumber(uint32 & sequenceNumber) const
+{
+  if(sequenceValid_)
+  {
+    sequenceNumber = sequenceNumber_;
+  }
+  return sequenceValid_;
+}
+
+void
+FastEncodedHeaderAnalyzer::captureSequenceByte(size_t fieldIndex, uchar next)
+{
+  if(hasSequence_ && fieldIndex == sequenceField_)
+  {
+    sequenceNumber_ <<= 7;
+    sequenceNumber_ |= (next & 0x7f);
+  }
+}
+
+void
+FastEncodedHeaderAnalyzer::reset()
 {
+  state_ = ParsingIdle;
+  blockSize_ = 0;
+  fieldCount_ = 0;
+  sequenceValid_ = false;
 }
 
 bool
@@ -40,6 +83,8 @@ FastEncodedHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize
       {
         state_ = ParsingPrefix;
         fieldCount_ = 0;
+        sequenceNumber_ = 0;
+        sequenceValid_ = false;
 //        break;
       }
     case ParsingPrefix:
@@ -51,6 +96,7 @@ FastEncodedHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize
           {
             return false;
           }
+          captureSequenceByte(fieldCount_, next);
           if((next & 0x80) != 0)
           {
             ++fieldCount_;
@@ -93,6 +139,7 @@ FastEncodedHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize
           {
             return false;
           }
+          captureSequenceByte(prefixCount_ + fieldCount_, next);
           if((next & 0x80) != 0)
           {
             ++fieldCount_;
@@ -110,5 +157,6 @@ FastEncodedHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize
   blockSize = blockSize_;
   skip = false;
   state_ = ParsingIdle;
+  sequenceValid_ = hasSequence_;
   return true;
 }
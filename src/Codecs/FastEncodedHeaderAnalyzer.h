@@ -34,9 +34,20 @@ namespace QuickFAST{
       /// @brief Typical virtual destructor
       virtual ~FastEncodedHeaderAnalyzer();
 
+      /// @brief Identify the header field that holds a sequence number.
+      ///
+      /// Fields are counted from zero starting with the prefix fields and continuing
+      /// with the suffix fields.  The block size (if any) is not counted.
+      /// @param fieldIndex is the position of the sequence number field.
+      void setSequenceNumberField(size_t fieldIndex);
+
       ////////////////////////
       // Implement HeaderAnalyzer
       virtual bool analyzeHeader(DataSource & source, size_t & blockSize, bool & skip);
+      virtual void reset();
+      virtual bool getSequenceNumber(uint32 & sequenceNumber) const;
+    private:
+      void captureSequenceByte(size_t fieldIndex, uchar next);
     private:
       size_t prefixCount_;
       size_t suffixCount_;
@@ -51,6 +62,11 @@ namespace QuickFAST{
       bool hasBlockSize_;
       size_t blockSize_;
       size_t fieldCount_;
+
+      bool hasSequence_;
+      size_t sequenceField_;
+      uint32 sequenceNumber_;
+      bool sequenceValid_;
     };
   }
 }
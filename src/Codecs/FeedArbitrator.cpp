@@ -0,0 +1,205 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "FeedArbitrator.h"
+#include <Communication/Receiver.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+using namespace Codecs;
+
+FeedArbitrator::FeedArbitrator(
+      TemplateRegistryPtr templateRegistry,
+      HeaderAnalyzer & sequenceAnalyzer,
+      MessagePerPacketAssembler & assembler,
+      size_t windowSize)
+  : Communication::Assembler(templateRegistry, assembler)
+  , sequenceAnalyzer_(sequenceAnalyzer)
+  , target_(assembler)
+  , runningFeeds_(0)
+  , currentBuffer_(0)
+  , currentSize_(0)
+  , window_(windowSize, 0)
+  , haveSequence_(false)
+  , highestSequence_(0)
+{
+  if(windowSize == 0)
+  {
+    throw std::invalid_argument("FeedArbitrator window size must be greater than zero.");
+  }
+  for(size_t nFeed = 0; nFeed < FEED_COUNT; ++nFeed)
+  {
+    feeds_[nFeed] = 0;
+    packetsWon_[nFeed] = 0;
+    duplicatesDropped_[nFeed] = 0;
+    unsequencedPackets_[nFeed] = 0;
+  }
+}
+
+FeedArbitrator::~FeedArbitrator()
+{
+}
+
+bool
+FeedArbitrator::start(
+  Communication::Receiver & feedA,
+  Communication::Receiver & feedB,
+  size_t bufferSize,
+  size_t bufferCount)
+{
+  feeds_[FEED_A] = &feedA;
+  feeds_[FEED_B] = &feedB;
+  bool result = feedA.start(*this, bufferSize, bufferCount);
+  if(result)
+  {
+    result = feedB.start(*this, bufferSize, bufferCount);
+  }
+  return result;
+}
+
+void
+FeedArbitrator::resetSequence()
+{
+  boost::mutex::scoped_lock lock(arbitrationMutex_);
+  std::fill(window_.begin(), window_.end(), 0);
+  haveSequence_ = false;
+  highestSequence_ = 0;
+}
+
+FeedArbitrator::Feed
+FeedArbitrator::identifyFeed(Communication::Receiver & receiver) const
+{
+  if(feeds_[FEED_B] == &receiver)
+  {
+    return FEED_B;
+  }
+  return FEED_A;
+}
+
+void
+FeedArbitrator::receiverStarted(Communication::Receiver & receiver)
+{
+  boost::mutex::scoped_lock lock(arbitrationMutex_);
+  // Receivers started directly (rather than via start()) are assigned in order.
+  if(feeds_[FEED_A] != &receiver && feeds_[FEED_B] != &receiver)
+  {
+    if(feeds_[FEED_A] == 0)
+    {
+      feeds_[FEED_A] = &receiver;
+    }
+    else if(feeds_[FEED_B] == 0)
+    {
+      feeds_[FEED_B] = &receiver;
+    }
+    else
+    {
+      throw UsageError("Coding Error", "FeedArbitrator supports only two receivers.");
+    }
+  }
+  if(runningFeeds_++ == 0)
+  {
+    target_.receiverStarted(receiver);
+  }
+}
+
+void
+FeedArbitrator::receiverStopped(Communication::Receiver & receiver)
+{
+  boost::mutex::scoped_lock lock(arbitrationMutex_);
+  if(runningFeeds_ > 0 && --runningFeeds_ == 0)
+  {
+    target_.receiverStopped(receiver);
+  }
+}
+
+bool
+FeedArbitrator::serviceQueue(Communication::Receiver & receiver)
+{
+  Feed feed = identifyFeed(receiver);
+  bool result = true;
+  Communication::LinkedBuffer * buffer = receiver.getBuffer(false);
+  while(result && buffer != 0)
+  {
+    try
+    {
+      result = arbitrate(feed, buffer->get(), buffer->used(), buffer->receiveTime());
+    }
+    catch(const std::exception &ex)
+    {
+      result = reportDecodingError(ex.what());
+    }
+    receiver.releaseBuffer(buffer);
+    buffer = 0;
+    if(result)
+    {
+      buffer = receiver.getBuffer(false);
+    }
+  }
+  return result;
+}
+
+bool
+FeedArbitrator::arbitrate(Feed feed, const unsigned char * buffer, size_t size, uint64 receiveTime)
+{
+  boost::mutex::scoped_lock lock(arbitrationMutex_);
+  currentBuffer_ = buffer;
+  currentSize_ = size;
+  size_t blockSize = 0;
+  bool skip = false;
+  uint32 sequence = 0;
+  bool sequenced = sequenceAnalyzer_.analyzeHeader(*this, blockSize, skip)
+    && sequenceAnalyzer_.getSequenceNumber(sequence);
+  // the target assembler will analyze the header again, so discard what's left.
+  sequenceAnalyzer_.reset();
+  DataSource::reset();
+  currentBuffer_ = 0;
+  currentSize_ = 0;
+
+  if(!sequenced)
+  {
+    ++unsequencedPackets_[feed];
+    return reportDecodingError("No sequence number in packet header.  Ignoring packet.");
+  }
+
+  const size_t windowSize = window_.size();
+  uint64 & slot = window_[sequence % windowSize];
+  if(haveSequence_)
+  {
+    // signed difference handles sequence number wrap-around
+    int32 distance = int32(sequence - highestSequence_);
+    if(distance <= 0)
+    {
+      if(size_t(-int64(distance)) >= windowSize || slot == uint64(sequence) + 1)
+      {
+        ++duplicatesDropped_[feed];
+        return true;
+      }
+    }
+    else
+    {
+      highestSequence_ = sequence;
+    }
+  }
+  else
+  {
+    haveSequence_ = true;
+    highestSequence_ = sequence;
+  }
+  slot = uint64(sequence) + 1;
+  ++packetsWon_[feed];
+  return target_.consumeBuffer(buffer, size, receiveTime);
+}
+
+bool
+FeedArbitrator::getBuffer(const uchar *& buffer, size_t & size)
+{
+  bool result = currentSize_ > 0;
+  buffer = currentBuffer_;
+  currentBuffer_ = 0;
+  size = currentSize_;
+  currentSize_ = 0;
+  return result;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef FEEDARBITRATOR_H
+#define FEEDARBITRATOR_H
+
+#include "FeedArbitrator_fwd.h"
+#include <Common/QuickFAST_Export.h>
+
+#include <Communication/Assembler.h>
+#include <Communication/Receiver_fwd.h>
+#include <Codecs/DataSource.h>
+#include <Codecs/HeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler_fwd.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    /// @brief Arbitrate between redundant (A/B) packet feeds.
+    ///
+    /// Many exchanges publish the same data on two multicast feeds.  The FeedArbitrator
+    /// services the queues of both Receivers, uses a HeaderAnalyzer to find the sequence
+    /// number in each packet's header, and passes the first copy of each packet to a single
+    /// MessagePerPacketAssembler. The second copy is discarded.
+    ///
+    /// The sequence analyzer must be a separate object from the packet header analyzer
+    /// used by the target assembler, and must support HeaderAnalyzer::getSequenceNumber
+    /// (for example a FixedSizeHeaderAnalyzer configured with setSequenceNumberLocation).
+    ///
+    /// Either receiver may be serviced on any thread; delivery to the target assembler
+    /// is serialized.
+    class QuickFAST_Export FeedArbitrator
+      : public Communication::Assembler
+      , public Codecs::DataSource
+    {
+    public:
+      /// @brief Identify the feeds.
+      enum Feed
+      {
+        FEED_A,
+        FEED_B,
+        FEED_COUNT
+      };
+
+      /// @brief Construct the arbitrator
+      /// @param templateRegistry defines the decoding instructions (required by Assembler)
+      /// @param sequenceAnalyzer finds the sequence number in the packet header
+      /// @param assembler receives the packets that win the arbitration
+      /// @param windowSize is how many sequence numbers behind the highest seen are remembered
+      ///        for duplicate detection.  Older packets are discarded.
+      FeedArbitrator(
+          TemplateRegistryPtr templateRegistry,
+          HeaderAnalyzer & sequenceAnalyzer,
+          MessagePerPacketAssembler & assembler,
+          size_t windowSize = 1024);
+
+      virtual ~FeedArbitrator();
+
+      /// @brief Start both receivers with this arbitrator as their assembler.
+      /// @param feedA is the receiver for the A feed
+      /// @param feedB is the receiver for the B feed
+      /// @param bufferSize determines the maximum size of an incoming packet
+      /// @param bufferCount is the number of buffers to allocate for each receiver
+      /// @returns true if both receivers started successfully
+      bool start(
+        Communication::Receiver & feedA,
+        Communication::Receiver & feedB,
+        size_t bufferSize = 1400,
+        size_t bufferCount = 2);
+
+      /// @brief Forget all sequence numbers.
+      ///
+      /// Use this when the sequence numbers on the feed are reset, i.e. at start of day.
+      void resetSequence();
+
+      /// @brief How many packets from this feed were passed to the assembler
+      /// @param feed identifies the feed
+      /// @returns the packet count
+      size_t packetsWon(Feed feed) const
+      {
+        return packetsWon_[feed];
+      }
+
+      /// @brief How many packets from this feed were discarded as duplicates or stale
+      /// @param feed identifies the feed
+      /// @returns the packet count
+      size_t duplicatesDropped(Feed feed) const
+      {
+        return duplicatesDropped_[feed];
+      }
+
+      /// @brief How many packets from this feed were discarded because no sequence number was found
+      /// @param feed identifies the feed
+      /// @returns the packet count
+      size_t unsequencedPackets(Feed feed) const
+      {
+        return unsequencedPackets_[feed];
+      }
+
+      /// @brief The highest sequence number accepted so far.
+      /// @returns the sequence number (zero if none)
+      uint32 highestSequence() const
+      {
+        return highestSequence_;
+      }
+
+      ///////////////////////////
+      // Implement Assembler
+      virtual void receiverStarted(Communication::Receiver & receiver);
+      virtual void receiverStopped(Communication::Receiver & receiver);
+      virtual bool serviceQueue(Communication::Receiver & receiver);
+
+      ///////////////////////
+      // Implement DataSource
+      virtual bool getBuffer(const uchar *& buffer, size_t & size);
+
+    private:
+      Feed identifyFeed(Communication::Receiver & receiver) const;
+      bool arbitrate(Feed feed, const unsigned char * buffer, size_t size, uint64 receiveTime);
+
+    private:
+      FeedArbitrator & operator = (const FeedArbitrator &);
+      FeedArbitrator(const FeedArbitrator &);
+      FeedArbitrator();
+
+    private:
+      HeaderAnalyzer & sequenceAnalyzer_;
+      MessagePerPacketAssembler & target_;
+
+      boost::mutex arbitrationMutex_;
+      Communication::Receiver * feeds_[FEED_COUNT];
+      size_t runningFeeds_;
+
+      const unsigned char * currentBuffer_;
+      size_t currentSize_;
+
+      /// slot [seq % window] holds seq + 1 for each sequence number accepted (0 means empty)
+      std::vector<uint64> window_;
+      bool haveSequence_;
+      uint32 highestSequence_;
+
+      size_t packetsWon_[FEED_COUNT];
+      size_t duplicatesDropped_[FEED_COUNT];
+      size_t unsequencedPackets_[FEED_COUNT];
+    };
+  }
+}
+#endif // FEEDARBITRATOR_H
@@ -0,0 +1,18 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef FEEDARBITRATOR_FWD_H
+#define FEEDARBITRATOR_FWD_H
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    class FeedArbitrator;
+
+    ///@brief smart pointer to FeedArbitrator
+    typedef boost::shared_ptr<FeedArbitrator> FeedArbitratorPtr;
+  }
+}
+#endif // FEEDARBITRATOR_FWD_H
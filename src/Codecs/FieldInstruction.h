@@ -128,6 +128,20 @@ namespace QuickFAST{
         return qualifiedApplicationType_;
       }
 
+      /// @brief get the Application Type without its namespace
+      /// @returns the type as passed to setApplicationType()
+      const std::string & getLocalApplicationType() const
+      {
+        return applicationType_;
+      }
+
+      /// @brief get the namespace for the Application Type
+      /// @returns the namespace as passed to setApplicationType()
+      const std::string & getApplicationTypeNamespace() const
+      {
+        return applicationTypeNamespace_;
+      }
+
       /// @brief Retrieve the field's name.
       /// @returns the field name.
       const std::string & getName() const
@@ -157,6 +171,13 @@ namespace QuickFAST{
         return mandatory_;
       }
 
+      /// @brief Is overflow checking disabled?
+      /// @returns true if setIgnoreOverflow(true) was called.
+      bool getIgnoreOverflow()const
+      {
+        return ignoreOverflow_;
+      }
+
       /// @brief Implement the dictionary= attribute.
       ///
       /// Defines an dictionary to be used for this element.
@@ -43,6 +43,18 @@ namespace QuickFAST{
         const Messages::MessageAccessor & accessor) const;
       virtual ValueType::Type fieldInstructionType()const;
 
+      /// @brief The name of the referenced template.
+      const std::string & templateName()const
+      {
+        return templateName_;
+      }
+
+      /// @brief The namespace of the referenced template.
+      const std::string & templateNamespace()const
+      {
+        return templateNamespace_;
+      }
+
     private:
       void interpretValue(const std::string & value);
 
@@ -145,6 +145,45 @@ namespace QuickFAST{
         dictionaryName_ = name;
       }
 
+      /// @brief Get the key= attribute
+      /// @returns the key or an empty string if none was specified.
+      const std::string & getKey()const
+      {
+        return key_;
+      }
+
+      /// @brief Get the nsKey= attribute
+      /// @returns the key namespace or an empty string if none was specified.
+      const std::string & getKeyNamespace()const
+      {
+        return keyNamespace_;
+      }
+
+      /// @brief Get the dictionary= attribute
+      /// @returns the dictionary name or an empty string if none was specified.
+      const std::string & getDictionaryName()const
+      {
+        return dictionaryName_;
+      }
+
+      /// @brief Get the pmap bit assigned by setPMapBit()
+      /// @param[out] pmapBit receives the bit if one was assigned.
+      /// @returns true if a pmap bit was assigned.
+      bool getPMapBit(size_t & pmapBit)const
+      {
+        pmapBit = pmapBit_;
+        return pmapBitValid_;
+      }
+
+      /// @brief Get the dictionary entry assigned by indexDictionaries()
+      /// @param[out] dictionaryIndex receives the index if one was assigned.
+      /// @returns true if this operation has a dictionary entry.
+      bool getDictionaryIndex(size_t & dictionaryIndex)const
+      {
+        dictionaryIndex = dictionaryIndex_;
+        return dictionaryIndexValid_;
+      }
+
       /// @brief Assign a dictionary entry to the field associated with this operation.
       /// @param indexer assigns the index.
       /// @param dictionaryName is the parent's dictionary name (inherited unless overridden)
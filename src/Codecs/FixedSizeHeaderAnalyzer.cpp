@@ -25,6 +25,12 @@ FixedSizeHeaderAnalyzer::FixedSizeHeaderAnalyzer(
 , byteCount_(0)
 , testSkip_(0)
 , headersParsed_(0)
+, bigEndian_(bigEndian)
+, headerPosition_(0)
+, sequenceOffset_(0)
+, sequenceBytes_(0)
+, sequenceNumber_(0)
+, sequenceValid_(false)
 {
 }
 
@@ -32,6 +38,50 @@ FixedSizeHeaderAnalyzer::~FixedSizeHeaderAnalyzer()
 {
 }
 
+void
+FixedSizeHeaderAnalyzer::setSequenceNumberLocation(size_t offset, size_t sequenceBytes)
+{
+  if(sequenceBytes > sizeof(uint32) ||
+    offset + sequenceBytes > prefixBytes_ + sizeBytes_ + suffixBytes_)
+  {
+    throw std::invalid_argument("Sequence number does not fit in fixed size header.");
+  }
+  sequenceOffset_ = offset;
+  sequenceBytes_ = sequenceBytes;
+  sequenceValid_ = false;
+}
+
+bool
+FixedSizeHeaderAnalyzer::getSequenceNumber(uint32 & sequenceNumber) const
+{
+  if(sequenceValid_)
+  {
+    sequenceNumber = sequenceNumber_;
+  }
+  return sequenceValid_;
+}
+
+void
+FixedSizeHeaderAnalyzer::captureSequenceByte(uchar next)
+{
+  if(sequenceBytes_ != 0 &&
+    headerPosition_ >= sequenceOffset_ &&
+    headerPosition_ < sequenceOffset_ + sequenceBytes_)
+  {
+    size_t byteIndex = headerPosition_ - sequenceOffset_;
+    if(bigEndian_)
+    {
+      sequenceNumber_ <<= 8;
+      sequenceNumber_ |= (next & 0xFF);
+    }
+    else
+    {
+      sequenceNumber_ |= uint32(next & 0xFF) << (byteIndex * 8);
+    }
+  }
+  ++headerPosition_;
+}
+
 bool
 FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize, bool & skip)
 {
@@ -46,6 +96,9 @@ FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize,
         source.beginField("FIXED_SIZE_HEADER");
         state_ = ParsingPrefix;
         byteCount_ = 0;
+        headerPosition_ = 0;
+        sequenceNumber_ = 0;
+        sequenceValid_ = false;
         break;
       }
     case ParsingPrefix:
@@ -57,6 +110,7 @@ FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize,
           {
             return false;
           }
+          captureSequenceByte(next);
           ++byteCount_;
         }
         state_ = ParsingBlockSize;
@@ -73,6 +127,7 @@ FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize,
           {
             return false;
           }
+          captureSequenceByte(next);
           if(swapNeeded_)
           {
             blockSize |= (next & 0xFF) << (byteCount_ * 8);
@@ -98,6 +153,7 @@ FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize,
           {
             return false;
           }
+          captureSequenceByte(next);
           ++byteCount_;
         }
         state_ = ParsingComplete;
@@ -113,6 +169,7 @@ FixedSizeHeaderAnalyzer::analyzeHeader(DataSource & source, size_t & blockSize,
   blockSize = blockSize_;
   blockSize_ = 0;
   byteCount_ = 0;
+  sequenceValid_ = (sequenceBytes_ != 0);
   if(testSkip_ != 0 && (++headersParsed_ % testSkip_ == 0))
   {
     std::cout << std::endl << "SKIPPING HEADER " << headersParsed_ << std::endl;
@@ -127,4 +184,6 @@ FixedSizeHeaderAnalyzer::reset()
   state_ = ParsingIdle;
   blockSize_ = 0;
   byteCount_ = 0;
+  headerPosition_ = 0;
+  sequenceValid_ = false;
 }
@@ -42,10 +42,20 @@ namespace QuickFAST{
         testSkip_ = testSkip;
       }
 
+      /// @brief Identify the bytes in the header that hold a sequence number.
+      ///
+      /// The sequence number is interpreted with the same byte order as the block size.
+      /// @param offset from the start of the header (including the prefix) to the sequence number.
+      /// @param sequenceBytes is the number of bytes in the sequence number (1 through 4).
+      void setSequenceNumberLocation(size_t offset, size_t sequenceBytes);
+
       ////////////////////////
       // Implement HeaderAnalyzer
       virtual bool analyzeHeader(DataSource & source, size_t & blockSize, bool & skip);
       virtual void reset();
+      virtual bool getSequenceNumber(uint32 & sequenceNumber) const;
+    private:
+      void captureSequenceByte(uchar next);
     private:
       size_t prefixBytes_;
       size_t sizeBytes_;
@@ -65,6 +75,13 @@ namespace QuickFAST{
 
       size_t testSkip_;
       size_t headersParsed_;
+
+      bool bigEndian_;
+      size_t headerPosition_;
+      size_t sequenceOffset_;
+      size_t sequenceBytes_;
+      uint32 sequenceNumber_;
+      bool sequenceValid_;
     };
   }
 }
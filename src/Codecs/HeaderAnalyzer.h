@@ -8,6 +8,7 @@
 #define HEADERANALYZER_H
 #include "HeaderAnalyzer_fwd.h"
 #include <Codecs/DataSource_fwd.h>
+#include <Common/Types.h>
 namespace QuickFAST{
   namespace Codecs{
     /// An interface to be used to adapt to various styles of block or message header
@@ -50,6 +51,17 @@ namespace QuickFAST{
       virtual void reset()
       {
       }
+
+      /// @brief Retrieve the sequence number found in the most recently analyzed header.
+      ///
+      /// Analyzers that do not know where the sequence number lives (the default)
+      /// return false.
+      /// @param[out] sequenceNumber from the last complete header.
+      /// @returns true if the last header carried a sequence number.
+      virtual bool getSequenceNumber(uint32 & /*sequenceNumber*/) const
+      {
+        return false;
+      }
     };
   }
 }
@@ -0,0 +1,214 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "MessageIndex.h"
+#include <Codecs/Decoder.h>
+#include <Codecs/DictionarySnapshot.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Messages/NullMessageBuilder.h>
+#include <algorithm>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  const char indexMagic[4] = {'Q', 'F', 'M', 'I'};
+  const uint32 indexVersion = 2;
+
+  void writeInteger(std::ostream & out, uint64 value, size_t bytes)
+  {
+    for(size_t nByte = 0; nByte < bytes; ++nByte)
+    {
+      out.put(char(value & 0xFF));
+      value >>= 8;
+    }
+  }
+
+  uint64 readInteger(std::istream & in, size_t bytes)
+  {
+    unsigned char buffer[8];
+    in.read(reinterpret_cast<char *>(buffer), bytes);
+    if(size_t(in.gcount()) != bytes)
+    {
+      throw std::runtime_error("Message index file is truncated.");
+    }
+    uint64 value = 0;
+    for(size_t nByte = bytes; nByte > 0; --nByte)
+    {
+      value <<= 8;
+      value |= buffer[nByte - 1];
+    }
+    return value;
+  }
+
+  bool lessMessageNumber(uint64 messageNumber, const MessageIndex::Entry & entry)
+  {
+    return messageNumber < entry.messageNumber_;
+  }
+}
+
+MessageIndex::MessageIndex()
+: messageCount_(0)
+, dataSize_(0)
+, interval_(0)
+{
+}
+
+MessageIndex::~MessageIndex()
+{
+}
+
+void
+MessageIndex::addEntry(
+  uint64 messageNumber,
+  uint64 offset,
+  const Decoder & decoder,
+  DictionarySnapshot & snapshot)
+{
+  entries_.push_back(Entry());
+  Entry & entry = entries_.back();
+  entry.messageNumber_ = messageNumber;
+  entry.offset_ = offset;
+  decoder.saveDictionary(snapshot);
+  snapshot.write(entry.dictionary_);
+}
+
+uint64
+MessageIndex::build(Decoder & decoder, DataSourceMapped & source, size_t interval)
+{
+  entries_.clear();
+  interval_ = interval;
+  dataSize_ = source.fileSize();
+  source.seek(0);
+  decoder.reset();
+
+  TemplateRegistryCPtr registry = decoder.getTemplateRegistry();
+  DictionarySnapshot snapshot(registry);
+  Messages::NullMessageBuilder builder;
+  uint64 messageNumber = 0;
+  // the start of the file is the first checkpoint
+  bool reset = true;
+  while(source.messageAvailable() > 0)
+  {
+    if(reset || (interval_ != 0 && messageNumber % interval_ == 0))
+    {
+      addEntry(messageNumber, source.bytesConsumed(), decoder, snapshot);
+    }
+    decoder.decodeMessage(source, builder);
+    ++messageNumber;
+
+    template_id_t templateId = decoder.getTemplateId();
+    reset = templateId == Context::SCPResetTemplateId;
+    TemplateCPtr templatePtr;
+    if(!reset && registry->getTemplate(templateId, templatePtr))
+    {
+      reset = templatePtr->getReset();
+    }
+  }
+  messageCount_ = messageNumber;
+  return messageCount_;
+}
+
+const MessageIndex::Entry *
+MessageIndex::find(uint64 messageNumber) const
+{
+  std::vector<Entry>::const_iterator it =
+    std::upper_bound(entries_.begin(), entries_.end(), messageNumber, lessMessageNumber);
+  if(it == entries_.begin())
+  {
+    return 0;
+  }
+  --it;
+  return &*it;
+}
+
+bool
+MessageIndex::seek(uint64 messageNumber, Decoder & decoder, DataSourceMapped & source) const
+{
+  if(messageNumber >= messageCount_)
+  {
+    return false;
+  }
+  if(source.fileSize() != dataSize_)
+  {
+    throw std::runtime_error("Message index does not match the FAST data file.");
+  }
+  const Entry * entry = find(messageNumber);
+  if(entry == 0)
+  {
+    return false;
+  }
+  DictionarySnapshot snapshot(decoder.getTemplateRegistry());
+  snapshot.read(entry->dictionary_);
+  decoder.restoreDictionary(snapshot);
+  source.seek(size_t(entry->offset_));
+  Messages::NullMessageBuilder builder;
+  for(uint64 skip = entry->messageNumber_; skip < messageNumber; ++skip)
+  {
+    decoder.decodeMessage(source, builder);
+  }
+  return true;
+}
+
+void
+MessageIndex::write(std::ostream & out) const
+{
+  out.write(indexMagic, sizeof(indexMagic));
+  writeInteger(out, indexVersion, 4);
+  writeInteger(out, dataSize_, 8);
+  writeInteger(out, messageCount_, 8);
+  writeInteger(out, interval_, 4);
+  writeInteger(out, entries_.size(), 4);
+  for(size_t nEntry = 0; nEntry < entries_.size(); ++nEntry)
+  {
+    const Entry & entry = entries_[nEntry];
+    writeInteger(out, entry.messageNumber_, 8);
+    writeInteger(out, entry.offset_, 8);
+    writeInteger(out, entry.dictionary_.size(), 4);
+    out.write(entry.dictionary_.data(), entry.dictionary_.size());
+  }
+}
+
+void
+MessageIndex::read(std::istream & in)
+{
+  char magic[sizeof(indexMagic)];
+  in.read(magic, sizeof(magic));
+  if(size_t(in.gcount()) != sizeof(magic) || !std::equal(magic, magic + sizeof(magic), indexMagic))
+  {
+    throw std::runtime_error("Not a message index file.");
+  }
+  if(readInteger(in, 4) != indexVersion)
+  {
+    throw std::runtime_error("Unsupported message index file version.");
+  }
+  std::vector<Entry> entries;
+  uint64 dataSize = readInteger(in, 8);
+  uint64 messageCount = readInteger(in, 8);
+  size_t interval = size_t(readInteger(in, 4));
+  size_t entryCount = size_t(readInteger(in, 4));
+  for(size_t nEntry = 0; nEntry < entryCount; ++nEntry)
+  {
+    entries.push_back(Entry());
+    Entry & entry = entries.back();
+    entry.messageNumber_ = readInteger(in, 8);
+    entry.offset_ = readInteger(in, 8);
+    size_t length = size_t(readInteger(in, 4));
+    entry.dictionary_.resize(length);
+    if(length > 0)
+    {
+      in.read(&entry.dictionary_[0], length);
+      if(size_t(in.gcount()) != length)
+      {
+        throw std::runtime_error("Message index file is truncated.");
+      }
+    }
+  }
+  entries_.swap(entries);
+  dataSize_ = dataSize;
+  messageCount_ = messageCount;
+  interval_ = interval;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MESSAGEINDEX_H
+#define MESSAGEINDEX_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/Decoder_fwd.h>
+#include <Codecs/DictionarySnapshot_fwd.h>
+#include <Codecs/DataSourceMapped.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Random access into a file of raw FAST messages.
+    ///
+    /// Decoding a message depends on the dictionary state left by every earlier
+    /// message, so normally the only way to reach message N is to decode messages
+    /// 0 through N-1.  A MessageIndex is built by decoding the file once.
+    /// Every "interval" messages, and after every message that resets the
+    /// dictionary (a template with reset="yes" or the SCP reset template)
+    /// it records the message number, the offset of the message in the file and
+    /// a DictionarySnapshot of the Decoder's dictionary.
+    ///
+    /// seek() restores the nearest snapshot at or before the requested message,
+    /// positions the DataSource and decodes (and discards) at most interval-1
+    /// messages to reach the requested one.
+    ///
+    /// The index can be written to and read from a file so it only needs
+    /// to be built once per data file.
+    class QuickFAST_Export MessageIndex
+    {
+    public:
+      /// @brief A point in the file where decoding can start.
+      struct Entry
+      {
+        /// @brief The number of the message (counting from 0) at offset_
+        uint64 messageNumber_;
+        /// @brief Offset of the message in the file.
+        uint64 offset_;
+        /// @brief Decoder state before decoding the message (see DictionarySnapshot::write()).
+        std::string dictionary_;
+      };
+
+      MessageIndex();
+      ~MessageIndex();
+
+      /// @brief Build the index by decoding the entire file.
+      ///
+      /// The source is positioned to the beginning of the file and the decoder is reset first.
+      /// @param decoder decodes the messages.  It should be configured as it will be for seek().
+      /// @param source contains raw FAST messages.
+      /// @param interval is the number of messages between index entries.
+      /// @returns the number of messages in the file.
+      uint64 build(Decoder & decoder, DataSourceMapped & source, size_t interval = 10000);
+
+      /// @brief Prepare to decode a particular message.
+      ///
+      /// On return the next message decoded from the source will be message messageNumber.
+      /// @param messageNumber identifies the message.  The first message in the file is message 0.
+      /// @param decoder uses the same templates as the decoder used to build the index.
+      /// @param source is the file the index was built from.
+      /// @returns false if messageNumber is past the end of the file.
+      /// @throws std::runtime_error if the source or decoder don't match the index.
+      bool seek(uint64 messageNumber, Decoder & decoder, DataSourceMapped & source) const;
+
+      /// @brief Find the last entry at or before a message.
+      /// @param messageNumber identifies the message.
+      /// @returns the entry or zero if the index is empty
+      const Entry * find(uint64 messageNumber) const;
+
+      /// @brief Write the index to a (binary) stream.
+      void write(std::ostream & out) const;
+
+      /// @brief Replace the index with one read from a (binary) stream.
+      /// @throws std::runtime_error if the stream doesn't contain a valid index.
+      void read(std::istream & in);
+
+      /// @brief The number of messages in the indexed file.
+      uint64 messageCount()const
+      {
+        return messageCount_;
+      }
+
+      /// @brief The size of the indexed file.
+      uint64 dataSize()const
+      {
+        return dataSize_;
+      }
+
+      /// @brief The number of messages between index entries.
+      size_t interval()const
+      {
+        return interval_;
+      }
+
+      /// @brief The number of entries in the index.
+      size_t size()const
+      {
+        return entries_.size();
+      }
+
+      /// @brief Access an entry
+      /// @param index from 0 to size()-1
+      const Entry & entry(size_t index)const
+      {
+        return entries_[index];
+      }
+
+    private:
+      void addEntry(
+        uint64 messageNumber,
+        uint64 offset,
+        const Decoder & decoder,
+        DictionarySnapshot & snapshot);
+
+    private:
+      uint64 messageCount_;
+      uint64 dataSize_;
+      size_t interval_;
+      std::vector<Entry> entries_;
+    };
+  }
+}
+#endif // MESSAGEINDEX_H
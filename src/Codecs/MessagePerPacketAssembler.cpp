@@ -7,6 +7,8 @@
 #include "MessagePerPacketAssembler.h"
 #include <Messages/ValueMessageBuilder.h>
 #include <Codecs/Decoder.h>
+#include <Common/Timestamp.h>
+#include <Common/AllocationCounter.h>
 
 using namespace QuickFAST;
 using namespace Codecs;
@@ -37,28 +39,145 @@ MessagePerPacketAssembler::serviceQueue(Communication::Receiver & receiver)
   Communication::LinkedBuffer * buffer = receiver.getBuffer(false);
   while(result && buffer != 0)
   {
+    if(sequencer_)
+    {
+      result = sequenceBuffer(receiver, buffer);
+    }
+    else
+    {
+      try
+      {
+        result = consumeBuffer(buffer->get(), buffer->used(), buffer->receiveTime());
+      }
+      catch(const std::exception &ex)
+      {
+        countDecodingError();
+        result = reportDecodingError(ex.what());
+        reset();
+      }
+      receiver.releaseBuffer(buffer);
+    }
+    buffer = 0;
+    if(result)
+    {
+      buffer = receiver.getBuffer(false);
+    }
+  }
+  if(result && sequencer_)
+  {
+    size_t missing = sequencer_->expire();
+    if(missing != 0)
+    {
+      result = reportGap(missing);
+    }
+    result = deliverReady(receiver) && result;
+  }
+  return result;
+}
+
+void
+MessagePerPacketAssembler::setPacketSequencing(size_t windowSize, unsigned long timeoutMilliseconds)
+{
+  sequencer_.reset(new PacketSequencer(windowSize, timeoutMilliseconds));
+}
+
+bool
+MessagePerPacketAssembler::sequenceBuffer(Communication::Receiver & receiver, Communication::LinkedBuffer * buffer)
+{
+  bool result = true;
+  uint32 sequence = 0;
+  if(!peekSequence(buffer->get(), buffer->used(), sequence))
+  {
+    // no sequence number: nothing to put in order.
     try
     {
-      result = consumeBuffer(buffer->get(), buffer->used());
+      result = consumeBuffer(buffer->get(), buffer->used(), buffer->receiveTime());
     }
     catch(const std::exception &ex)
     {
+      countDecodingError();
       result = reportDecodingError(ex.what());
       reset();
     }
     receiver.releaseBuffer(buffer);
-    buffer = 0;
+    return result;
+  }
+  size_t missing = 0;
+  if(!sequencer_->accept(sequence, buffer, missing))
+  {
+    if(builder_.wantLog(Common::Logger::QF_LOG_VERBOSE))
+    {
+      std::stringstream message;
+      message << "Discarding duplicate packet #" << sequence;
+      builder_.logMessage(Common::Logger::QF_LOG_VERBOSE, message.str());
+    }
+    receiver.releaseBuffer(buffer);
+    return true;
+  }
+  if(missing != 0)
+  {
+    result = reportGap(missing);
+  }
+  return deliverReady(receiver) && result;
+}
+
+bool
+MessagePerPacketAssembler::peekSequence(const unsigned char * buffer, size_t size, uint32 & sequence)
+{
+  currentBuffer_ = buffer;
+  currentSize_ = size;
+  size_t blockSize = 0;
+  bool skip = false;
+  bool result = packetHeaderAnalyzer_.analyzeHeader(*this, blockSize, skip)
+    && packetHeaderAnalyzer_.getSequenceNumber(sequence);
+  // consumeBuffer will analyze the header again when the packet is decoded.
+  packetHeaderAnalyzer_.reset();
+  DataSource::reset();
+  currentBuffer_ = 0;
+  currentSize_ = 0;
+  return result;
+}
+
+bool
+MessagePerPacketAssembler::deliverReady(Communication::Receiver & receiver)
+{
+  bool result = true;
+  Communication::LinkedBuffer * buffer = sequencer_->nextReady();
+  while(buffer != 0)
+  {
+    // once decoding stops, keep draining so the buffers go back to the receiver.
     if(result)
     {
-      buffer = receiver.getBuffer(false);
+      try
+      {
+        result = consumeBuffer(buffer->get(), buffer->used(), buffer->receiveTime());
+      }
+      catch(const std::exception &ex)
+      {
+        countDecodingError();
+        result = reportDecodingError(ex.what());
+        reset();
+      }
     }
+    receiver.releaseBuffer(buffer);
+    buffer = sequencer_->nextReady();
   }
   return result;
 }
 
 bool
-MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t size)
+MessagePerPacketAssembler::reportGap(size_t missing)
 {
+  std::stringstream message;
+  message << "Sequence gap: " << missing << " packet(s) lost starting at #"
+    << sequencer_->lastGapStart();
+  return builder_.reportCommunicationError(message.str());
+}
+
+bool
+MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t size, uint64 receiveTime)
+{
+  Common::AllocationPhase allocationPhase(Common::AllocationCounter::ASSEMBLER);
   bool result = true;
   ++messageCount_;
   ++byteCount_ += size;
@@ -86,6 +205,7 @@ MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t si
     if(!packetHeaderAnalyzer_.analyzeHeader(*this, blockSize, skipBlock))
     {
       // header must be complete in one packet
+      countDecodingError();
       builder_.reportDecodingError("Invalid header in packet.  Ignoring packet.");
       packetHeaderAnalyzer_.reset();
       DataSource::reset();
@@ -102,6 +222,7 @@ MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t si
       }
       else
       {
+        builder_.setReceiveTimes(receiveTime, Common::wallClockNanoseconds());
         // note we apply reset at the packet level. If there are multiple messages per packet
         // the decoder is NOT reset for each one.
         if(reset_)
@@ -115,6 +236,7 @@ MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t si
           if(!messageHeaderAnalyzer_.analyzeHeader(*this, messageSize, skipMessage))
           {
             // header must be complete in one packet
+            countDecodingError();
             builder_.reportDecodingError("Invalid message header.  Ignoring remainder of packet.");
             messageHeaderAnalyzer_.reset();
             DataSource::reset();
@@ -130,6 +252,7 @@ MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t si
           else
           {
             decoder_.decodeMessage(*this, builder_);
+            countMessage();
           }
         }
       }
@@ -137,6 +260,7 @@ MessagePerPacketAssembler::consumeBuffer(const unsigned char * buffer, size_t si
   }
   catch (const std::exception &ex)
   {
+    countDecodingError();
     result = builder_.reportDecodingError(ex.what());
     reset();
 
@@ -160,8 +284,18 @@ MessagePerPacketAssembler::receiverStarted(Communication::Receiver & /*receiver*
   }
 }
 void
-MessagePerPacketAssembler::receiverStopped(Communication::Receiver & /*receiver*/)
+MessagePerPacketAssembler::receiverStopped(Communication::Receiver & receiver)
 {
+  if(sequencer_)
+  {
+    // decode whatever is being held and return the buffers to the receiver.
+    size_t missing = sequencer_->flush();
+    if(missing != 0)
+    {
+      reportGap(missing);
+    }
+    deliverReady(receiver);
+  }
   if(builder_.wantLog(Common::Logger::QF_LOG_INFO))
   {
     builder_.logMessage(Common::Logger::QF_LOG_INFO, "Receiver stopped");
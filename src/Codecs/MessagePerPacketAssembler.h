@@ -12,6 +12,7 @@
 #include <Codecs/Decoder.h>
 #include <Codecs/DataSource.h>
 #include <Codecs/HeaderAnalyzer.h>
+#include <Codecs/PacketSequencer.h>
 #include <Codecs/TemplateRegistry_fwd.h>
 #include <Messages/ValueMessageBuilder_fwd.h>
 
@@ -45,6 +46,24 @@ namespace QuickFAST
         messageLimit_ = messageLimit;
       }
 
+      /// @brief Deliver packets in sequence number order.
+      ///
+      /// The packet header analyzer must supply sequence numbers (see HeaderAnalyzer::getSequenceNumber).
+      /// Packets with no sequence number are decoded as they arrive.
+      /// Gaps are reported to the builder via reportCommunicationError.
+      /// Out-of-order packets are held in their buffers, so the receiver needs
+      /// windowSize additional buffers.
+      /// @param windowSize is the maximum number of out-of-order packets to hold.
+      /// @param timeoutMilliseconds is how long to wait for a missing packet.
+      void setPacketSequencing(size_t windowSize, unsigned long timeoutMilliseconds);
+
+      /// @brief Access the packet sequencer (for statistics)
+      /// @returns a pointer to the sequencer; zero if packet sequencing is not enabled.
+      const PacketSequencer * packetSequencer() const
+      {
+        return sequencer_.get();
+      }
+
       /// @brief Access the internal decoder
       /// @returns a reference to the internal decoder
       Codecs::Decoder & decoder()
@@ -83,8 +102,21 @@ namespace QuickFAST
       // Implement DataSource
       virtual bool getBuffer(const uchar *& buffer, size_t & size);
 
+      /// @brief Decode the message(s) in a single packet.
+      ///
+      /// Normally called from serviceQueue, but exposed so a packet filter
+      /// (i.e. a FeedArbitrator) can deliver the packets it accepts.
+      /// @param buffer points to the packet
+      /// @param size is the number of bytes in the packet
+      /// @param receiveTime is when the packet was received (passed to the builder)
+      /// @returns true if decoding should continue
+      bool consumeBuffer(const unsigned char * buffer, size_t size, uint64 receiveTime = 0);
+
     private:
-      bool consumeBuffer(const unsigned char * buffer, size_t size);
+      bool sequenceBuffer(Communication::Receiver & receiver, Communication::LinkedBuffer * buffer);
+      bool peekSequence(const unsigned char * buffer, size_t size, uint32 & sequence);
+      bool deliverReady(Communication::Receiver & receiver);
+      bool reportGap(size_t missing);
     private:
       MessagePerPacketAssembler & operator = (const MessagePerPacketAssembler &);
       MessagePerPacketAssembler(const MessagePerPacketAssembler &);
@@ -101,6 +133,8 @@ namespace QuickFAST
       size_t messageCount_;
       size_t byteCount_;
       size_t messageLimit_;
+
+      boost::scoped_ptr<PacketSequencer> sequencer_;
     };
   }
 }
@@ -18,6 +18,8 @@ MulticastDecoder::MulticastDecoder(
 , templateRegistry_(templateRegistry)
 , messageLimit_(0)
 , strict_(true)
+, reset_(false)
+, statistics_(0)
 , verboseOut_(0)
 {
 }
@@ -32,6 +34,8 @@ MulticastDecoder::MulticastDecoder(
 , templateRegistry_(templateRegistry)
 , messageLimit_(0)
 , strict_(true)
+, reset_(false)
+, statistics_(0)
 , verboseOut_(0)
 {
 }
@@ -40,6 +44,14 @@ MulticastDecoder::~MulticastDecoder()
 {
 }
 
+void
+MulticastDecoder::setStatistics(Common::StatisticsRegistry * registry, const std::string & prefix)
+{
+  statistics_ = registry;
+  statisticsPrefix_ = prefix;
+  receiver_.setStatistics(registry, prefix + "receiver.");
+}
+
 void
 MulticastDecoder::setVerboseOutput(std::ostream & out)
 {
@@ -109,6 +121,8 @@ MulticastDecoder::start(
     builder));
   assembler_->setMessageLimit(messageLimit_);
   assembler_->decoder().setStrict(strict_);
+  assembler_->setReset(reset_);
+  assembler_->setStatistics(statistics_, statisticsPrefix_ + "assembler.");
   if(verboseOut_ != 0)
   {
     assembler_->decoder().setVerboseOutput(*verboseOut_);
@@ -132,6 +146,8 @@ MulticastDecoder::start(
     builder));
   assembler_->setMessageLimit(messageLimit_);
   assembler_->decoder().setStrict(strict_);
+  assembler_->setReset(reset_);
+  assembler_->setStatistics(statistics_, statisticsPrefix_ + "assembler.");
   if(verboseOut_ != 0)
   {
     assembler_->decoder().setVerboseOutput(*verboseOut_);
@@ -156,6 +172,8 @@ MulticastDecoder::start(
     builder));
   assembler_->setMessageLimit(messageLimit_);
   assembler_->decoder().setStrict(strict_);
+  assembler_->setReset(reset_);
+  assembler_->setStatistics(statistics_, statisticsPrefix_ + "assembler.");
   if(verboseOut_ != 0)
   {
     assembler_->decoder().setVerboseOutput(*verboseOut_);
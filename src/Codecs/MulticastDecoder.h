@@ -70,6 +70,25 @@ namespace QuickFAST{
       /// @param strict true to enable; false to disable strict checking
       void setStrict(bool strict);
 
+      /// @brief Reset the decoder at the start of every packet.
+      ///
+      /// Use this when each packet is encoded independently of the others so a
+      /// lost packet cannot leave the dictionary out of step with the sender.
+      /// Must be called before start().
+      /// @param reset true to reset before every packet.
+      void setReset(bool reset)
+      {
+        reset_ = reset;
+      }
+
+      /// @brief Publish the statistics of the receiver and the assembler.
+      ///
+      /// They are named prefix + "receiver." and prefix + "assembler." followed
+      /// by the name of the statistic.  Must be called before start().
+      /// @param registry must outlive this object (or zero to stop publishing.)
+      /// @param prefix distinguishes this decoder from others using the same registry.
+      void setStatistics(Common::StatisticsRegistry * registry, const std::string & prefix = "");
+
       /// @brief get the current status of the strict property.
       ///
       /// @returns true if strict checking is enabled.
@@ -178,6 +197,9 @@ namespace QuickFAST{
       size_t byteCount_;
       size_t messageCount_;
       bool strict_;
+      bool reset_;
+      Common::StatisticsRegistry * statistics_;
+      std::string statisticsPrefix_;
       std::ostream * verboseOut_;
     };
   }
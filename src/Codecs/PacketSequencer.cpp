@@ -0,0 +1,180 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "PacketSequencer.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace QuickFAST;
+using namespace Codecs;
+
+PacketSequencer::PacketSequencer(size_t windowSize, unsigned long timeoutMilliseconds)
+  : window_(windowSize, 0)
+  , timeout_(boost::posix_time::milliseconds(timeoutMilliseconds))
+  , started_(false)
+  , expected_(0)
+  , highest_(0)
+  , held_(0)
+  , overflow_(0)
+  , overflowSequence_(0)
+  , flushing_(false)
+  , lastGapStart_(0)
+  , gaps_(0)
+  , lostPackets_(0)
+  , duplicates_(0)
+  , reordered_(0)
+{
+  if(windowSize == 0)
+  {
+    throw std::invalid_argument("PacketSequencer window size must be greater than zero.");
+  }
+}
+
+PacketSequencer::~PacketSequencer()
+{
+}
+
+bool
+PacketSequencer::accept(uint32 sequence, Communication::LinkedBuffer * buffer, size_t & missing)
+{
+  missing = 0;
+  if(!started_)
+  {
+    started_ = true;
+    expected_ = sequence;
+    highest_ = sequence;
+  }
+  // signed differences handle sequence number wrap-around
+  int32 distance = int32(sequence - expected_);
+  if(distance < 0)
+  {
+    ++duplicates_;
+    return false;
+  }
+
+  if(size_t(distance) < window_.size())
+  {
+    Communication::LinkedBuffer *& slot = window_[sequence % window_.size()];
+    if(slot != 0)
+    {
+      ++duplicates_;
+      return false;
+    }
+    slot = buffer;
+    if(distance > 0 && held_ == 0)
+    {
+      holdStart_ = boost::posix_time::microsec_clock::universal_time();
+    }
+    ++held_;
+  }
+  else
+  {
+    // Too far ahead to hold: give up on everything missing before it.
+    missing = size_t(distance) - held_;
+    lastGapStart_ = expected_;
+    ++gaps_;
+    lostPackets_ += missing;
+    overflow_ = buffer;
+    overflowSequence_ = sequence;
+    flushing_ = true;
+  }
+
+  if(int32(sequence - highest_) > 0)
+  {
+    highest_ = sequence;
+  }
+  else if(sequence != highest_)
+  {
+    ++reordered_;
+  }
+  return true;
+}
+
+Communication::LinkedBuffer *
+PacketSequencer::nextReady()
+{
+  while(true)
+  {
+    Communication::LinkedBuffer *& slot = window_[expected_ % window_.size()];
+    if(slot != 0)
+    {
+      Communication::LinkedBuffer * buffer = slot;
+      slot = 0;
+      --held_;
+      ++expected_;
+      if(held_ > 0 && !flushing_ && window_[expected_ % window_.size()] == 0)
+      {
+        // a new gap; start timing it now.
+        holdStart_ = boost::posix_time::microsec_clock::universal_time();
+      }
+      return buffer;
+    }
+    if(flushing_ && held_ > 0)
+    {
+      // skip over a packet that has already been counted as lost
+      ++expected_;
+      continue;
+    }
+    flushing_ = false;
+    if(overflow_ != 0)
+    {
+      Communication::LinkedBuffer * buffer = overflow_;
+      overflow_ = 0;
+      expected_ = overflowSequence_ + 1;
+      return buffer;
+    }
+    return 0;
+  }
+}
+
+size_t
+PacketSequencer::expire()
+{
+  if(held_ == 0 || flushing_)
+  {
+    return 0;
+  }
+  boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+  if(now - holdStart_ < timeout_)
+  {
+    return 0;
+  }
+  size_t missing = skipToHeld();
+  holdStart_ = now;
+  return missing;
+}
+
+size_t
+PacketSequencer::flush()
+{
+  if(held_ == 0 || flushing_)
+  {
+    return 0;
+  }
+  // every held packet is at or below highest_
+  size_t missing = size_t(uint32(highest_ - expected_) + 1) - held_;
+  if(missing > 0)
+  {
+    lastGapStart_ = expected_;
+    ++gaps_;
+    lostPackets_ += missing;
+  }
+  flushing_ = true;
+  return missing;
+}
+
+size_t
+PacketSequencer::skipToHeld()
+{
+  size_t missing = 0;
+  lastGapStart_ = expected_;
+  while(window_[expected_ % window_.size()] == 0)
+  {
+    ++expected_;
+    ++missing;
+  }
+  ++gaps_;
+  lostPackets_ += missing;
+  return missing;
+}
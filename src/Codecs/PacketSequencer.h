@@ -0,0 +1,153 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef PACKETSEQUENCER_H
+#define PACKETSEQUENCER_H
+
+#include "PacketSequencer_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Communication/LinkedBuffer.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    /// @brief Put sequenced packets back in order, detecting gaps and duplicates.
+    ///
+    /// Packets that arrive ahead of the expected sequence number are held (in the
+    /// LinkedBuffer in which they arrived -- no data is copied) in a bounded window.
+    /// They are released in sequence order when the missing packets arrive.
+    /// The missing packets are declared lost (a gap) when:
+    ///  - a packet arrives too far ahead to fit in the window, or
+    ///  - the oldest held packet has been waiting longer than the timeout.
+    ///
+    /// Typical use:
+    /// <pre>
+    ///   size_t missing = 0;
+    ///   if(!sequencer.accept(sequence, buffer, missing))
+    ///   {
+    ///     // duplicate: release buffer
+    ///   }
+    ///   // report missing (if any), then
+    ///   while((buffer = sequencer.nextReady()) != 0)
+    ///   {
+    ///     // decode and release buffer
+    ///   }
+    /// </pre>
+    ///
+    /// The timeout is checked only when expire() is called, so a gap at the end
+    /// of a burst is not declared until more traffic arrives.
+    ///
+    /// Buffers are held, not released, so the Receiver must have at least windowSize
+    /// more buffers than it would otherwise need.
+    class QuickFAST_Export PacketSequencer
+    {
+    public:
+      /// @brief Construct
+      /// @param windowSize is the maximum number of out-of-order packets to hold.
+      /// @param timeoutMilliseconds is how long to wait for a missing packet.
+      PacketSequencer(size_t windowSize, unsigned long timeoutMilliseconds);
+
+      ~PacketSequencer();
+
+      /// @brief Accept a newly arrived packet.
+      ///
+      /// Unless it is a duplicate, the sequencer takes ownership of the buffer until
+      /// it is returned by nextReady().
+      /// @param sequence is the sequence number from the packet header
+      /// @param buffer contains the packet
+      /// @param[out] missing is the number of packets declared lost by this call.
+      /// @returns false if the packet is a duplicate (or too late) and should be discarded.
+      bool accept(uint32 sequence, Communication::LinkedBuffer * buffer, size_t & missing);
+
+      /// @brief Get the next packet to be decoded, if any.
+      /// @returns the buffer or zero if nothing is ready.
+      Communication::LinkedBuffer * nextReady();
+
+      /// @brief Declare a gap if the oldest held packet has waited too long.
+      /// @returns the number of packets declared lost.
+      size_t expire();
+
+      /// @brief Give up on all missing packets so every held packet becomes ready.
+      /// @returns the number of packets declared lost.
+      size_t flush();
+
+      /// @brief The first sequence number in the most recently declared gap
+      uint32 lastGapStart() const
+      {
+        return lastGapStart_;
+      }
+
+      /// @brief The next sequence number expected.
+      uint32 expected() const
+      {
+        return expected_;
+      }
+
+      /// @brief Statistic: how many gaps have been declared
+      size_t gaps() const
+      {
+        return gaps_;
+      }
+
+      /// @brief Statistic: how many packets were declared lost
+      size_t lostPackets() const
+      {
+        return lostPackets_;
+      }
+
+      /// @brief Statistic: how many duplicate or late packets were discarded
+      size_t duplicates() const
+      {
+        return duplicates_;
+      }
+
+      /// @brief Statistic: how many packets arrived after a higher-numbered packet
+      /// and were put back in order.
+      size_t reordered() const
+      {
+        return reordered_;
+      }
+
+      /// @brief How many packets are being held right now
+      size_t held() const
+      {
+        return held_;
+      }
+
+    private:
+      size_t skipToHeld();
+
+    private:
+      PacketSequencer & operator = (const PacketSequencer &);
+      PacketSequencer(const PacketSequencer &);
+      PacketSequencer();
+
+    private:
+      /// slot [seq % window] holds the packet with that sequence number
+      std::vector<Communication::LinkedBuffer *> window_;
+      boost::posix_time::time_duration timeout_;
+      boost::posix_time::ptime holdStart_;
+
+      bool started_;
+      uint32 expected_;
+      uint32 highest_;
+      size_t held_;
+
+      /// a packet too far ahead to be held.  Delivered after everything in the window.
+      Communication::LinkedBuffer * overflow_;
+      uint32 overflowSequence_;
+      bool flushing_;
+
+      uint32 lastGapStart_;
+      size_t gaps_;
+      size_t lostPackets_;
+      size_t duplicates_;
+      size_t reordered_;
+    };
+  }
+}
+#endif // PACKETSEQUENCER_H
@@ -0,0 +1,18 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef PACKETSEQUENCER_FWD_H
+#define PACKETSEQUENCER_FWD_H
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    class PacketSequencer;
+
+    ///@brief smart pointer to PacketSequencer
+    typedef boost::shared_ptr<PacketSequencer> PacketSequencerPtr;
+  }
+}
+#endif // PACKETSEQUENCER_FWD_H
@@ -58,6 +58,13 @@ namespace QuickFAST{
         return applicationNamespace_;
       }
 
+      /// @brief Retrieve the dictionary= attribute
+      /// @returns the dictionary name or an empty string if none was specified.
+      const std::string & getDictionaryName()const
+      {
+        return dictionaryName_;
+      }
+
       /// @brief Enable the addLengt+hInstruction() method.
       void allowLengthField()
       {
@@ -8,6 +8,8 @@
 #include <Messages/ValueMessageBuilder.h>
 #include <Codecs/DataSourceBuffer.h>
 #include <Codecs/Decoder.h>
+#include <Common/Timestamp.h>
+#include <Common/AllocationCounter.h>
 
 using namespace QuickFAST;
 using namespace Codecs;
@@ -43,6 +45,7 @@ bool
 StreamingAssembler::serviceQueue(
   Communication::Receiver & receiver)
 {
+  Common::AllocationPhase allocationPhase(Common::AllocationCounter::ASSEMBLER);
   // save the receiver so callbacks from the decoder can find it.
   receiver_ = &receiver;
   bool more = true;
@@ -92,10 +95,16 @@ StreamingAssembler::serviceQueue(
           {
             decoder_.reset();
           }
+          // the message starts in the current buffer.
+          builder_.setReceiveTimes(
+            currentBuffer_ == 0 ? 0 : currentBuffer_->receiveTime(),
+            Common::wallClockNanoseconds());
           decoder_.decodeMessage(*this, builder_);
+          countMessage();
         }
         catch(std::exception & ex)
         {
+          countDecodingError();
           more = builder_.reportDecodingError(ex.what());
           if(!more)
           {
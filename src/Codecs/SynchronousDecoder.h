@@ -10,6 +10,7 @@
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/Decoder.h>
 #include <Codecs/DataSource.h>
+#include <Codecs/DecodeObserver.h>
 #include <Messages/ValueMessageBuilder.h>
 
 namespace QuickFAST{
@@ -27,6 +28,7 @@ namespace QuickFAST{
       , messageCountLimit_(0)
       , maxFieldCount_(templateRegistry->maxFieldCount())
       , headerBytes_(0)
+      , observer_(0)
       {
       }
 
@@ -100,6 +102,13 @@ namespace QuickFAST{
         headerBytes_ = headerBytes;
       }
 
+      /// @brief Notify an observer as each message is decoded.
+      /// @param observer must outlive the calls to decode() (or zero to stop observing).
+      void setObserver(DecodeObserver * observer)
+      {
+        observer_ = observer;
+      }
+
       /// @brief How many messages have been decoded.
       /// @returns the number of messages that have been decoded.
       size_t messageCount() const
@@ -107,6 +116,14 @@ namespace QuickFAST{
         return messageCount_;
       }
 
+      /// @brief Access the underlying Decoder.
+      ///
+      /// i.e. to position it with MessageIndex::seek() before calling decode().
+      Decoder & decoder()
+      {
+        return decoder_;
+      }
+
       /// @brief Run the decoding process
       ///
       /// Runs until the DataSource reports end of data
@@ -136,7 +153,16 @@ namespace QuickFAST{
             }
 //            std::cout << ']' << std::endl;
 //          }
-          decoder_.decodeMessage(source, builder);
+          if(observer_ != 0)
+          {
+            observer_->messageStarting(source);
+            decoder_.decodeMessage(source, builder);
+            observer_->messageDecoded(decoder_.getTemplateId(), messageCount_);
+          }
+          else
+          {
+            decoder_.decodeMessage(source, builder);
+          }
           messageCount_ += 1;
         }
       }
@@ -152,6 +178,7 @@ namespace QuickFAST{
       size_t messageCountLimit_;
       size_t maxFieldCount_;
       size_t headerBytes_;
+      DecodeObserver * observer_;
     };
   }
 }
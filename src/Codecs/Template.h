@@ -106,6 +106,12 @@ namespace QuickFAST{
         return namespace_;
       }
 
+      /// @brief Retrieve the templateNs= attribute
+      const std::string & getTemplateNs()const
+      {
+        return templateNamespace_;
+      }
+
       /// @brief should the dictionaries be reset for this template?
       /// @returns true if they should be reset.
       bool getReset()const
@@ -0,0 +1,747 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "TemplateCache.h"
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstructionInt8.h>
+#include <Codecs/FieldInstructionUInt8.h>
+#include <Codecs/FieldInstructionInt16.h>
+#include <Codecs/FieldInstructionUInt16.h>
+#include <Codecs/FieldInstructionInt32.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt64.h>
+#include <Codecs/FieldInstructionUInt64.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionExponent.h>
+#include <Codecs/FieldInstructionMantissa.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUtf8.h>
+#include <Codecs/FieldInstructionByteVector.h>
+#include <Codecs/FieldInstructionGroup.h>
+#include <Codecs/FieldInstructionSequence.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldOpNop.h>
+#include <Codecs/FieldOpConstant.h>
+#include <Codecs/FieldOpDefault.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/FieldOpTail.h>
+#include <Common/MappedFile.h>
+#include <Common/Exceptions.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  const char cacheMagic[4] = {'Q', 'F', 'T', 'C'};
+  const uchar cacheVersion = 1;
+
+  // flags for templates
+  const uchar TEMPLATE_RESET = 0x01;
+  const uchar TEMPLATE_IGNORE = 0x02;
+
+  // flags for field instructions
+  const uchar INSTRUCTION_MANDATORY = 0x01;
+  const uchar INSTRUCTION_IGNORE_OVERFLOW = 0x02;
+  const uchar INSTRUCTION_STATIC_REFERENCE = 0x04;
+  const uchar INSTRUCTION_HAS_COMPONENTS = 0x08; // decimal with exponent and mantissa
+  const uchar INSTRUCTION_HAS_LENGTH = 0x10;     // sequence with a length instruction
+
+  // flags for field operations
+  const uchar OP_HAS_VALUE = 0x01;
+  const uchar OP_HAS_PMAP_BIT = 0x02;
+  const uchar OP_HAS_DICTIONARY_INDEX = 0x04;
+
+  /// seven bits per byte, low order first, high bit set on all but the last byte.
+  void appendVarint(std::string & out, uint64 value)
+  {
+    while(value >= 0x80)
+    {
+      out += char((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out += char(value);
+  }
+
+  /// Walks a registry writing the body of the cache.
+  /// Strings are written once, to a table that precedes the body, and referred to by index.
+  class Writer
+  {
+  public:
+    void writeRegistry(const TemplateRegistry & registry);
+
+    void finish(const TemplateRegistry & registry, std::string & out)const;
+
+  private:
+    void writeString(const std::string & value);
+    void writeTemplate(const Template & templ);
+    void writeSegment(const SegmentBody & segment);
+    void writeInstruction(const FieldInstruction & instruction);
+    void writeOp(const FieldOp & op);
+
+  private:
+    typedef std::map<std::string, size_t> StringIndex;
+    StringIndex stringIndex_;
+    std::vector<const std::string *> strings_;
+    std::string body_;
+  };
+
+  void
+  Writer::writeString(const std::string & value)
+  {
+    std::pair<StringIndex::iterator, bool> inserted =
+      stringIndex_.insert(StringIndex::value_type(value, strings_.size()));
+    if(inserted.second)
+    {
+      strings_.push_back(&inserted.first->first);
+    }
+    appendVarint(body_, inserted.first->second);
+  }
+
+  void
+  Writer::writeRegistry(const TemplateRegistry & registry)
+  {
+    writeString(registry.getName());
+    writeString(registry.getNamespace());
+    writeString(registry.getTemplateNamespace());
+    writeString(registry.getDictionaryName());
+    size_t count = registry.definedTemplateCount();
+    appendVarint(body_, count);
+    for(size_t nTemplate = 0; nTemplate < count; ++nTemplate)
+    {
+      writeTemplate(*registry.definedTemplate(nTemplate));
+    }
+  }
+
+  void
+  Writer::writeTemplate(const Template & templ)
+  {
+    writeString(templ.getTemplateName());
+    writeString(templ.getNamespace());
+    writeString(templ.getTemplateNs());
+    appendVarint(body_, templ.getId());
+    uchar flags = 0;
+    if(templ.getReset())
+    {
+      flags |= TEMPLATE_RESET;
+    }
+    if(templ.getIgnore())
+    {
+      flags |= TEMPLATE_IGNORE;
+    }
+    body_ += char(flags);
+    writeSegment(templ);
+  }
+
+  void
+  Writer::writeSegment(const SegmentBody & segment)
+  {
+    writeString(segment.getDictionaryName());
+    writeString(segment.getApplicationType());
+    writeString(segment.getApplicationTypeNamespace());
+    size_t count = segment.size();
+    appendVarint(body_, count);
+    for(size_t nInstruction = 0; nInstruction < count; ++nInstruction)
+    {
+      writeInstruction(*segment.getInstruction(nInstruction));
+    }
+  }
+
+  void
+  Writer::writeInstruction(const FieldInstruction & instruction)
+  {
+    ValueType::Type type = instruction.fieldInstructionType();
+    FieldInstructionCPtr exponent;
+    FieldInstructionCPtr mantissa;
+    FieldInstructionCPtr length;
+    SegmentBodyPtr segment;
+    const FieldInstructionStaticTemplateRef * staticReference = 0;
+
+    uchar flags = 0;
+    if(instruction.isMandatory())
+    {
+      flags |= INSTRUCTION_MANDATORY;
+    }
+    if(instruction.getIgnoreOverflow())
+    {
+      flags |= INSTRUCTION_IGNORE_OVERFLOW;
+    }
+    switch(type)
+    {
+    case ValueType::INT8:
+    case ValueType::UINT8:
+    case ValueType::INT16:
+    case ValueType::UINT16:
+    case ValueType::INT32:
+    case ValueType::UINT32:
+    case ValueType::INT64:
+    case ValueType::UINT64:
+    case ValueType::EXPONENT:
+    case ValueType::MANTISSA:
+    case ValueType::LENGTH:
+    case ValueType::ASCII:
+    case ValueType::UTF8:
+    case ValueType::BYTEVECTOR:
+      break;
+    case ValueType::DECIMAL:
+      if(instruction.getExponentInstruction(exponent) && instruction.getMantissaInstruction(mantissa))
+      {
+        flags |= INSTRUCTION_HAS_COMPONENTS;
+      }
+      break;
+    case ValueType::GROUP:
+      instruction.getSegmentBody(segment);
+      break;
+    case ValueType::SEQUENCE:
+      instruction.getSegmentBody(segment);
+      if(segment->getLengthInstruction(length))
+      {
+        flags |= INSTRUCTION_HAS_LENGTH;
+      }
+      break;
+    case ValueType::TEMPLATEREF:
+      staticReference = dynamic_cast<const FieldInstructionStaticTemplateRef *>(&instruction);
+      if(staticReference != 0)
+      {
+        flags |= INSTRUCTION_STATIC_REFERENCE;
+      }
+      break;
+    default:
+      throw TemplateDefinitionError(
+        "Can't cache field instruction " + instruction.getName() +
+        " of type " + ValueType::typeName(type));
+    }
+
+    body_ += char(type);
+    body_ += char(flags);
+    const Messages::FieldIdentityCPtr & identity = instruction.getIdentity();
+    writeString(identity->getLocalName());
+    writeString(identity->getNamespace());
+    writeString(identity->id());
+    writeString(instruction.getLocalApplicationType());
+    writeString(instruction.getApplicationTypeNamespace());
+
+    if((flags & INSTRUCTION_HAS_COMPONENTS) != 0)
+    {
+      writeInstruction(*exponent);
+      writeInstruction(*mantissa);
+    }
+    if((flags & INSTRUCTION_HAS_LENGTH) != 0)
+    {
+      writeInstruction(*length);
+    }
+    if(staticReference != 0)
+    {
+      writeString(staticReference->templateName());
+      writeString(staticReference->templateNamespace());
+    }
+    if(segment)
+    {
+      // a sequence's own field operation is the one that belongs to its length.
+      writeSegment(*segment);
+    }
+    else
+    {
+      writeOp(*instruction.getFieldOp());
+    }
+  }
+
+  void
+  Writer::writeOp(const FieldOp & op)
+  {
+    body_ += char(op.opType());
+    uchar flags = 0;
+    size_t pmapBit = 0;
+    size_t dictionaryIndex = 0;
+    if(op.hasValue())
+    {
+      flags |= OP_HAS_VALUE;
+    }
+    if(op.getPMapBit(pmapBit))
+    {
+      flags |= OP_HAS_PMAP_BIT;
+    }
+    if(op.getDictionaryIndex(dictionaryIndex))
+    {
+      flags |= OP_HAS_DICTIONARY_INDEX;
+    }
+    body_ += char(flags);
+    if((flags & OP_HAS_VALUE) != 0)
+    {
+      writeString(op.getValue());
+    }
+    writeString(op.getKey());
+    writeString(op.getKeyNamespace());
+    writeString(op.getDictionaryName());
+    if((flags & OP_HAS_PMAP_BIT) != 0)
+    {
+      appendVarint(body_, pmapBit);
+    }
+    if((flags & OP_HAS_DICTIONARY_INDEX) != 0)
+    {
+      appendVarint(body_, dictionaryIndex);
+    }
+  }
+
+  void
+  Writer::finish(const TemplateRegistry & registry, std::string & out)const
+  {
+    out.erase();
+    out.append(cacheMagic, sizeof(cacheMagic));
+    out += char(cacheVersion);
+    uint64 fingerprint = registry.fingerprint();
+    for(size_t nByte = 0; nByte < 8; ++nByte)
+    {
+      out += char(fingerprint & 0xFF);
+      fingerprint >>= 8;
+    }
+    appendVarint(out, registry.dictionarySize());
+    appendVarint(out, strings_.size());
+    for(size_t nString = 0; nString < strings_.size(); ++nString)
+    {
+      appendVarint(out, strings_[nString]->size());
+      out += *strings_[nString];
+    }
+    out += body_;
+  }
+
+  /// Builds a registry from the cache using the same calls the XMLTemplateParser makes.
+  class Reader
+  {
+  public:
+    Reader(const uchar * data, size_t length)
+      : data_(data)
+      , length_(length)
+      , pos_(0)
+    {
+    }
+
+    TemplateRegistryPtr readCache();
+
+  private:
+    void need(size_t bytes)
+    {
+      if(length_ - pos_ < bytes)
+      {
+        throw std::runtime_error("Template cache is truncated.");
+      }
+    }
+
+    uchar byte()
+    {
+      need(1);
+      return data_[pos_++];
+    }
+
+    uint64 varint()
+    {
+      uint64 value = 0;
+      size_t shift = 0;
+      uchar b = 0;
+      do
+      {
+        if(shift > 63)
+        {
+          throw std::runtime_error("Template cache is corrupt.");
+        }
+        b = byte();
+        value |= uint64(b & 0x7F) << shift;
+        shift += 7;
+      } while((b & 0x80) != 0);
+      return value;
+    }
+
+    const std::string & text()
+    {
+      uint64 index = varint();
+      if(index >= strings_.size())
+      {
+        throw std::runtime_error("Template cache is corrupt.");
+      }
+      return strings_[size_t(index)];
+    }
+
+    void readTemplate(TemplateRegistry & registry);
+    void readSegment(SegmentBody & segment);
+    FieldInstructionPtr readInstruction();
+    FieldOpPtr readOp();
+    void verifyIndexes()const;
+
+  private:
+    const uchar * data_;
+    size_t length_;
+    size_t pos_;
+    std::vector<std::string> strings_;
+
+    typedef std::pair<FieldOpCPtr, size_t> ExpectedIndex;
+    std::vector<ExpectedIndex> expectedIndexes_;
+  };
+
+  TemplateRegistryPtr
+  Reader::readCache()
+  {
+    need(sizeof(cacheMagic) + 1 + 8);
+    if(memcmp(data_, cacheMagic, sizeof(cacheMagic)) != 0)
+    {
+      throw std::runtime_error("Not a template cache.");
+    }
+    pos_ = sizeof(cacheMagic);
+    if(byte() != cacheVersion)
+    {
+      throw std::runtime_error("Unsupported template cache version.");
+    }
+    uint64 fingerprint = 0;
+    for(size_t nByte = 0; nByte < 8; ++nByte)
+    {
+      fingerprint |= uint64(byte()) << (8 * nByte);
+    }
+    uint64 dictionarySize = varint();
+
+    uint64 stringCount = varint();
+    // every string needs at least one byte so this limits the allocation for corrupt data.
+    need(size_t(stringCount));
+    strings_.resize(size_t(stringCount));
+    for(size_t nString = 0; nString < strings_.size(); ++nString)
+    {
+      uint64 size = varint();
+      need(size_t(size));
+      strings_[nString].assign(reinterpret_cast<const char *>(data_ + pos_), size_t(size));
+      pos_ += size_t(size);
+    }
+
+    TemplateRegistryPtr registry(new TemplateRegistry);
+    registry->setName(text());
+    registry->setNamespace(text());
+    registry->setTemplateNamespace(text());
+    registry->setDictionaryName(text());
+    uint64 templateCount = varint();
+    for(uint64 nTemplate = 0; nTemplate < templateCount; ++nTemplate)
+    {
+      readTemplate(*registry);
+    }
+    if(pos_ != length_)
+    {
+      throw std::runtime_error("Template cache has unexpected trailing data.");
+    }
+
+    registry->finalize();
+    if(registry->dictionarySize() != dictionarySize)
+    {
+      throw std::runtime_error("Template cache dictionary size does not match the templates.");
+    }
+    verifyIndexes();
+    if(registry->fingerprint() != fingerprint)
+    {
+      throw std::runtime_error("Template cache fingerprint does not match the templates.");
+    }
+    return registry;
+  }
+
+  void
+  Reader::readTemplate(TemplateRegistry & registry)
+  {
+    TemplatePtr templ(new Template);
+    templ->setTemplateName(text());
+    const std::string & ns = text();
+    if(!ns.empty())
+    {
+      templ->setNamespace(ns);
+    }
+    const std::string & templateNs = text();
+    if(!templateNs.empty())
+    {
+      templ->setTemplateNamespace(templateNs);
+    }
+    templ->setId(template_id_t(varint()));
+    uchar flags = byte();
+    templ->setReset((flags & TEMPLATE_RESET) != 0);
+    templ->setIgnore((flags & TEMPLATE_IGNORE) != 0);
+    readSegment(*templ);
+    registry.addTemplate(templ);
+  }
+
+  void
+  Reader::readSegment(SegmentBody & segment)
+  {
+    const std::string & dictionaryName = text();
+    if(!dictionaryName.empty())
+    {
+      segment.setDictionaryName(dictionaryName);
+    }
+    const std::string & applicationType = text();
+    const std::string & applicationTypeNamespace = text();
+    segment.setApplicationType(applicationType, applicationTypeNamespace);
+    uint64 count = varint();
+    for(uint64 nInstruction = 0; nInstruction < count; ++nInstruction)
+    {
+      FieldInstructionPtr instruction = readInstruction();
+      segment.addInstruction(instruction);
+    }
+  }
+
+  FieldInstructionPtr
+  Reader::readInstruction()
+  {
+    ValueType::Type type = ValueType::Type(byte());
+    uchar flags = byte();
+    FieldInstructionPtr instruction;
+    switch(type)
+    {
+    case ValueType::INT8:
+      instruction.reset(new FieldInstructionInt8);
+      break;
+    case ValueType::UINT8:
+      instruction.reset(new FieldInstructionUInt8);
+      break;
+    case ValueType::INT16:
+      instruction.reset(new FieldInstructionInt16);
+      break;
+    case ValueType::UINT16:
+      instruction.reset(new FieldInstructionUInt16);
+      break;
+    case ValueType::INT32:
+      instruction.reset(new FieldInstructionInt32);
+      break;
+    case ValueType::UINT32:
+      instruction.reset(new FieldInstructionUInt32);
+      break;
+    case ValueType::INT64:
+      instruction.reset(new FieldInstructionInt64);
+      break;
+    case ValueType::UINT64:
+      instruction.reset(new FieldInstructionUInt64);
+      break;
+    case ValueType::EXPONENT:
+      instruction.reset(new FieldInstructionExponent);
+      break;
+    case ValueType::MANTISSA:
+      instruction.reset(new FieldInstructionMantissa);
+      break;
+    case ValueType::LENGTH:
+      instruction.reset(new FieldInstructionLength);
+      break;
+    case ValueType::DECIMAL:
+      instruction.reset(new FieldInstructionDecimal);
+      break;
+    case ValueType::ASCII:
+      instruction.reset(new FieldInstructionAscii);
+      break;
+    // the names are set below.  These use the named constructors because only they set the blob type.
+    case ValueType::UTF8:
+      instruction.reset(new FieldInstructionUtf8("", ""));
+      break;
+    case ValueType::BYTEVECTOR:
+      instruction.reset(new FieldInstructionByteVector("", ""));
+      break;
+    case ValueType::GROUP:
+      instruction.reset(new FieldInstructionGroup);
+      break;
+    case ValueType::SEQUENCE:
+      instruction.reset(new FieldInstructionSequence);
+      break;
+    case ValueType::TEMPLATEREF:
+      if((flags & INSTRUCTION_STATIC_REFERENCE) == 0)
+      {
+        instruction.reset(new FieldInstructionDynamicTemplateRef);
+      }
+      break;
+    default:
+      throw std::runtime_error("Template cache is corrupt.");
+    }
+
+    const std::string & name = text();
+    const std::string & fieldNamespace = text();
+    const std::string & id = text();
+    const std::string & applicationType = text();
+    const std::string & applicationTypeNamespace = text();
+
+    if((flags & INSTRUCTION_HAS_COMPONENTS) != 0)
+    {
+      FieldInstructionPtr exponent = readInstruction();
+      FieldInstructionPtr mantissa = readInstruction();
+      instruction->setPresence((flags & INSTRUCTION_MANDATORY) != 0);
+      instruction->setExponentInstruction(exponent);
+      instruction->setMantissaInstruction(mantissa);
+    }
+    FieldInstructionPtr length;
+    if((flags & INSTRUCTION_HAS_LENGTH) != 0)
+    {
+      length = readInstruction();
+    }
+    if(type == ValueType::TEMPLATEREF && (flags & INSTRUCTION_STATIC_REFERENCE) != 0)
+    {
+      const std::string & templateName = text();
+      const std::string & templateNamespace = text();
+      instruction.reset(new FieldInstructionStaticTemplateRef(templateName, templateNamespace));
+    }
+
+    instruction->setName(name);
+    instruction->setNamespace(fieldNamespace);
+    if(!id.empty())
+    {
+      instruction->setId(id);
+    }
+    instruction->setPresence((flags & INSTRUCTION_MANDATORY) != 0);
+    if((flags & INSTRUCTION_IGNORE_OVERFLOW) != 0)
+    {
+      instruction->setIgnoreOverflow(true);
+    }
+    if(!applicationType.empty())
+    {
+      instruction->setApplicationType(applicationType, applicationTypeNamespace);
+    }
+
+    if(type == ValueType::GROUP || type == ValueType::SEQUENCE)
+    {
+      SegmentBodyPtr segment(new SegmentBody);
+      instruction->setSegmentBody(segment);
+      if(type == ValueType::SEQUENCE)
+      {
+        segment->allowLengthField();
+        if(length)
+        {
+          segment->addLengthInstruction(length);
+        }
+      }
+      readSegment(*segment);
+    }
+    else
+    {
+      FieldOpPtr op = readOp();
+      if(op->opType() != FieldOp::NOP)
+      {
+        instruction->setFieldOp(op);
+      }
+    }
+    return instruction;
+  }
+
+  FieldOpPtr
+  Reader::readOp()
+  {
+    FieldOp::OpType type = FieldOp::OpType(byte());
+    FieldOpPtr op;
+    switch(type)
+    {
+    case FieldOp::NOP:
+      op.reset(new FieldOpNop);
+      break;
+    case FieldOp::CONSTANT:
+      op.reset(new FieldOpConstant);
+      break;
+    case FieldOp::DEFAULT:
+      op.reset(new FieldOpDefault);
+      break;
+    case FieldOp::COPY:
+      op.reset(new FieldOpCopy);
+      break;
+    case FieldOp::DELTA:
+      op.reset(new FieldOpDelta);
+      break;
+    case FieldOp::INCREMENT:
+      op.reset(new FieldOpIncrement);
+      break;
+    case FieldOp::TAIL:
+      op.reset(new FieldOpTail);
+      break;
+    default:
+      throw std::runtime_error("Template cache is corrupt.");
+    }
+    uchar flags = byte();
+    if((flags & OP_HAS_VALUE) != 0)
+    {
+      op->setValue(text());
+    }
+    const std::string & key = text();
+    if(!key.empty())
+    {
+      op->setKey(key);
+    }
+    const std::string & keyNamespace = text();
+    if(!keyNamespace.empty())
+    {
+      op->setKeyNamespace(keyNamespace);
+    }
+    const std::string & dictionaryName = text();
+    if(!dictionaryName.empty())
+    {
+      op->setDictionaryName(dictionaryName);
+    }
+    if((flags & OP_HAS_PMAP_BIT) != 0)
+    {
+      op->setPMapBit(size_t(varint()));
+    }
+    if((flags & OP_HAS_DICTIONARY_INDEX) != 0)
+    {
+      expectedIndexes_.push_back(ExpectedIndex(op, size_t(varint())));
+    }
+    return op;
+  }
+
+  void
+  Reader::verifyIndexes()const
+  {
+    for(size_t nOp = 0; nOp < expectedIndexes_.size(); ++nOp)
+    {
+      size_t index = 0;
+      if(!expectedIndexes_[nOp].first->getDictionaryIndex(index)
+        || index != expectedIndexes_[nOp].second)
+      {
+        throw std::runtime_error("Template cache dictionary indexes do not match the templates.");
+      }
+    }
+  }
+}
+
+void
+TemplateCache::write(const TemplateRegistry & registry, std::string & out)
+{
+  Writer writer;
+  writer.writeRegistry(registry);
+  writer.finish(registry, out);
+}
+
+void
+TemplateCache::writeFile(const TemplateRegistry & registry, const std::string & filename)
+{
+  std::string data;
+  write(registry, data);
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if(file.good())
+  {
+    file.write(data.data(), data.size());
+    file.close();
+  }
+  if(!file.good())
+  {
+    throw std::runtime_error("Can't write template cache: " + filename);
+  }
+}
+
+TemplateRegistryPtr
+TemplateCache::read(const uchar * data, size_t length)
+{
+  Reader reader(data, length);
+  return reader.readCache();
+}
+
+TemplateRegistryPtr
+TemplateCache::readFile(const std::string & filename)
+{
+  Common::MappedFile file;
+  if(!file.open(filename.c_str()))
+  {
+    throw std::runtime_error("Can't open template cache: " + filename);
+  }
+  return read(file.data(), file.size());
+}
+
+bool
+TemplateCache::isCache(const uchar * data, size_t length)
+{
+  return length >= sizeof(cacheMagic) && memcmp(data, cacheMagic, sizeof(cacheMagic)) == 0;
+}
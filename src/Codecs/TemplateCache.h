@@ -0,0 +1,76 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef TEMPLATECACHE_H
+#define TEMPLATECACHE_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief A precompiled, binary form of a TemplateRegistry.
+    ///
+    /// Parsing a large XML template file with Xerces can take a significant part
+    /// of the time needed to start a feed handler.  The cache holds everything the
+    /// XML defined -- instructions, operators, initial values and attributes -- in a
+    /// compact versioned format that can be loaded without an XML parser.
+    ///
+    /// Typical use: parse the XML once (at build or deployment time), call writeFile(),
+    /// then call readFile() at startup.  readFile() memory maps the file (see Common::MappedFile)
+    /// and builds the registry directly from the mapped bytes.
+    ///
+    /// The dictionary indexes resolved when the registry was finalized and the registry's
+    /// fingerprint() are stored as well.  The loaded registry is finalized and checked against
+    /// them, so a cache written by an incompatible version of QuickFAST is rejected rather
+    /// than silently decoding with a different dictionary layout.
+    class QuickFAST_Export TemplateCache
+    {
+    public:
+      /// @brief Serialize a finalized registry.
+      /// @param registry holds the templates.
+      /// @param out receives the data (replacing any previous contents)
+      /// @throws TemplateDefinitionError if the registry contains an instruction that can not be cached.
+      static void write(const TemplateRegistry & registry, std::string & out);
+
+      /// @brief Serialize a finalized registry to a file.
+      /// @param registry holds the templates.
+      /// @param filename names the file to be written.
+      /// @throws std::runtime_error if the file can not be written.
+      static void writeFile(const TemplateRegistry & registry, const std::string & filename);
+
+      /// @brief Build a registry from data produced by write()
+      /// @param data points to the serialized registry
+      /// @param length is the number of bytes of data
+      /// @returns the finalized registry.
+      /// @throws std::runtime_error if the data is not a valid cache.
+      static TemplateRegistryPtr read(const uchar * data, size_t length);
+
+      /// @brief Build a registry from data produced by write()
+      /// @param data is the serialized registry
+      /// @returns the finalized registry.
+      /// @throws std::runtime_error if the data is not a valid cache.
+      static TemplateRegistryPtr read(const std::string & data)
+      {
+        return read(reinterpret_cast<const uchar *>(data.data()), data.size());
+      }
+
+      /// @brief Build a registry from a file produced by writeFile()
+      /// @param filename names the file.
+      /// @returns the finalized registry.
+      /// @throws std::runtime_error if the file is missing or is not a valid cache.
+      static TemplateRegistryPtr readFile(const std::string & filename);
+
+      /// @brief Does the data start with the cache file signature?
+      ///
+      /// Lets a program accept either an XML template file or a cache.
+      /// @param data points to the start of the file
+      /// @param length is the number of bytes available
+      static bool isCache(const uchar * data, size_t length);
+    };
+  }
+}
+#endif // TEMPLATECACHE_H
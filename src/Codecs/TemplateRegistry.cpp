@@ -5,14 +5,179 @@
 #include "TemplateRegistry.h"
 #include <Codecs/Template.h>
 #include <Codecs/DictionaryIndexer.h>
+#include <Codecs/FieldInstruction.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldOp.h>
 
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
+namespace
+{
+  /// FNV-1a hash of the structure of a registry.
+  /// Covers everything that determines how a message is encoded and decoded,
+  /// including the dictionary name, key and resolved index of every field operation.
+  class Fingerprint
+  {
+  public:
+    Fingerprint()
+      : hash_(14695981039346656037ULL)
+    {
+    }
+
+    uint64 value()const
+    {
+      return hash_;
+    }
+
+    void addNumber(uint64 number)
+    {
+      for(size_t nByte = 0; nByte < sizeof(number); ++nByte)
+      {
+        addByte(uchar(number >> (nByte * 8)));
+      }
+    }
+
+    void addString(const std::string & text)
+    {
+      // the length prefix keeps adjacent strings from running together.
+      addNumber(text.size());
+      for(size_t pos = 0; pos < text.size(); ++pos)
+      {
+        addByte(uchar(text[pos]));
+      }
+    }
+
+    void addRegistry(const TemplateRegistry & registry);
+
+  private:
+    void addByte(uchar byte)
+    {
+      hash_ ^= byte;
+      hash_ *= 1099511628211ULL;
+    }
+
+    void addTemplate(const Template & templ);
+    void addSegment(const SegmentBody & segment);
+    void addInstruction(const FieldInstruction & instruction);
+    void addOp(const FieldOp & op);
+
+  private:
+    uint64 hash_;
+  };
+
+  void
+  Fingerprint::addRegistry(const TemplateRegistry & registry)
+  {
+    addString(registry.getName());
+    addString(registry.getNamespace());
+    addString(registry.getTemplateNamespace());
+    addString(registry.getDictionaryName());
+    size_t count = registry.definedTemplateCount();
+    addNumber(count);
+    for(size_t nTemplate = 0; nTemplate < count; ++nTemplate)
+    {
+      addTemplate(*registry.definedTemplate(nTemplate));
+    }
+  }
+
+  void
+  Fingerprint::addTemplate(const Template & templ)
+  {
+    addString(templ.getTemplateName());
+    addString(templ.getNamespace());
+    addString(templ.getTemplateNs());
+    addNumber(templ.getId());
+    addNumber(templ.getReset());
+    addNumber(templ.getIgnore());
+    addSegment(templ);
+  }
+
+  void
+  Fingerprint::addSegment(const SegmentBody & segment)
+  {
+    addString(segment.getDictionaryName());
+    addString(segment.getApplicationType());
+    addString(segment.getApplicationTypeNamespace());
+    size_t count = segment.size();
+    addNumber(count);
+    for(size_t nInstruction = 0; nInstruction < count; ++nInstruction)
+    {
+      addInstruction(*segment.getInstruction(nInstruction));
+    }
+  }
+
+  void
+  Fingerprint::addInstruction(const FieldInstruction & instruction)
+  {
+    ValueType::Type type = instruction.fieldInstructionType();
+    addNumber(type);
+    addNumber(instruction.isMandatory());
+    addNumber(instruction.getIgnoreOverflow());
+    const Messages::FieldIdentityCPtr & identity = instruction.getIdentity();
+    addString(identity->getLocalName());
+    addString(identity->getNamespace());
+    addString(identity->id());
+
+    FieldInstructionCPtr exponent;
+    FieldInstructionCPtr mantissa;
+    if(type == ValueType::DECIMAL
+      && instruction.getExponentInstruction(exponent)
+      && instruction.getMantissaInstruction(mantissa))
+    {
+      addInstruction(*exponent);
+      addInstruction(*mantissa);
+    }
+    const FieldInstructionStaticTemplateRef * staticReference =
+      dynamic_cast<const FieldInstructionStaticTemplateRef *>(&instruction);
+    if(staticReference != 0)
+    {
+      addString(staticReference->templateName());
+      addString(staticReference->templateNamespace());
+    }
+    SegmentBodyPtr segment;
+    if((type == ValueType::GROUP || type == ValueType::SEQUENCE)
+      && instruction.getSegmentBody(segment))
+    {
+      FieldInstructionCPtr length;
+      if(type == ValueType::SEQUENCE && segment->getLengthInstruction(length))
+      {
+        addInstruction(*length);
+      }
+      addSegment(*segment);
+    }
+    else
+    {
+      addOp(*instruction.getFieldOp());
+    }
+  }
+
+  void
+  Fingerprint::addOp(const FieldOp & op)
+  {
+    addNumber(op.opType());
+    addNumber(op.hasValue());
+    if(op.hasValue())
+    {
+      addString(op.getValue());
+    }
+    addString(op.getKey());
+    addString(op.getKeyNamespace());
+    addString(op.getDictionaryName());
+    size_t pmapBit = 0;
+    addNumber(op.getPMapBit(pmapBit));
+    addNumber(pmapBit);
+    size_t dictionaryIndex = 0;
+    addNumber(op.getDictionaryIndex(dictionaryIndex));
+    addNumber(dictionaryIndex);
+  }
+}
+
 TemplateRegistry::TemplateRegistry()
 : presenceMapBits_(1) // every template requires 1 bit for the template ID
 , dictionarySize_(0)
 , maxFieldCount_(0)
+, fingerprint_(0)
 {
 }
 
@@ -23,8 +188,9 @@ TemplateRegistry::TemplateRegistry(
 : presenceMapBits_(pmapBits)
 , dictionarySize_(dictionarySize)
 , maxFieldCount_(fieldCount)
+, fingerprint_(0)
 {
-
+  computeFingerprint();
 }
 
 
@@ -51,6 +217,7 @@ TemplateRegistry::finalize()
       ""); // typeNs
   }
   dictionarySize_ = indexer.size();
+  dictionaryKeys_ = indexer.keys();
 
   presenceMapBits_ = 1;
   maxFieldCount_ = 0;
@@ -69,6 +236,17 @@ TemplateRegistry::finalize()
       maxFieldCount_ = fieldCount;
     }
   }
+  computeFingerprint();
+}
+
+void
+TemplateRegistry::computeFingerprint()
+{
+  Fingerprint fingerprint;
+  fingerprint.addRegistry(*this);
+  fingerprint.addNumber(dictionarySize_);
+  fingerprint.addNumber(presenceMapBits_);
+  fingerprint_ = fingerprint.value();
 }
 
 
@@ -66,6 +66,19 @@ namespace QuickFAST{
       /// @return the count of known templates.
       size_t size()const;
 
+      /// @brief How many templates have been added (including those with no id)?
+      size_t definedTemplateCount()const
+      {
+        return mutableTemplates_.size();
+      }
+
+      /// @brief Access the templates in the order they were added.
+      /// @param index must be less than definedTemplateCount()
+      TemplateCPtr definedTemplate(size_t index)const
+      {
+        return mutableTemplates_[index];
+      }
+
       /// @brief What is the largest number of PresenceMap bits needed?
       /// @returns the number of bits needed in the largest presence map for these templates
       size_t presenceMapBits()const
@@ -80,6 +93,16 @@ namespace QuickFAST{
         return dictionarySize_;
       }
 
+      /// @brief Identify the dictionary entries.
+      ///
+      /// Entries for the same field in two registries have the same key even if
+      /// their dictionary indexes differ.  Valid after finalize().
+      /// @returns a key for each entry, indexed by dictionary index.
+      const std::vector<std::string> & dictionaryKeys()const
+      {
+        return dictionaryKeys_;
+      }
+
       /// @brief Returns the maximum number of fields that will be produced by any template in the registry.
       ///
       /// Does not include "nested" fields -- unmerged groups and sequences count as one each.
@@ -89,6 +112,16 @@ namespace QuickFAST{
         return maxFieldCount_;
       }
 
+      /// @brief Identify the template definitions.
+      ///
+      /// Registries built from the same template definitions have the same fingerprint,
+      /// so state saved using one registry (i.e. a DictionarySnapshot) can be checked
+      /// before it is used with another.  Valid after finalize().
+      uint64 fingerprint()const
+      {
+        return fingerprint_;
+      }
+
       /// @brief Use Template ID to find a template.
       /// @param[in] templateId the desired template
       /// @param[out] valueFound is the result of the search if return is true
@@ -202,6 +235,7 @@ namespace QuickFAST{
       TemplateRegistry(const TemplateRegistry &);
       // forbid assignment
       TemplateRegistry & operator =(const TemplateRegistry &);
+      void computeFingerprint();
 
     private:
       TemplateIdMap templates_;
@@ -212,7 +246,9 @@ namespace QuickFAST{
       MutableTemplates mutableTemplates_;
       size_t presenceMapBits_;
       size_t dictionarySize_;
+      std::vector<std::string> dictionaryKeys_;
       size_t maxFieldCount_;
+      uint64 fingerprint_;
       std::string name_;
       std::string namespace_;
       std::string templateNamespace_;
@@ -0,0 +1,118 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "AllocationCounter.h"
+
+using namespace QuickFAST;
+using namespace Common;
+
+#if defined(_MSC_VER)
+# define ALLOCATION_THREAD_LOCAL __declspec(thread)
+#else
+# define ALLOCATION_THREAD_LOCAL __thread
+#endif
+
+namespace
+{
+  // Plain data so the thread local storage needs no construction
+  // (operator new must not allocate to find its counters).
+  ALLOCATION_THREAD_LOCAL AllocationCounter::Counts threadCounts[AllocationCounter::PHASE_COUNT];
+  ALLOCATION_THREAD_LOCAL int threadPhase = AllocationCounter::OTHER;
+
+  bool installed = false;
+
+  const char * phaseNames[AllocationCounter::PHASE_COUNT] =
+  {
+    "other",
+    "assembler",
+    "decoder",
+    "builder",
+    "encoder"
+  };
+}
+
+AllocationCounter::Snapshot::Snapshot()
+{
+  for(size_t nPhase = 0; nPhase < PHASE_COUNT; ++nPhase)
+  {
+    phases_[nPhase] = threadCounts[nPhase];
+  }
+}
+
+AllocationCounter::Counts
+AllocationCounter::Snapshot::total()const
+{
+  Counts result = {0, 0, 0};
+  for(size_t nPhase = 0; nPhase < PHASE_COUNT; ++nPhase)
+  {
+    result.allocations_ += phases_[nPhase].allocations_;
+    result.bytes_ += phases_[nPhase].bytes_;
+    result.deallocations_ += phases_[nPhase].deallocations_;
+  }
+  return result;
+}
+
+AllocationCounter::Snapshot
+AllocationCounter::Snapshot::since(const Snapshot & before)const
+{
+  Snapshot result(*this);
+  for(size_t nPhase = 0; nPhase < PHASE_COUNT; ++nPhase)
+  {
+    result.phases_[nPhase].allocations_ -= before.phases_[nPhase].allocations_;
+    result.phases_[nPhase].bytes_ -= before.phases_[nPhase].bytes_;
+    result.phases_[nPhase].deallocations_ -= before.phases_[nPhase].deallocations_;
+  }
+  return result;
+}
+
+bool
+AllocationCounter::enabled()
+{
+  return installed;
+}
+
+bool
+AllocationCounter::install()
+{
+  installed = true;
+  return installed;
+}
+
+const char *
+AllocationCounter::phaseName(Phase phase)
+{
+  if(phase < 0 || phase >= PHASE_COUNT)
+  {
+    return "unknown";
+  }
+  return phaseNames[phase];
+}
+
+AllocationCounter::Phase
+AllocationCounter::phase()
+{
+  return Phase(threadPhase);
+}
+
+AllocationCounter::Phase
+AllocationCounter::setPhase(Phase phase)
+{
+  Phase previous = Phase(threadPhase);
+  threadPhase = phase;
+  return previous;
+}
+
+void
+AllocationCounter::recordAllocation(size_t size)
+{
+  Counts & counts = threadCounts[threadPhase];
+  counts.allocations_ += 1;
+  counts.bytes_ += size;
+}
+
+void
+AllocationCounter::recordDeallocation()
+{
+  threadCounts[threadPhase].deallocations_ += 1;
+}
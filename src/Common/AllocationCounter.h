@@ -0,0 +1,154 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Count heap allocations made by each thread, broken down by phase.
+    ///
+    /// Counting is opt-in: a program (or test executable) that wants the counts
+    /// replaces the global operator new and delete by expanding
+    /// QUICKFAST_COUNT_ALLOCATIONS once, at namespace scope, in one of its own
+    /// source files.  Without it the counts stay at zero and enabled() returns false.
+    ///
+    /// Each allocation is charged to the calling thread's current phase.  The
+    /// assemblers, Decoder::decodeMessage() and Encoder::encodeMessage() set their phase
+    /// with an AllocationPhase.  Wrap the application's builder in a
+    /// Messages::AllocationPhaseBuilder to separate the builder's allocations from
+    /// the decoder's.
+    ///
+    /// The counters belong to the thread so nothing is locked or shared; read them
+    /// from the thread that did the work.
+    class QuickFAST_Export AllocationCounter
+    {
+    public:
+      /// @brief What the thread was doing when it allocated.
+      enum Phase
+      {
+        OTHER,
+        ASSEMBLER,
+        DECODER,
+        BUILDER,
+        ENCODER,
+        PHASE_COUNT
+      };
+
+      /// @brief The counts for one phase.
+      struct Counts
+      {
+        /// Calls to operator new
+        uint64 allocations_;
+        /// Bytes requested
+        uint64 bytes_;
+        /// Calls to operator delete
+        uint64 deallocations_;
+      };
+
+      /// @brief A copy of the current thread's counts for every phase.
+      struct Snapshot
+      {
+        /// @brief Capture the current thread's counts.
+        Snapshot();
+        /// Counts indexed by Phase
+        Counts phases_[PHASE_COUNT];
+        /// @brief The counts for all phases together.
+        Counts total()const;
+        /// @brief What happened since an earlier snapshot.
+        /// @param before was taken earlier by the same thread.
+        Snapshot since(const Snapshot & before)const;
+      };
+
+      /// @brief Has the counting operator new been linked into this program?
+      static bool enabled();
+
+      /// @brief The name of a phase for reports.
+      static const char * phaseName(Phase phase);
+
+      /// @brief The phase to which the current thread's allocations are charged.
+      static Phase phase();
+
+      /// @brief Change the current thread's phase.
+      /// @returns the previous phase.
+      static Phase setPhase(Phase phase);
+
+      /// @brief Called by the counting operator new.  Do not call directly.
+      static void recordAllocation(size_t size);
+      /// @brief Called by the counting operator delete.  Do not call directly.
+      static void recordDeallocation();
+      /// @brief Called by QUICKFAST_COUNT_ALLOCATIONS.  Do not call directly.
+      static bool install();
+    };
+
+    /// @brief Charge the current thread's allocations to a phase while in scope.
+    class AllocationPhase
+    {
+    public:
+      /// @brief Enter the phase
+      explicit AllocationPhase(AllocationCounter::Phase phase)
+        : previous_(AllocationCounter::setPhase(phase))
+      {
+      }
+
+      /// @brief Return to the previous phase
+      ~AllocationPhase()
+      {
+        AllocationCounter::setPhase(previous_);
+      }
+    private:
+      AllocationPhase(const AllocationPhase &);
+      AllocationPhase & operator=(const AllocationPhase &);
+    private:
+      AllocationCounter::Phase previous_;
+    };
+  }
+}
+
+#if !defined(_MSC_VER) && __cplusplus < 201103L
+# define QUICKFAST_NEW_THROWS throw(std::bad_alloc)
+#else
+# define QUICKFAST_NEW_THROWS
+#endif
+
+/// @brief Replace the global operator new and delete with versions that count.
+///
+/// The sized forms of operator delete are replaced too so that C++14 compilers
+/// (which call them for complete objects) do not bypass the count.
+/// Expand once, at namespace scope, in exactly one source file of a program.
+/// Requires <new> and <cstdlib>.
+#define QUICKFAST_COUNT_ALLOCATIONS \
+  namespace { \
+    const bool QuickFAST_allocationsCounted = QuickFAST::Common::AllocationCounter::install(); \
+    void * QuickFAST_countedAllocate(size_t size) \
+    { \
+      void * block = std::malloc(size == 0 ? 1 : size); \
+      if(block == 0) \
+      { \
+        throw std::bad_alloc(); \
+      } \
+      QuickFAST::Common::AllocationCounter::recordAllocation(size); \
+      return block; \
+    } \
+    void QuickFAST_countedFree(void * block) \
+    { \
+      if(block != 0) \
+      { \
+        QuickFAST::Common::AllocationCounter::recordDeallocation(); \
+        std::free(block); \
+      } \
+    } \
+  } \
+  void * operator new(size_t size) QUICKFAST_NEW_THROWS { return QuickFAST_countedAllocate(size); } \
+  void * operator new[](size_t size) QUICKFAST_NEW_THROWS { return QuickFAST_countedAllocate(size); } \
+  void operator delete(void * block) throw() { QuickFAST_countedFree(block); } \
+  void operator delete[](void * block) throw() { QuickFAST_countedFree(block); } \
+  void operator delete(void * block, size_t) throw() { QuickFAST_countedFree(block); } \
+  void operator delete[](void * block, size_t) throw() { QuickFAST_countedFree(block); }
+
+#endif // ALLOCATIONCOUNTER_H
@@ -22,7 +22,7 @@ namespace QuickFAST
     /// Warning, not synchronized so you know this counter had the returned
     /// value at some point, but not necessarily when.
     inline
-    operator const long()const
+    operator long()const
     {
       return counter_;
     }
@@ -41,6 +41,14 @@ namespace QuickFAST
       return atomic_decrement_long(&counter_);
     }
 
+    /// @brief Add atomically
+    /// @param value is added to the counter
+    inline
+    long operator +=(long value)
+    {
+      return atomic_add_long(&counter_, value);
+    }
+
     /// @brief Atomically set the value assuming it hasn't changed from "expected"
     /// @param expected the value that the counter must start with if this is to work
     /// @param value the new value to be stored in the counter
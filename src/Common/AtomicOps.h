@@ -14,7 +14,7 @@
 // No intrinsic compare and swap pointer so we asm it below
 # endif
 #elif defined(__GNUC__)
-#include <sys/atomic_op.h>
+// gcc provides builtins
 #else // something else.  Solaris maybe?
 #include <sys/atomic.h>
 #endif
@@ -52,21 +52,8 @@ namespace QuickFAST
       (PVOID volatile *)target, value, ifeq);
 # endif
 #elif defined(__GNUC__)
-# if 0 // force ASM on gcc (assume x86 processor)
+    // also a full memory barrier.
     return __sync_bool_compare_and_swap(target, ifeq, value);
-# else // force ASM on gcc
-    bool result;
-    asm(
-      "lock \n\t"
-      "cmpxchgl %%ecx,(%%edx) \n\t"
-      "setz %%al \n\t"
-      "xor %%ah,%%ah"
-      : "=a" (result)
-      : "a" (ifeq) , "c" (value), "d"(target) /* */
-      : "memory"
-    );
-    return result;
-# endif // force asm on gcc
 #else // otherwise we hope this is defind on your favorite platform
     return ifeq == atomic_cas_ptr(target, ifeq, value);
 #endif
@@ -100,21 +87,7 @@ namespace QuickFAST
     return ifeq == _InterlockedCompareExchange(target, value, ifeq);
 # endif // cpu type
 #elif defined(__GNUC__)
-# if 0 // force ASM on gcc
-    return __sync_bool_`_swap(target, ifeq, value);
-# else // force ASM on gcc
-    bool result;
-    asm(
-      "lock \n\t"
-      "cmpxchgl %%ecx,(%%edx) \n\t"
-      "setz %%al \n\t"
-      "xor %%ah,%%ah"
-      : "=a" (result)
-      : "a" (ifeq), "c" (value), "d"(target)
-      : "memory"
-    );
-    return result;
-# endif // force asm on gcc
+    return __sync_bool_compare_and_swap(target, ifeq, value);
 #else
     return ifeq == atomic_cas_ulong(target, ifeq, value);
 #endif
@@ -152,5 +125,22 @@ namespace QuickFAST
 #endif
   }
 
+  /// @brief Add to a long integer atomically
+  ///
+  /// @param target points to the long to be updated
+  /// @param value is added to target
+  /// @returns the new value
+  inline
+  long atomic_add_long(volatile long * target, long value)
+  {
+#if defined(_WIN32)
+    return InterlockedExchangeAdd(target, value) + value;
+#elif defined(__GNUC__)
+    return __sync_add_and_fetch(target, value);
+#else
+    return atomic_add_long_nv(target, value);
+#endif
+  }
+
 }
 #endif // ATOMICOPS_H
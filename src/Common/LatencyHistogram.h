@@ -0,0 +1,197 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+// All inline, do not export.
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Count durations in log-linear buckets so percentiles can be reported.
+    ///
+    /// Values below 32 have their own bucket.  Above that each power of two is
+    /// divided into 16 equal buckets, so any value is reported within about 6% of
+    /// its true value.  Recording is a bit scan and an increment with no allocation,
+    /// so it is cheap enough for the hot path.
+    ///
+    /// The units are whatever the caller records (nanoseconds, clock ticks...).
+    /// Not thread safe: use one histogram per thread and merge() them for reporting.
+    class LatencyHistogram
+    {
+    public:
+      /// @brief The number of buckets
+      static const size_t bucketCount = 976;
+
+      LatencyHistogram()
+      {
+        reset();
+      }
+
+      /// @brief Forget all recorded values.
+      void reset()
+      {
+        for(size_t nBucket = 0; nBucket < bucketCount; ++nBucket)
+        {
+          buckets_[nBucket] = 0;
+        }
+        count_ = 0;
+        sum_ = 0;
+        min_ = ~uint64(0);
+        max_ = 0;
+      }
+
+      /// @brief Count one value.
+      void record(uint64 value)
+      {
+        ++buckets_[bucketIndex(value)];
+        ++count_;
+        sum_ += value;
+        if(value < min_)
+        {
+          min_ = value;
+        }
+        if(value > max_)
+        {
+          max_ = value;
+        }
+      }
+
+      /// @brief Add the values counted by another histogram.
+      void merge(const LatencyHistogram & rhs)
+      {
+        for(size_t nBucket = 0; nBucket < bucketCount; ++nBucket)
+        {
+          buckets_[nBucket] += rhs.buckets_[nBucket];
+        }
+        count_ += rhs.count_;
+        sum_ += rhs.sum_;
+        if(rhs.min_ < min_)
+        {
+          min_ = rhs.min_;
+        }
+        if(rhs.max_ > max_)
+        {
+          max_ = rhs.max_;
+        }
+      }
+
+      /// @brief How many values have been recorded.
+      uint64 count()const
+      {
+        return count_;
+      }
+
+      /// @brief The total of the recorded values.
+      uint64 sum()const
+      {
+        return sum_;
+      }
+
+      /// @brief The smallest value recorded (zero if none)
+      uint64 minimum()const
+      {
+        return count_ == 0 ? 0 : min_;
+      }
+
+      /// @brief The largest value recorded.
+      uint64 maximum()const
+      {
+        return max_;
+      }
+
+      /// @brief The average of the recorded values.
+      double mean()const
+      {
+        return count_ == 0 ? 0.0 : double(sum_) / double(count_);
+      }
+
+      /// @brief Find the value below which a given fraction of the recorded values fall.
+      /// @param fraction between 0 and 1, i.e. 0.999 for the 99.9th percentile
+      /// @returns the upper bound of the bucket containing that value (never more than maximum())
+      uint64 percentile(double fraction)const
+      {
+        if(count_ == 0)
+        {
+          return 0;
+        }
+        uint64 target = uint64(fraction * double(count_) + 0.5);
+        if(target < 1)
+        {
+          target = 1;
+        }
+        uint64 seen = 0;
+        for(size_t nBucket = 0; nBucket < bucketCount; ++nBucket)
+        {
+          seen += buckets_[nBucket];
+          if(seen >= target)
+          {
+            uint64 bound = bucketLimit(nBucket);
+            return bound < max_ ? bound : max_;
+          }
+        }
+        return max_;
+      }
+
+      /// @brief Access the count in one bucket.
+      uint64 bucket(size_t index)const
+      {
+        return buckets_[index];
+      }
+
+      /// @brief The largest value that is counted in a bucket.
+      static uint64 bucketLimit(size_t index)
+      {
+        if(index < 2 * subBuckets)
+        {
+          return index;
+        }
+        size_t shift = index / subBuckets - 1;
+        uint64 sub = index % subBuckets + subBuckets;
+        return ((sub + 1) << shift) - 1;
+      }
+
+      /// @brief Which bucket counts a value.
+      static size_t bucketIndex(uint64 value)
+      {
+        if(value < 2 * subBuckets)
+        {
+          return size_t(value);
+        }
+        size_t shift = highBit(value) - subBucketBits;
+        return shift * subBuckets + size_t(value >> shift);
+      }
+
+    private:
+      static const size_t subBucketBits = 4;
+      static const size_t subBuckets = 16;
+
+      static size_t highBit(uint64 value)
+      {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        size_t bit = 0;
+        if(value >> 32) { value >>= 32; bit += 32; }
+        if(value >> 16) { value >>= 16; bit += 16; }
+        if(value >> 8) { value >>= 8; bit += 8; }
+        if(value >> 4) { value >>= 4; bit += 4; }
+        if(value >> 2) { value >>= 2; bit += 2; }
+        if(value >> 1) { bit += 1; }
+        return bit;
+#endif
+      }
+
+    private:
+      uint64 buckets_[bucketCount];
+      uint64 count_;
+      uint64 sum_;
+      uint64 min_;
+      uint64 max_;
+    };
+  }
+}
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,160 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "MappedFile.h"
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace QuickFAST;
+using namespace Common;
+
+namespace
+{
+  const size_t readAheadBytes = 16 * 1024 * 1024;
+}
+
+MappedFile::MappedFile()
+: data_(0)
+, size_(0)
+, mapped_(false)
+, readAheadPos_(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool
+MappedFile::open(const char * filename)
+{
+  close();
+  bool ok = map(filename);
+  if(!ok)
+  {
+    // mapping isn't possible.  Fall back to reading the whole file.
+    FILE * file = fopen(filename, "rb");
+    ok = file != 0;
+    if(ok)
+    {
+      fseek(file, 0, SEEK_END);
+      size_ = ftell(file);
+      buffer_.reset(new unsigned char[size_]);
+      fseek(file, 0, SEEK_SET);
+      size_t byteCount = fread(buffer_.get(), 1, size_, file);
+      ok = byteCount == size_;
+      fclose(file);
+      data_ = buffer_.get();
+    }
+    if(!ok)
+    {
+      close();
+    }
+  }
+  return ok;
+}
+
+bool
+MappedFile::map(const char * filename)
+{
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER size;
+  bool ok = GetFileSizeEx(file, &size) != 0 && size.QuadPart > 0
+    && uint64(size.QuadPart) <= uint64(~size_t(0));
+  if(ok)
+  {
+    HANDLE mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+    ok = mapping != 0;
+    if(ok)
+    {
+      // the view keeps the mapping (and the file) open.
+      data_ = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      ok = data_ != 0;
+      CloseHandle(mapping);
+    }
+    size_ = size_t(size.QuadPart);
+  }
+  CloseHandle(file);
+#else // _WIN32
+  int file = ::open(filename, O_RDONLY);
+  if(file < 0)
+  {
+    return false;
+  }
+  struct stat status;
+  bool ok = fstat(file, &status) == 0 && status.st_size > 0
+    && uint64(status.st_size) <= uint64(~size_t(0));
+  if(ok)
+  {
+    void * mapping = mmap(0, size_t(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+    ok = mapping != MAP_FAILED;
+    if(ok)
+    {
+      data_ = static_cast<const unsigned char *>(mapping);
+      size_ = size_t(status.st_size);
+      // files are normally read from front to back.
+      madvise(mapping, size_, MADV_SEQUENTIAL);
+    }
+  }
+  // the mapping keeps the file open.
+  ::close(file);
+#endif // _WIN32
+  mapped_ = ok;
+  if(!ok)
+  {
+    data_ = 0;
+    size_ = 0;
+  }
+  return ok;
+}
+
+void
+MappedFile::close()
+{
+  if(mapped_)
+  {
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#else // _WIN32
+    munmap(const_cast<unsigned char *>(data_), size_);
+#endif // _WIN32
+    mapped_ = false;
+  }
+  buffer_.reset();
+  data_ = 0;
+  size_ = 0;
+  readAheadPos_ = 0;
+}
+
+void
+MappedFile::readAhead(size_t position)
+{
+#if !defined(_WIN32)
+  // The sequential hint alone doesn't read far enough ahead to keep a fast decoder busy.
+  // Start a new window when the reader is half way through the current one, or has
+  // moved back before it (i.e. rewind)
+  if(mapped_ && (position >= readAheadPos_ || position + readAheadBytes < readAheadPos_) && position < size_)
+  {
+    size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    size_t start = position - position % pageSize;
+    size_t length = std::min(readAheadBytes, size_ - start);
+    madvise(const_cast<unsigned char *>(data_) + start, length, MADV_WILLNEED);
+    readAheadPos_ = start + length / 2;
+  }
+#else
+  (void)position;
+#endif // _WIN32
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief A read-only view of an entire file in memory.
+    ///
+    /// The file is memory mapped when possible, so opening a file takes the same time
+    /// regardless of its size and the data is never copied.  If the file can not be
+    /// mapped (i.e. a file larger than the address space on a 32 bit platform or an
+    /// empty file) it is read into memory instead.
+    class QuickFAST_Export MappedFile
+    {
+    public:
+      MappedFile();
+      ~MappedFile();
+
+      /// @brief Open a file.  Any previously opened file is closed.
+      /// @param filename names the file
+      /// @returns true if the file is available
+      bool open(const char * filename);
+
+      /// @brief Release the file.  Pointers into the data are no longer valid.
+      void close();
+
+      /// @brief Access the contents of the file.
+      /// @returns a pointer to the first byte or zero if no file is open.
+      const unsigned char * data() const
+      {
+        return data_;
+      }
+
+      /// @brief The number of bytes in the file.
+      size_t size() const
+      {
+        return size_;
+      }
+
+      /// @brief Is the file memory mapped (as opposed to read into memory)
+      bool isMapped() const
+      {
+        return mapped_;
+      }
+
+      /// @brief Hint that the file will be read sequentially starting at position.
+      ///
+      /// Asks the kernel to start reading the next window of the file so the reader
+      /// doesn't stall on page faults.  Cheap enough to call for every record: it only
+      /// does something when the reader gets half way through the previous window.
+      /// @param position is the offset in the file that is about to be read.
+      void readAhead(size_t position);
+
+    private:
+      MappedFile(const MappedFile &);
+      MappedFile & operator=(const MappedFile &);
+      bool map(const char * filename);
+
+    private:
+      const unsigned char * data_;
+      size_t size_;
+      bool mapped_;   // true: data_ is a memory mapped file; false: data_ is buffer_
+      boost::scoped_array<unsigned char> buffer_;
+      size_t readAheadPos_;
+    };
+  }
+}
+#endif // MAPPEDFILE_H
@@ -3,56 +3,185 @@
 // See the file license.txt for licensing information.
 #include <Common/QuickFASTPch.h>
 #include "Profiler.h"
+#include <Common/Timestamp.h>
 #include <math.h>
 
 using namespace QuickFAST;
 
 ProfileAccumulator * ProfileAccumulator::root_ = 0;
+size_t ProfileAccumulator::count_ = 0;
+
+#if defined(_MSC_VER)
+# define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+# define PROFILER_THREAD_LOCAL __thread
+#endif
+
+namespace
+{
+  typedef std::vector<ProfileCounters *> ThreadCounters;
+
+  // The current thread's counters indexed by ProfileAccumulator.
+  // Compiler supported thread local storage: no lookup and no locking.
+  PROFILER_THREAD_LOCAL ThreadCounters * threadCounters = 0;
+
+  // Protects the list of accumulators and the list of per-thread counters.
+  // Only locked when a thread first uses a profile point and when results are written.
+  boost::mutex & registryMutex()
+  {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  // Counters outlive their threads so the results can be written after the threads exit.
+  std::vector<ThreadCounters *> & allThreads()
+  {
+    static std::vector<ThreadCounters *> threads;
+    return threads;
+  }
+}
+
+void
+ProfileCounters::merge(const ProfileCounters & rhs)
+{
+  entries_ += rhs.entries_;
+  exits_ += rhs.exits_;
+  pauses_ += rhs.pauses_;
+  resumes_ += rhs.resumes_;
+  sum_ += rhs.sum_;
+  sumOfSquares_ += rhs.sumOfSquares_;
+  recursions_ += rhs.recursions_;
+  recursiveSum_ += rhs.recursiveSum_;
+  recursiveSumOfSquares_ += rhs.recursiveSumOfSquares_;
+  histogram_.merge(rhs.histogram_);
+}
 
 ProfileAccumulator::ProfileAccumulator(const char * name, const char * file, size_t line)
   : name_(name)
   , file_(file)
   , line_(line)
-  , entries_(0)
-  , exits_(0)
-  , pauses_(0)
-  , resumes_(0)
-  , sum_(0.0)
-  , sumOfSquares_(0.0)
-  , recursions_(0)
-  , recursiveSum_(0.0)
-  , recursiveSumOfSquares_(0.0)
-
 {
+  boost::mutex::scoped_lock lock(registryMutex());
+  index_ = count_++;
   next_ = root_;
   root_ = this;
 }
 
+ProfileCounters &
+ProfileAccumulator::counters()const
+{
+  ThreadCounters * thread = threadCounters;
+  if(thread != 0 && index_ < thread->size())
+  {
+    return *(*thread)[index_];
+  }
+  return newCounters();
+}
+
+ProfileCounters &
+ProfileAccumulator::newCounters()const
+{
+  boost::mutex::scoped_lock lock(registryMutex());
+  ThreadCounters * thread = threadCounters;
+  if(thread == 0)
+  {
+    thread = new ThreadCounters;
+    allThreads().push_back(thread);
+    threadCounters = thread;
+  }
+  while(thread->size() < count_)
+  {
+    thread->push_back(new ProfileCounters);
+  }
+  return *(*thread)[index_];
+}
+
+void
+ProfileAccumulator::merge(ProfileCounters & result)const
+{
+  boost::mutex::scoped_lock lock(registryMutex());
+  std::vector<ThreadCounters *> & threads = allThreads();
+  for(size_t nThread = 0; nThread < threads.size(); ++nThread)
+  {
+    if(index_ < threads[nThread]->size())
+    {
+      result.merge(*(*threads[nThread])[index_]);
+    }
+  }
+}
+
+double
+ProfileAccumulator::nanosecondsPerTick()
+{
+  static double result = 0.0;
+  double scale = 0.0;
+  {
+    boost::mutex::scoped_lock lock(registryMutex());
+    scale = result;
+  }
+  if(scale == 0.0)
+  {
+    // Calibrate without the lock so threads registering profile points do not wait.
+    // Two threads may both calibrate; either answer will do.
+#if defined(PROFILER_TSC)
+    // count ticks for a known interval
+    uint64 startTime = Common::monotonicNanoseconds();
+    uint64 startTicks = profilerTicks();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    uint64 ticks = profilerTicks() - startTicks;
+    uint64 nanoseconds = Common::monotonicNanoseconds() - startTime;
+    scale = ticks == 0 ? 1.0 : double(nanoseconds) / double(ticks);
+#elif defined(_WIN32)
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    scale = 1.0e9 / double(frequency.QuadPart);
+#else
+    scale = 1.0;
+#endif
+    boost::mutex::scoped_lock lock(registryMutex());
+    result = scale;
+  }
+  return scale;
+}
+
 void
 ProfileAccumulator::write(std::ostream & out)
 {
-  const ProfileAccumulator * ac = root_;
+  double scale = nanosecondsPerTick();
+  const ProfileAccumulator * ac = 0;
+  {
+    boost::mutex::scoped_lock lock(registryMutex());
+    ac = root_;
+  }
   out << "name\tfile\tline\tentries\texits\tsum\tsum_of_squares"
     << "\trecursions\trecursive_sum\trecursive_sum_of_squares"
     // helpers
     << "\tnonRsum"
     << "\tnonRmean"
+    << "\tp50\tp99\tp99.9\tmax"
     << std::endl;
   while(ac != 0)
   {
+    ProfileCounters counters;
+    ac->merge(counters);
+    const Common::LatencyHistogram & histogram = counters.histogram_;
     out << ac->name_
       << '\t' << ac->file_
       << '\t' << ac->line_
-      << '\t' << ac->entries_
-      << '\t' << ac->exits_
-      << '\t' << ac->sum_
-      << '\t' << ac->sumOfSquares_
-      << '\t' << ac->recursions_
-      << '\t' << ac->recursiveSum_
-      << '\t' << ac->recursiveSumOfSquares_
+      << '\t' << counters.entries_
+      << '\t' << counters.exits_
+      << '\t' << counters.sum_ * scale
+      << '\t' << counters.sumOfSquares_ * scale * scale
+      << '\t' << counters.recursions_
+      << '\t' << counters.recursiveSum_ * scale
+      << '\t' << counters.recursiveSumOfSquares_ * scale * scale
       // helpers
-      << '\t' << ac->sum_ - ac->recursiveSum_
-      << '\t' << (ac->sum_ - ac->recursiveSum_) /double(ac->exits_ - ac->recursions_)
+      << '\t' << (counters.sum_ - counters.recursiveSum_) * scale
+      << '\t' << (counters.sum_ - counters.recursiveSum_) * scale /double(counters.exits_ - counters.recursions_)
+      << '\t' << double(histogram.percentile(0.5)) * scale
+      << '\t' << double(histogram.percentile(0.99)) * scale
+      << '\t' << double(histogram.percentile(0.999)) * scale
+      << '\t' << double(histogram.maximum()) * scale
       << std::endl;
     ac = ac->next_;
   }
@@ -61,30 +190,42 @@ ProfileAccumulator::write(std::ostream & out)
 void
 ProfileAccumulator::print(std::ostream & out)
 {
-  const ProfileAccumulator * ac = root_;
-  out << "name\tcount\tsum\tmean\tstd_dev\trecursions\trsum\trmean\trstd_dev" << std::endl;
+  double scale = nanosecondsPerTick();
+  const ProfileAccumulator * ac = 0;
+  {
+    boost::mutex::scoped_lock lock(registryMutex());
+    ac = root_;
+  }
+  out << "name\tcount\tsum\tmean\tstd_dev\tp50\tp99\tp99.9\tmax\trecursions\trsum\trmean\trstd_dev" << std::endl;
   while(ac != 0)
   {
-    double count = double(ac->exits_ - ac->recursions_);
-    double sum = ac->sum_ - ac->recursiveSum_;
-    double sumsq = ac->sumOfSquares_ - ac->recursiveSumOfSquares_;
+    ProfileCounters counters;
+    ac->merge(counters);
+    double count = double(counters.exits_ - counters.recursions_);
+    double sum = (counters.sum_ - counters.recursiveSum_) * scale;
+    double sumsq = (counters.sumOfSquares_ - counters.recursiveSumOfSquares_) * scale * scale;
 
     out << ac->name_
       << '\t' << std::fixed << std::setprecision(0) << count
       << '\t' << std::fixed << std::setprecision(0) << sum;
     if(count > 1)
     {
+      const Common::LatencyHistogram & histogram = counters.histogram_;
       double mean = sum/ count;
       double stdDev = std::sqrt((sumsq - sum * mean) / (count - 1.0));
       out
         << '\t' << std::fixed << std::setprecision(3) << mean
         << '\t' << std::fixed << std::setprecision(3) << stdDev
-        << '\t' << ac->recursions_;
-      if(ac->recursions_ > 0)
+        << '\t' << std::fixed << std::setprecision(0) << double(histogram.percentile(0.5)) * scale
+        << '\t' << std::fixed << std::setprecision(0) << double(histogram.percentile(0.99)) * scale
+        << '\t' << std::fixed << std::setprecision(0) << double(histogram.percentile(0.999)) * scale
+        << '\t' << std::fixed << std::setprecision(0) << double(histogram.maximum()) * scale
+        << '\t' << counters.recursions_;
+      if(counters.recursions_ > 0)
       {
-        double count = double(ac->recursions_);
-        double sum = ac->recursiveSum_;
-        double sumsq = ac->recursiveSumOfSquares_;
+        double count = double(counters.recursions_);
+        double sum = counters.recursiveSum_ * scale;
+        double sumsq = counters.recursiveSumOfSquares_ * scale * scale;
         double mean = sum/ count;
         double stdDev = std::sqrt((sumsq - sum * mean) / (count - 1.0));
         out << '\t' << std::fixed << std::setprecision(0) << sum
@@ -96,5 +237,3 @@ ProfileAccumulator::print(std::ostream & out)
     ac = ac->next_;
   }
 }
-
-
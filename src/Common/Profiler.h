@@ -7,42 +7,111 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 #include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Common/LatencyHistogram.h>
 
 /// enable or disable generation of profiler code.
 #define PROFILER_ENABLEx
 
+// The profiler reads a tick counter rather than a clock: the CPU's time stamp counter
+// where there is one, otherwise the raw monotonic clock in nanoseconds.
+// Ticks are converted to nanoseconds only when the results are written.
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# include <intrin.h>
+# define PROFILER_TSC
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define PROFILER_TSC
+#elif !defined(_WIN32)
+# include <time.h>
+#endif
 
-// Note: boost's microsecond_clock was slow enough to skew the results
-// hence the win32 GetTickCount stuff.
-#ifdef _WIN32
-# ifndef _WINBASE_ // if we didn't #include <windows.h>
-// this is the ultimate expansion of the declaration for GetTickCount
-// after the macros have been resolved on a 16 bit windows build
-// With luck, it won't conflict with the windows declaration in case
-// the included occur in the wrong order
-typedef unsigned long DWORD;
-__declspec(dllimport) DWORD GetTickCount(void);
-# endif // _WINBASE_
-# define PROFILER_GET_TIME ::GetTickCount()
-# define PROFILER_TIME_TYPE DWORD
-# define PROFILER_DIFF_MSEC(a, b) (a - b)
-#else // _WIN32
-# include <boost/date_time/posix_time/posix_time.hpp>
-# define PROFILER_GET_TIME boost::posix_time::microsec_clock::universal_time()
-# define PROFILER_TIME_TYPE boost::posix_time::ptime
-# define PROFILER_DIFF_MSEC(a,b) ((a - b).total_milliseconds())
-#endif // _WIN32
+#define PROFILER_GET_TIME QuickFAST::profilerTicks()
+#define PROFILER_TIME_TYPE QuickFAST::uint64
+#define PROFILER_DIFF_TICKS(a, b) ((a) - (b))
 
 namespace QuickFAST{
+  /// @brief Read the profiler's tick counter.
+  ///
+  /// The time stamp counter on x86 processors.  On other platforms the raw monotonic
+  /// clock in nanoseconds.  See ProfileAccumulator::nanosecondsPerTick()
+  inline uint64 profilerTicks()
+  {
+#if defined(PROFILER_TSC) && defined(_MSC_VER)
+    return __rdtsc();
+#elif defined(PROFILER_TSC)
+    unsigned int low;
+    unsigned int high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return (uint64(high) << 32) | low;
+#elif defined(_WIN32)
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return uint64(now.QuadPart);
+#else
+    struct timespec now;
+# if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+# else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+# endif
+    return uint64(now.tv_sec) * 1000000000ULL + uint64(now.tv_nsec);
+#endif
+  }
+
+  /// @brief The statistics for one profile point collected by one thread.
+  struct QuickFAST_Export ProfileCounters
+  {
+    ProfileCounters()
+      : entries_(0)
+      , exits_(0)
+      , pauses_(0)
+      , resumes_(0)
+      , sum_(0.0)
+      , sumOfSquares_(0.0)
+      , recursions_(0)
+      , recursiveSum_(0.0)
+      , recursiveSumOfSquares_(0.0)
+    {
+    }
+    /// @brief Add another thread's statistics to these.
+    void merge(const ProfileCounters & rhs);
+
+    /// Times the profile point was entered
+    size_t entries_;
+    /// Times the profile point was exited
+    size_t exits_;
+    /// Times profiling was paused
+    size_t pauses_;
+    /// Times profiling was resumed
+    size_t resumes_;
+    /// Total ticks
+    double sum_;
+    /// For the standard deviation
+    double sumOfSquares_;
+    /// Exits while another instance of this point was active in the same thread
+    size_t recursions_;
+    /// Total ticks in recursive calls
+    double recursiveSum_;
+    /// For the standard deviation of recursive calls
+    double recursiveSumOfSquares_;
+    /// Distribution of the non-recursive laps in ticks
+    Common::LatencyHistogram histogram_;
+  };
+
   /// @brief Accumulate profiler statistics.
   ///
   /// A ProfileAccumulater is statically created for each Profile Point.
   /// The ProfileInstances created to do the actual timing store their results
-  /// into the corresponding ProfileAccumulator.
+  /// into counters belonging to the current thread, so threads never contend
+  /// and nothing is locked while timing.  The counters from all threads are merged
+  /// when the results are written.
   /// These accumulators link themselves together in a list starting at root_.
   /// Walking this list lets you find all profile points in the system.
   /// The static write(...) method writes a tab-delimited file of the statistics.
   /// Hint: try importing this file into a spreadsheet for analysis.
+  ///
+  /// All times are reported in nanoseconds.  Results may be written while profiled
+  /// threads are running, but the latest measurements from those threads may be missed.
   class QuickFAST_Export ProfileAccumulator
   {
   public:
@@ -56,28 +125,36 @@ namespace QuickFAST{
     /// @brief write in somewhat human readable format
     static void print(std::ostream & out);
 
+    /// @brief Collect the statistics from all threads for this profile point.
+    /// @param[out] result receives the merged counters (times are in ticks)
+    void merge(ProfileCounters & result)const;
+
+    /// @brief Find the current thread's counters for this profile point.
+    ProfileCounters & counters()const;
+
+    /// @brief The length of a tick in nanoseconds.
+    ///
+    /// Measured against the system clock the first time it is needed.
+    static double nanosecondsPerTick();
+
+  private:
+    ProfileCounters & newCounters()const;
+
   private:
     friend class ProfileInstance;
     static ProfileAccumulator * root_;
+    static size_t count_;
     ProfileAccumulator * next_;
     const char * name_;
     const char * file_;
     size_t line_;
-    size_t entries_;
-    size_t exits_;
-    size_t pauses_;
-    size_t resumes_;
-    double sum_;
-    double sumOfSquares_;
-    size_t recursions_;
-    double recursiveSum_;
-    double recursiveSumOfSquares_;
+    size_t index_;
   };
 
   /// @brief an auto variable to measure the time in a section of code
   ///
   /// Measures time from creation to destruction (usually controlled by scope)
-  /// and stores the results in a ProfileAccumulator
+  /// and stores the results in the current thread's counters for a ProfileAccumulator
   class QuickFAST_Export ProfileInstance
   {
   public:
@@ -85,18 +162,18 @@ namespace QuickFAST{
     /// @brief Construct and link to an accumulator
     /// @param accumulator to receive the measured results.
     ProfileInstance(ProfileAccumulator & accumulator)
-      : accumulator_(accumulator)
-      , start_(PROFILER_GET_TIME)
+      : counters_(accumulator.counters())
       , running_(true)
     {
-      accumulator_.entries_ += 1;
+      counters_.entries_ += 1;
+      start_ = PROFILER_GET_TIME;
     }
 
     /// @brief Stop timing and accumulate results.
     ~ProfileInstance()
     {
       stop();
-      accumulator_.exits_ += 1;
+      counters_.exits_ += 1;
     }
 
     /// @brief Stop timing -- may be resumable
@@ -105,7 +182,7 @@ namespace QuickFAST{
     {
       bool result = running_;
       stop();
-      accumulator_.pauses_ += 1;
+      counters_.pauses_ += 1;
       return result;
     }
 
@@ -113,7 +190,7 @@ namespace QuickFAST{
     /// @param pauseState is the return value from a pause
     void resume(bool pauseState)
     {
-      accumulator_.resumes_ += 1;
+      counters_.resumes_ += 1;
       if(!running_ && pauseState)
       {
         start_ = PROFILER_GET_TIME;
@@ -127,15 +204,20 @@ namespace QuickFAST{
       if(running_)
       {
         PROFILER_TIME_TYPE now = PROFILER_GET_TIME;
-        double lapse = double(PROFILER_DIFF_MSEC(now, start_));
-        accumulator_.sum_ += lapse;
-        accumulator_.sumOfSquares_ += lapse * lapse;
-        assert(accumulator_.entries_ > accumulator_.exits_);
-        if(accumulator_.entries_ != accumulator_.exits_ + 1)
+        uint64 ticks = PROFILER_DIFF_TICKS(now, start_);
+        double lapse = double(ticks);
+        counters_.sum_ += lapse;
+        counters_.sumOfSquares_ += lapse * lapse;
+        assert(counters_.entries_ > counters_.exits_);
+        if(counters_.entries_ != counters_.exits_ + 1)
+        {
+          counters_.recursions_ += 1;
+          counters_.recursiveSum_ += lapse;
+          counters_.recursiveSumOfSquares_ += lapse * lapse;
+        }
+        else
         {
-          accumulator_.recursions_ += 1;
-          accumulator_.recursiveSum_ += lapse;
-          accumulator_.recursiveSumOfSquares_ += lapse * lapse;
+          counters_.histogram_.record(ticks);
         }
         running_ = false;
       }
@@ -146,7 +228,7 @@ namespace QuickFAST{
     ProfileInstance(const ProfileInstance &);
 
   private:
-    ProfileAccumulator & accumulator_;
+    ProfileCounters & counters_;
     PROFILER_TIME_TYPE start_;
     bool running_;
   };
@@ -164,7 +246,7 @@ namespace QuickFAST{
 
 /// Resume after pause
 # define PROFILE_RESUME \
-    PROFILE_instance.pause(PROFILE_pauseState)
+    PROFILE_instance.resume(PROFILE_pauseState)
 
 /// Define the start point of a block of code to be profiled.
 /// Allows more than one profiler in the same scope.
@@ -178,12 +260,13 @@ namespace QuickFAST{
 
 /// Resume after pause
 # define NESTED_PROFILE_RESUME(id) \
-  PROFILE_instance##id.pause(PROFILE_pauseState##id)
+  PROFILE_instance##id.resume(PROFILE_pauseState##id)
 
 #else // PROFILER_ENABLE
 
 # define PROFILE_POINT(name)  void(0)
 # define PROFILE_PAUSE  void(0)
+# define PROFILE_RESUME  void(0)
 # define NESTED_PROFILE_POINT(id, name)  void(0)
 # define NESTED_PROFILE_PAUSE(id) void(0)
 # define NESTED_PROFILE_RESUME(id) void(0)
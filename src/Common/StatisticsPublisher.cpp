@@ -0,0 +1,91 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "StatisticsPublisher.h"
+#include <boost/bind.hpp>
+
+using namespace QuickFAST;
+using namespace Common;
+
+StatisticsPublisher::StatisticsPublisher(const StatisticsRegistry & registry)
+: registry_(registry)
+, interval_(1000)
+, publications_(0)
+, stopping_(false)
+{
+}
+
+StatisticsPublisher::~StatisticsPublisher()
+{
+  stop();
+}
+
+void
+StatisticsPublisher::start(
+  const std::string & segmentName,
+  size_t capacity,
+  unsigned long intervalMilliseconds)
+{
+  stop();
+  if(!segment_.create(segmentName, capacity))
+  {
+    throw std::runtime_error("Can't create statistics segment: " + segmentName);
+  }
+  interval_ = intervalMilliseconds;
+  stopping_ = false;
+  publish();
+  thread_.reset(new boost::thread(boost::bind(&StatisticsPublisher::run, this)));
+}
+
+void
+StatisticsPublisher::stop()
+{
+  if(thread_)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stopping_ = true;
+      stopCondition_.notify_all();
+    }
+    thread_->join();
+    thread_.reset();
+    publish();
+  }
+  segment_.close();
+}
+
+void
+StatisticsPublisher::publish()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  publishLocked();
+}
+
+void
+StatisticsPublisher::publishLocked()
+{
+  if(segment_.isOpen())
+  {
+    segment_.publish(registry_);
+    ++publications_;
+  }
+}
+
+void
+StatisticsPublisher::run()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  while(!stopping_)
+  {
+    boost::system_time wakeup = boost::get_system_time()
+      + boost::posix_time::milliseconds(interval_);
+    while(!stopping_ && stopCondition_.timed_wait(lock, wakeup))
+    {
+    }
+    if(!stopping_)
+    {
+      publishLocked();
+    }
+  }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef STATISTICSPUBLISHER_H
+#define STATISTICSPUBLISHER_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/StatisticsSegment.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Publish a StatisticsRegistry to a StatisticsSegment from a background thread.
+    ///
+    /// Once started, the publisher copies the registry into the segment at regular
+    /// intervals until it is stopped (or destroyed.)  The threads doing the real work
+    /// never wait for it.  The segment can then be read by another process, i.e. the
+    /// StatisticsMonitor example program.
+    class QuickFAST_Export StatisticsPublisher
+    {
+    public:
+      /// @brief Construct.
+      /// @param registry holds the statistics.  It must outlive the publisher.
+      explicit StatisticsPublisher(const StatisticsRegistry & registry);
+      ~StatisticsPublisher();
+
+      /// @brief Create the segment and start publishing.
+      /// @param segmentName identifies the shared memory segment.
+      /// @param capacity is the most statistics that will be published.
+      /// @param intervalMilliseconds is the time between publications.
+      /// @throws std::runtime_error if the segment cannot be created.
+      void start(
+        const std::string & segmentName,
+        size_t capacity = 1024,
+        unsigned long intervalMilliseconds = 1000);
+
+      /// @brief Publish one last time, stop the thread and remove the segment.
+      void stop();
+
+      /// @brief Publish immediately (from the calling thread.)
+      void publish();
+
+      /// @brief How many times the statistics have been published.
+      size_t publications()const
+      {
+        return publications_;
+      }
+
+    private:
+      StatisticsPublisher(const StatisticsPublisher &);
+      StatisticsPublisher & operator=(const StatisticsPublisher &);
+      void run();
+      void publishLocked();
+
+    private:
+      const StatisticsRegistry & registry_;
+      StatisticsSegment segment_;
+      unsigned long interval_;
+      size_t publications_;
+
+      // Protects the segment (it must have only one writer) and stopping_
+      boost::mutex mutex_;
+      boost::condition_variable stopCondition_;
+      bool stopping_;
+      boost::scoped_ptr<boost::thread> thread_;
+    };
+  }
+}
+#endif // STATISTICSPUBLISHER_H
@@ -0,0 +1,67 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "StatisticsRegistry.h"
+
+using namespace QuickFAST;
+using namespace Common;
+
+StatisticsRegistry::StatisticsRegistry()
+{
+}
+
+StatisticsRegistry::~StatisticsRegistry()
+{
+}
+
+void
+StatisticsRegistry::add(Statistic & statistic, const std::string & name)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  statistic.setName(name);
+  statistics_.push_back(&statistic);
+}
+
+void
+StatisticsRegistry::remove(Statistic & statistic)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  std::vector<Statistic *>::iterator it =
+    std::find(statistics_.begin(), statistics_.end(), &statistic);
+  if(it != statistics_.end())
+  {
+    statistics_.erase(it);
+  }
+}
+
+size_t
+StatisticsRegistry::size()const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return statistics_.size();
+}
+
+size_t
+StatisticsRegistry::copy(Statistic * target, size_t capacity)const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  size_t count = std::min(capacity, statistics_.size());
+  for(size_t nStatistic = 0; nStatistic < count; ++nStatistic)
+  {
+    target[nStatistic] = *statistics_[nStatistic];
+  }
+  return count;
+}
+
+void
+StatisticsRegistry::copy(std::vector<Statistic> & statistics)const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  statistics.clear();
+  statistics.reserve(statistics_.size());
+  for(size_t nStatistic = 0; nStatistic < statistics_.size(); ++nStatistic)
+  {
+    statistics.push_back(*statistics_[nStatistic]);
+  }
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef STATISTICSREGISTRY_H
+#define STATISTICSREGISTRY_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <cstring>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief One named counter or gauge.
+    ///
+    /// A Statistic lives inside the object it describes (a Receiver, an Assembler, ...)
+    /// and is updated in place with a plain store: there is no lock and no atomic
+    /// instruction on the hot path.  In exchange each Statistic must have only one
+    /// writer at a time.  The owner provides that guarantee; the receivers, for example,
+    /// update their statistics while holding their buffer mutex or from the single
+    /// thread servicing their queue.  Readers (see StatisticsRegistry::copy()) may see a
+    /// value that is slightly out of date, never a mixture of two values (on platforms
+    /// where a 64 bit store is a single instruction.)
+    ///
+    /// Every Statistic occupies 64 bytes with the value in the last eight, so the values
+    /// of two statistics never share a cache line: the writer of one does not
+    /// invalidate the cache line holding another.  The same layout is used for the
+    /// entries in a StatisticsSegment.
+    class Statistic
+    {
+    public:
+      /// @brief What the value means.
+      enum Kind
+      {
+        /// A running total.  Only increases.
+        COUNTER,
+        /// A current level (i.e. queue depth.)  May go up or down.
+        GAUGE
+      };
+
+      /// @brief Room for the name including the terminating null.
+      static const size_t nameSize = 48;
+
+      /// @brief Construct an unnamed statistic with a value of zero.
+      /// @param kind says how the value should be interpreted.
+      explicit Statistic(Kind kind = COUNTER)
+        : kind_(uint32(kind))
+        , reserved_(0)
+        , value_(0)
+      {
+        name_[0] = 0;
+      }
+
+      /// @brief Copy the name, kind and current value.
+      Statistic(const Statistic & rhs)
+        : kind_(rhs.kind_)
+        , reserved_(0)
+        , value_(rhs.value_)
+      {
+        std::memcpy(name_, rhs.name_, sizeof(name_));
+      }
+
+      /// @brief Copy the name, kind and current value.
+      Statistic & operator=(const Statistic & rhs)
+      {
+        std::memcpy(name_, rhs.name_, sizeof(name_));
+        kind_ = rhs.kind_;
+        value_ = rhs.value_;
+        return *this;
+      }
+
+      /// @brief Count one.
+      Statistic & operator++()
+      {
+        value_ = value_ + 1;
+        return *this;
+      }
+
+      /// @brief Count several.
+      Statistic & operator+=(uint64 amount)
+      {
+        value_ = value_ + amount;
+        return *this;
+      }
+
+      /// @brief Set the current level of a gauge.
+      void set(uint64 value)
+      {
+        value_ = value;
+      }
+
+      /// @brief Keep the largest value seen (a high water mark.)
+      void raise(uint64 value)
+      {
+        if(value > value_)
+        {
+          value_ = value;
+        }
+      }
+
+      /// @brief The current value.
+      uint64 value()const
+      {
+        return value_;
+      }
+
+      /// @brief How the value should be interpreted.
+      Kind kind()const
+      {
+        return Kind(kind_);
+      }
+
+      /// @brief The name given by StatisticsRegistry::add() (empty if unregistered.)
+      const char * name()const
+      {
+        return name_;
+      }
+
+      /// @brief Change the name.  Names longer than nameSize - 1 are truncated.
+      void setName(const std::string & name)
+      {
+        size_t length = std::min(name.size(), nameSize - 1);
+        std::memcpy(name_, name.data(), length);
+        name_[length] = 0;
+      }
+
+    private:
+      char name_[nameSize];
+      uint32 kind_;
+      uint32 reserved_;
+      volatile uint64 value_;
+    };
+
+    /// @brief An index of the statistics published by a program.
+    ///
+    /// The statistics themselves stay where they are; the registry remembers
+    /// where to find them.  Owners add their statistics when asked to publish them
+    /// (i.e. Communication::Receiver::setStatistics()) and remove them before they are
+    /// destroyed.  Adding, removing and copying are protected by a mutex, none
+    /// of which happens while a statistic is being updated.
+    ///
+    /// A StatisticsPublisher copies the registry into shared memory periodically for
+    /// monitoring tools.
+    class QuickFAST_Export StatisticsRegistry
+    {
+    public:
+      StatisticsRegistry();
+      ~StatisticsRegistry();
+
+      /// @brief Name a statistic and add it to the registry.
+      /// @param statistic must be removed before it is destroyed.
+      /// @param name identifies it to readers.
+      void add(Statistic & statistic, const std::string & name);
+
+      /// @brief Remove a statistic from the registry.  Unknown statistics are ignored.
+      /// @param statistic was added earlier.
+      void remove(Statistic & statistic);
+
+      /// @brief How many statistics are registered.
+      size_t size()const;
+
+      /// @brief Copy the registered statistics in the order they were added.
+      /// @param target receives the copies.
+      /// @param capacity is the number of entries available at target.
+      /// @returns the number copied (at most capacity.)
+      size_t copy(Statistic * target, size_t capacity)const;
+
+      /// @brief Copy all the registered statistics.
+      /// @param statistics is replaced with the copies.
+      void copy(std::vector<Statistic> & statistics)const;
+
+    private:
+      StatisticsRegistry(const StatisticsRegistry &);
+      StatisticsRegistry & operator=(const StatisticsRegistry &);
+
+    private:
+      mutable boost::mutex mutex_;
+      std::vector<Statistic *> statistics_;
+    };
+  }
+}
+#endif // STATISTICSREGISTRY_H
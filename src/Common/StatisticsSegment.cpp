@@ -0,0 +1,255 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "StatisticsSegment.h"
+#include <Common/Timestamp.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace QuickFAST;
+using namespace Common;
+
+namespace
+{
+  // A reader gives up if the writer is always in the middle of a publication.
+  const size_t readAttempts = 1000;
+
+  // Keep the compiler and the processor from moving loads or stores across
+  // the updates to the sequence number.
+  void fence()
+  {
+#if defined(_WIN32)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+  }
+
+  std::string segmentName(const std::string & name)
+  {
+#if defined(_WIN32)
+    return name;
+#else
+    if(!name.empty() && name[0] == '/')
+    {
+      return name;
+    }
+    return "/" + name;
+#endif
+  }
+}
+
+StatisticsSegment::StatisticsSegment()
+: header_(0)
+, entries_(0)
+, size_(0)
+, owner_(false)
+{
+}
+
+StatisticsSegment::~StatisticsSegment()
+{
+  close();
+}
+
+bool
+StatisticsSegment::create(const std::string & name, size_t capacity)
+{
+  close();
+  size_t size = sizeof(Header) + capacity * sizeof(Statistic);
+  if(!map(segmentName(name), size, true))
+  {
+    return false;
+  }
+  owner_ = true;
+  std::memset(header_, 0, size_);
+  header_->magic_ = magicNumber;
+  header_->version_ = layoutVersion;
+  header_->capacity_ = uint32(capacity);
+  return true;
+}
+
+bool
+StatisticsSegment::open(const std::string & name)
+{
+  close();
+  if(!map(segmentName(name), 0, false))
+  {
+    return false;
+  }
+  bool ok = size_ >= sizeof(Header)
+    && header_->magic_ == magicNumber
+    && header_->version_ == layoutVersion
+    && sizeof(Header) + header_->capacity_ * sizeof(Statistic) <= size_;
+  if(!ok)
+  {
+    close();
+  }
+  return ok;
+}
+
+bool
+StatisticsSegment::map(const std::string & name, size_t size, bool create)
+{
+#if defined(_WIN32)
+  HANDLE mapping = 0;
+  if(create)
+  {
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE,
+      DWORD(uint64(size) >> 32), DWORD(size), name.c_str());
+  }
+  else
+  {
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+  }
+  if(mapping == 0)
+  {
+    return false;
+  }
+  // the view keeps the mapping open.
+  void * view = MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if(view == 0)
+  {
+    return false;
+  }
+  if(!create)
+  {
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(view, &info, sizeof(info));
+    size = info.RegionSize;
+  }
+#else // _WIN32
+  if(create)
+  {
+    // Replace rather than reuse an old segment: a reader may still have it mapped.
+    shm_unlink(name.c_str());
+  }
+  int segment = create
+    ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644)
+    : shm_open(name.c_str(), O_RDONLY, 0);
+  if(segment < 0)
+  {
+    return false;
+  }
+  bool ok = true;
+  if(create)
+  {
+    ok = ftruncate(segment, off_t(size)) == 0;
+  }
+  else
+  {
+    struct stat status;
+    ok = fstat(segment, &status) == 0 && status.st_size > 0;
+    size = size_t(status.st_size);
+  }
+  void * view = MAP_FAILED;
+  if(ok)
+  {
+    view = mmap(0, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, segment, 0);
+  }
+  // the mapping keeps the segment open.
+  ::close(segment);
+  if(view == MAP_FAILED)
+  {
+    if(create)
+    {
+      shm_unlink(name.c_str());
+    }
+    return false;
+  }
+#endif // _WIN32
+  name_ = name;
+  header_ = static_cast<Header *>(view);
+  entries_ = reinterpret_cast<Statistic *>(header_ + 1);
+  size_ = size;
+  return true;
+}
+
+void
+StatisticsSegment::close()
+{
+  if(header_ != 0)
+  {
+#if defined(_WIN32)
+    UnmapViewOfFile(header_);
+#else // _WIN32
+    munmap(header_, size_);
+    if(owner_)
+    {
+      // readers that already have it open keep their mapping.
+      shm_unlink(name_.c_str());
+    }
+#endif // _WIN32
+  }
+  name_.clear();
+  header_ = 0;
+  entries_ = 0;
+  size_ = 0;
+  owner_ = false;
+}
+
+size_t
+StatisticsSegment::capacity()const
+{
+  if(header_ == 0)
+  {
+    return 0;
+  }
+  return header_->capacity_;
+}
+
+size_t
+StatisticsSegment::publish(const StatisticsRegistry & registry)
+{
+  if(!owner_)
+  {
+    throw std::logic_error("StatisticsSegment::publish: segment was not created by this object.");
+  }
+  Header & header = *header_;
+  uint64 sequence = header.sequence_;
+  header.sequence_ = sequence + 1;
+  fence();
+  header.publishTime_ = wallClockNanoseconds();
+  size_t count = registry.copy(entries_, header.capacity_);
+  header.count_ = uint32(count);
+  ++header.publications_;
+  fence();
+  header.sequence_ = sequence + 2;
+  return count;
+}
+
+bool
+StatisticsSegment::read(std::vector<Statistic> & statistics, uint64 & publishTime)const
+{
+  if(header_ == 0)
+  {
+    return false;
+  }
+  const Header & header = *header_;
+  for(size_t attempt = 0; attempt < readAttempts; ++attempt)
+  {
+    uint64 before = header.sequence_;
+    if((before & 1) == 0)
+    {
+      fence();
+      size_t count = std::min(size_t(header.count_), size_t(header.capacity_));
+      statistics.assign(entries_, entries_ + count);
+      publishTime = header.publishTime_;
+      bool published = header.publications_ != 0;
+      fence();
+      if(header.sequence_ == before)
+      {
+        return published;
+      }
+    }
+    boost::this_thread::yield();
+  }
+  return false;
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef STATISTICSSEGMENT_H
+#define STATISTICSSEGMENT_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/StatisticsRegistry.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief A named shared memory segment holding a copy of a StatisticsRegistry.
+    ///
+    /// One process creates the segment and publishes into it (normally via a
+    /// StatisticsPublisher.)  Any number of other processes open it read-only and read
+    /// it whenever they like.  The reader never blocks the writer: the segment is
+    /// protected by a sequence number that is odd while a publication is in progress,
+    /// and a reader that sees the number change while it was copying simply tries again.
+    ///
+    /// The segment is a 64 byte header followed by capacity() entries laid out
+    /// exactly like a Statistic.
+    ///
+    /// The name is a POSIX shared memory object name on Unix-like systems ("/" is
+    /// prepended if necessary) and a named file mapping on Windows.
+    class QuickFAST_Export StatisticsSegment
+    {
+    public:
+      /// @brief The beginning of the segment.
+      struct Header
+      {
+        /// Identifies a statistics segment: magicNumber
+        uint32 magic_;
+        /// Layout version: layoutVersion
+        uint32 version_;
+        /// Number of entries following the header.
+        uint32 capacity_;
+        /// Number of entries in use.
+        uint32 count_;
+        /// Odd while a publication is in progress.
+        volatile uint64 sequence_;
+        /// When the last publication started (see Common::wallClockNanoseconds())
+        uint64 publishTime_;
+        /// How many times the statistics have been published.
+        uint64 publications_;
+        /// Pads the header to 64 bytes.
+        unsigned char reserved_[24];
+      };
+
+      /// @brief Identifies a statistics segment.
+      static const uint32 magicNumber = 0x51465354; // "QFST"
+      /// @brief The layout described by Header and Statistic.
+      static const uint32 layoutVersion = 1;
+
+      StatisticsSegment();
+      ~StatisticsSegment();
+
+      /// @brief Create a segment for publishing.  Any previously opened segment is closed.
+      ///
+      /// An existing segment with the same name is replaced.  The segment is removed
+      /// when this object is closed.
+      /// @param name identifies the segment.
+      /// @param capacity is the most statistics that will be published.
+      /// @returns true if the segment was created.
+      bool create(const std::string & name, size_t capacity);
+
+      /// @brief Open an existing segment for reading.  Any previously opened segment is closed.
+      /// @param name identifies the segment.
+      /// @returns true if a statistics segment by that name exists.
+      bool open(const std::string & name);
+
+      /// @brief Release the segment (and remove it if this object created it.)
+      void close();
+
+      /// @brief Is a segment open?
+      bool isOpen()const
+      {
+        return header_ != 0;
+      }
+
+      /// @brief How many statistics the segment can hold.
+      size_t capacity()const;
+
+      /// @brief Copy the statistics from a registry into the segment.
+      ///
+      /// Statistics that do not fit are left out.  Only valid for a created segment.
+      /// @param registry holds the statistics.
+      /// @returns the number of statistics published.
+      size_t publish(const StatisticsRegistry & registry);
+
+      /// @brief Get a consistent copy of the statistics in the segment.
+      /// @param statistics is replaced with the copies.
+      /// @param publishTime is set to the time of the publication that was copied.
+      /// @returns false if nothing has been published yet, or the writer kept
+      ///          publishing while we tried to read.
+      bool read(std::vector<Statistic> & statistics, uint64 & publishTime)const;
+
+    private:
+      StatisticsSegment(const StatisticsSegment &);
+      StatisticsSegment & operator=(const StatisticsSegment &);
+      bool map(const std::string & name, size_t size, bool create);
+
+    private:
+      std::string name_;
+      Header * header_;
+      Statistic * entries_;
+      size_t size_;
+      bool owner_;
+    };
+  }
+}
+#endif // STATISTICSSEGMENT_H
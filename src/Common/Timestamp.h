@@ -0,0 +1,61 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+// All inline, do not export.
+#include <Common/Types.h>
+#if !defined(_WIN32)
+# include <time.h>
+#endif
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Read the wall clock.
+    ///
+    /// The result uses the same clock and units as kernel receive timestamps
+    /// (SO_TIMESTAMPNS) and PCap record headers, so the values can be compared
+    /// directly to measure latency.
+    /// @returns nanoseconds since 1970-01-01 00:00:00 UTC
+    inline uint64 wallClockNanoseconds()
+    {
+#if defined(_WIN32)
+      // FILETIME counts 100ns intervals since 1601-01-01
+      FILETIME now;
+      GetSystemTimeAsFileTime(&now);
+      uint64 ticks = (uint64(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+      return (ticks - 116444736000000000ULL) * 100;
+#else
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      return uint64(now.tv_sec) * 1000000000ULL + uint64(now.tv_nsec);
+#endif
+    }
+
+    /// @brief Read a clock that never jumps.
+    ///
+    /// Use this to measure intervals or to schedule events.  The values are
+    /// unrelated to the wall clock.
+    /// @returns nanoseconds since an arbitrary starting point.
+    inline uint64 monotonicNanoseconds()
+    {
+#if defined(_WIN32)
+      LARGE_INTEGER frequency;
+      LARGE_INTEGER now;
+      QueryPerformanceFrequency(&frequency);
+      QueryPerformanceCounter(&now);
+      uint64 ticks = uint64(now.QuadPart);
+      uint64 perSecond = uint64(frequency.QuadPart);
+      return (ticks / perSecond) * 1000000000ULL + (ticks % perSecond) * 1000000000ULL / perSecond;
+#else
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return uint64(now.tv_sec) * 1000000000ULL + uint64(now.tv_nsec);
+#endif
+    }
+  }
+}
+#endif // TIMESTAMP_H
@@ -475,6 +475,18 @@ namespace QuickFAST{
       return Decimal(signedInteger_, exponent_);
     }
 
+    /// @brief Exchange contents with another Value without allocating memory.
+    /// @param rhs is the other value.
+    void swap(Value & rhs)
+    {
+      std::swap(class_, rhs.class_);
+      std::swap(cachedString_, rhs.cachedString_);
+      std::swap(unsignedInteger_, rhs.unsignedInteger_);
+      std::swap(signedInteger_, rhs.signedInteger_);
+      std::swap(exponent_, rhs.exponent_);
+      string_.swap(rhs.string_);
+    }
+
   private:
     /// @brief Produce a cached "human readable" representation of the value
     void valueToStringBuffer()const
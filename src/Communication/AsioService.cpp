@@ -4,6 +4,10 @@
 #include <Common/QuickFASTPch.h>
 #include "AsioService.h"
 #include <Common/Logger.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace QuickFAST;
 using namespace Communication;
@@ -72,8 +76,16 @@ AsioService::runThreads(size_t threadCount /*= 0*/, bool useThisThread /* = true
   }
   while(threadCount_ < threadCount)
   {
-    threads_[threadCount_].reset(
-      new boost::thread(boost::bind(&AsioService::run, this)));
+    if(cpus_.empty())
+    {
+      threads_[threadCount_].reset(
+        new boost::thread(boost::bind(&AsioService::run, this)));
+    }
+    else
+    {
+      threads_[threadCount_].reset(
+        new boost::thread(boost::bind(&AsioService::runPinned, this, cpus_[threadCount_ % cpus_.size()])));
+    }
     ++threadCount_;
   }
   if(useThisThread)
@@ -83,6 +95,42 @@ AsioService::runThreads(size_t threadCount /*= 0*/, bool useThisThread /* = true
   }
 }
 
+bool
+AsioService::pinCurrentThread(int cpu)
+{
+#if defined(_WIN32)
+  DWORD_PTR mask = DWORD_PTR(1) << cpu;
+  return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+void
+AsioService::runPinned(int cpu)
+{
+  if(!pinCurrentThread(cpu))
+  {
+    std::stringstream msg;
+    msg << "Unable to pin thread to CPU " << cpu;
+    if(logger_ != 0)
+    {
+      logger_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+    }
+    else
+    {
+      std::cerr << msg.str() << std::endl;
+    }
+  }
+  run();
+}
+
 void
 AsioService::run()
   {
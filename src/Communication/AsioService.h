@@ -33,6 +33,24 @@ namespace QuickFAST
 
       void setLogger(Common::Logger & logger);
 
+      /// @brief Pin the additional threads to specific CPUs.
+      ///
+      /// Thread n created by runThreads() or startThreads() is pinned to cpus[n % cpus.size()].
+      /// The calling thread (when useThisThread is true) is not pinned.
+      /// Must be called before the threads are started.  An empty vector disables pinning.
+      /// @param cpus is a list of zero-based CPU numbers.
+      void setThreadAffinity(const std::vector<int> & cpus)
+      {
+        cpus_ = cpus;
+      }
+
+      /// @brief Pin the calling thread to a CPU.
+      ///
+      /// Supported on Linux and Windows.  On other platforms this does nothing.
+      /// @param cpu is the zero-based CPU number
+      /// @returns true if the thread was pinned.
+      static bool pinCurrentThread(int cpu);
+
       /// @brief Run the event loop with this threads and threadCount additional threads.
       void runThreads(size_t threadCount = 0, bool useThisThread = true);
 
@@ -100,6 +118,9 @@ namespace QuickFAST
         ioService_.post(handler);
       }
 
+    private:
+      void runPinned(int cpu);
+
     private:
       static boost::asio::io_service privateIoService_;
       /// Pointer to a boost thread
@@ -108,6 +129,7 @@ namespace QuickFAST
       boost::scoped_array<ThreadPtr> threads_;
       size_t threadCount_;
       size_t threadCapacity_;
+      std::vector<int> cpus_;
     protected:
       /// Protected reference to the io_service.
       boost::asio::io_service & ioService_;
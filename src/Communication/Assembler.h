@@ -11,8 +11,11 @@
 #include <Communication/Receiver_fwd.h>
 #include <Codecs/TemplateRegistry_fwd.h>
 #include <Codecs/Decoder.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
 #include <Communication/LinkedBuffer.h>
 #include <Common/Logger.h>
+#include <Common/StatisticsRegistry.h>
 
 namespace QuickFAST{
   namespace Communication
@@ -36,10 +39,16 @@ namespace QuickFAST{
         , logger_(logger)
         , strict_(true)
         , reset_(false)
+        , statistics_(0)
+        , lastTemplateId_(0)
+        , lastTemplateStatistic_(0)
       {
       }
 
-      virtual ~Assembler(){}
+      virtual ~Assembler()
+      {
+        setStatistics(0);
+      }
 
       /// @brief notify queue service that receiver is started
       /// Will be called once before serviceQueue is called
@@ -99,6 +108,96 @@ namespace QuickFAST{
         return decoder_;
       }
 
+      /// @brief Publish this Assembler's statistics.
+      ///
+      /// Publishes prefix + "messagesDecoded", prefix + "decodingErrors" and
+      /// prefix + "template." + id counting the messages decoded with each template
+      /// in the decoder's template registry.  (Templates that are not in the registry
+      /// when this is called are counted only in messagesDecoded.)
+      /// Call before decoding starts.  The statistics are removed from the registry
+      /// when this Assembler is destroyed.
+      /// @param registry must outlive this Assembler (or zero to stop publishing.)
+      /// @param prefix distinguishes this Assembler from others using the same registry.
+      void setStatistics(Common::StatisticsRegistry * registry, const std::string & prefix = "assembler.")
+      {
+        if(statistics_ != 0)
+        {
+          statistics_->remove(messagesDecoded_);
+          statistics_->remove(decodingErrors_);
+          for(TemplateStatistics::iterator it = templateStatistics_.begin();
+            it != templateStatistics_.end();
+            ++it)
+          {
+            statistics_->remove(*it->second);
+          }
+        }
+        templateStatistics_.clear();
+        lastTemplateStatistic_ = 0;
+        statistics_ = registry;
+        if(statistics_ != 0)
+        {
+          statistics_->add(messagesDecoded_, prefix + "messagesDecoded");
+          statistics_->add(decodingErrors_, prefix + "decodingErrors");
+          // Register every template now so the decoding thread never allocates.
+          Codecs::TemplateRegistryCPtr templates = decoder_.getTemplateRegistry();
+          for(size_t nTemplate = 0; nTemplate < templates->definedTemplateCount(); ++nTemplate)
+          {
+            template_id_t id = templates->definedTemplate(nTemplate)->getId();
+            if(id != 0 && templateStatistics_.find(id) == templateStatistics_.end())
+            {
+              StatisticPtr statistic(new Common::Statistic);
+              statistics_->add(*statistic,
+                prefix + "template." + boost::lexical_cast<std::string>(id));
+              templateStatistics_[id] = statistic;
+            }
+          }
+        }
+      }
+
+      /// @brief Statistic: How many messages have been decoded
+      size_t messagesDecoded()const
+      {
+        return size_t(messagesDecoded_.value());
+      }
+
+      /// @brief Statistic: How many decoding errors have been reported
+      size_t decodingErrors()const
+      {
+        return size_t(decodingErrors_.value());
+      }
+
+    protected:
+      /// @brief Count a message that was decoded successfully.
+      ///
+      /// Called by the thread servicing the queue after Decoder::decodeMessage().
+      /// Only updates statistics registered by setStatistics(); it never allocates.
+      void countMessage()
+      {
+        ++messagesDecoded_;
+        if(statistics_ != 0)
+        {
+          template_id_t id = decoder_.getTemplateId();
+          if(lastTemplateStatistic_ == 0 || id != lastTemplateId_)
+          {
+            TemplateStatistics::const_iterator it = templateStatistics_.find(id);
+            lastTemplateStatistic_ = (it == templateStatistics_.end()) ? 0 : it->second.get();
+            lastTemplateId_ = id;
+          }
+          if(lastTemplateStatistic_ != 0)
+          {
+            ++*lastTemplateStatistic_;
+          }
+        }
+      }
+
+      /// @brief Count a decoding error.
+      ///
+      /// Called by the thread servicing the queue.
+      void countDecodingError()
+      {
+        ++decodingErrors_;
+      }
+
     protected:
       /// The decoder that does the work.
       Codecs::Decoder decoder_;
@@ -110,6 +209,17 @@ namespace QuickFAST{
       /// Reset the decoder for every message
       bool reset_;
 
+    private:
+      typedef boost::shared_ptr<Common::Statistic> StatisticPtr;
+      typedef std::map<template_id_t, StatisticPtr> TemplateStatistics;
+
+      Common::StatisticsRegistry * statistics_;
+      Common::Statistic messagesDecoded_;
+      Common::Statistic decodingErrors_;
+      TemplateStatistics templateStatistics_;
+      // Most feeds send runs of one template: remember the last one.
+      template_id_t lastTemplateId_;
+      Common::Statistic * lastTemplateStatistic_;
 
     };
   }
@@ -9,6 +9,12 @@
 #include "AsynchReceiver_fwd.h"
 #include <Communication/Receiver.h>
 #include <Communication/AsioService.h>
+#include <Common/Timestamp.h>
+#include <boost/version.hpp>
+#if defined(__linux__)
+# include <sys/socket.h>
+# include <errno.h>
+#endif
 
 namespace QuickFAST
 {
@@ -144,6 +150,20 @@ namespace QuickFAST
       {
         // should this thread service the queue?
         bool service = false;
+        if(!error && bytesReceived > 0)
+        {
+          if(buffer->receiveTime() == 0)
+          {
+            // no kernel timestamp. Next best thing.
+            buffer->setReceiveTime(Common::wallClockNanoseconds());
+          }
+          // the buffer belongs to this thread until it is queued,
+          // so it can be journaled before taking the lock.
+          if(!paused_)
+          {
+            journalPacket(buffer, bytesReceived);
+          }
+        }
         { // Scope for lock
           boost::mutex::scoped_lock lock(bufferMutex_);
           readInProgress_ = false;
@@ -167,7 +187,7 @@ namespace QuickFAST
             {
               ++packetsQueued_;
               bytesReceived_ += bytesReceived;
-              largestPacket_ = std::max(largestPacket_, bytesReceived);
+              largestPacket_.raise(bytesReceived);
               buffer->setUsed(bytesReceived);
               if(queue_.push(buffer, lock))
               {
@@ -176,6 +196,7 @@ namespace QuickFAST
                 // accepted.  We'll service the queue after releasing the lock.
                 service = queue_.startService(lock);
               }
+              updateQueueDepth(lock);
             }
           }
           else
@@ -204,6 +225,80 @@ namespace QuickFAST
         }
       }
 
+#if defined(__linux__)
+      /// @brief Find the native handle of an asio socket
+      template<typename Socket>
+      static int nativeSocket(Socket & socket)
+      {
+#if BOOST_VERSION >= 104700
+        return socket.native_handle();
+#else
+        return socket.native();
+#endif
+      }
+
+      /// @brief Ask the kernel to timestamp incoming data on a socket
+      /// @param socket is the native socket handle
+      static void enableReceiveTimestamps(int socket)
+      {
+        int enable = 1;
+        // Failure is not fatal: handleReceive will use the completion time instead.
+        (void)::setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+      }
+
+      /// @brief Read from a socket that is ready, capturing the kernel receive timestamp.
+      ///
+      /// Used by receivers that wait for readability (null_buffers) rather than
+      /// letting asio do the read, because asio does not return ancillary data.
+      /// @param socket is the native socket handle
+      /// @param buffer receives the data and the timestamp.
+      /// @param[out] bytesReceived is the number of bytes read.
+      /// @param[out] error is set if the read fails.
+      /// @returns false if no data was available (wait again).
+      static bool receiveTimestamped(
+        int socket,
+        LinkedBuffer * buffer,
+        size_t & bytesReceived,
+        boost::system::error_code & error)
+      {
+        struct iovec data;
+        data.iov_base = buffer->get();
+        data.iov_len = buffer->capacity();
+        char control[CMSG_SPACE(sizeof(struct timespec))];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        bytesReceived = 0;
+        ssize_t result = ::recvmsg(socket, &message, MSG_DONTWAIT);
+        if(result < 0)
+        {
+          if(errno == EAGAIN || errno == EWOULDBLOCK)
+          {
+            return false;
+          }
+          error = boost::system::error_code(errno, boost::asio::error::get_system_category());
+          return true;
+        }
+        bytesReceived = size_t(result);
+        for(struct cmsghdr * header = CMSG_FIRSTHDR(&message);
+          header != 0;
+          header = CMSG_NXTHDR(&message, header))
+        {
+          if(header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS)
+          {
+            struct timespec stamp;
+            memcpy(&stamp, CMSG_DATA(header), sizeof(stamp));
+            buffer->setReceiveTime(uint64(stamp.tv_sec) * 1000000000ULL + uint64(stamp.tv_nsec));
+          }
+        }
+        return true;
+      }
+#endif // __linux__
+
     protected:
       /// @brief a manager for the boost::io_service object
       AsioService ioService_;
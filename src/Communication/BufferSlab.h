@@ -0,0 +1,99 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef BUFFERSLAB_H
+#define BUFFERSLAB_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "BufferSlab_fwd.h"
+#include <Communication/LinkedBuffer.h>
+#include <Communication/Receiver.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief One allocation carved into many LinkedBuffers.
+    ///
+    /// When many receivers run in the same process (i.e. one per multicast channel)
+    /// allocating all of their buffers from a single slab keeps the buffers together
+    /// in memory and replaces hundreds of small allocations with one.
+    ///
+    /// Each buffer starts on a cache line boundary.
+    /// The slab must outlive the receivers to which its buffers are assigned.
+    class BufferSlab
+    {
+    public:
+      /// @brief The alignment for each buffer.
+      static const size_t cacheLineSize = 64;
+
+      /// @brief Allocate the slab
+      /// @param bufferSize is the capacity of each buffer (rounded up to a multiple of cacheLineSize)
+      /// @param bufferCount is the total number of buffers
+      BufferSlab(size_t bufferSize, size_t bufferCount)
+        : bufferSize_(bufferSize)
+        , stride_((bufferSize + cacheLineSize - 1) / cacheLineSize * cacheLineSize)
+        , bufferCount_(bufferCount)
+        , assigned_(0)
+        , memory_(new unsigned char[stride_ * bufferCount + cacheLineSize])
+        , buffers_(new LinkedBuffer[bufferCount])
+      {
+        unsigned char * storage = memory_.get();
+        size_t misalignment = reinterpret_cast<size_t>(storage) % cacheLineSize;
+        if(misalignment != 0)
+        {
+          storage += cacheLineSize - misalignment;
+        }
+        for(size_t nBuffer = 0; nBuffer < bufferCount_; ++nBuffer)
+        {
+          buffers_[nBuffer].setExternalStorage(storage + nBuffer * stride_, bufferSize_);
+        }
+      }
+
+      /// @brief Give buffers from the slab to a receiver.
+      /// @param receiver is to receive the buffers
+      /// @param count is how many buffers to give it.
+      void assign(Receiver & receiver, size_t count)
+      {
+        if(count > available())
+        {
+          throw std::invalid_argument("BufferSlab: Not enough buffers in slab.");
+        }
+        receiver.addBuffers(&buffers_[assigned_], count);
+        assigned_ += count;
+      }
+
+      /// @brief How many buffers have not yet been assigned
+      size_t available() const
+      {
+        return bufferCount_ - assigned_;
+      }
+
+      /// @brief The capacity of each buffer
+      size_t bufferSize() const
+      {
+        return bufferSize_;
+      }
+
+      /// @brief The total number of buffers in the slab
+      size_t bufferCount() const
+      {
+        return bufferCount_;
+      }
+
+    private:
+      BufferSlab(const BufferSlab &);
+      BufferSlab & operator=(const BufferSlab &);
+
+    private:
+      size_t bufferSize_;
+      size_t stride_;
+      size_t bufferCount_;
+      size_t assigned_;
+      boost::scoped_array<unsigned char> memory_;
+      boost::scoped_array<LinkedBuffer> buffers_;
+    };
+  }
+}
+#endif // BUFFERSLAB_H
@@ -0,0 +1,14 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef BUFFERSLAB_FWD_H
+#define BUFFERSLAB_FWD_H
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    class BufferSlab;
+  }
+}
+#endif // BUFFERSLAB_FWD_H
@@ -7,6 +7,7 @@
 // All inline, do not export.
 //#include <Common/QuickFAST_Export.h>
 #include "LinkedBuffer_fwd.h"
+#include <Common/Types.h>
 
 namespace QuickFAST
 {
@@ -23,6 +24,8 @@ namespace QuickFAST
         , buffer_(new unsigned char [capacity])
         , capacity_(capacity)
         , used_(0)
+        , external_(false)
+        , receiveTime_(0)
       {
       }
 
@@ -35,12 +38,14 @@ namespace QuickFAST
         , buffer_(0)
         , capacity_(0)
         , used_(0)
+        , external_(false)
+        , receiveTime_(0)
       {
       }
 
       ~LinkedBuffer()
       {
-        if(capacity_ != 0)
+        if(capacity_ != 0 && !external_)
         {
           delete[] buffer_;
         }
@@ -91,13 +96,31 @@ namespace QuickFAST
       ///
       void setExternal(const unsigned char * externalBuffer, size_t used)
       {
-        if(capacity_ != 0)
+        if(capacity_ != 0 && !external_)
         {
           delete[] buffer_;
-          capacity_ = 0;
         }
+        capacity_ = 0;
         buffer_ = const_cast<unsigned char *>(externalBuffer);
         used_ = used;
+        external_ = true;
+      }
+
+      /// @brief Use storage owned by someone else (i.e. a BufferSlab) to receive data.
+      ///
+      /// Unlike setExternal, the buffer is empty and can be filled.
+      /// @param externalStorage is the memory to be used.  It must outlive this buffer.
+      /// @param capacity is the size of externalStorage
+      void setExternalStorage(unsigned char * externalStorage, size_t capacity)
+      {
+        if(capacity_ != 0 && !external_)
+        {
+          delete[] buffer_;
+        }
+        buffer_ = externalStorage;
+        capacity_ = capacity;
+        used_ = 0;
+        external_ = true;
       }
 
       /// @brief Set the number of bytes used in this buffer
@@ -114,6 +137,23 @@ namespace QuickFAST
         return used_;
       }
 
+      /// @brief Record when the data in this buffer was received.
+      /// @param receiveTime is nanoseconds since the epoch (see Common::wallClockNanoseconds())
+      void setReceiveTime(uint64 receiveTime)
+      {
+        receiveTime_ = receiveTime;
+      }
+
+      /// @brief When was the data in this buffer received?
+      ///
+      /// Depending on the receiver this is the time the kernel received the packet,
+      /// the time recorded in a PCap file, or the time the receive completed.
+      /// @returns nanoseconds since the epoch; zero if unknown.
+      uint64 receiveTime() const
+      {
+        return receiveTime_;
+      }
+
       /// @brief Linked List support: Set the link
       /// @param link pointer to buffer to be linked <b>after</b> this one.
       void link(LinkedBuffer * link)
@@ -134,6 +174,7 @@ namespace QuickFAST
       size_t capacity_;
       size_t used_;
       bool external_;
+      uint64 receiveTime_;
     };
 
     /// @brief No frills ordered collection of buffers: FIFO
@@ -147,6 +188,7 @@ namespace QuickFAST
       BufferQueue()
         : head_()
         , tail_(&head_)
+        , size_(0)
       {
       }
 
@@ -156,6 +198,12 @@ namespace QuickFAST
         return head_.link() == 0;
       }
 
+      ///@brief How many buffers are in the queue
+      size_t size() const
+      {
+        return size_;
+      }
+
       /// @brief Push a single buffer onto the queue
       /// @returns true if this queue was empty before the push; and not empty afterward
       bool push(LinkedBuffer * buffer)
@@ -165,6 +213,7 @@ namespace QuickFAST
         buffer->link(0);
         tail_->link(buffer);
         tail_ = buffer;
+        ++size_;
         return first;
       }
 
@@ -176,9 +225,11 @@ namespace QuickFAST
         bool first = isEmpty();
         assert(buffer != 0);
         tail_->link(buffer);
+        ++size_;
         while(buffer->link() != 0)
         {
           buffer = buffer->link();
+          ++size_;
         }
         tail_ = buffer;
         return first;
@@ -197,9 +248,11 @@ namespace QuickFAST
         {
           tail_->link(head);
           tail_ = queue.tail_;
+          size_ += queue.size_;
         }
         queue.head_.link(0);
         queue.tail_ = & queue.head_;
+        queue.size_ = 0;
         return first && !isEmpty();
       }
 
@@ -212,6 +265,7 @@ namespace QuickFAST
         {
           head_.link(result->link());
           result->link(0);
+          --size_;
           if(head_.link() == 0)
           {
             tail_ = &head_;
@@ -226,6 +280,7 @@ namespace QuickFAST
         LinkedBuffer * result = head_.link();
         head_.link(0);
         tail_ = &head_;
+        size_ = 0;
         return result;
       }
 
@@ -244,6 +299,7 @@ namespace QuickFAST
     private:
       LinkedBuffer head_;
       LinkedBuffer * tail_;
+      size_t size_;
     };
 
     ///@brief Keep a queue of buffers waiting to be serviced by one server thread.
@@ -67,7 +67,17 @@ namespace QuickFAST
       {
         socket_.open(endpoint_.protocol());
         socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+#if defined(_WIN32)
         socket_.bind(endpoint_);
+#else // _WIN32
+        // Binding to the group rather than the interface keeps packets sent to
+        // other groups on the same port (i.e. the other half of an A/B feed pair)
+        // from being delivered to this socket.
+        socket_.bind(boost::asio::ip::udp::endpoint(multicastGroup_, endpoint_.port()));
+#endif // _WIN32
+#if defined(__linux__)
+        enableReceiveTimestamps(nativeSocket(socket_));
+#endif // __linux__
 
         if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
         {
@@ -149,6 +159,38 @@ namespace QuickFAST
 
     private:
 
+#if defined(__linux__)
+      // Wait until a datagram is ready then read it ourselves to capture the kernel timestamp.
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+      {
+        socket_.async_receive(
+          boost::asio::null_buffers(),
+          boost::bind(&MulticastReceiver::handleReadable,
+          this,
+          boost::asio::placeholders::error,
+          buffer)
+          );
+        return true;
+      }
+
+      void handleReadable(const boost::system::error_code& error, LinkedBuffer * buffer)
+      {
+        boost::system::error_code result(error);
+        size_t bytesReceived = 0;
+        if(!result && !receiveTimestamped(nativeSocket(socket_), buffer, bytesReceived, result))
+        {
+          // spurious wakeup: wait again.
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          if(!stopping_)
+          {
+            fillBuffer(buffer, lock);
+            return;
+          }
+          result = boost::asio::error::operation_aborted;
+        }
+        handleReceive(result, buffer, bytesReceived);
+      }
+#else // __linux__
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
         socket_.async_receive_from(
@@ -162,6 +204,7 @@ namespace QuickFAST
           );
         return true;
       }
+#endif // __linux__
 
     private:
       boost::asio::ip::address listenInterface_;
@@ -8,12 +8,31 @@
 //#include <Common/QuickFAST_Export.h>
 #include "MulticastSender_fwd.h"
 #include <Communication/AsynchReceiver.h>
+#if defined(__linux__)
+# include <netinet/in.h>
+# include <sys/uio.h>
+# include <string.h>
+// UDP generic segmentation offload (Linux 4.18)
+# ifndef UDP_SEGMENT
+#  define UDP_SEGMENT 103
+# endif
+#endif
 
 namespace QuickFAST
 {
   namespace Communication
   {
-    /// @brief Receive Multicast Packets and pass them to a packet handler
+    /// @brief Send Multicast Packets
+    ///
+    /// Datagrams may be sent one at a time with send() or asyncSend(), or in batches:
+    /// queue() copies a datagram into the batch; flush() sends everything queued.
+    /// On Linux a batch is sent with a single sendmmsg() system call, and if segmentation
+    /// is enabled, runs of equal-sized datagrams to the same destination are handed to
+    /// the kernel as one UDP GSO buffer.  Elsewhere flush() sends the datagrams one at a time.
+    ///
+    /// Batching does not change when a datagram is sent relative to the caller's
+    /// pacing: to preserve inter-packet gaps, call flush() before waiting for the
+    /// next packet's send time.  The batch is flushed automatically when it is full.
     class MulticastSender
     {
     public:
@@ -27,6 +46,9 @@ namespace QuickFAST
         : sendAddress_(sendAddress)
         , portNumber_(portNumber)
         , socket_(ioService_)
+        , batchSize_(1)
+        , segmentation_(false)
+        , sendCalls_(0)
       {
       }
 
@@ -39,6 +61,9 @@ namespace QuickFAST
         , sendAddress_(sendAddress)
         , portNumber_(portNumber)
         , socket_(ioService_)
+        , batchSize_(1)
+        , segmentation_(false)
+        , sendCalls_(0)
       {
       }
 
@@ -128,6 +153,258 @@ namespace QuickFAST
         socket_.async_send_to(buffers, flags, handler, endpoint_);
       }
 
+      /// @brief Set the number of datagrams queued before the batch is sent automatically.
+      /// @param batchSize is the maximum batch size (zero is treated as one).
+      void setBatchSize(size_t batchSize)
+      {
+        batchSize_ = std::max(batchSize, size_t(1));
+        batch_.reserve(batchSize_);
+      }
+
+      /// @brief Use UDP generic segmentation offload for batches (Linux only)
+      ///
+      /// If the kernel or the network device does not support it, the sender quietly
+      /// falls back to one datagram per message.
+      /// @param enable true to use segmentation
+      void setSegmentation(bool enable = true)
+      {
+        segmentation_ = enable;
+      }
+
+      /// @brief Is segmentation enabled (and still working)?
+      bool segmentation() const
+      {
+        return segmentation_;
+      }
+
+      /// @brief Add a datagram for the multicast group to the batch.
+      ///
+      /// The data is copied, so the caller may reuse its buffer immediately.
+      /// @param data points to the datagram
+      /// @param size is the number of bytes in the datagram
+      /// @returns the number of datagrams sent (nonzero if the batch filled up)
+      std::size_t queue(const void * data, size_t size)
+      {
+        return queue(data, size, endpoint_);
+      }
+
+      /// @brief Add a datagram for a specific destination to the batch.
+      /// @param data points to the datagram
+      /// @param size is the number of bytes in the datagram
+      /// @param destination is where to send it.
+      /// @returns the number of datagrams sent (nonzero if the batch filled up)
+      std::size_t queue(const void * data, size_t size, const boost::asio::ip::udp::endpoint & destination)
+      {
+        QueuedDatagram datagram;
+        datagram.offset_ = batchData_.size();
+        datagram.size_ = size;
+        datagram.destination_ = destination;
+        batchData_.insert(
+          batchData_.end(),
+          static_cast<const unsigned char *>(data),
+          static_cast<const unsigned char *>(data) + size);
+        batch_.push_back(datagram);
+        if(batch_.size() >= batchSize_)
+        {
+          return flush();
+        }
+        return 0;
+      }
+
+      /// @brief How many datagrams are waiting to be sent
+      size_t queued() const
+      {
+        return batch_.size();
+      }
+
+      /// @brief Send all queued datagrams.
+      ///
+      /// If the send fails the datagrams that were sent are removed from the batch;
+      /// the rest remain queued.
+      /// @returns the number of datagrams sent.
+      /// @throws boost::system::system_error if the send fails.
+      std::size_t flush()
+      {
+        size_t count = batch_.size();
+        if(count == 0)
+        {
+          return 0;
+        }
+        size_t sent = 0;
+        try
+        {
+#if defined(__linux__)
+          while(sent < count)
+          {
+            sendBatch(sent);
+          }
+#else // __linux__
+          while(sent < count)
+          {
+            const QueuedDatagram & datagram = batch_[sent];
+            socket_.send_to(
+              boost::asio::buffer(&batchData_[datagram.offset_], datagram.size_),
+              datagram.destination_);
+            ++sendCalls_;
+            ++sent;
+          }
+#endif // __linux__
+        }
+        catch(...)
+        {
+          // don't send them twice if the caller flushes again.
+          discard(sent);
+          throw;
+        }
+        batch_.clear();
+        batchData_.clear();
+        return count;
+      }
+
+      /// @brief How many system calls have been used to send batches (for statistics)
+      size_t sendCalls() const
+      {
+        return sendCalls_;
+      }
+
+    private:
+      struct QueuedDatagram
+      {
+        size_t offset_;
+        size_t size_;
+        boost::asio::ip::udp::endpoint destination_;
+      };
+
+      // Remove the first count datagrams from the batch.
+      void discard(size_t count)
+      {
+        if(count >= batch_.size())
+        {
+          batch_.clear();
+          batchData_.clear();
+          return;
+        }
+        size_t bytes = batch_[count].offset_;
+        batch_.erase(batch_.begin(), batch_.begin() + count);
+        batchData_.erase(batchData_.begin(), batchData_.begin() + bytes);
+        for(size_t nDatagram = 0; nDatagram < batch_.size(); ++nDatagram)
+        {
+          batch_[nDatagram].offset_ -= bytes;
+        }
+      }
+
+#if defined(__linux__)
+      // Send batch_[first..] with as few sendmmsg calls as possible.
+      // first is advanced past the datagrams that are sent.  It is only left less
+      // than batch_.size() if segmentation failed and must be retried without it,
+      // or if sendmmsg fails.
+      void sendBatch(size_t & first)
+      {
+        // the kernel limits a GSO buffer to 64 segments and one IP datagram.
+        static const size_t maxSegments = 64;
+        static const size_t maxSegmentBytes = 65507;
+        size_t count = batch_.size();
+        headers_.resize(count - first);
+        iovecs_.resize(count - first);
+        control_.resize((count - first) * CMSG_SPACE(sizeof(uint16)));
+        segments_.resize(count - first);
+        memset(&headers_[0], 0, headers_.size() * sizeof(headers_[0]));
+        memset(&control_[0], 0, control_.size());
+        size_t messageCount = 0;
+        size_t nDatagram = first;
+        while(nDatagram < count)
+        {
+          const QueuedDatagram & datagram = batch_[nDatagram];
+          size_t segments = 1;
+          size_t bytes = datagram.size_;
+          if(segmentation_)
+          {
+            // Extend the run while the datagrams are the same size and have the same destination.
+            // The last datagram in a run may be shorter.
+            while(nDatagram + segments < count && segments < maxSegments)
+            {
+              const QueuedDatagram & next = batch_[nDatagram + segments];
+              if(next.size_ > datagram.size_
+                || next.size_ == 0
+                || !(next.destination_ == datagram.destination_)
+                || bytes + next.size_ > maxSegmentBytes)
+              {
+                break;
+              }
+              bytes += next.size_;
+              ++segments;
+              if(next.size_ < datagram.size_)
+              {
+                break;
+              }
+            }
+          }
+          iovec & iov = iovecs_[messageCount];
+          iov.iov_base = &batchData_[datagram.offset_];
+          iov.iov_len = bytes;
+          msghdr & header = headers_[messageCount].msg_hdr;
+          header.msg_name = const_cast<sockaddr *>(datagram.destination_.data());
+          header.msg_namelen = socklen_t(datagram.destination_.size());
+          header.msg_iov = &iov;
+          header.msg_iovlen = 1;
+          if(segments > 1)
+          {
+            // the datagrams are contiguous in batchData_, so one iovec covers them all.
+            header.msg_control = &control_[messageCount * CMSG_SPACE(sizeof(uint16))];
+            header.msg_controllen = CMSG_SPACE(sizeof(uint16));
+            cmsghdr * cmsg = CMSG_FIRSTHDR(&header);
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+            uint16 segmentSize = uint16(datagram.size_);
+            memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+          }
+          segments_[messageCount] = segments;
+          ++messageCount;
+          nDatagram += segments;
+        }
+
+        int socket = nativeSocket();
+        size_t sent = 0;
+        while(sent < messageCount)
+        {
+          int result = sendmmsg(socket, &headers_[sent], unsigned(messageCount - sent), 0);
+          ++sendCalls_;
+          if(result < 0)
+          {
+            int error = errno;
+            if(error == EINTR)
+            {
+              continue;
+            }
+            if(segmentation_ && segments_[sent] > 1)
+            {
+              // GSO is not supported here.  Resend the rest one datagram per message.
+              segmentation_ = false;
+              return;
+            }
+            throw boost::system::system_error(
+              boost::system::error_code(error, boost::system::system_category()),
+              "MulticastSender sendmmsg");
+          }
+          for(size_t nMessage = sent; nMessage < sent + size_t(result); ++nMessage)
+          {
+            first += segments_[nMessage];
+          }
+          sent += size_t(result);
+        }
+      }
+
+      int nativeSocket()
+      {
+#if BOOST_VERSION >= 104700
+        return socket_.native_handle();
+#else
+        return socket_.native();
+#endif
+      }
+#endif // __linux__
+
     private:
       AsioService ioService_;
       const std::string & sendAddress_;
@@ -135,6 +412,18 @@ namespace QuickFAST
       boost::asio::ip::address multicastAddress_;
       boost::asio::ip::udp::endpoint endpoint_;
       boost::asio::ip::udp::socket socket_;
+
+      size_t batchSize_;
+      bool segmentation_;
+      size_t sendCalls_;
+      std::vector<QueuedDatagram> batch_;
+      std::vector<unsigned char> batchData_;
+#if defined(__linux__)
+      std::vector<mmsghdr> headers_;
+      std::vector<iovec> iovecs_;
+      std::vector<unsigned char> control_;
+      std::vector<size_t> segments_;
+#endif // __linux__
     };
   }
 }
@@ -37,6 +37,22 @@ namespace QuickFAST
       {
       }
 
+      /// @brief Only deliver packets sent to the given destination.
+      ///
+      /// Call before starting the receiver.  See PCapReader::addFlow
+      /// @param address is the destination in dotted decimal form, i.e. "239.1.2.3"
+      /// @param port is the destination UDP port.
+      void addFlow(const std::string & address, unsigned short port)
+      {
+        reader_.addFlow(address, port);
+      }
+
+      /// @brief How many packets were skipped because they did not match a flow.
+      size_t filteredPackets()const
+      {
+        return reader_.filteredPackets();
+      }
+
     private:
 
       // Implement Receiver method
@@ -62,12 +78,11 @@ namespace QuickFAST
         bool result = reader_.read(pcapBuffer, pcapSize);
         if(result)
         {
-          if(pcapSize <= buffer->capacity())
-          {
-            memcpy(buffer->get(), pcapBuffer, pcapSize);
-            acceptFullBuffer(buffer, pcapSize, lock);
-            result = true;
-          }
+          // point into the memory mapped file rather than copying.
+          buffer->setExternal(pcapBuffer, pcapSize);
+          // replay the capture time so latency measurements are realistic.
+          buffer->setReceiveTime(reader_.timestamp());
+          acceptFullBuffer(buffer, pcapSize, lock);
         }
         return result;
       }
@@ -204,77 +204,203 @@ namespace
 
   static const uint32 nativeMagic = 0xa1b2c3d4;
   static const uint32 swappedMagic = 0xd4c3b2a1;
+  // same as above, but timestamps are in nanoseconds rather than microseconds
+  static const uint32 nativeNanoMagic = 0xa1b23c4d;
+  static const uint32 swappedNanoMagic = 0x4d3cb2a1;
+
+  /*
+   * pcapng (see http://www.winpcap.org/ntar/draft/PCAP-DumpFileFormat.html)
+   * Every block starts with a type and a total length and ends with the total length.
+   */
+  struct pcapng_block_header {
+    uint32 type;
+    uint32 totalLength;
+  };
+  enum pcapngBlockType
+  {
+    PCAPNG_INTERFACE_DESCRIPTION = 0x00000001,
+    PCAPNG_PACKET = 0x00000002, /* obsolete */
+    PCAPNG_SIMPLE_PACKET = 0x00000003,
+    PCAPNG_ENHANCED_PACKET = 0x00000006,
+    PCAPNG_SECTION_HEADER = 0x0A0D0D0A
+  };
+  static const uint32 pcapngByteOrderMagic = 0x1A2B3C4D;
+  static const uint16 pcapngOptionEnd = 0;
+  static const uint16 pcapngOptionTimestampResolution = 9;
+
+  struct pcapng_section_header {
+    pcapng_block_header header;
+    uint32 byteOrderMagic;
+    uint16 majorVersion;
+    uint16 minorVersion;
+    uint32 sectionLengthLow;
+    uint32 sectionLengthHigh;
+  };
+
+  struct pcapng_interface_description {
+    pcapng_block_header header;
+    uint16 linkType;
+    uint16 reserved;
+    uint32 snapLength;
+  };
+
+  struct pcapng_enhanced_packet {
+    pcapng_block_header header;
+    uint32 interfaceId;
+    uint32 timestampHigh;
+    uint32 timestampLow;
+    uint32 caplen;
+    uint32 len;
+  };
+
+  struct pcapng_packet {
+    pcapng_block_header header;
+    uint16 interfaceId;
+    uint16 drops;
+    uint32 timestampHigh;
+    uint32 timestampLow;
+    uint32 caplen;
+    uint32 len;
+  };
+
+  struct pcapng_simple_packet {
+    pcapng_block_header header;
+    uint32 len;
+  };
+
+  static const uchar UDPProtocol = 17;
 
   // Packet checksum
   typedef uint32 checksum_t;
 #pragma pack(pop)
 
+  // ByteSwapper doesn't do 64 bit values (or longs)
+  template<typename VALUE>
+  uint64 swapTime(const ByteSwapper & swap, VALUE value)
+  {
+    if(sizeof(VALUE) <= sizeof(uint32))
+    {
+      return swap(uint32(value));
+    }
+    uint64 value64 = uint64(value);
+    if(swap(uint32(1)) == 1)
+    {
+      // not swapping
+      return value64;
+    }
+    return (uint64(swap(uint32(value64))) << 32) | swap(uint32(value64 >> 32));
+  }
+
+  uint64 nanoseconds(uint64 seconds, uint64 fraction, uint64 unitsPerSecond)
+  {
+    return seconds * 1000000000ULL + fraction * (1000000000ULL / unitsPerSecond);
+  }
+
+  // pcapng timestamps count units since the epoch.
+  uint64 nanoseconds(uint64 units, uint64 unitsPerSecond)
+  {
+    return nanoseconds(units / unitsPerSecond, 0, 1)
+      + (units % unitsPerSecond) * 1000000000ULL / unitsPerSecond;
+  }
+
+  size_t pad4(size_t length)
+  {
+    return (length + 3) & ~size_t(3);
+  }
 }
 
 PCapReader::PCapReader()
-: fileSize_(0)
+: data_(0)
+, fileSize_(0)
 , pos_(0)
 , ok_(false)
 , usetv32_(false)
 , usetv64_(false)
-, linktype_(DLT_NULL)
+, pcapng_(false)
 , swap(false)
 , verbose_(false)
+, timestamp_(0)
+, destinationAddress_(0)
+, destinationPort_(0)
+, filteredPackets_(0)
 {
 }
 
+PCapReader::~PCapReader()
+{
+  close();
+}
+
 bool
 PCapReader::open(const char * filename)
 {
-  ok_ = true;
-  FILE * file = fopen(filename, "rb");
-  ok_ = file != 0;
-  if(ok_)
-  {
-    fseek(file, 0, SEEK_END);
-    fileSize_ = ftell(file);
-    buffer_.reset(new unsigned char[fileSize_]);
-    fseek(file, 0, SEEK_SET);
-    size_t byteCount = fread(buffer_.get(), 1, fileSize_, file);
-    ok_ = byteCount == fileSize_;
-    fclose(file);
-  }
+  close();
+  ok_ = file_.open(filename);
   if(ok_)
   {
+    data_ = file_.data();
+    fileSize_ = file_.size();
     ok_ = rewind();
   }
   return ok_;
 }
 
+void
+PCapReader::close()
+{
+  file_.close();
+  data_ = 0;
+  fileSize_ = 0;
+  pos_ = 0;
+  ok_ = false;
+}
+
 bool
 PCapReader::rewind()
 {
-  ok_ = true;
+  ok_ = data_ != 0;
   pos_ = 0;
+  pcapng_ = false;
+  interfaces_.clear();
 
   //////////////////////////
   // Process the file header
-  if(fileSize_ - pos_ < sizeof(pcap_file_header))
+  if(fileSize_ - pos_ < sizeof(uint32))
+  {
+    std::cerr << "Invalid pcap file: no header." << std::endl;
+    ok_ = false;
+  }
+  if(ok_ && *reinterpret_cast<const uint32 *>(data_) == PCAPNG_SECTION_HEADER)
+  {
+    // pcapng: the section header (and everything else) is handled by nextRecord()
+    pcapng_ = true;
+    return ok_;
+  }
+  if(ok_ && fileSize_ - pos_ < sizeof(pcap_file_header))
   {
     std::cerr << "Invalid pcap file: no header." << std::endl;
     ok_ = false;
   }
   if(ok_)
   {
-    pcap_file_header * fileHeader = reinterpret_cast<pcap_file_header *>(buffer_.get() + pos_);
+    const pcap_file_header * fileHeader = reinterpret_cast<const pcap_file_header *>(data_ + pos_);
     pos_ += sizeof(pcap_file_header);
 
-    if(fileHeader->magic != nativeMagic && fileHeader->magic != swappedMagic)
+    uint32 magic = fileHeader->magic;
+    if(magic != nativeMagic && magic != swappedMagic
+      && magic != nativeNanoMagic && magic != swappedNanoMagic)
     {
       std::cerr << "Invalid pcap file: missing magic." << std::endl;
       ok_ = false;
     }
     if(ok_)
     {
-      swap.setSwap(fileHeader->magic == swappedMagic);
-      assert(swap(fileHeader->magic) == nativeMagic);
+      swap.setSwap(magic == swappedMagic || magic == swappedNanoMagic);
+      Interface classic;
+      classic.linkType_ = swap(fileHeader->linktype);
+      classic.unitsPerSecond_ = (swap(magic) == nativeNanoMagic) ? 1000000000ULL : 1000000ULL;
+      interfaces_.push_back(classic);
     }
-    linktype_ = swap(fileHeader->linktype);
   }
   return ok_;
 }
@@ -285,128 +411,279 @@ PCapReader::good()const
   return ok_;
 }
 
-bool
-PCapReader::read(const unsigned char *& buffer, size_t & size)
+void
+PCapReader::addFlow(uint32 address, uint16 port)
 {
-  if(ok_)
+  flows_.insert(flowKey(address, port));
+}
+
+void
+PCapReader::addFlow(const std::string & address, uint16 port)
+{
+  uint32 value = 0;
+  std::istringstream in(address);
+  for(size_t nByte = 0; nByte < 4; ++nByte)
   {
-    ok_ = false;
-    size_t skipped = 0;
-    size_t minBytes = sizeof(pcap_pkthdr) + sizeof(ip_header) + sizeof(udp_header);
-    if(usetv32_)
+    unsigned int byte = 256;
+    char dot = '.';
+    if(nByte != 0)
     {
-      minBytes = sizeof(pcap_pkthdr32) + sizeof(ip_header) + sizeof(udp_header);
+      in >> dot;
     }
-    if(usetv64_)
+    if(!(in >> byte) || byte > 255 || dot != '.')
     {
-      minBytes = sizeof(pcap_pkthdr64) + sizeof(ip_header) + sizeof(udp_header);
+      throw std::invalid_argument("PCapReader: invalid IP address: " + address);
     }
+    value = (value << 8) | byte;
+  }
+  addFlow(value, port);
+}
+
+void
+PCapReader::clearFlows()
+{
+  flows_.clear();
+}
 
-    while(!ok_ && (pos_ + minBytes < fileSize_))
+bool
+PCapReader::nextRecord(size_t & packetPos, size_t & packetLength, uint32 & linkType, bool & truncated)
+{
+  if(pcapng_)
+  {
+    return nextBlock(packetPos, packetLength, linkType, truncated);
+  }
+  size_t headerSize = sizeof(pcap_pkthdr);
+  if(usetv32_)
+  {
+    headerSize = sizeof(pcap_pkthdr32);
+  }
+  else if(usetv64_)
+  {
+    headerSize = sizeof(pcap_pkthdr64);
+  }
+  if(pos_ + headerSize > fileSize_)
+  {
+    return false;
+  }
+  const Interface & interface = interfaces_[0];
+  uint32 caplen = 0;
+  uint32 len = 0;
+  if(usetv32_)
+  {
+    const pcap_pkthdr32 * packetHeader = reinterpret_cast<const pcap_pkthdr32 *>(data_ + pos_);
+    caplen = swap(packetHeader->caplen);
+    len = swap(packetHeader->len);
+    timestamp_ = nanoseconds(
+      swapTime(swap, packetHeader->tv_sec), swapTime(swap, packetHeader->tv_usec), interface.unitsPerSecond_);
+  }
+  else if(usetv64_)
+  {
+    const pcap_pkthdr64 * packetHeader = reinterpret_cast<const pcap_pkthdr64 *>(data_ + pos_);
+    caplen = swap(packetHeader->caplen);
+    len = swap(packetHeader->len);
+    timestamp_ = nanoseconds(
+      swapTime(swap, packetHeader->tv_sec), swapTime(swap, packetHeader->tv_usec), interface.unitsPerSecond_);
+  }
+  else
+  {
+    const pcap_pkthdr * packetHeader = reinterpret_cast<const pcap_pkthdr *>(data_ + pos_);
+    caplen = swap(packetHeader->caplen);
+    len = swap(packetHeader->len);
+    timestamp_ = nanoseconds(
+      swapTime(swap, packetHeader->ts.tv_sec), swapTime(swap, packetHeader->ts.tv_usec), interface.unitsPerSecond_);
+  }
+  if(pos_ + headerSize + caplen > fileSize_)
+  {
+    // the capture was cut off in the middle of a packet.
+    pos_ = fileSize_;
+    return false;
+  }
+  packetPos = pos_ + headerSize;
+  packetLength = caplen;
+  linkType = interface.linkType_;
+  truncated = caplen != len;
+  pos_ = packetPos + caplen;
+  return true;
+}
+
+bool
+PCapReader::nextBlock(size_t & packetPos, size_t & packetLength, uint32 & linkType, bool & truncated)
+{
+  while(pos_ + sizeof(pcapng_block_header) <= fileSize_)
+  {
+    const pcapng_block_header * block = reinterpret_cast<const pcapng_block_header *>(data_ + pos_);
+    size_t blockPos = pos_;
+    uint32 type = block->type;
+    if(type == PCAPNG_SECTION_HEADER)
     {
-      ////////////////////////////
-      // process the packet header
-      size_t headerPos = pos_;
-      size_t datalen = 0;
-      bool truncate = false;
-      unsigned int dataLinkType = 0;
-
-      if(usetv32_)
+      // a new section may have a different byte order. Interface numbers start over.
+      if(blockPos + sizeof(pcapng_section_header) > fileSize_)
       {
-        pcap_pkthdr32 * packetHeader = reinterpret_cast<pcap_pkthdr32 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr32);
-        datalen = swap(packetHeader->caplen);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        break;
       }
-      else if(usetv64_)
+      const pcapng_section_header * section = reinterpret_cast<const pcapng_section_header *>(block);
+      if(section->byteOrderMagic != pcapngByteOrderMagic)
       {
-        pcap_pkthdr64 * packetHeader = reinterpret_cast<pcap_pkthdr64 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr64);
-        datalen = swap(packetHeader->caplen);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        swap.setSwap(true);
+        if(swap(section->byteOrderMagic) != pcapngByteOrderMagic)
+        {
+          std::cerr << "Invalid pcapng file: bad byte order magic." << std::endl;
+          break;
+        }
       }
       else
       {
-        pcap_pkthdr * packetHeader = reinterpret_cast<pcap_pkthdr *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr);
-        datalen = swap(packetHeader->caplen);
-        truncate = (packetHeader->caplen != packetHeader->len);
-      }
-      if(truncate)
-      {
-        pos_ += datalen;
-        skipped+= 1;
+        swap.setSwap(false);
       }
-      else
+      interfaces_.clear();
+    }
+    else
+    {
+      type = swap(type);
+    }
+    size_t totalLength = swap(block->totalLength);
+    if(totalLength < sizeof(pcapng_block_header) + sizeof(uint32) || blockPos + totalLength > fileSize_)
+    {
+      std::cerr << "Invalid pcapng file: bad block length at " << blockPos << std::endl;
+      break;
+    }
+    pos_ = blockPos + totalLength;
+    // the body ends before the trailing copy of totalLength.
+    size_t bodyEnd = blockPos + totalLength - sizeof(uint32);
+
+    switch(type)
+    {
+    case PCAPNG_INTERFACE_DESCRIPTION:
       {
-        bool found = false;
-        switch(linktype_)
+        if(blockPos + sizeof(pcapng_interface_description) > bodyEnd)
         {
-        case DLT_EN10MB:
-          {
-            pos_ += sizeof(ethernetIIHeader);
-            datalen -= sizeof(ethernetIIHeader);
-            found = true;
-            break;
-          }
-        case DLT_LINUX_SLL:
+          break;
+        }
+        const pcapng_interface_description * description =
+          reinterpret_cast<const pcapng_interface_description *>(block);
+        Interface interface;
+        interface.linkType_ = swap(description->linkType);
+        interface.unitsPerSecond_ = 1000000ULL;
+        size_t optionPos = blockPos + sizeof(pcapng_interface_description);
+        while(optionPos + 2 * sizeof(uint16) <= bodyEnd)
+        {
+          const uint16 * option = reinterpret_cast<const uint16 *>(data_ + optionPos);
+          uint16 code = swap(option[0]);
+          size_t length = swap(option[1]);
+          optionPos += 2 * sizeof(uint16);
+          if(code == pcapngOptionEnd || optionPos + length > bodyEnd)
           {
-            pos_ += sizeof(linuxCookedCaptureHeader);
-            datalen -= sizeof(linuxCookedCaptureHeader);
-            found = true;
             break;
           }
-        default:
+          if(code == pcapngOptionTimestampResolution && length >= 1)
           {
-            // HACK!look for the IP protocol flag to mark the end of the the link layer header
-            static unsigned short IPProtocol = 0x0008;
-            while(!found && datalen - sizeof(checksum_t) > 2)
+            uchar resolution = data_[optionPos];
+            uint64 units = 1;
+            for(uchar power = 0; power < (resolution & 0x7F); ++power)
             {
-              unsigned short protocol = *(unsigned short *)(buffer_.get() + pos_);
-              if(swap(protocol) == IPProtocol)
-              {
-                found = true;
-                pos_ += 2;
-                datalen -= 2;
-              }
-              else
-              {
-                pos_ += 1;
-                datalen -= 1;
-              }
+              // high bit set means a power of two, otherwise a power of ten.
+              units *= (resolution & 0x80) ? 2 : 10;
             }
-            break;
+            interface.unitsPerSecond_ = units;
           }
+          optionPos += pad4(length);
         }
-        if(found)
+        interfaces_.push_back(interface);
+        break;
+      }
+    case PCAPNG_ENHANCED_PACKET:
+    case PCAPNG_PACKET:
+      {
+        size_t interfaceId = 0;
+        uint32 timestampHigh = 0;
+        uint32 timestampLow = 0;
+        uint32 caplen = 0;
+        uint32 len = 0;
+        if(type == PCAPNG_ENHANCED_PACKET)
         {
-          ip_header * ipHeader = reinterpret_cast<ip_header *>(buffer_.get() + pos_);
-          // IP header contains its own length expressed in 4 byte units.
-          size_t ipLen = (ipHeader->ver_ihl & 0xF) * 4;
-          pos_ += ipLen;
-          datalen -= ipLen;
-          pos_ += sizeof(udp_header);
-          datalen -= sizeof(udp_header);
-          // a 4 byte checksum appears at the end of the packet.  It is not part of the payload.
-          if(datalen > sizeof(checksum_t))
+          packetPos = blockPos + sizeof(pcapng_enhanced_packet);
+          if(packetPos > bodyEnd)
           {
-            buffer = buffer_.get() + pos_;
-            size = datalen - sizeof(checksum_t);
-            if(verbose_)
-            {
-              std::cout << "PCapReader: " << headerPos << ": " << pos_ << ' ' << datalen
-                << "=== 0x" << std::hex  << headerPos << ": 0x" << pos_ << " 0x" << datalen << std::dec << std::endl;
-            }
-            ok_ = true;
+            break;
           }
-          pos_ += datalen;
+          const pcapng_enhanced_packet * packet = reinterpret_cast<const pcapng_enhanced_packet *>(block);
+          interfaceId = swap(packet->interfaceId);
+          timestampHigh = swap(packet->timestampHigh);
+          timestampLow = swap(packet->timestampLow);
+          caplen = swap(packet->caplen);
+          len = swap(packet->len);
         }
         else
         {
-          pos_ += datalen;
-          skipped += 1;
+          packetPos = blockPos + sizeof(pcapng_packet);
+          if(packetPos > bodyEnd)
+          {
+            break;
+          }
+          const pcapng_packet * packet = reinterpret_cast<const pcapng_packet *>(block);
+          interfaceId = swap(packet->interfaceId);
+          timestampHigh = swap(packet->timestampHigh);
+          timestampLow = swap(packet->timestampLow);
+          caplen = swap(packet->caplen);
+          len = swap(packet->len);
         }
+        if(interfaceId >= interfaces_.size() || packetPos + caplen > bodyEnd)
+        {
+          break;
+        }
+        const Interface & interface = interfaces_[interfaceId];
+        timestamp_ = nanoseconds((uint64(timestampHigh) << 32) | timestampLow, interface.unitsPerSecond_);
+        packetLength = caplen;
+        linkType = interface.linkType_;
+        truncated = caplen != len;
+        return true;
+      }
+    case PCAPNG_SIMPLE_PACKET:
+      {
+        // no timestamp and no captured length: the packet fills the block.
+        packetPos = blockPos + sizeof(pcapng_simple_packet);
+        if(interfaces_.empty() || packetPos > bodyEnd)
+        {
+          break;
+        }
+        const pcapng_simple_packet * packet = reinterpret_cast<const pcapng_simple_packet *>(block);
+        size_t len = swap(packet->len);
+        packetLength = std::min(len, bodyEnd - packetPos);
+        linkType = interfaces_[0].linkType_;
+        truncated = packetLength != len;
+        timestamp_ = 0;
+        return true;
+      }
+    default:
+      // statistics, name resolution, etc.
+      break;
+    }
+  }
+  pos_ = fileSize_;
+  return false;
+}
 
+bool
+PCapReader::read(const unsigned char *& buffer, size_t & size)
+{
+  if(ok_)
+  {
+    ok_ = false;
+    size_t skipped = 0;
+    file_.readAhead(pos_);
+    size_t packetPos = 0;
+    size_t packetLength = 0;
+    uint32 linkType = 0;
+    bool truncated = false;
+    while(!ok_ && nextRecord(packetPos, packetLength, linkType, truncated))
+    {
+      if(truncated)
+      {
+        skipped += 1;
+      }
+      else
+      {
+        ok_ = parsePacket(packetPos, packetLength, linkType, buffer, size);
       }
     }
     if(skipped != 0)
@@ -417,6 +694,120 @@ PCapReader::read(const unsigned char *& buffer, size_t & size)
   return ok_;
 }
 
+bool
+PCapReader::parsePacket(
+  size_t pos,
+  size_t datalen,
+  uint32 linkType,
+  const unsigned char *& buffer,
+  size_t & size)
+{
+  size_t headerPos = pos;
+  bool found = false;
+  switch(linkType)
+  {
+  case DLT_EN10MB:
+    {
+      if(datalen >= sizeof(ethernetIIHeader))
+      {
+        pos += sizeof(ethernetIIHeader);
+        datalen -= sizeof(ethernetIIHeader);
+        found = true;
+      }
+      break;
+    }
+  case DLT_LINUX_SLL:
+    {
+      if(datalen >= sizeof(linuxCookedCaptureHeader))
+      {
+        pos += sizeof(linuxCookedCaptureHeader);
+        datalen -= sizeof(linuxCookedCaptureHeader);
+        found = true;
+      }
+      break;
+    }
+  default:
+    {
+      // HACK!look for the IP protocol flag to mark the end of the the link layer header
+      static unsigned short IPProtocol = 0x0008;
+      while(!found && datalen > sizeof(checksum_t) + 2)
+      {
+        unsigned short protocol = *(const unsigned short *)(data_ + pos);
+        if(swap(protocol) == IPProtocol)
+        {
+          found = true;
+        }
+        pos += 1;
+        datalen -= 1;
+      }
+      if(found)
+      {
+        pos += 1;
+        datalen -= 1;
+      }
+      break;
+    }
+  }
+  if(!found || datalen < 20 + sizeof(udp_header))
+  {
+    return false;
+  }
+  // IP and UDP headers are in network byte order regardless of the capturing machine.
+  const ip_header * ipHeader = reinterpret_cast<const ip_header *>(data_ + pos);
+  // IP header contains its own length expressed in 4 byte units.
+  size_t ipLen = (ipHeader->ver_ihl & 0xF) * 4;
+  if((ipHeader->ver_ihl >> 4) != 4 || ipHeader->proto != UDPProtocol || datalen < ipLen + sizeof(udp_header))
+  {
+    return false;
+  }
+  uint32 address =
+    (uint32(ipHeader->daddr.byte1) << 24) |
+    (uint32(ipHeader->daddr.byte2) << 16) |
+    (uint32(ipHeader->daddr.byte3) << 8) |
+    uint32(ipHeader->daddr.byte4);
+  pos += ipLen;
+  datalen -= ipLen;
+  const uchar * udp = data_ + pos;
+  uint16 port = uint16((uint16(udp[2]) << 8) | udp[3]);
+  if(!flows_.empty()
+    && flows_.find(flowKey(address, port)) == flows_.end()
+    && flows_.find(flowKey(0, port)) == flows_.end())
+  {
+    // not subscribed.  Don't touch the payload.
+    ++filteredPackets_;
+    return false;
+  }
+  size_t udpLen = (size_t(udp[4]) << 8) | udp[5];
+  pos += sizeof(udp_header);
+  datalen -= sizeof(udp_header);
+  // Use the UDP length so padding and any frame check sequence at the
+  // end of the packet are not mistaken for payload.
+  size_t payload = 0;
+  if(udpLen >= sizeof(udp_header) && udpLen - sizeof(udp_header) <= datalen)
+  {
+    payload = udpLen - sizeof(udp_header);
+  }
+  else if(datalen > sizeof(checksum_t))
+  {
+    // a 4 byte checksum appears at the end of the packet.  It is not part of the payload.
+    payload = datalen - sizeof(checksum_t);
+  }
+  if(payload == 0)
+  {
+    return false;
+  }
+  destinationAddress_ = address;
+  destinationPort_ = port;
+  buffer = data_ + pos;
+  size = payload;
+  if(verbose_)
+  {
+    std::cout << "PCapReader: " << headerPos << ": " << pos << ' ' << payload
+      << "=== 0x" << std::hex  << headerPos << ": 0x" << pos << " 0x" << payload << std::dec << std::endl;
+  }
+  return true;
+}
+
 void
 PCapReader::setVerbose(bool verbose)
 {
@@ -9,6 +9,8 @@
 #include <Common/QuickFAST_Export.h>
 #include <Common/Types.h>
 #include <Common/ByteSwapper.h>
+#include <Common/MappedFile.h>
+#include <set>
 
 
 namespace QuickFAST
@@ -22,16 +24,35 @@ namespace QuickFAST
     ///
     /// PCap is the format used by many communication utility data capture packages
     /// including Wireshark (aka Ethereal) and tcpdump.
+    ///
+    /// The file is memory mapped (when possible) so opening a file takes the same time
+    /// regardless of its size, and read() returns pointers into the mapping without copying.
+    /// On a 32 bit platform files larger than the address space can not be mapped.
+    ///
+    /// Classic PCap files with microsecond or nanosecond timestamps and PCapNG files
+    /// (section, interface description, enhanced/simple/obsolete packet blocks) are supported.
+    ///
+    /// If flows are added with addFlow(), packets for other destinations are skipped
+    /// while the headers are parsed, so their payloads are never touched.
     class QuickFAST_Export PCapReader
     {
     public:
       PCapReader();
+      ~PCapReader();
+
       /// @brief open a PCap formatted file
       ///
+      /// Any previously opened file is closed.  Pointers returned by read() for that file
+      /// are no longer valid.
       /// @param filename names the file
       /// @returns true if the open was successful
       bool open(const char * filename);
 
+      /// @brief release the file.
+      ///
+      /// Pointers returned by read() are no longer valid.
+      void close();
+
       /// @brief enable noisy operation for debugging purposes
       ///
       /// @param verbose true turns on the noise.
@@ -49,11 +70,57 @@ namespace QuickFAST
 
       /// @brief Read the next record in the file.
       ///
+      /// The data is not copied.  It remains valid until the file is closed.
       /// @param[out] buffer end up pointing to the user data in the packet (headers are bypassed)
       /// @param[out] size contains the number of bytes of user data in the packet (zero is possible and legal!)
       /// @returns true if the read was successful.  False usually means end of data
       bool read(const unsigned char *& buffer, size_t & size);
 
+      /// @brief The capture time of the packet returned by the most recent read()
+      /// @returns nanoseconds since the epoch (as recorded in the PCap record header)
+      uint64 timestamp()const
+      {
+        return timestamp_;
+      }
+
+      /// @brief The destination IP address of the packet returned by the most recent read()
+      /// @returns the IPv4 address in host byte order (i.e. 239.1.2.3 is 0xEF010203)
+      uint32 destinationAddress()const
+      {
+        return destinationAddress_;
+      }
+
+      /// @brief The destination UDP port of the packet returned by the most recent read()
+      /// @returns the port number in host byte order.
+      uint16 destinationPort()const
+      {
+        return destinationPort_;
+      }
+
+      /// @brief Only return packets sent to the given destination.
+      ///
+      /// May be called more than once to accept several flows.  If no flows
+      /// have been added, all UDP packets are returned.
+      /// @param address is the destination IPv4 address in host byte order.  Zero matches any address.
+      /// @param port is the destination UDP port.
+      void addFlow(uint32 address, uint16 port);
+
+      /// @brief Only return packets sent to the given destination.
+      ///
+      /// @param address is the destination in dotted decimal form, i.e. "239.1.2.3"
+      /// @param port is the destination UDP port.
+      /// @throws std::invalid_argument if the address can not be parsed.
+      void addFlow(const std::string & address, uint16 port);
+
+      /// @brief Forget all flows.  All UDP packets will be returned.
+      void clearFlows();
+
+      /// @brief How many packets have been skipped because they did not match a flow.
+      size_t filteredPackets()const
+      {
+        return filteredPackets_;
+      }
+
       /// @brief DEBUG ONLY.  Seek to a particular address.
       ///
       /// since there is no tell() method the address probably came from a verbose display.
@@ -80,7 +147,32 @@ namespace QuickFAST
       }
 
     private:
-      boost::scoped_array<unsigned char> buffer_;
+      PCapReader(const PCapReader &);
+      PCapReader & operator=(const PCapReader &);
+      bool nextRecord(size_t & packetPos, size_t & packetLength, uint32 & linkType, bool & truncated);
+      bool nextBlock(size_t & packetPos, size_t & packetLength, uint32 & linkType, bool & truncated);
+      bool parsePacket(
+        size_t pos,
+        size_t datalen,
+        uint32 linkType,
+        const unsigned char *& buffer,
+        size_t & size);
+      static uint64 flowKey(uint32 address, uint16 port)
+      {
+        return (uint64(address) << 16) | port;
+      }
+
+      /// link layer and timestamp resolution for the packets.
+      /// Classic PCap files have one; PCapNG files have one per interface description block.
+      struct Interface
+      {
+        uint32 linkType_;
+        uint64 unitsPerSecond_;
+      };
+
+    private:
+      Common::MappedFile file_;
+      const unsigned char * data_;
       size_t fileSize_;
       size_t pos_;
       bool ok_;
@@ -88,9 +180,15 @@ namespace QuickFAST
       bool usetv64_;  // true forces 64 bit header on 32 bit platform
                       // neither usetv32_ nor usetv64_ means use native
                       // both is an (undetected) error.
-      uint32 linktype_;
+      bool pcapng_;
+      std::vector<Interface> interfaces_;
       ByteSwapper swap;
       bool verbose_;
+      uint64 timestamp_;
+      uint32 destinationAddress_;
+      uint16 destinationPort_;
+      std::set<uint64> flows_;
+      size_t filteredPackets_;
     };
   }
   }
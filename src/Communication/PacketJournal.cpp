@@ -0,0 +1,467 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "PacketJournal.h"
+#include <Common/Timestamp.h>
+#include <fcntl.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <malloc.h>
+#else
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+using namespace QuickFAST;
+using namespace Communication;
+
+namespace
+{
+  const size_t pageSize = 4096;
+
+  // classic PCap with nanosecond timestamps; written in native byte order
+  const uint32 pcapNanoMagic = 0xa1b23c4d;
+  const uint32 linkTypeEthernet = 1;
+  const size_t fileHeaderSize = 24;
+  const size_t recordHeaderSize = 16;
+  const size_t ethernetHeaderSize = 14;
+  const size_t ipHeaderSize = 20;
+  const size_t udpHeaderSize = 8;
+  const size_t packetHeaderSize = recordHeaderSize + ethernetHeaderSize + ipHeaderSize + udpHeaderSize;
+  // the most a UDP datagram can carry.  Larger packets are split.
+  const size_t maxPayload = 65535 - ipHeaderSize - udpHeaderSize;
+  // what record() puts in the ring ahead of each packet: the receive time and the size.
+  const size_t packetInfoSize = 2 * sizeof(uint64);
+
+  void putNative32(unsigned char * out, uint32 value)
+  {
+    std::memcpy(out, &value, sizeof(value));
+  }
+
+  void putNative16(unsigned char * out, uint16 value)
+  {
+    std::memcpy(out, &value, sizeof(value));
+  }
+
+  void putBig16(unsigned char * out, uint16 value)
+  {
+    out[0] = uchar(value >> 8);
+    out[1] = uchar(value);
+  }
+
+  void putBig32(unsigned char * out, uint32 value)
+  {
+    putBig16(out, uint16(value >> 16));
+    putBig16(out + 2, uint16(value));
+  }
+
+  unsigned char * allocateAligned(size_t size)
+  {
+#if defined(_WIN32)
+    void * result = _aligned_malloc(size, pageSize);
+#else
+    void * result = 0;
+    if(posix_memalign(&result, pageSize, size) != 0)
+    {
+      result = 0;
+    }
+#endif
+    if(result == 0)
+    {
+      throw std::bad_alloc();
+    }
+    return static_cast<unsigned char *>(result);
+  }
+
+  void freeAligned(unsigned char * storage)
+  {
+#if defined(_WIN32)
+    _aligned_free(storage);
+#else
+    free(storage);
+#endif
+  }
+}
+
+PacketJournal::PacketJournal(
+  size_t bufferSize,
+  size_t bufferCount,
+  OverflowPolicy policy)
+: bufferSize_((bufferSize + pageSize - 1) / pageSize * pageSize)
+, bufferCount_(bufferCount)
+, policy_(policy)
+, destinationAddress_(0)
+, destinationPort_(0)
+, storage_(0)
+, fd_(-1)
+, direct_(false)
+, outputPos_(0)
+, ring_(0)
+, ringSize_(0)
+, stopping_(false)
+{
+  if(bufferCount_ < 2)
+  {
+    throw std::invalid_argument("PacketJournal: at least two buffers are required.");
+  }
+  if(bufferSize_ == 0)
+  {
+    bufferSize_ = pageSize;
+  }
+  storage_ = allocateAligned(bufferSize_ * bufferCount_);
+  ring_ = storage_ + bufferSize_;
+  ringSize_ = bufferSize_ * (bufferCount_ - 1);
+}
+
+PacketJournal::~PacketJournal()
+{
+  close();
+  freeAligned(storage_);
+}
+
+void
+PacketJournal::setDestination(const std::string & address, unsigned short port)
+{
+  uint32 value = 0;
+  std::istringstream in(address);
+  for(size_t nByte = 0; nByte < 4; ++nByte)
+  {
+    unsigned int byte = 256;
+    char dot = '.';
+    if(nByte != 0)
+    {
+      in >> dot;
+    }
+    if(!(in >> byte) || byte > 255 || dot != '.')
+    {
+      throw std::invalid_argument("PacketJournal: invalid IP address: " + address);
+    }
+    value = (value << 8) | byte;
+  }
+  destinationAddress_ = value;
+  destinationPort_ = port;
+}
+
+bool
+PacketJournal::open(const std::string & filename, bool direct)
+{
+  close();
+#if defined(_WIN32)
+  direct = false;
+  fd_ = ::_open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+# if defined(O_DIRECT)
+  if(direct)
+  {
+    fd_ = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+  }
+# else
+  direct = false;
+# endif
+  if(fd_ < 0)
+  {
+    // O_DIRECT is not supported by every file system.  Fall back to ordinary writes.
+    direct = false;
+    fd_ = ::open(filename.c_str(), flags, 0644);
+  }
+#endif
+  if(fd_ < 0)
+  {
+    return false;
+  }
+  direct_ = direct;
+  stopping_ = false;
+  // the writer empties the ring before it exits so head_ and tail_ are left as they are.
+  outputPos_ = 0;
+
+  unsigned char header[fileHeaderSize];
+  putNative32(header, pcapNanoMagic);
+  putNative16(header + 4, 2);  // version 2.4
+  putNative16(header + 6, 4);
+  putNative32(header + 8, 0);  // timestamps are UTC
+  putNative32(header + 12, 0);
+  putNative32(header + 16, 262144); // snap length
+  putNative32(header + 20, linkTypeEthernet);
+  emit(header, sizeof(header));
+
+  thread_.reset(new boost::thread(boost::bind(&PacketJournal::writer, this)));
+  return true;
+}
+
+void
+PacketJournal::close()
+{
+  if(thread_)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stopping_ = true;
+      filled_.notify_all();
+      emptied_.notify_all();
+    }
+    thread_->join();
+    thread_.reset();
+  }
+  if(fd_ >= 0)
+  {
+#if defined(_WIN32)
+    ::_close(fd_);
+#else
+    ::close(fd_);
+#endif
+    fd_ = -1;
+  }
+}
+
+size_t
+PacketJournal::available()const
+{
+  size_t head = size_t(long(head_));
+  size_t tail = size_t(long(tail_));
+  return (tail + ringSize_ - head - 1) % ringSize_;
+}
+
+void
+PacketJournal::copyIn(size_t position, const unsigned char * data, size_t size)
+{
+  size_t first = std::min(size, ringSize_ - position);
+  std::memcpy(ring_ + position, data, first);
+  std::memcpy(ring_, data + first, size - first);
+}
+
+void
+PacketJournal::copyOut(size_t position, unsigned char * data, size_t size)const
+{
+  size_t first = std::min(size, ringSize_ - position);
+  std::memcpy(data, ring_ + position, first);
+  std::memcpy(data + first, ring_, size - first);
+}
+
+bool
+PacketJournal::record(const unsigned char * data, size_t size, uint64 receiveTime)
+{
+  if(receiveTime == 0)
+  {
+    receiveTime = Common::wallClockNanoseconds();
+  }
+  size_t needed = packetInfoSize + size;
+  if(!thread_ || stopping_ || needed >= ringSize_)
+  {
+    ++packetsDropped_;
+    return false;
+  }
+  if(available() < needed)
+  {
+    if(policy_ == DROP)
+    {
+      ++packetsDropped_;
+      return false;
+    }
+    ++producerWaits_;
+    boost::mutex::scoped_lock lock(mutex_);
+    producerWaiting_.CAS(0, 1);
+    while(available() < needed && !stopping_)
+    {
+      emptied_.wait(lock);
+    }
+    producerWaiting_.CAS(1, 0);
+    if(stopping_)
+    {
+      ++packetsDropped_;
+      return false;
+    }
+  }
+
+  size_t head = size_t(long(head_));
+  unsigned char info[packetInfoSize];
+  uint64 packetSize = size;
+  std::memcpy(info, &receiveTime, sizeof(receiveTime));
+  std::memcpy(info + sizeof(receiveTime), &packetSize, sizeof(packetSize));
+  copyIn(head, info, packetInfoSize);
+  copyIn((head + packetInfoSize) % ringSize_, data, size);
+  ++packetsRecorded_;
+  bytesRecorded_ += long(size);
+
+  // publish the packet. CAS is a full barrier so the copy is visible first.
+  head_.CAS(long(head), long((head + needed) % ringSize_));
+  if(writerWaiting_ != 0)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    filled_.notify_one();
+  }
+  return true;
+}
+
+void
+PacketJournal::emit(const unsigned char * data, size_t size)
+{
+  while(size > 0)
+  {
+    size_t count = std::min(size, bufferSize_ - outputPos_);
+    std::memcpy(storage_ + outputPos_, data, count);
+    outputPos_ += count;
+    data += count;
+    size -= count;
+    if(outputPos_ == bufferSize_)
+    {
+      if(!writeAll(storage_, bufferSize_))
+      {
+        // keep going so the receiver is never blocked by a failed disk.
+        ++writeErrors_;
+      }
+      ++buffersWritten_;
+      outputPos_ = 0;
+    }
+  }
+}
+
+void
+PacketJournal::emitPacket(size_t position, size_t size, uint64 receiveTime)
+{
+  uint32 seconds = uint32(receiveTime / 1000000000ULL);
+  uint32 nanoseconds = uint32(receiveTime % 1000000000ULL);
+  size_t remaining = size;
+  do
+  {
+    size_t payload = std::min(remaining, maxPayload);
+    unsigned char header[packetHeaderSize];
+    size_t wireLength = ethernetHeaderSize + ipHeaderSize + udpHeaderSize + payload;
+    unsigned char * pos = header;
+    putNative32(pos, seconds);
+    putNative32(pos + 4, nanoseconds);
+    putNative32(pos + 8, uint32(wireLength));
+    putNative32(pos + 12, uint32(wireLength));
+    pos += recordHeaderSize;
+
+    // Ethernet: the multicast MAC for the destination; no source.
+    pos[0] = 0x01;
+    pos[1] = 0x00;
+    pos[2] = 0x5e;
+    pos[3] = uchar((destinationAddress_ >> 16) & 0x7F);
+    pos[4] = uchar(destinationAddress_ >> 8);
+    pos[5] = uchar(destinationAddress_);
+    std::memset(pos + 6, 0, 6);
+    putBig16(pos + 12, 0x0800);
+    pos += ethernetHeaderSize;
+
+    // IPv4
+    pos[0] = 0x45;
+    pos[1] = 0;
+    putBig16(pos + 2, uint16(ipHeaderSize + udpHeaderSize + payload));
+    putBig32(pos + 4, 0);   // identification, flags, fragment offset
+    pos[8] = 1;             // ttl
+    pos[9] = 17;            // UDP
+    putBig16(pos + 10, 0);  // checksum (below)
+    putBig32(pos + 12, 0);  // source
+    putBig32(pos + 16, destinationAddress_);
+    uint32 sum = 0;
+    for(size_t nWord = 0; nWord < ipHeaderSize; nWord += 2)
+    {
+      sum += (uint32(pos[nWord]) << 8) | pos[nWord + 1];
+    }
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum += sum >> 16;
+    putBig16(pos + 10, uint16(~sum));
+    pos += ipHeaderSize;
+
+    // UDP: no checksum
+    putBig16(pos, 0);
+    putBig16(pos + 2, destinationPort_);
+    putBig16(pos + 4, uint16(udpHeaderSize + payload));
+    putBig16(pos + 6, 0);
+
+    emit(header, sizeof(header));
+    // the payload may wrap at the end of the ring.
+    size_t first = std::min(payload, ringSize_ - position);
+    emit(ring_ + position, first);
+    emit(ring_, payload - first);
+    position = (position + payload) % ringSize_;
+    remaining -= payload;
+  } while(remaining > 0);
+}
+
+bool
+PacketJournal::writeAll(const unsigned char * data, size_t size)
+{
+  while(size > 0)
+  {
+#if defined(_WIN32)
+    int written = ::_write(fd_, data, unsigned(size));
+#else
+    ssize_t written = ::write(fd_, data, size);
+#endif
+    if(written <= 0)
+    {
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool
+PacketJournal::waitForPackets()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  // CAS is a full barrier so record() either sees the flag or we see its packet.
+  writerWaiting_.CAS(0, 1);
+  while(long(head_) == long(tail_) && !stopping_)
+  {
+    filled_.wait(lock);
+  }
+  writerWaiting_.CAS(1, 0);
+  return long(head_) != long(tail_);
+}
+
+void
+PacketJournal::writer()
+{
+  for(;;)
+  {
+    size_t tail = size_t(long(tail_));
+    if(size_t(long(head_)) == tail)
+    {
+      if(!waitForPackets())
+      {
+        break;
+      }
+      continue;
+    }
+    unsigned char info[packetInfoSize];
+    copyOut(tail, info, packetInfoSize);
+    uint64 receiveTime = 0;
+    uint64 size = 0;
+    std::memcpy(&receiveTime, info, sizeof(receiveTime));
+    std::memcpy(&size, info + sizeof(receiveTime), sizeof(size));
+    emitPacket((tail + packetInfoSize) % ringSize_, size_t(size), receiveTime);
+
+    // release the space.
+    tail_.CAS(long(tail), long((tail + packetInfoSize + size_t(size)) % ringSize_));
+    if(producerWaiting_ != 0)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      emptied_.notify_all();
+    }
+  }
+
+  // stopping: write the partially filled buffer.
+  if(outputPos_ > 0)
+  {
+#if !defined(_WIN32) && defined(O_DIRECT)
+    if(direct_)
+    {
+      // the last write is not a whole number of blocks.
+      ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+    if(!writeAll(storage_, outputPos_))
+    {
+      ++writeErrors_;
+    }
+    outputPos_ = 0;
+  }
+}
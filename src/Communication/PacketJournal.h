@@ -0,0 +1,205 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PACKETJOURNAL_H
+#define PACKETJOURNAL_H
+#include "PacketJournal_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Common/AtomicCounter.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Record received packets in a PCap file without slowing down the receiver.
+    ///
+    /// Attach a journal to a Receiver with Receiver::setJournal().  Every packet the
+    /// Receiver accepts is copied, with its size and receive time, into a preallocated
+    /// single-producer/single-consumer ring.  The ring's head and tail are atomic counters
+    /// so that copy is the only work done on the receiving thread; it takes the lock only
+    /// to wake an idle writer or to wait for room under the BACKPRESSURE policy.
+    /// A dedicated writer thread formats the PCap records into a page-aligned buffer and
+    /// writes it to disk as it fills using large sequential writes (optionally with
+    /// O_DIRECT so the journal does not pollute the page cache).
+    ///
+    /// The file is a classic PCap file with nanosecond timestamps.  Each packet is given
+    /// synthetic Ethernet, IPv4 and UDP headers addressed to the destination set by
+    /// setDestination() so the file can be examined with Wireshark or replayed by
+    /// PCapFileReceiver or the PCapToMulticast example.  Packets too large for a UDP
+    /// datagram (i.e. from a TCPReceiver) are split into several records.
+    /// Record headers use the standard 32 bit layout regardless of platform, so
+    /// read the file with PCapReader::set32bit() (-pcapsource 32).
+    ///
+    /// If the disk falls behind and the ring is full the policy decides what happens:
+    ///   - DROP: the packet is not journaled. See packetsDropped()
+    ///   - BACKPRESSURE: the receiving thread waits for the writer. See producerWaits()
+    ///
+    /// The partially filled buffer is written when the journal is closed.
+    class QuickFAST_Export PacketJournal
+    {
+    public:
+      /// @brief What to do when the ring is full.
+      enum OverflowPolicy
+      {
+        DROP,
+        BACKPRESSURE
+      };
+
+      /// @brief Allocate the ring.
+      /// @param bufferSize is the size of each write.  Rounded up to a multiple of the page size.
+      /// @param bufferCount is the number of buffers allocated.  One is the writer's output buffer;
+      ///        the rest form the ring.  Must be at least two.
+      /// @param policy determines what happens when the writer falls behind.
+      /// @throws std::invalid_argument if bufferCount is less than two.
+      PacketJournal(
+        size_t bufferSize = 1024 * 1024,
+        size_t bufferCount = 8,
+        OverflowPolicy policy = DROP);
+
+      /// @brief Closes the file if necessary.
+      ~PacketJournal();
+
+      /// @brief Set the destination recorded in the synthetic IP and UDP headers.
+      ///
+      /// Call before open().
+      /// @param address is the destination in dotted decimal form, i.e. "239.1.2.3"
+      /// @param port is the destination UDP port.
+      /// @throws std::invalid_argument if the address is not valid.
+      void setDestination(const std::string & address, unsigned short port);
+
+      /// @brief Create the file and start the writer thread.
+      /// @param filename names the file to be written.  An existing file is replaced.
+      /// @param direct requests O_DIRECT writes where they are supported.
+      /// @returns true if the file was created.
+      bool open(const std::string & filename, bool direct = false);
+
+      /// @brief Write everything recorded so far, stop the writer thread and close the file.
+      void close();
+
+      /// @brief Record one packet.
+      ///
+      /// Called by the Receiver for each packet it accepts.
+      /// @param data points to the contents of the packet
+      /// @param size is the number of bytes in the packet
+      /// @param receiveTime is nanoseconds since the epoch.  Zero means "now".
+      /// @returns true if the packet was journaled; false if it was dropped.
+      bool record(const unsigned char * data, size_t size, uint64 receiveTime);
+
+      /// @brief Is the file open?
+      bool isOpen()const
+      {
+        return fd_ >= 0;
+      }
+
+      /// @brief Are writes bypassing the page cache?
+      bool directIO()const
+      {
+        return direct_;
+      }
+
+      /// @brief The size of each buffer in the ring after rounding.
+      size_t bufferSize()const
+      {
+        return bufferSize_;
+      }
+
+      /// @brief Statistic: How many packets have been journaled.
+      size_t packetsRecorded()const
+      {
+        return size_t(long(packetsRecorded_));
+      }
+
+      /// @brief Statistic: How many bytes of packet data have been journaled.
+      size_t bytesRecorded()const
+      {
+        return size_t(long(bytesRecorded_));
+      }
+
+      /// @brief Statistic: How many packets were dropped because the ring was full (DROP policy)
+      /// or the journal was not open.
+      size_t packetsDropped()const
+      {
+        return size_t(long(packetsDropped_));
+      }
+
+      /// @brief Statistic: How many times the receiving thread waited for the writer (BACKPRESSURE policy).
+      size_t producerWaits()const
+      {
+        return size_t(long(producerWaits_));
+      }
+
+      /// @brief Statistic: How many full buffers have been written.
+      size_t buffersWritten()const
+      {
+        return size_t(long(buffersWritten_));
+      }
+
+      /// @brief Statistic: How many writes failed.
+      size_t writeErrors()const
+      {
+        return size_t(long(writeErrors_));
+      }
+
+    private:
+      PacketJournal(const PacketJournal &);
+      PacketJournal & operator=(const PacketJournal &);
+
+      // bytes free in the ring.  One byte is kept free to tell a full ring from an empty one.
+      size_t available()const;
+      // copy into and out of the ring at position, wrapping at the end.
+      void copyIn(size_t position, const unsigned char * data, size_t size);
+      void copyOut(size_t position, unsigned char * data, size_t size)const;
+      // append to the output buffer, writing it to the file each time it fills.
+      void emit(const unsigned char * data, size_t size);
+      // format the PCap records for one packet.  The packet starts at position in the ring.
+      void emitPacket(size_t position, size_t size, uint64 receiveTime);
+      // wait for the producer. Returns false if the journal is closing and the ring is empty.
+      bool waitForPackets();
+      bool writeAll(const unsigned char * data, size_t size);
+      void writer();
+
+    private:
+      size_t bufferSize_;
+      size_t bufferCount_;
+      OverflowPolicy policy_;
+      uint32 destinationAddress_;
+      uint16 destinationPort_;
+      // the writer's page-aligned output buffer, followed by the ring.
+      unsigned char * storage_;
+
+      int fd_;
+      bool direct_;
+
+      // bytes in the output buffer
+      size_t outputPos_;
+      unsigned char * ring_;
+      size_t ringSize_;
+      // offsets into the ring.  head_ is written only by record(), tail_ only by the writer.
+      // The ring is empty when they are equal.
+      AtomicCounter head_;
+      AtomicCounter tail_;
+
+      // The lock protects stopping_ and the waits.  A thread sets its
+      // waiting flag before it waits so the other knows to notify it.
+      boost::mutex mutex_;
+      boost::condition_variable filled_;
+      boost::condition_variable emptied_;
+      AtomicCounter writerWaiting_;
+      AtomicCounter producerWaiting_;
+      boost::scoped_ptr<boost::thread> thread_;
+      bool stopping_;
+
+      AtomicCounter packetsRecorded_;
+      AtomicCounter bytesRecorded_;
+      AtomicCounter packetsDropped_;
+      AtomicCounter producerWaits_;
+      AtomicCounter buffersWritten_;
+      AtomicCounter writeErrors_;
+    };
+  }
+}
+#endif // PACKETJOURNAL_H
@@ -0,0 +1,13 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef PACKETJOURNAL_FWD_H
+#define PACKETJOURNAL_FWD_H
+
+namespace QuickFAST{
+  namespace Communication{
+    class PacketJournal;
+  }
+}
+#endif // PACKETJOURNAL_FWD_H
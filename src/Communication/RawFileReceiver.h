@@ -8,6 +8,7 @@
 //#include <Common/QuickFAST_Export.h>
 #include "RawFileReceiver_fwd.h"
 #include <Communication/SynchReceiver.h>
+#include <Common/MappedFile.h>
 
 namespace QuickFAST
 {
@@ -28,7 +29,22 @@ namespace QuickFAST
       RawFileReceiver(
         std::istream & stream
         )
-        : stream_(stream)
+        : stream_(&stream)
+        , delivered_(false)
+      {
+      }
+
+      /// @brief Memory map a file into a Receiver
+      ///
+      /// The entire file is delivered as a single buffer that points
+      /// into the mapped file, so no data is copied.
+      /// @param filename names the file containing FAST encoded data
+      explicit RawFileReceiver(
+        const std::string & filename
+        )
+        : stream_(0)
+        , filename_(filename)
+        , delivered_(false)
       {
       }
 
@@ -41,17 +57,36 @@ namespace QuickFAST
       // Implement Receiver method
       virtual bool initializeReceiver()
       {
-        return stream_.good() && !stream_.eof();
+        if(stream_ == 0)
+        {
+          delivered_ = false;
+          return file_.open(filename_.c_str());
+        }
+        return stream_->good() && !stream_->eof();
       }
 
       // Implement Receiver method
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
         bool filling = false;
-        if(!stopping_ && stream_.good() && !stream_.eof())
+        if(stream_ == 0)
+        {
+          if(!stopping_ && !delivered_ && file_.size() > 0)
+          {
+            delivered_ = true;
+            // point into the memory mapped file rather than copying.
+            buffer->setExternal(file_.data(), file_.size());
+            if(acceptFullBuffer(buffer, file_.size(), lock))
+            {
+              needService_ = true;
+            }
+            filling = true;
+          }
+        }
+        else if(!stopping_ && stream_->good() && !stream_->eof())
         {
-          stream_.read(reinterpret_cast<char *>(buffer->get()), buffer->capacity());
-          size_t size = (size_t) stream_.gcount();
+          stream_->read(reinterpret_cast<char *>(buffer->get()), buffer->capacity());
+          size_t size = (size_t) stream_->gcount();
           if(acceptFullBuffer(buffer, size, lock))
           {
             needService_ = true;
@@ -68,7 +103,10 @@ namespace QuickFAST
       }
 
     private:
-      std::istream & stream_;
+      std::istream * stream_;
+      std::string filename_;
+      Common::MappedFile file_;
+      bool delivered_;
       bool needService_;
     };
   }
@@ -9,6 +9,8 @@
 #include "Receiver_fwd.h"
 #include <Communication/Assembler.h>
 #include <Communication/LinkedBuffer.h>
+#include <Communication/PacketJournal.h>
+#include <Common/StatisticsRegistry.h>
 #include <Common/Exceptions.h>
 
 namespace QuickFAST
@@ -24,22 +26,28 @@ namespace QuickFAST
         , paused_(false)
         , stopping_(false)
         , readInProgress_(false)
-        , noBufferAvailable_(0)
-        , packetsReceived_(0)
-        , bytesReceived_(0)
-        , errorPackets_(0)
-        , pausedPackets_(0)
-        , emptyPackets_(0)
-        , packetsQueued_(0)
-        , batchesProcessed_(0)
-        , packetsProcessed_(0)
-        , bytesProcessed_(0)
-        , largestPacket_(0)
+        , noBufferAvailable_()
+        , packetsReceived_()
+        , bytesReceived_()
+        , errorPackets_()
+        , pausedPackets_()
+        , emptyPackets_()
+        , packetsQueued_()
+        , batchesProcessed_()
+        , packetsProcessed_()
+        , bytesProcessed_()
+        , largestPacket_(Common::Statistic::GAUGE)
+        , queueDepth_(Common::Statistic::GAUGE)
+        , buffers_(Common::Statistic::GAUGE)
+        , buffersIdle_(Common::Statistic::GAUGE)
+        , journal_(0)
+        , statistics_(0)
       {
       }
 
       virtual ~Receiver()
       {
+        setStatistics(0);
       }
 
       /// @brief Start accepting packets.  Returns immediately
@@ -69,6 +77,7 @@ namespace QuickFAST
             bufferLifetimes_.push_back(buffer);
             idleBufferPool_.push(buffer.get());
           }
+          buffers_ += bufferCount;
           startReceive(lock);
           result = true;
         }
@@ -90,6 +99,61 @@ namespace QuickFAST
           bufferLifetimes_.push_back(buffer);
           idleBufferPool_.push(buffer.get());
         }
+        buffers_ += bufferCount;
+        buffersIdle_.set(idleBufferPool_.size());
+      }
+
+      /// @brief add buffers owned by someone else (i.e. a BufferSlab)
+      ///
+      /// Buffers may be added before start() is called, in which case start() can
+      /// be told to allocate zero buffers of its own.
+      /// @param buffers points to an array of buffers that must outlive this Receiver
+      /// @param bufferCount is how many buffers are in the array
+      void addBuffers(
+        LinkedBuffer * buffers,
+        size_t bufferCount)
+      {
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+        {
+          idleBufferPool_.push(&buffers[nBuffer]);
+        }
+        buffers_ += bufferCount;
+        buffersIdle_.set(idleBufferPool_.size());
+      }
+
+      /// @brief Record every packet this Receiver accepts.
+      ///
+      /// Call before start().
+      /// @param journal is an open PacketJournal that must outlive this Receiver (or zero to stop journaling).
+      void setJournal(PacketJournal * journal)
+      {
+        journal_ = journal;
+      }
+
+      /// @brief Publish this Receiver's statistics.
+      ///
+      /// The statistics are named prefix followed by the name of the
+      /// accessor method, i.e. "feedA.packetsReceived".  They are removed
+      /// from the registry when this Receiver is destroyed.
+      /// @param registry must outlive this Receiver (or zero to stop publishing.)
+      /// @param prefix distinguishes this Receiver from others using the same registry.
+      void setStatistics(Common::StatisticsRegistry * registry, const std::string & prefix = "receiver.")
+      {
+        size_t count = 0;
+        const StatisticEntry * entries = statisticEntries(count);
+        for(size_t nEntry = 0; nEntry < count; ++nEntry)
+        {
+          if(statistics_ != 0)
+          {
+            statistics_->remove(this->*entries[nEntry].member_);
+          }
+          if(registry != 0)
+          {
+            registry->add(this->*entries[nEntry].member_, prefix + entries[nEntry].name_);
+          }
+        }
+        statistics_ = registry;
       }
 
       ////////////////////////////////////////////////////////////////////
@@ -190,6 +254,7 @@ namespace QuickFAST
             boost::mutex::scoped_lock lock(bufferMutex_);
             // add any idle buffers to pool
             idleBufferPool_.push(idleBuffers_);
+            updateQueueDepth(lock);
             startReceive(lock);
             queue_.refresh(lock, wait && !stopping_);
           }
@@ -269,6 +334,7 @@ namespace QuickFAST
           if(buffer != 0)
           {
             readInProgress_ = true;
+            buffer->setReceiveTime(0);
             if(!fillBuffer(buffer, lock))
             {
               idleBufferPool_.push(buffer);
@@ -281,6 +347,28 @@ namespace QuickFAST
             ++noBufferAvailable_;
           }
         }
+        buffersIdle_.set(idleBufferPool_.size());
+      }
+
+      /// @brief Update the queue depth after adding a packet to the queue
+      /// scoped_lock parameter means a mutex must be locked
+      void updateQueueDepth(boost::mutex::scoped_lock &)
+      {
+        queueDepth_.set(packetsQueued_.value() - packetsProcessed_.value());
+      }
+
+      /// @brief Copy an accepted packet to the journal if there is one.
+      ///
+      /// Never call this with bufferMutex_ locked: the journal has its own
+      /// lock and in BACKPRESSURE mode it waits for the writer to catch up.
+      /// @param buffer contains the packet
+      /// @param bytesReceived is the size of the packet
+      void journalPacket(const LinkedBuffer * buffer, size_t bytesReceived)
+      {
+        if(journal_ != 0)
+        {
+          journal_->record(buffer->get(), bytesReceived, buffer->receiveTime());
+        }
       }
 
       ////////////////////////////////////////////////////////////////////
@@ -319,49 +407,49 @@ namespace QuickFAST
       /// @returns the number of times no buffers were available to receive packets.
       size_t noBufferAvailable() const
       {
-        return noBufferAvailable_;
+        return size_t(noBufferAvailable_.value());
       }
 
       /// @brief Statistic: How many packets have been received
       /// @returns the number of packets that have been received
       size_t packetsReceived() const
       {
-        return packetsReceived_;
+        return size_t(packetsReceived_.value());
       }
 
       /// @brief Statistic: How many packets have been queued for processing
       /// @returns the number of packets that have been received
       size_t packetsQueued() const
       {
-        return packetsQueued_;
+        return size_t(packetsQueued_.value());
       }
 
       /// @brief Statistic: How many batches of packets have been processed
       /// @returns the number of batches
       size_t batchesProcessed() const
       {
-        return batchesProcessed_;
+        return size_t(batchesProcessed_.value());
       }
 
       /// @brief Statistic: How many packets have been processed
       /// @returns the number of packets that have been processed.
       size_t packetsProcessed() const
       {
-        return packetsProcessed_;
+        return size_t(packetsProcessed_.value());
       }
 
       /// @brief Statistic: How many bytes have been processed
       /// @returns the number of bytes that have been processed.
       size_t bytesProcessed() const
       {
-        return bytesProcessed_;
+        return size_t(bytesProcessed_.value());
       }
 
       /// @brief Statistic: How many received packets had errors
       /// @returns the number of packets that have encountered communication errors
       size_t packetsWithErrors() const
       {
-        return errorPackets_;
+        return size_t(errorPackets_.value());
       }
 
       /// @brief Statistic: How many packetes were ignored because this connection was paused
@@ -369,35 +457,56 @@ namespace QuickFAST
       /// @returns the number of paused packets.
       size_t pausedPackets() const
       {
-        return pausedPackets_;
+        return size_t(pausedPackets_.value());
       }
 
       /// @brief Statistic: How many received packets were empty
       /// @returns the number of packets that were empty
       size_t emptyPackets() const
       {
-        return emptyPackets_;
+        return size_t(emptyPackets_.value());
       }
 
       /// @brief Statistic: How many bytes have been received
       /// @returns the number of bytes that have been received
       size_t bytesReceived() const
       {
-        return bytesReceived_;
+        return size_t(bytesReceived_.value());
       }
 
       /// @brief Statistic: How big was the largest packet received
       /// @returns the number of bytes in the largest packet
       size_t largestPacket() const
       {
-        return largestPacket_;
+        return size_t(largestPacket_.value());
       }
 
       /// @brief Approximately how many bytes are waiting to be decoded
       size_t bytesReadable() const
       {
         // todo: we *could* ask the socket how much data is waiting
-        return bytesReceived_ - bytesProcessed_;
+        return size_t(bytesReceived_.value() - bytesProcessed_.value());
+      }
+
+      /// @brief Statistic: How many packets are waiting for the Assembler
+      /// @returns the number of packets queued but not yet processed.
+      size_t queueDepth() const
+      {
+        return size_t(queueDepth_.value());
+      }
+
+      /// @brief Statistic: How many buffers does this receiver have
+      /// @returns the number of buffers.
+      size_t buffers() const
+      {
+        return size_t(buffers_.value());
+      }
+
+      /// @brief Statistic: How many buffers are waiting to be filled
+      /// @returns the number of buffers in the idle pool.
+      size_t buffersIdle() const
+      {
+        return size_t(buffersIdle_.value());
       }
       // Statistics
       /////////////
@@ -420,6 +529,7 @@ namespace QuickFAST
           boost::mutex::scoped_lock lock(bufferMutex_);
           // add idle buffers to pool before trying to start a read.
           idleBufferPool_.push(idleBuffers_);
+          updateQueueDepth(lock);
           startReceive(lock);
           // see if this thread is still needed to service the queue
           return queue_.endService(!stopping_, lock);
@@ -463,28 +573,74 @@ namespace QuickFAST
 
       /////////////
       // Statistics
+      // The receive statistics are updated with bufferMutex_ locked.
+      // The processing statistics are updated by the thread servicing the queue.
       /// No buffers avaliable when we could have started a read
-      size_t noBufferAvailable_;
+      Common::Statistic noBufferAvailable_;
       /// Packets accepted (includes error & empty)
-      size_t packetsReceived_;
+      Common::Statistic packetsReceived_;
       /// Bytes in those packets
-      size_t bytesReceived_;
+      Common::Statistic bytesReceived_;
       /// Packets received with errors (usually disconnect or EOF0
-      size_t errorPackets_;
+      Common::Statistic errorPackets_;
       /// Packets received in error due to a linux bug.
-      size_t pausedPackets_;
+      Common::Statistic pausedPackets_;
       /// Packets containing no data (usually during shutdown)
-      size_t emptyPackets_;
+      Common::Statistic emptyPackets_;
       /// Packets containing valid data: queued to be processed
-      size_t packetsQueued_;
+      Common::Statistic packetsQueued_;
       /// Batches of packets collected by queue_
-      size_t batchesProcessed_;
+      Common::Statistic batchesProcessed_;
       /// Individual packets in the batches
-      size_t packetsProcessed_;
+      Common::Statistic packetsProcessed_;
       /// Bytes in the processed packets.
-      size_t bytesProcessed_;
+      Common::Statistic bytesProcessed_;
       /// Largest single packet received
-      size_t largestPacket_;
+      Common::Statistic largestPacket_;
+      /// Packets queued, not yet processed
+      Common::Statistic queueDepth_;
+      /// Buffers belonging to this receiver
+      Common::Statistic buffers_;
+      /// Buffers in idleBufferPool_
+      Common::Statistic buffersIdle_;
+      // Statistics
+      /////////////
+
+      /// @brief If not zero, accepted packets are recorded here.
+      PacketJournal * journal_;
+
+    private:
+      struct StatisticEntry
+      {
+        const char * name_;
+        Common::Statistic Receiver::* member_;
+      };
+
+      static const StatisticEntry * statisticEntries(size_t & count)
+      {
+        static const StatisticEntry entries[] =
+        {
+          {"noBufferAvailable", &Receiver::noBufferAvailable_},
+          {"packetsReceived", &Receiver::packetsReceived_},
+          {"bytesReceived", &Receiver::bytesReceived_},
+          {"packetsWithErrors", &Receiver::errorPackets_},
+          {"pausedPackets", &Receiver::pausedPackets_},
+          {"emptyPackets", &Receiver::emptyPackets_},
+          {"packetsQueued", &Receiver::packetsQueued_},
+          {"batchesProcessed", &Receiver::batchesProcessed_},
+          {"packetsProcessed", &Receiver::packetsProcessed_},
+          {"bytesProcessed", &Receiver::bytesProcessed_},
+          {"largestPacket", &Receiver::largestPacket_},
+          {"queueDepth", &Receiver::queueDepth_},
+          {"buffers", &Receiver::buffers_},
+          {"buffersIdle", &Receiver::buffersIdle_}
+        };
+        count = sizeof(entries) / sizeof(entries[0]);
+        return entries;
+      }
+
+      /// @brief If not zero, statistics are published here.
+      Common::StatisticsRegistry * statistics_;
     };
   }
 }
@@ -49,14 +49,24 @@ namespace QuickFAST
         )
       {
         bool needService = false;
+        if(journal_ != 0 && bytesReceived > 0)
+        {
+          // readInProgress_ is still set so no other packet can be
+          // accepted while the lock is released for the journal.
+          lock.unlock();
+          journalPacket(buffer, bytesReceived);
+          lock.lock();
+        }
         readInProgress_ = false;
         ++packetsReceived_;
         if(bytesReceived > 0)
         {
           ++packetsQueued_;
-          largestPacket_ = std::max(largestPacket_, bytesReceived);
+          bytesReceived_ += bytesReceived;
+          largestPacket_.raise(bytesReceived);
           buffer->setUsed(bytesReceived);
           needService = queue_.push(buffer, lock);
+          updateQueueDepth(lock);
         }
         else
         {
@@ -79,6 +79,9 @@ namespace QuickFAST
         }
         else
         {
+#if defined(__linux__)
+          enableReceiveTimestamps(nativeSocket(socket_));
+#endif // __linux__
           if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
           {
             std::stringstream msg;
@@ -179,6 +182,46 @@ namespace QuickFAST
 
     private:
 
+#if defined(__linux__)
+      // Wait until data is ready then read it ourselves to capture the kernel timestamp.
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+      {
+        socket_.async_receive(
+          boost::asio::null_buffers(),
+          boost::bind(&TCPReceiver::handleReadable,
+            this,
+            boost::asio::placeholders::error,
+            buffer)
+          );
+        return true;
+      }
+
+      void handleReadable(const boost::system::error_code& error, LinkedBuffer * buffer)
+      {
+        boost::system::error_code result(error);
+        size_t bytesReceived = 0;
+        if(!result)
+        {
+          if(!receiveTimestamped(nativeSocket(socket_), buffer, bytesReceived, result))
+          {
+            // spurious wakeup: wait again.
+            boost::mutex::scoped_lock lock(bufferMutex_);
+            if(!stopping_)
+            {
+              fillBuffer(buffer, lock);
+              return;
+            }
+            result = boost::asio::error::operation_aborted;
+          }
+          else if(!result && bytesReceived == 0)
+          {
+            // as asio would report it.
+            result = boost::asio::error::eof;
+          }
+        }
+        handleReceive(result, buffer, bytesReceived);
+      }
+#else // __linux__
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
         socket_.async_receive(
@@ -191,6 +234,7 @@ namespace QuickFAST
           );
         return true;
       }
+#endif // __linux__
 
     private:
       std::string hostName_;
@@ -0,0 +1,371 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "ChannelScaling.h"
+#include <Examples/MessagePerformance.h>
+#include <Examples/StopWatch.h>
+#include <Application/MultiChannelConnection.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Communication/Receiver.h>
+#include <Communication/AsioService.h>
+#include <Common/Timestamp.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  /// how long without progress before waiting packets are considered lost.
+  const uint64 stallNanoseconds = 200000000;
+
+  size_t packetsProcessed(Application::MultiChannelConnection & connection)
+  {
+    // Receiver statistics may be read while other threads are receiving.
+    size_t processed = 0;
+    for(size_t nChannel = 0; nChannel < connection.channelCount(); ++nChannel)
+    {
+      processed += connection.receiver(nChannel).packetsProcessed();
+    }
+    return processed;
+  }
+}
+
+ChannelScaling::ChannelScaling()
+: maxThreads_(0)
+, group_("239.255.1.1")
+, port_(30001)
+, bufferCount_(64)
+, window_(32)
+, pin_(false)
+, use32_(false)
+, use64_(false)
+, configurationArgs_(configuration_)
+{
+}
+
+ChannelScaling::~ChannelScaling()
+{
+}
+
+bool
+ChannelScaling::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  commandArgParser_.addHandler(&configurationArgs_);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+ChannelScaling::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-f" && argc > 1)
+    {
+      pcapFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-threads" && argc > 1)
+    {
+      maxThreads_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-group" && argc > 1)
+    {
+      group_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-port" && argc > 1)
+    {
+      port_ = boost::lexical_cast<unsigned short>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-buffers" && argc > 1)
+    {
+      bufferCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-window" && argc > 1)
+    {
+      window_ = std::max(size_t(1), boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-pin")
+    {
+      pin_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-cpus" && argc > 1)
+    {
+      std::string list(argv[1]);
+      std::replace(list.begin(), list.end(), ',', ' ');
+      std::istringstream cpus(list);
+      int cpu;
+      while(cpus >> cpu)
+      {
+        cpus_.push_back(cpu);
+      }
+      consumed = 2;
+    }
+    else if(opt == "-32")
+    {
+      use32_ = true;
+      use64_ = false;
+      consumed = 1;
+    }
+    else if(opt == "-64")
+    {
+      use32_ = false;
+      use64_ = true;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+ChannelScaling::usage(std::ostream & out) const
+{
+  out << "  -t file       : Template file (required)." << std::endl;
+  out << "  -f file       : PCap file containing one or more multicast feeds (required)." << std::endl;
+  out << "                  Each destination address:port is decoded as a separate channel." << std::endl;
+  out << "  -threads n    : Measure 1 through n threads (default is the number of CPUs)." << std::endl;
+  out << "  -group ip     : Replay channel n to multicast group ip + n (default 239.255.1.1)." << std::endl;
+  out << "  -port n       : Replay to UDP port n (default 30001)." << std::endl;
+  out << "  -buffers n    : Receive buffers per channel (default 64)." << std::endl;
+  out << "  -window n     : Packets per channel waiting to be decoded before the replay" << std::endl;
+  out << "                  pauses (default 32)." << std::endl;
+  out << "  -pin          : Pin thread n to CPU n." << std::endl;
+  out << "  -cpus list    : Pin threads to a comma separated list of CPUs." << std::endl;
+  out << "  -32           : Data file was captured on 32 bit system." << std::endl;
+  out << "  -64           : Data file was captured on 64 bit system." << std::endl;
+}
+
+bool
+ChannelScaling::applyArgs()
+{
+  bool ok = true;
+  try
+  {
+    if(templateFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+    }
+    if(pcapFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -f [pcapfile] option is required." << std::endl;
+    }
+    if(!ok)
+    {
+      commandArgParser_.usage(std::cerr);
+      return false;
+    }
+    std::ifstream templates(templateFileName_.c_str(), std::ios::in | std::ios::binary);
+    if(!templates.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return false;
+    }
+    Codecs::XMLTemplateParser parser;
+    registry_ = parser.parse(templates);
+
+    flows_.reset(new Application::PCapFlowDecoder(registry_, configuration_));
+    flows_->reader().set32bit(use32_);
+    flows_->reader().set64bit(use64_);
+    if(flows_->open(pcapFileName_) == 0)
+    {
+      std::cerr << "ERROR: No UDP packets found in " << pcapFileName_ << std::endl;
+      return false;
+    }
+
+    if(maxThreads_ == 0)
+    {
+      maxThreads_ = boost::thread::hardware_concurrency();
+      if(maxThreads_ == 0)
+      {
+        maxThreads_ = 1;
+      }
+    }
+    if(pin_ && cpus_.empty())
+    {
+      for(size_t nCpu = 0; nCpu < maxThreads_; ++nCpu)
+      {
+        cpus_.push_back(int(nCpu));
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+int
+ChannelScaling::run()
+{
+  try
+  {
+    for(size_t nFlow = 0; nFlow < flows_->flowCount(); ++nFlow)
+    {
+      std::cout << "Channel " << flows_->flow(nFlow).name_ << ": "
+        << flows_->flow(nFlow).packets_.size() << " packets." << std::endl;
+    }
+    std::cout << "threads   messages       msec      msg/sec  speedup  lost" << std::endl;
+    double baseRate = 0.0;
+    for(size_t threadCount = 1; threadCount <= maxThreads_; ++threadCount)
+    {
+      unsigned long lapse = 0;
+      size_t lost = 0;
+      size_t messageCount = decodeAll(threadCount, lapse, lost);
+      double rate = 1000. * double(messageCount) / double(std::max(lapse, 1UL));
+      if(threadCount == 1)
+      {
+        baseRate = rate;
+      }
+      std::cout << std::setw(7) << threadCount
+        << std::setw(11) << messageCount
+        << std::setw(11) << lapse
+        << std::setw(13) << std::fixed << std::setprecision(0) << rate
+        << std::setw(9) << std::setprecision(2) << (baseRate > 0.0 ? rate / baseRate : 0.0)
+        << std::setw(6) << lost
+        << std::endl;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+size_t
+ChannelScaling::decodeAll(size_t threadCount, unsigned long & lapse, size_t & lost)
+{
+  Application::MultiChannelConnection connection(registry_);
+  std::vector<boost::shared_ptr<PerformanceBuilder> > builders;
+  std::vector<boost::asio::ip::udp::endpoint> destinations;
+  unsigned long group = boost::asio::ip::address_v4::from_string(group_).to_ulong();
+  for(size_t nFlow = 0; nFlow < flows_->flowCount(); ++nFlow)
+  {
+    boost::asio::ip::address_v4 address(group + nFlow);
+    destinations.push_back(boost::asio::ip::udp::endpoint(address, port_));
+    Application::DecoderConfiguration configuration(configuration_);
+    configuration.setMulticastGroupIP(address.to_string());
+    configuration.setListenInterfaceIP("127.0.0.1");
+    configuration.setPortNumber(port_);
+    configuration.setBufferCount(bufferCount_);
+    configuration.setExtra("channel", flows_->flow(nFlow).name_);
+    builders.push_back(boost::shared_ptr<PerformanceBuilder>(new PerformanceBuilder));
+    connection.addChannel(configuration, *builders.back());
+  }
+  connection.start();
+  connection.setThreadAffinity(cpus_);
+  connection.runThreads(threadCount, false);
+
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket socket(ioService, boost::asio::ip::udp::v4());
+  socket.set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::loopback()));
+  socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+
+  // Send the flows round-robin, a packet at a time; each flow stays in capture order.
+  size_t longest = 0;
+  for(size_t nFlow = 0; nFlow < flows_->flowCount(); ++nFlow)
+  {
+    longest = std::max(longest, flows_->flow(nFlow).packets_.size());
+  }
+  const size_t window = window_ * flows_->flowCount();
+  size_t sent = 0;
+  size_t processed = 0;
+  lost = 0;
+  uint64 start = Common::wallClockNanoseconds();
+  uint64 progress = start;
+  for(size_t nPacket = 0; nPacket < longest; ++nPacket)
+  {
+    for(size_t nFlow = 0; nFlow < flows_->flowCount(); ++nFlow)
+    {
+      const Application::PCapFlowDecoder::Flow & flow = flows_->flow(nFlow);
+      if(nPacket < flow.packets_.size())
+      {
+        if(sent - lost - processed >= window
+          && !waitForDecoders(connection, sent - lost - window + 1, processed, progress))
+        {
+          lost = sent - processed;
+        }
+        const Application::PCapFlowDecoder::Packet & packet = flow.packets_[nPacket];
+        socket.send_to(boost::asio::buffer(packet.data_, packet.size_), destinations[nFlow]);
+        ++sent;
+      }
+    }
+  }
+  (void)waitForDecoders(connection, sent - lost, processed, progress);
+  lapse = (unsigned long)((progress - start) / 1000000);
+  lost = sent - processed;
+
+  connection.stop();
+  connection.joinThreads();
+
+  size_t messageCount = 0;
+  for(size_t nChannel = 0; nChannel < builders.size(); ++nChannel)
+  {
+    messageCount += builders[nChannel]->msgCount();
+  }
+  return messageCount;
+}
+
+bool
+ChannelScaling::waitForDecoders(
+  Application::MultiChannelConnection & connection,
+  size_t target,
+  size_t & processed,
+  uint64 & progress)
+{
+  uint64 waitStart = Common::wallClockNanoseconds();
+  while(processed < target)
+  {
+    size_t now = packetsProcessed(connection);
+    uint64 time = Common::wallClockNanoseconds();
+    if(now != processed)
+    {
+      processed = now;
+      progress = time;
+      waitStart = time;
+    }
+    else if(time - waitStart > stallNanoseconds)
+    {
+      // the rest were dropped; carry on without them.
+      return false;
+    }
+    else
+    {
+      // don't compete with the decoding threads for a CPU.
+      boost::this_thread::sleep(boost::posix_time::microseconds(50));
+    }
+  }
+  return true;
+}
+
+void
+ChannelScaling::fini()
+{
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef CHANNELSCALING_H
+#define CHANNELSCALING_H
+
+#include <Examples/CommandArgParser.h>
+#include <Examples/DecoderConfigurationArgs.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Application/PCapFlowDecoder.h>
+#include <Application/DecoderConfiguration.h>
+#include <Application/MultiChannelConnection_fwd.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Measure how decoding many channels scales with the number of threads.
+    ///
+    /// The packets in a PCap file are split into channels by destination address and port
+    /// (Application::PCapFlowDecoder::open()).
+    /// Each channel is added to an Application::MultiChannelConnection, which is run
+    /// using 1, 2, ... N threads (MultiChannelConnection::runThreads()).  The capture is
+    /// replayed to the channels over loopback multicast -- channel n receives group
+    /// -group + n -- so the measurement includes the connection's own scheduling:
+    /// any idle thread picks up whichever channel has data ready, but a channel is never
+    /// decoded by two threads at once.
+    ///
+    /// The replay is paced so no more than -window packets per channel are waiting to be
+    /// decoded; that keeps the socket buffers from overflowing, so the decoders rather than
+    /// the sender set the rate.  Packets that are lost anyway are reported.
+    ///
+    /// The report shows messages per second and the speedup relative to a single thread.
+    ///
+    /// Use the -? command line option for more information.
+    class ChannelScaling : public CommandArgHandler
+    {
+    public:
+      ChannelScaling();
+      ~ChannelScaling();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      size_t decodeAll(size_t threadCount, unsigned long & lapse, size_t & lost);
+      bool waitForDecoders(
+        Application::MultiChannelConnection & connection,
+        size_t target,
+        size_t & processed,
+        uint64 & progress);
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string templateFileName_;
+      std::string pcapFileName_;
+      size_t maxThreads_;
+      std::string group_;
+      unsigned short port_;
+      size_t bufferCount_;
+      size_t window_;
+      bool pin_;
+      std::vector<int> cpus_;
+      bool use32_;
+      bool use64_;
+      Application::DecoderConfiguration configuration_;
+      DecoderConfigurationArgs configurationArgs_;
+
+      Codecs::TemplateRegistryPtr registry_;
+      boost::scoped_ptr<Application::PCapFlowDecoder> flows_;
+    };
+  }
+}
+#endif // CHANNELSCALING_H
@@ -0,0 +1,403 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "EncodePerformanceTest.h"
+#include <Examples/AllocationReport.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceBuffer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Messages/Message.h>
+#include <Examples/LatencyReport.h>
+#include <Examples/StopWatch.h>
+#include <Common/Profiler.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+EncodePerformanceTest::EncodePerformanceTest()
+  : resetOnMessage_(false)
+  , performanceFile_(0)
+  , head_(0)
+  , count_(10)
+  , verify_(true)
+{
+}
+
+EncodePerformanceTest::~EncodePerformanceTest()
+{
+}
+
+bool
+EncodePerformanceTest::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+EncodePerformanceTest::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-r")
+    {
+      resetOnMessage_ = !resetOnMessage_;
+      consumed = 1;
+    }
+    else if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-f" && argc > 1)
+    {
+      fastFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-p" && argc > 1)
+    {
+      performanceFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-json" && argc > 1)
+    {
+      jsonFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-head" && argc > 1)
+    {
+      head_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-c" && argc > 1)
+    {
+      count_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-noverify")
+    {
+      verify_ = false;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+EncodePerformanceTest::usage(std::ostream & out) const
+{
+  out << "  -t file     : Template file (required)" << std::endl;
+  out << "  -f file     : FAST Message file (required)" << std::endl;
+  out << "  -p file     : File to which performance measurements are written. (default standard output)" << std::endl;
+  out << "  -json file  : Write the latency report to file as JSON." << std::endl;
+  out << "  -head n     : use only the first 'n' messages" << std::endl;
+  out << "  -c count    : encode the messages 'count' times (default 10)" << std::endl;
+  out << "  -r          : Toggle 'reset encoder on every message' (default false)." << std::endl;
+  out << "                Must match the way the FAST Message file was encoded." << std::endl;
+  out << "  -noverify   : Do not compare the encoded messages to the FAST Message file." << std::endl;
+}
+
+bool
+EncodePerformanceTest::applyArgs()
+{
+  bool ok = true;
+  if(templateFileName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+  }
+  if(fastFileName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -f [FASTfile] option is required." << std::endl;
+  }
+  if(count_ == 0)
+  {
+    ok = false;
+    std::cerr << "ERROR: -c must be greater than zero." << std::endl;
+  }
+  if(ok && !performanceFileName_.empty())
+  {
+    performanceFile_ = new std::ofstream(performanceFileName_.c_str());
+    if(!performanceFile_->good())
+    {
+      ok = false;
+      std::cerr << "ERROR: Can't open performance output file: "
+        << performanceFileName_
+        << std::endl;
+    }
+  }
+  else
+  {
+    performanceFile_ = & std::cout;
+  }
+  if(!ok)
+  {
+    commandArgParser_.usage(std::cerr);
+  }
+  return ok;
+}
+
+void
+EncodePerformanceTest::decodeInput(
+  Codecs::TemplateRegistryPtr registry,
+  const std::string & input,
+  Samples & samples)
+{
+  Codecs::DataSourceBuffer source(reinterpret_cast<const uchar *>(input.data()), input.size());
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::Decoder decoder(registry);
+  while((head_ == 0 || samples.size() < head_) && source.messageAvailable() > 0)
+  {
+    if(resetOnMessage_)
+    {
+      decoder.reset();
+    }
+    Sample sample;
+    sample.offset_ = size_t(source.bytesConsumed());
+    decoder.decodeMessage(source, builder);
+    sample.size_ = size_t(source.bytesConsumed()) - sample.offset_;
+    sample.templateId_ = decoder.getTemplateId();
+    Messages::FieldSetPtr message(new Messages::FieldSet(1));
+    message->swap(consumer.message());
+    sample.message_ = message;
+    samples.push_back(sample);
+  }
+}
+
+bool
+EncodePerformanceTest::verify(
+  Codecs::TemplateRegistryPtr registry,
+  const std::string & input,
+  const Samples & samples)
+{
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  std::string encoded;
+  std::string output;
+  size_t identical = 0;
+  for(size_t nMessage = 0; nMessage < samples.size(); ++nMessage)
+  {
+    const Sample & sample = samples[nMessage];
+    if(resetOnMessage_)
+    {
+      encoder.reset();
+    }
+    destination.clear();
+    encoder.encodeMessage(destination, sample.templateId_, *sample.message_);
+    destination.toString(encoded);
+    if(input.compare(sample.offset_, sample.size_, encoded) == 0)
+    {
+      ++identical;
+    }
+    output += encoded;
+  }
+  (*performanceFile_) << "Verify: " << identical << " of " << samples.size()
+    << " messages encoded exactly as in the input." << std::endl;
+  if(identical == samples.size())
+  {
+    return true;
+  }
+
+  // The encoder may have made different (valid) choices.  Make sure the values survived.
+  Codecs::DataSourceBuffer source(reinterpret_cast<const uchar *>(output.data()), output.size());
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::Decoder decoder(registry);
+  size_t failures = 0;
+  for(size_t nMessage = 0; nMessage < samples.size(); ++nMessage)
+  {
+    std::stringstream reason;
+    bool same = false;
+    try
+    {
+      if(resetOnMessage_)
+      {
+        decoder.reset();
+      }
+      decoder.decodeMessage(source, builder);
+      same = decoder.getTemplateId() == samples[nMessage].templateId_
+        && consumer.message().equals(*samples[nMessage].message_, reason);
+    }
+    catch (std::exception & ex)
+    {
+      reason << ex.what();
+    }
+    if(!same)
+    {
+      if(failures == 0)
+      {
+        std::cerr << "ERROR: Message " << nMessage
+          << " [template " << samples[nMessage].templateId_ << "]"
+          << " did not survive encoding: " << reason.str() << std::endl;
+      }
+      ++failures;
+      if(decoder.getTemplateId() != samples[nMessage].templateId_)
+      {
+        // the rest of the output cannot be trusted.
+        failures += samples.size() - nMessage - 1;
+        break;
+      }
+    }
+  }
+  (*performanceFile_) << "Verify: " << samples.size() - failures << " of " << samples.size()
+    << " messages decoded to the original values." << std::endl;
+  return failures == 0;
+}
+
+int
+EncodePerformanceTest::run()
+{
+  int result = 0;
+  try
+  {
+    std::ifstream templateFile(templateFileName_.c_str(), std::ios::in
+#ifdef _WIN32
+      | std::ios::binary
+#endif
+      );
+    if(!templateFile.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return -1;
+    }
+    std::ifstream fastFile(fastFileName_.c_str(), std::ios::in | std::ios::binary);
+    if(!fastFile.good())
+    {
+      std::cerr << "ERROR: Can't open FAST Message file: " << fastFileName_ << std::endl;
+      return -1;
+    }
+    std::string input(
+      (std::istreambuf_iterator<char>(fastFile)),
+      std::istreambuf_iterator<char>());
+
+    std::cout << "Parsing templates" << std::endl;
+    Codecs::XMLTemplateParser parser;
+    Codecs::TemplateRegistryPtr registry = parser.parse(templateFile);
+
+    std::cout << "Decoding input" << std::endl;
+    Samples samples;
+    decodeInput(registry, input, samples);
+    if(samples.empty())
+    {
+      std::cerr << "ERROR: No messages found in " << fastFileName_ << std::endl;
+      return -1;
+    }
+    if(verify_ && !verify(registry, input, samples))
+    {
+      result = -1;
+    }
+
+    LatencyReport latency(ProfileAccumulator::nanosecondsPerTick(), 10, "Encode");
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    size_t messageCount = samples.size();
+    size_t passBytes = 0;
+
+    // one untimed pass so buffers reach their working size.
+    for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+    {
+      if(resetOnMessage_)
+      {
+        encoder.reset();
+      }
+      destination.clear();
+      encoder.encodeMessage(destination, samples[nMessage].templateId_, *samples[nMessage].message_);
+      for(size_t nBuffer = 0; nBuffer < destination.size(); ++nBuffer)
+      {
+        passBytes += destination[nBuffer].size();
+      }
+    }
+
+    Common::AllocationCounter::Snapshot allocationsBefore;
+    StopWatch encodeTimer;
+    for(size_t nPass = 0; nPass < count_; ++nPass)
+    {
+      encoder.reset();
+      for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+      {
+        const Sample & sample = samples[nMessage];
+        uint64 start = profilerTicks();
+        if(resetOnMessage_)
+        {
+          encoder.reset();
+        }
+        destination.clear();
+        encoder.encodeMessage(destination, sample.templateId_, *sample.message_);
+        latency.record(sample.templateId_, profilerTicks() - start, nMessage, sample.offset_);
+      }
+    }
+    unsigned long encodeLapse = encodeTimer.freeze();
+    Common::AllocationCounter::Snapshot allocations = Common::AllocationCounter::Snapshot().since(allocationsBefore);
+    size_t totalMessages = messageCount * count_;
+    uint64 bytesEncoded = uint64(passBytes) * count_;
+
+    (*performanceFile_)
+#ifdef _DEBUG
+      << "[debug] "
+#endif // _DEBUG
+      << "Encoded " << totalMessages << " messages in "
+      << std::fixed << std::setprecision(3)
+      << encodeLapse
+      << " milliseconds. [";
+    if(encodeLapse != 0)
+    {
+      (*performanceFile_) << std::fixed << std::setprecision(3)
+        << 1000 * double(encodeLapse)/double(totalMessages) << " usec/message. = "
+        << std::fixed << std::setprecision(3)
+        << 1000. * double(totalMessages)/double(encodeLapse) << " messages/second]"
+        << std::endl;
+      (*performanceFile_)
+        << "      Bytes: " << bytesEncoded << " -> "
+        << std::fixed << std::setprecision(3)
+        << 1000. * double(bytesEncoded)/double(encodeLapse)/(1024. * 1024.) << " MB/second"
+        << std::endl;
+    }
+    else
+    {
+      (*performanceFile_) << "]" << std::endl;
+    }
+    AllocationReport::writeText(*performanceFile_, allocations, totalMessages);
+    latency.writeText(*performanceFile_);
+    if(!jsonFileName_.empty())
+    {
+      std::ofstream json(jsonFileName_.c_str());
+      latency.writeJson(json, fastFileName_);
+      if(!json.good())
+      {
+        std::cerr << "ERROR: Can't write JSON output file: " << jsonFileName_ << std::endl;
+      }
+    }
+  }
+  catch (std::exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    result = -1;
+  }
+  return result;
+}
+
+void
+EncodePerformanceTest::fini()
+{
+  if(performanceFile_ != 0 && performanceFile_ != & std::cout)
+  {
+    delete performanceFile_;
+  }
+  performanceFile_ = 0;
+}
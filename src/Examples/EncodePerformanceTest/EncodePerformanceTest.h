@@ -0,0 +1,78 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef ENCODEPERFORMANCETEST_H
+#define ENCODEPERFORMANCETEST_H
+
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Messages/FieldSet_fwd.h>
+#include <Examples/CommandArgParser.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Measure the time used to encode the messages in a file.
+    ///
+    /// The counterpart of PerformanceTest.  The file is decoded once into
+    /// Messages::Message objects which are then encoded repeatedly.
+    /// Reports messages and bytes per second, the latency of each encodeMessage()
+    /// call by template, and the number of heap allocations per message.
+    /// Allocations are counted by Common::AllocationCounter; main.cpp installs it.
+    ///
+    /// Before timing starts the messages are encoded once and the result is
+    /// compared to the original file.  If the bytes differ (an encoder may make
+    /// different but valid choices) the result is decoded and compared field by field.
+    ///
+    /// Run the program with a -? command line option for detailed usage information.
+    class EncodePerformanceTest : public CommandArgHandler
+    {
+    public:
+      EncodePerformanceTest();
+      ~EncodePerformanceTest();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      struct Sample
+      {
+        template_id_t templateId_;
+        Messages::FieldSetCPtr message_;
+        // position and size of the original encoding in the input.
+        size_t offset_;
+        size_t size_;
+      };
+      typedef std::vector<Sample> Samples;
+
+      void decodeInput(Codecs::TemplateRegistryPtr registry, const std::string & input, Samples & samples);
+      bool verify(Codecs::TemplateRegistryPtr registry, const std::string & input, const Samples & samples);
+
+    private:
+      CommandArgParser commandArgParser_;
+      bool resetOnMessage_;
+      std::string templateFileName_;
+      std::string fastFileName_;
+      std::string performanceFileName_;
+      std::ostream * performanceFile_;
+      std::string jsonFileName_;
+      size_t head_;
+      size_t count_;
+      bool verify_;
+    };
+  }
+}
+#endif // ENCODEPERFORMANCETEST_H
@@ -0,0 +1,28 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+
+#include <Examples/ExamplesPch.h>
+#include <Examples/EncodePerformanceTest/EncodePerformanceTest.h>
+
+#include <Common/AllocationCounter.h>
+#include <new>
+#include <cstdlib>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+QUICKFAST_COUNT_ALLOCATIONS
+
+int main(int argc, char* argv[])
+{
+  int result = -1;
+  EncodePerformanceTest application;
+  if(application.init(argc, argv))
+  {
+    result = application.run();
+    application.fini();
+  }
+  return result;
+}
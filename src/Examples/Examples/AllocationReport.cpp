@@ -0,0 +1,56 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+
+#include <Examples/ExamplesPch.h>
+#include "AllocationReport.h"
+
+using namespace QuickFAST;
+using namespace Examples;
+
+void
+AllocationReport::writeText(
+  std::ostream & out,
+  const Common::AllocationCounter::Snapshot & counts,
+  size_t messageCount)
+{
+  if(!Common::AllocationCounter::enabled())
+  {
+    out << "      Allocations: not counted by this program." << std::endl;
+    return;
+  }
+  std::ios::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+  double messages = double(messageCount == 0 ? 1 : messageCount);
+  out << "      Allocations per message:" << std::endl;
+  out << "      " << std::setw(10) << "phase"
+    << std::setw(14) << "allocations" << std::setw(12) << "bytes" << std::setw(12) << "frees" << std::endl;
+  for(size_t nPhase = 0; nPhase < Common::AllocationCounter::PHASE_COUNT; ++nPhase)
+  {
+    const Common::AllocationCounter::Counts & phase = counts.phases_[nPhase];
+    if(phase.allocations_ != 0 || phase.deallocations_ != 0)
+    {
+      out << "      " << std::setw(10)
+        << Common::AllocationCounter::phaseName(Common::AllocationCounter::Phase(nPhase))
+        << std::fixed << std::setprecision(3)
+        << std::setw(14) << double(phase.allocations_) / messages
+        << std::setprecision(1)
+        << std::setw(12) << double(phase.bytes_) / messages
+        << std::setprecision(3)
+        << std::setw(12) << double(phase.deallocations_) / messages
+        << std::endl;
+    }
+  }
+  Common::AllocationCounter::Counts total = counts.total();
+  out << "      " << std::setw(10) << "all"
+    << std::fixed << std::setprecision(3)
+    << std::setw(14) << double(total.allocations_) / messages
+    << std::setprecision(1)
+    << std::setw(12) << double(total.bytes_) / messages
+    << std::setprecision(3)
+    << std::setw(12) << double(total.deallocations_) / messages
+    << std::endl;
+  out.flags(flags);
+  out.precision(precision);
+}
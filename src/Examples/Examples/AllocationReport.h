@@ -0,0 +1,30 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ALLOCATIONREPORT_H
+#define ALLOCATIONREPORT_H
+#include <Common/AllocationCounter.h>
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Write the heap allocations per message by phase.
+    ///
+    /// The program must expand QUICKFAST_COUNT_ALLOCATIONS (see Common::AllocationCounter)
+    /// for there to be anything to report.
+    class AllocationReport
+    {
+    public:
+      /// @brief Write a human readable report.
+      /// @param out receives the report.
+      /// @param counts are the allocations made while processing the messages.
+      /// @param messageCount is the number of messages processed.
+      static void writeText(
+        std::ostream & out,
+        const Common::AllocationCounter::Snapshot & counts,
+        size_t messageCount);
+    };
+  }
+}
+#endif /* ALLOCATIONREPORT_H */
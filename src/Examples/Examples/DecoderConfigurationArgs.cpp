@@ -0,0 +1,137 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+
+#include <Examples/ExamplesPch.h>
+#include "DecoderConfigurationArgs.h"
+#include <Application/DecoderConfiguration.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+DecoderConfigurationArgs::DecoderConfigurationArgs(Application::DecoderConfiguration & configuration)
+: configuration_(configuration)
+{
+}
+
+DecoderConfigurationArgs::~DecoderConfigurationArgs()
+{
+}
+
+int
+DecoderConfigurationArgs::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-reset")
+    {
+      configuration_.setReset(!configuration_.reset());
+      consumed = 1;
+    }
+    else if(opt == "-strict")
+    {
+      configuration_.setStrict(!configuration_.strict());
+      consumed = 1;
+    }
+    else if(opt == "-hnone" )
+    {
+      configuration_.setMessageHeaderType(Application::DecoderConfiguration::NO_HEADER);
+      consumed = 1;
+    }
+    else if(opt == "-hfix" && argc > 1)
+    {
+      configuration_.setMessageHeaderType(Application::DecoderConfiguration::FIXED_HEADER);
+      configuration_.setMessageHeaderMessageSizeBytes(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-hfast" )
+    {
+      configuration_.setMessageHeaderType(Application::DecoderConfiguration::FAST_HEADER);
+      consumed = 1;
+    }
+    else if(opt == "-hprefix" && argc > 1)
+    {
+      configuration_.setMessageHeaderPrefixCount(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-hsuffix" && argc > 1)
+    {
+      configuration_.setMessageHeaderSuffixCount(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-hbig" )
+    {
+      configuration_.setMessageHeaderBigEndian(true);
+      consumed = 1;
+    }
+    else if(opt == "-pnone" )
+    {
+      configuration_.setPacketHeaderType(Application::DecoderConfiguration::NO_HEADER);
+      consumed = 1;
+    }
+    else if(opt == "-pfix" && argc > 1)
+    {
+      configuration_.setPacketHeaderType(Application::DecoderConfiguration::FIXED_HEADER);
+      configuration_.setPacketHeaderMessageSizeBytes(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-pfast" )
+    {
+      configuration_.setPacketHeaderType(Application::DecoderConfiguration::FAST_HEADER);
+      consumed = 1;
+    }
+    else if(opt == "-pprefix" && argc > 1)
+    {
+      configuration_.setPacketHeaderPrefixCount(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-psuffix" && argc > 1)
+    {
+      configuration_.setPacketHeaderSuffixCount(boost::lexical_cast<size_t>(argv[1]));
+      consumed = 2;
+    }
+    else if(opt == "-pbig" )
+    {
+      configuration_.setPacketHeaderBigEndian(true);
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+DecoderConfigurationArgs::usage(std::ostream & out) const
+{
+  out << "  -reset        : Toggle 'reset decoder on every message' (default false)." << std::endl;
+  out << "  -strict       : Toggle 'strict decoding rules' (default true)." << std::endl;
+  out << std::endl;
+  out << "  -hnone        : No header(preamble) before each FAST message (default)." << std::endl;
+  out << "  -hfix n       : Message header contains fixed size fields;" << std::endl;
+  out << "                  block size field is n bytes:" << std::endl;
+  out << "  -hbig         : fixed size header is big-endian." << std::endl;
+  out << "  -hfast        : Message header contains fast encoded fields:" << std::endl;
+  out << "  -hprefix n    : 'n' bytes (fixed) or fields (FAST) precede block size." << std::endl;
+  out << "  -hsuffix n    : 'n' bytes (fixed) or fields (FAST) follow block size." << std::endl;
+  out << std::endl;
+  out << "  -pnone        : No header(preamble) in packet (default)." << std::endl;
+  out << "  -pfix n       : Packet header contains fixed size fields;" << std::endl;
+  out << "                  block size field is n bytes:" << std::endl;
+  out << "  -pbig         : fixed size header is big-endian." << std::endl;
+  out << "  -pfast        : Packet header contains fast encoded fields:" << std::endl;
+  out << "  -pprefix n    : 'n' bytes (fixed) or fields (FAST) precede block size." << std::endl;
+  out << "  -psuffix n    : 'n' bytes (fixed) or fields (FAST) follow block size." << std::endl;
+}
+
+bool
+DecoderConfigurationArgs::applyArgs()
+{
+  return true;
+}
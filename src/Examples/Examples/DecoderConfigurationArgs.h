@@ -0,0 +1,35 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DECODERCONFIGURATIONARGS_H
+#define DECODERCONFIGURATIONARGS_H
+#include <Examples/CommandArgHandler.h>
+#include <Application/DecoderConfiguration_fwd.h>
+namespace QuickFAST{
+  namespace Examples{
+
+    /// @brief Command line options for the decoding rules and the packet and message headers.
+    ///
+    /// Handles -reset, -strict, -h... and -p... by updating a DecoderConfiguration.
+    /// Add it to a CommandArgParser next to the program's own handler.
+    class DecoderConfigurationArgs : public CommandArgHandler
+    {
+    public:
+      /// @brief Construct
+      /// @param configuration is updated as options are parsed.  It must outlive this object.
+      explicit DecoderConfigurationArgs(Application::DecoderConfiguration & configuration);
+      ~DecoderConfigurationArgs();
+
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      Application::DecoderConfiguration & configuration_;
+    };
+  }
+}
+#endif // DECODERCONFIGURATIONARGS_H
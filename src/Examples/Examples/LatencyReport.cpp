@@ -0,0 +1,200 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+
+#include <Examples/ExamplesPch.h>
+#include "LatencyReport.h"
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  struct Percentile
+  {
+    const char * name_;
+    double fraction_;
+  };
+  const Percentile percentiles[] =
+  {
+    {"p50", 0.50},
+    {"p90", 0.90},
+    {"p99", 0.99},
+    {"p99.9", 0.999}
+  };
+  const size_t percentileCount = sizeof(percentiles) / sizeof(percentiles[0]);
+}
+
+LatencyReport::LatencyReport(double nanosecondsPerTick, size_t worstCount, const std::string & activity)
+  : nanosecondsPerTick_(nanosecondsPerTick)
+  , activity_(activity)
+  , worstCount_(worstCount)
+  , lastTemplateId_(0)
+  , lastHistogram_(0)
+  , worstThreshold_(0)
+{
+}
+
+LatencyReport::~LatencyReport()
+{
+}
+
+Common::LatencyHistogram &
+LatencyReport::histogram(template_id_t templateId)
+{
+  HistogramPtr & result = histograms_[templateId];
+  if(!result)
+  {
+    result.reset(new Common::LatencyHistogram);
+  }
+  return *result;
+}
+
+void
+LatencyReport::addWorst(template_id_t templateId, uint64 ticks, size_t messageNumber, uint64 offset)
+{
+  if(worstCount_ == 0)
+  {
+    return;
+  }
+  Worst entry;
+  entry.templateId_ = templateId;
+  entry.ticks_ = ticks;
+  entry.messageNumber_ = messageNumber;
+  entry.offset_ = offset;
+  std::vector<Worst>::iterator pos = worst_.begin();
+  while(pos != worst_.end() && pos->ticks_ >= ticks)
+  {
+    ++pos;
+  }
+  worst_.insert(pos, entry);
+  if(worst_.size() > worstCount_)
+  {
+    worst_.pop_back();
+  }
+  if(worst_.size() == worstCount_)
+  {
+    worstThreshold_ = worst_.back().ticks_;
+  }
+}
+
+void
+LatencyReport::total(Common::LatencyHistogram & all)const
+{
+  for(Histograms::const_iterator it = histograms_.begin(); it != histograms_.end(); ++it)
+  {
+    all.merge(*it->second);
+  }
+}
+
+void
+LatencyReport::writeText(std::ostream & out)const
+{
+  std::ios::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+  Common::LatencyHistogram all;
+  total(all);
+  out << "      " << activity_ << " latency in nanoseconds:" << std::endl;
+  out << "      " << std::setw(10) << "template" << std::setw(12) << "count";
+  for(size_t nPercentile = 0; nPercentile < percentileCount; ++nPercentile)
+  {
+    out << std::setw(10) << percentiles[nPercentile].name_;
+  }
+  out << std::setw(12) << "max" << std::endl;
+
+  Histograms::const_iterator it = histograms_.begin();
+  for(size_t nRow = 0; nRow <= histograms_.size(); ++nRow)
+  {
+    const Common::LatencyHistogram * histogram = &all;
+    out << "      ";
+    if(it != histograms_.end())
+    {
+      out << std::setw(10) << it->first;
+      histogram = it->second.get();
+      ++it;
+    }
+    else
+    {
+      out << std::setw(10) << "all";
+    }
+    out << std::setw(12) << histogram->count();
+    for(size_t nPercentile = 0; nPercentile < percentileCount; ++nPercentile)
+    {
+      out << std::setw(10) << std::fixed << std::setprecision(0)
+        << double(histogram->percentile(percentiles[nPercentile].fraction_)) * nanosecondsPerTick_;
+    }
+    out << std::setw(12) << std::fixed << std::setprecision(0)
+      << double(histogram->maximum()) * nanosecondsPerTick_ << std::endl;
+  }
+
+  out << "      Slowest messages:" << std::endl;
+  for(size_t nWorst = 0; nWorst < worst_.size(); ++nWorst)
+  {
+    const Worst & entry = worst_[nWorst];
+    out << "        " << std::fixed << std::setprecision(0)
+      << double(entry.ticks_) * nanosecondsPerTick_ << " ns: message " << entry.messageNumber_
+      << " template " << entry.templateId_
+      << " at byte offset " << entry.offset_ << std::endl;
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void
+LatencyReport::writeJsonStatistics(std::ostream & out, const Common::LatencyHistogram & histogram)const
+{
+  out << "\"count\": " << histogram.count()
+    << ", \"mean_ns\": " << std::fixed << std::setprecision(1) << histogram.mean() * nanosecondsPerTick_;
+  for(size_t nPercentile = 0; nPercentile < percentileCount; ++nPercentile)
+  {
+    out << ", \"" << percentiles[nPercentile].name_ << "_ns\": "
+      << std::fixed << std::setprecision(0)
+      << double(histogram.percentile(percentiles[nPercentile].fraction_)) * nanosecondsPerTick_;
+  }
+  out << ", \"max_ns\": " << std::fixed << std::setprecision(0)
+    << double(histogram.maximum()) * nanosecondsPerTick_;
+}
+
+void
+LatencyReport::writeJson(std::ostream & out, const std::string & input)const
+{
+  Common::LatencyHistogram all;
+  total(all);
+  out << "{" << std::endl;
+  out << "  \"input\": \"";
+  for(std::string::const_iterator pos = input.begin(); pos != input.end(); ++pos)
+  {
+    if(*pos == '"' || *pos == '\\')
+    {
+      out << '\\';
+    }
+    out << *pos;
+  }
+  out << "\"," << std::endl;
+  out << "  \"all\": {";
+  writeJsonStatistics(out, all);
+  out << "}," << std::endl;
+  out << "  \"templates\": [";
+  for(Histograms::const_iterator it = histograms_.begin(); it != histograms_.end(); ++it)
+  {
+    out << (it == histograms_.begin() ? "" : ",") << std::endl;
+    out << "    {\"id\": " << it->first << ", ";
+    writeJsonStatistics(out, *it->second);
+    out << "}";
+  }
+  out << std::endl << "  ]," << std::endl;
+  out << "  \"worst\": [";
+  for(size_t nWorst = 0; nWorst < worst_.size(); ++nWorst)
+  {
+    const Worst & entry = worst_[nWorst];
+    out << (nWorst == 0 ? "" : ",") << std::endl;
+    out << "    {\"template\": " << entry.templateId_
+      << ", \"message\": " << entry.messageNumber_
+      << ", \"offset\": " << entry.offset_
+      << ", \"ns\": " << std::fixed << std::setprecision(0) << double(entry.ticks_) * nanosecondsPerTick_
+      << "}";
+  }
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LATENCYREPORT_H
+#define LATENCYREPORT_H
+#include <Common/Types.h>
+#include <Common/LatencyHistogram.h>
+namespace QuickFAST{
+  namespace Examples{
+
+    /// @brief Collect the time taken to decode (or encode) each message.
+    ///
+    /// Times are kept in a histogram per template id so the tail (p99, p99.9, max)
+    /// can be reported rather than just the average.  The slowest messages are remembered
+    /// along with their position in the input so they can be examined.
+    class LatencyReport
+    {
+    public:
+      /// @brief Construct
+      /// @param nanosecondsPerTick converts the recorded times to nanoseconds.
+      /// @param worstCount is the number of slowest messages to remember.
+      /// @param activity names what was timed in the text report.
+      LatencyReport(double nanosecondsPerTick, size_t worstCount = 10, const std::string & activity = "Decode");
+      ~LatencyReport();
+
+      /// @brief Record the time taken to process one message
+      /// @param templateId identifies the message's template
+      /// @param ticks is the time it took
+      /// @param messageNumber counts messages from zero.
+      /// @param offset is the position of the message in the input.
+      void record(template_id_t templateId, uint64 ticks, size_t messageNumber, uint64 offset)
+      {
+        if(templateId != lastTemplateId_ || lastHistogram_ == 0)
+        {
+          lastHistogram_ = & histogram(templateId);
+          lastTemplateId_ = templateId;
+        }
+        lastHistogram_->record(ticks);
+        if(ticks > worstThreshold_)
+        {
+          addWorst(templateId, ticks, messageNumber, offset);
+        }
+      }
+
+      /// @brief Write a human readable report.
+      void writeText(std::ostream & out)const;
+
+      /// @brief Write a machine readable report.
+      /// @param out receives the JSON
+      /// @param input names the file that was decoded.
+      void writeJson(std::ostream & out, const std::string & input)const;
+
+    private:
+      struct Worst
+      {
+        template_id_t templateId_;
+        uint64 ticks_;
+        size_t messageNumber_;
+        uint64 offset_;
+      };
+      typedef boost::shared_ptr<Common::LatencyHistogram> HistogramPtr;
+      typedef std::map<template_id_t, HistogramPtr> Histograms;
+
+      Common::LatencyHistogram & histogram(template_id_t templateId);
+      void addWorst(template_id_t templateId, uint64 ticks, size_t messageNumber, uint64 offset);
+      void total(Common::LatencyHistogram & all)const;
+      void writeJsonStatistics(std::ostream & out, const Common::LatencyHistogram & histogram)const;
+    private:
+      double nanosecondsPerTick_;
+      std::string activity_;
+      size_t worstCount_;
+      Histograms histograms_;
+      template_id_t lastTemplateId_;
+      Common::LatencyHistogram * lastHistogram_;
+      std::vector<Worst> worst_; // slowest first
+      uint64 worstThreshold_;
+    };
+  }
+}
+#endif /* LATENCYREPORT_H */
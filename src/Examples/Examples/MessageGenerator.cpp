@@ -0,0 +1,550 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "MessageGenerator.h"
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstruction.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldOp.h>
+#include <Messages/FieldSet.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldInt8.h>
+#include <Messages/FieldUInt8.h>
+#include <Messages/FieldInt16.h>
+#include <Messages/FieldUInt16.h>
+#include <Messages/FieldInt32.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldUInt64.h>
+#include <Messages/FieldDecimal.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldUtf8.h>
+#include <Messages/FieldByteVector.h>
+#include <Messages/FieldGroup.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+#include <Common/Decimal.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  // guards against recursive templateRefs
+  const size_t maximumDepth = 32;
+  // where delta fields start if the template does not say.
+  const int64 deltaStart = 100000;
+  // copy fields without an initial value choose from values spaced this far apart.
+  const int64 copySpacing = 37;
+  // fields without operators get random values up to this.
+  const int64 randomLimit = 1000000;
+}
+
+/// @brief How to generate one field, and its previous value.
+struct MessageGenerator::FieldPlan
+{
+  FieldPlan()
+    : type_(ValueType::UNDEFINED)
+    , op_(Codecs::FieldOp::NOP)
+    , mandatory_(true)
+    , hasInitial_(false)
+    , initial_(0)
+    , exponent_(-2)
+    , minimum_(0)
+    , maximum_(0)
+    , integer_(0)
+    , started_(false)
+  {
+  }
+
+  Messages::FieldIdentityCPtr identity_;
+  Messages::FieldIdentityCPtr lengthIdentity_;
+  ValueType::Type type_;
+  Codecs::FieldOp::OpType op_;
+  bool mandatory_;
+  bool hasInitial_;
+  // initial value of integers and decimal mantissas
+  int64 initial_;
+  std::string initialString_;
+  exponent_t exponent_;
+  int64 minimum_;
+  int64 maximum_;
+  // previous values
+  int64 integer_;
+  std::string string_;
+  bool started_;
+  // group and sequence contents
+  Plan children_;
+};
+
+MessageGenerator::MessageGenerator(Codecs::TemplateRegistryCPtr registry, uint64 seed)
+  : registry_(registry)
+  , random_(seed == 0 ? 1 : seed)
+  , symbolCount_(0)
+  , repeatProbability_(0.8)
+  , deltaStep_(5)
+  , minimumSequenceLength_(1)
+  , maximumSequenceLength_(5)
+  , absentProbability_(0.1)
+{
+  setSymbolCount(100);
+  for(Codecs::TemplateRegistry::const_iterator it = registry_->begin();
+    it != registry_->end();
+    ++it)
+  {
+    TemplatePlan & plan = plans_[it->first];
+    plan.id_ = it->first;
+    try
+    {
+      planSegment(*it->second, plan.fields_, 0);
+      plan.valid_ = true;
+    }
+    catch (const std::exception &)
+    {
+      plan.valid_ = false;
+      plan.fields_.clear();
+    }
+  }
+}
+
+MessageGenerator::~MessageGenerator()
+{
+}
+
+void
+MessageGenerator::setSymbolCount(size_t count)
+{
+  if(count == 0)
+  {
+    count = 1;
+  }
+  symbolCount_ = count;
+  symbols_.clear();
+  for(size_t nSymbol = 0; nSymbol < count; ++nSymbol)
+  {
+    std::stringstream symbol;
+    symbol << "SYM" << std::setw(4) << std::setfill('0') << nSymbol;
+    symbols_.push_back(symbol.str());
+  }
+}
+
+void
+MessageGenerator::setRepeatProbability(double probability)
+{
+  repeatProbability_ = probability;
+}
+
+void
+MessageGenerator::setDeltaStep(uint32 step)
+{
+  deltaStep_ = step;
+}
+
+void
+MessageGenerator::setSequenceLength(size_t minimum, size_t maximum)
+{
+  minimumSequenceLength_ = minimum;
+  maximumSequenceLength_ = std::max(minimum, maximum);
+}
+
+void
+MessageGenerator::setAbsentProbability(double probability)
+{
+  absentProbability_ = probability;
+}
+
+MessageGenerator::TemplatePlan &
+MessageGenerator::findPlan(template_id_t id)
+{
+  TemplatePlans::iterator it = plans_.find(id);
+  if(it == plans_.end() || !it->second.valid_)
+  {
+    std::stringstream msg;
+    msg << "Template " << id << (it == plans_.end() ? " is not defined." : " cannot be encoded.");
+    throw std::invalid_argument(msg.str());
+  }
+  return it->second;
+}
+
+void
+MessageGenerator::addTemplate(template_id_t id, double weight)
+{
+  findPlan(id);
+  mixIds_.push_back(id);
+  mixWeights_.push_back((mixWeights_.empty() ? 0.0 : mixWeights_.back()) + weight);
+}
+
+bool
+MessageGenerator::canGenerate(template_id_t id)const
+{
+  TemplatePlans::const_iterator it = plans_.find(id);
+  return it != plans_.end() && it->second.valid_;
+}
+
+size_t
+MessageGenerator::maxFieldCount()const
+{
+  return registry_->maxFieldCount();
+}
+
+void
+MessageGenerator::planSegment(const Codecs::SegmentBody & segment, Plan & plan, size_t depth)
+{
+  if(depth > maximumDepth)
+  {
+    throw std::runtime_error("Templates are nested too deeply.");
+  }
+  for(size_t nField = 0; nField < segment.size(); ++nField)
+  {
+    const Codecs::FieldInstructionCPtr & instruction = segment.getInstruction(nField);
+    ValueType::Type type = instruction->fieldInstructionType();
+    if(type == ValueType::TEMPLATEREF)
+    {
+      // The encoder finds the fields of a static templateRef in the referencing message.
+      const Codecs::FieldInstructionStaticTemplateRef * reference =
+        dynamic_cast<const Codecs::FieldInstructionStaticTemplateRef *>(instruction.get());
+      Codecs::TemplateCPtr target;
+      if(reference == 0)
+      {
+        throw std::runtime_error("Dynamic templateRefs cannot be encoded.");
+      }
+      if(!registry_->findNamedTemplate(reference->templateName(), reference->templateNamespace(), target))
+      {
+        throw std::runtime_error("Unknown template: " + reference->templateName());
+      }
+      planSegment(*target, plan, depth + 1);
+      continue;
+    }
+
+    FieldPlanPtr field(new FieldPlan);
+    field->identity_ = instruction->getIdentity();
+    field->type_ = type;
+    field->mandatory_ = instruction->isMandatory();
+    Codecs::FieldOpCPtr fieldOp = instruction->getFieldOp();
+    if(fieldOp)
+    {
+      field->op_ = fieldOp->opType();
+      field->hasInitial_ = fieldOp->hasValue();
+      field->initialString_ = fieldOp->getValue();
+    }
+
+    switch(type)
+    {
+    case ValueType::INT8:
+      field->minimum_ = -128;
+      field->maximum_ = 127;
+      break;
+    case ValueType::UINT8:
+      field->maximum_ = 255;
+      break;
+    case ValueType::INT16:
+      field->minimum_ = -32768;
+      field->maximum_ = 32767;
+      break;
+    case ValueType::UINT16:
+      field->maximum_ = 65535;
+      break;
+    case ValueType::INT32:
+      field->minimum_ = -2147483647;
+      field->maximum_ = 2147483647;
+      break;
+    case ValueType::UINT32:
+      field->maximum_ = 4294967295LL;
+      break;
+    case ValueType::INT64:
+      field->minimum_ = -9223372036854775807LL;
+      field->maximum_ = 9223372036854775807LL;
+      break;
+    case ValueType::UINT64:
+      field->maximum_ = 9223372036854775807LL;
+      break;
+    case ValueType::DECIMAL:
+    {
+      field->minimum_ = -9223372036854775807LL;
+      field->maximum_ = 9223372036854775807LL;
+      Codecs::FieldInstructionCPtr exponent;
+      Codecs::FieldInstructionCPtr mantissa;
+      if(instruction->getExponentInstruction(exponent) && instruction->getMantissaInstruction(mantissa))
+      {
+        // The exponent stays put and the mantissa follows the mantissa's operator.
+        Codecs::FieldOpCPtr exponentOp = exponent->getFieldOp();
+        if(exponentOp && exponentOp->hasValue())
+        {
+          field->exponent_ = exponent_t(boost::lexical_cast<int>(exponentOp->getValue()));
+        }
+        Codecs::FieldOpCPtr mantissaOp = mantissa->getFieldOp();
+        field->op_ = Codecs::FieldOp::NOP;
+        field->hasInitial_ = false;
+        if(mantissaOp)
+        {
+          field->op_ = mantissaOp->opType();
+          field->hasInitial_ = mantissaOp->hasValue();
+          if(field->hasInitial_)
+          {
+            field->initial_ = boost::lexical_cast<int64>(mantissaOp->getValue());
+          }
+        }
+      }
+      else if(field->hasInitial_)
+      {
+        Decimal initial;
+        initial.parse(field->initialString_);
+        field->initial_ = initial.getMantissa();
+        field->exponent_ = initial.getExponent();
+      }
+      break;
+    }
+    case ValueType::ASCII:
+    case ValueType::UTF8:
+    case ValueType::BYTEVECTOR:
+      break;
+    case ValueType::GROUP:
+    case ValueType::SEQUENCE:
+    {
+      Codecs::SegmentBodyPtr body;
+      if(!instruction->getSegmentBody(body))
+      {
+        throw std::runtime_error("Group or sequence has no contents.");
+      }
+      if(type == ValueType::SEQUENCE)
+      {
+        Codecs::FieldInstructionCPtr length;
+        if(body->getLengthInstruction(length))
+        {
+          field->lengthIdentity_ = length->getIdentity();
+        }
+        else
+        {
+          field->lengthIdentity_ = new Messages::FieldIdentity("length");
+        }
+      }
+      planSegment(*body, field->children_, depth + 1);
+      break;
+    }
+    default:
+      throw std::runtime_error("Cannot generate values for " + ValueType::typeName(type));
+    }
+    if(field->hasInitial_ && type <= ValueType::UINT64)
+    {
+      field->initial_ = boost::lexical_cast<int64>(field->initialString_);
+    }
+    plan.push_back(field);
+  }
+}
+
+template_id_t
+MessageGenerator::generate(Messages::FieldSet & message)
+{
+  if(mixIds_.empty())
+  {
+    for(TemplatePlans::const_iterator it = plans_.begin(); it != plans_.end(); ++it)
+    {
+      if(it->second.valid_)
+      {
+        addTemplate(it->first, 1.0);
+      }
+    }
+    if(mixIds_.empty())
+    {
+      throw std::runtime_error("None of the templates can be encoded.");
+    }
+  }
+  size_t index = 0;
+  if(mixIds_.size() > 1)
+  {
+    double pick = uniform() * mixWeights_.back();
+    index = std::upper_bound(mixWeights_.begin(), mixWeights_.end(), pick) - mixWeights_.begin();
+    if(index >= mixIds_.size())
+    {
+      index = mixIds_.size() - 1;
+    }
+  }
+  template_id_t id = mixIds_[index];
+  generate(id, message);
+  return id;
+}
+
+void
+MessageGenerator::generate(template_id_t id, Messages::FieldSet & message)
+{
+  generateFields(findPlan(id).fields_, message);
+}
+
+void
+MessageGenerator::generateFields(Plan & plan, Messages::FieldSet & fields)
+{
+  for(Plan::iterator it = plan.begin(); it != plan.end(); ++it)
+  {
+    generateField(**it, fields);
+  }
+}
+
+void
+MessageGenerator::generateField(FieldPlan & field, Messages::FieldSet & fields)
+{
+  if(field.op_ == Codecs::FieldOp::CONSTANT && field.mandatory_)
+  {
+    // the encoder does not need the value.
+    return;
+  }
+  if(!field.mandatory_ && uniform() < absentProbability_)
+  {
+    return;
+  }
+  switch(field.type_)
+  {
+  case ValueType::INT8:
+    fields.addField(field.identity_, Messages::FieldInt8::create(int8(nextInteger(field))));
+    break;
+  case ValueType::UINT8:
+    fields.addField(field.identity_, Messages::FieldUInt8::create(uchar(nextInteger(field))));
+    break;
+  case ValueType::INT16:
+    fields.addField(field.identity_, Messages::FieldInt16::create(int16(nextInteger(field))));
+    break;
+  case ValueType::UINT16:
+    fields.addField(field.identity_, Messages::FieldUInt16::create(uint16(nextInteger(field))));
+    break;
+  case ValueType::INT32:
+    fields.addField(field.identity_, Messages::FieldInt32::create(int32(nextInteger(field))));
+    break;
+  case ValueType::UINT32:
+    fields.addField(field.identity_, Messages::FieldUInt32::create(uint32(nextInteger(field))));
+    break;
+  case ValueType::INT64:
+    fields.addField(field.identity_, Messages::FieldInt64::create(nextInteger(field)));
+    break;
+  case ValueType::UINT64:
+    fields.addField(field.identity_, Messages::FieldUInt64::create(uint64(nextInteger(field))));
+    break;
+  case ValueType::DECIMAL:
+    fields.addField(field.identity_, Messages::FieldDecimal::create(mantissa_t(nextInteger(field)), field.exponent_));
+    break;
+  case ValueType::ASCII:
+    fields.addField(field.identity_, Messages::FieldAscii::create(nextString(field)));
+    break;
+  case ValueType::UTF8:
+    fields.addField(field.identity_, Messages::FieldUtf8::create(nextString(field)));
+    break;
+  case ValueType::BYTEVECTOR:
+    fields.addField(field.identity_, Messages::FieldByteVector::create(nextString(field)));
+    break;
+  case ValueType::GROUP:
+  {
+    Messages::FieldSetPtr group(new Messages::FieldSet(field.children_.size()));
+    generateFields(field.children_, *group);
+    fields.addField(field.identity_, Messages::FieldGroup::create(group));
+    break;
+  }
+  case ValueType::SEQUENCE:
+  {
+    size_t length = minimumSequenceLength_ + below(maximumSequenceLength_ - minimumSequenceLength_ + 1);
+    Messages::SequencePtr sequence(new Messages::Sequence(field.lengthIdentity_, length));
+    for(size_t nEntry = 0; nEntry < length; ++nEntry)
+    {
+      Messages::FieldSetPtr entry(new Messages::FieldSet(field.children_.size()));
+      generateFields(field.children_, *entry);
+      sequence->addEntry(entry);
+    }
+    fields.addField(field.identity_, Messages::FieldSequence::create(sequence));
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+int64
+MessageGenerator::nextInteger(FieldPlan & field)
+{
+  int64 value = 0;
+  switch(field.op_)
+  {
+  case Codecs::FieldOp::CONSTANT:
+    return field.initial_;
+  case Codecs::FieldOp::DEFAULT:
+    if(field.hasInitial_ && uniform() < repeatProbability_)
+    {
+      return field.initial_;
+    }
+    value = int64(below(size_t(randomLimit)));
+    break;
+  case Codecs::FieldOp::COPY:
+    if(field.started_ && uniform() < repeatProbability_)
+    {
+      return field.integer_;
+    }
+    value = (field.hasInitial_ ? field.initial_ : copySpacing) + int64(below(symbolCount_)) * copySpacing;
+    break;
+  case Codecs::FieldOp::INCREMENT:
+    value = field.started_ ? field.integer_ + 1 : (field.hasInitial_ ? field.initial_ : 1);
+    break;
+  case Codecs::FieldOp::DELTA:
+    if(field.started_)
+    {
+      value = field.integer_ + int64(below(2 * deltaStep_ + 1)) - int64(deltaStep_);
+    }
+    else
+    {
+      value = field.hasInitial_ ? field.initial_ : deltaStart;
+    }
+    break;
+  default:
+    value = int64(below(size_t(randomLimit)));
+    break;
+  }
+  if(value < field.minimum_)
+  {
+    value = field.minimum_;
+  }
+  else if(value > field.maximum_)
+  {
+    // an increment field wraps
+    value = field.op_ == Codecs::FieldOp::INCREMENT ? std::max(field.minimum_, int64(0)) : field.maximum_;
+  }
+  field.integer_ = value;
+  field.started_ = true;
+  return value;
+}
+
+const std::string &
+MessageGenerator::nextString(FieldPlan & field)
+{
+  switch(field.op_)
+  {
+  case Codecs::FieldOp::CONSTANT:
+    return field.initialString_;
+  case Codecs::FieldOp::DEFAULT:
+    if(field.hasInitial_ && uniform() < repeatProbability_)
+    {
+      return field.initialString_;
+    }
+    field.string_ = symbols_[below(symbolCount_)];
+    break;
+  case Codecs::FieldOp::COPY:
+    if(!field.started_ || uniform() >= repeatProbability_)
+    {
+      field.string_ = symbols_[below(symbolCount_)];
+    }
+    break;
+  case Codecs::FieldOp::DELTA:
+  case Codecs::FieldOp::TAIL:
+    if(!field.started_ || field.string_.empty())
+    {
+      field.string_ = symbols_[below(symbolCount_)];
+    }
+    else
+    {
+      field.string_[field.string_.size() - 1] = char('A' + below(26));
+    }
+    break;
+  default:
+    field.string_ = symbols_[below(symbolCount_)];
+    break;
+  }
+  field.started_ = true;
+  return field.string_;
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MESSAGEGENERATOR_H
+#define MESSAGEGENERATOR_H
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/SegmentBody_fwd.h>
+#include <Messages/FieldSet_fwd.h>
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Generate messages with plausible values for any set of templates.
+    ///
+    /// The values are chosen to suit each field's operator so the encoded data
+    /// resembles a real feed:
+    ///   - increment: sequence numbers that go up by one.
+    ///   - delta: a random walk in small steps (prices).
+    ///   - copy: a value from a fixed universe (symbols) that often repeats.
+    ///   - default: usually the default value.
+    ///   - tail: the end of the previous value changes.
+    ///   - constant: the constant (if optional; mandatory constants are not needed by the encoder)
+    ///   - no operator: random values.
+    /// Optional fields are sometimes absent.  Sequence lengths are random within limits.
+    /// Static templateRefs are expanded into the referencing message.
+    ///
+    /// Templates that cannot be encoded (i.e. dynamic templateRefs) are left
+    /// out of the default template mix.
+    ///
+    /// The generator is deterministic for a given seed.
+    class MessageGenerator
+    {
+    public:
+      /// @brief Construct
+      /// @param registry defines the templates.  It must be finalized.
+      /// @param seed for the random number generator.
+      explicit MessageGenerator(Codecs::TemplateRegistryCPtr registry, uint64 seed = 1);
+      ~MessageGenerator();
+
+      /// @brief Set the number of distinct values used for copy fields. (default 100)
+      void setSymbolCount(size_t count);
+
+      /// @brief Set the probability that a copy or default field repeats the previous or default value. (default 0.8)
+      void setRepeatProbability(double probability);
+
+      /// @brief Set the largest change in one step of a delta field. (default 5)
+      void setDeltaStep(uint32 step);
+
+      /// @brief Set the range of sequence lengths. (default 1 through 5)
+      void setSequenceLength(size_t minimum, size_t maximum);
+
+      /// @brief Set the probability that an optional field is absent. (default 0.1)
+      void setAbsentProbability(double probability);
+
+      /// @brief Add a template to the mix.
+      ///
+      /// If no templates are added every template that can be encoded is used equally often.
+      /// @param id identifies the template
+      /// @param weight is the relative frequency of this template.
+      /// @throws std::invalid_argument if the template is not defined or cannot be encoded.
+      void addTemplate(template_id_t id, double weight);
+
+      /// @brief Generate the next message using the template mix.
+      /// @param[out] message receives the fields.  It should be empty.
+      /// @returns the id of the template with which the message should be encoded.
+      /// @throws std::runtime_error if there are no templates that can be encoded.
+      template_id_t generate(Messages::FieldSet & message);
+
+      /// @brief Generate a message for a specific template
+      /// @param id identifies the template.
+      /// @param[out] message receives the fields.  It should be empty.
+      /// @throws std::invalid_argument if the template is not defined or cannot be encoded.
+      void generate(template_id_t id, Messages::FieldSet & message);
+
+      /// @brief The capacity needed by a FieldSet to hold any message.
+      size_t maxFieldCount()const;
+
+      /// @brief Can this template be encoded?
+      bool canGenerate(template_id_t id)const;
+
+    private:
+      MessageGenerator(const MessageGenerator &);
+      MessageGenerator & operator=(const MessageGenerator &);
+
+      struct FieldPlan;
+      typedef boost::shared_ptr<FieldPlan> FieldPlanPtr;
+      typedef std::vector<FieldPlanPtr> Plan;
+      struct TemplatePlan
+      {
+        template_id_t id_;
+        bool valid_;
+        Plan fields_;
+      };
+      typedef std::map<template_id_t, TemplatePlan> TemplatePlans;
+
+      void planSegment(const Codecs::SegmentBody & segment, Plan & plan, size_t depth);
+      void generateFields(Plan & plan, Messages::FieldSet & fields);
+      void generateField(FieldPlan & field, Messages::FieldSet & fields);
+      int64 nextInteger(FieldPlan & field);
+      const std::string & nextString(FieldPlan & field);
+      TemplatePlan & findPlan(template_id_t id);
+
+      uint64 random()
+      {
+        // xorshift64*
+        random_ ^= random_ >> 12;
+        random_ ^= random_ << 25;
+        random_ ^= random_ >> 27;
+        return random_ * 2685821657736338717ULL;
+      }
+
+      double uniform()
+      {
+        return double(random() >> 11) * (1.0 / 9007199254740992.0);
+      }
+
+      size_t below(size_t limit)
+      {
+        return size_t(random() % limit);
+      }
+
+    private:
+      Codecs::TemplateRegistryCPtr registry_;
+      uint64 random_;
+      size_t symbolCount_;
+      double repeatProbability_;
+      uint32 deltaStep_;
+      size_t minimumSequenceLength_;
+      size_t maximumSequenceLength_;
+      double absentProbability_;
+      std::vector<std::string> symbols_;
+
+      TemplatePlans plans_;
+      // template mix
+      std::vector<template_id_t> mixIds_;
+      std::vector<double> mixWeights_; // cumulative
+    };
+  }
+}
+#endif // MESSAGEGENERATOR_H
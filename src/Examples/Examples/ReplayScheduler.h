@@ -0,0 +1,145 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef REPLAYSCHEDULER_H
+#define REPLAYSCHEDULER_H
+#include <Common/Types.h>
+#include <Common/Timestamp.h>
+#include <Common/LatencyHistogram.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Release captured packets with the same spacing they had when they were captured.
+    ///
+    /// The capture timestamp of the first packet is aligned with the moment start() is called.
+    /// Later packets are released when the same interval (divided by the speed) has passed.
+    ///
+    /// Sleeping is too coarse to reproduce microbursts, and spinning for the whole
+    /// replay wastes a CPU, so waitUntil() sleeps until shortly before the release time
+    /// then spins on the monotonic clock for the rest.
+    ///
+    /// The lateness of every packet is counted in a Common::LatencyHistogram so the accuracy
+    /// of a replay of any length can be reported.
+    class ReplayScheduler
+    {
+    public:
+      /// @brief Construct
+      /// @param speed is the replay rate relative to the capture.  2.0 replays twice as fast.
+      ///        Zero means "as fast as possible" (no waiting).
+      /// @param spinNanoseconds is how long before the release time to stop sleeping and start spinning.
+      explicit ReplayScheduler(double speed = 1.0, uint64 spinNanoseconds = 100000)
+        : speed_(speed)
+        , spinNanoseconds_(spinNanoseconds)
+        , captureStart_(0)
+        , replayStart_(0)
+      {
+      }
+
+      /// @brief Start (or restart) the replay.
+      /// @param captureTimestamp is the capture time of the first packet (nanoseconds)
+      void start(uint64 captureTimestamp)
+      {
+        captureStart_ = captureTimestamp;
+        replayStart_ = Common::monotonicNanoseconds();
+      }
+
+      /// @brief Wait until it is time to release a packet.
+      ///
+      /// Packets that are already late (including packets whose timestamps go
+      /// backwards) are released immediately.
+      /// @param captureTimestamp is the capture time of the packet (nanoseconds)
+      void waitUntil(uint64 captureTimestamp)
+      {
+        if(speed_ <= 0.0)
+        {
+          return;
+        }
+        uint64 target = releaseTime(captureTimestamp);
+        uint64 now = Common::monotonicNanoseconds();
+        if(now + spinNanoseconds_ < target)
+        {
+          sleepUntil(target - spinNanoseconds_);
+          now = Common::monotonicNanoseconds();
+        }
+        while(now < target)
+        {
+          now = Common::monotonicNanoseconds();
+        }
+        lateness_.record(now - target);
+      }
+
+      /// @brief Is it already time to release a packet?
+      ///
+      /// Use this to decide whether to send any batched packets before waiting.
+      /// @param captureTimestamp is the capture time of the packet (nanoseconds)
+      bool due(uint64 captureTimestamp) const
+      {
+        return speed_ <= 0.0 || Common::monotonicNanoseconds() >= releaseTime(captureTimestamp);
+      }
+
+      /// @brief How late were the packets released (nanoseconds)
+      const Common::LatencyHistogram & lateness() const
+      {
+        return lateness_;
+      }
+
+      /// @brief Report percentiles of the lateness.
+      /// @param out receives the report
+      void report(std::ostream & out) const
+      {
+        if(lateness_.count() == 0)
+        {
+          return;
+        }
+        static const double percentiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+        static const char * names[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+        out << "Timing error (microseconds late) for " << lateness_.count() << " packets:";
+        for(size_t nPercentile = 0; nPercentile < sizeof(percentiles)/sizeof(percentiles[0]); ++nPercentile)
+        {
+          out << ' ' << names[nPercentile] << '=' << std::fixed << std::setprecision(3)
+            << double(lateness_.percentile(percentiles[nPercentile])) / 1000.0;
+        }
+        out << " max=" << std::fixed << std::setprecision(3)
+          << double(lateness_.maximum()) / 1000.0 << std::endl;
+      }
+
+    private:
+      uint64 releaseTime(uint64 captureTimestamp) const
+      {
+        uint64 offset = 0;
+        if(captureTimestamp > captureStart_)
+        {
+          offset = uint64(double(captureTimestamp - captureStart_) / speed_);
+        }
+        return replayStart_ + offset;
+      }
+
+      static void sleepUntil(uint64 target)
+      {
+#if defined(_WIN32)
+        uint64 now = Common::monotonicNanoseconds();
+        if(target > now)
+        {
+          Sleep(DWORD((target - now) / 1000000));
+        }
+#else
+        struct timespec wakeup;
+        wakeup.tv_sec = time_t(target / 1000000000ULL);
+        wakeup.tv_nsec = long(target % 1000000000ULL);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, 0);
+#endif
+      }
+
+    private:
+      double speed_;
+      uint64 spinNanoseconds_;
+      uint64 captureStart_;
+      uint64 replayStart_;
+      Common::LatencyHistogram lateness_;
+    };
+  }
+}
+#endif // REPLAYSCHEDULER_H
@@ -0,0 +1,225 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "FastFileIndexer.h"
+#include <Examples/MessageInterpreter.h>
+#include <Examples/StopWatch.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/MessageIndex.h>
+#include <Codecs/DataSourceMapped.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/GenericMessageBuilder.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+FastFileIndexer::FastFileIndexer()
+: interval_(10000)
+, rebuild_(false)
+, strict_(true)
+, seek_(false)
+, seekMessage_(0)
+, count_(1)
+{
+}
+
+FastFileIndexer::~FastFileIndexer()
+{
+}
+
+bool
+FastFileIndexer::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+FastFileIndexer::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-f" && argc > 1)
+    {
+      fastFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-x" && argc > 1)
+    {
+      indexFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-interval" && argc > 1)
+    {
+      interval_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-build")
+    {
+      rebuild_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-seek" && argc > 1)
+    {
+      seek_ = true;
+      seekMessage_ = boost::lexical_cast<unsigned long long>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-count" && argc > 1)
+    {
+      count_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-strict")
+    {
+      strict_ = !strict_;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+FastFileIndexer::usage(std::ostream & out) const
+{
+  out << "  -t file       : Template file (required)." << std::endl;
+  out << "  -f file       : Raw FAST message file (required)." << std::endl;
+  out << "  -x file       : Index file (default is the FAST file name plus .idx)." << std::endl;
+  out << "                  The index is built if the file does not exist." << std::endl;
+  out << "  -build        : Rebuild the index even if the index file exists." << std::endl;
+  out << "  -interval n   : Index every n'th message (default 10000)." << std::endl;
+  out << "                  Messages following a dictionary reset are always indexed." << std::endl;
+  out << "  -seek n       : Use the index to find message n (counting from 0) and display it." << std::endl;
+  out << "  -count n      : Display n messages starting with the -seek message (default 1)." << std::endl;
+  out << "  -strict       : Toggle 'strict decoding rules' (default true)." << std::endl;
+}
+
+bool
+FastFileIndexer::applyArgs()
+{
+  bool ok = true;
+  try
+  {
+    if(templateFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+    }
+    if(fastFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -f [FASTfile] option is required." << std::endl;
+    }
+    if(!ok)
+    {
+      commandArgParser_.usage(std::cerr);
+      return false;
+    }
+    if(indexFileName_.empty())
+    {
+      indexFileName_ = fastFileName_ + ".idx";
+    }
+    std::ifstream templates(templateFileName_.c_str(), std::ios::in | std::ios::binary);
+    if(!templates.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return false;
+    }
+    Codecs::XMLTemplateParser parser;
+    registry_ = parser.parse(templates);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+int
+FastFileIndexer::run()
+{
+  try
+  {
+    Codecs::DataSourceMapped source(fastFileName_);
+    Codecs::Decoder decoder(registry_);
+    decoder.setStrict(strict_);
+    Codecs::MessageIndex index;
+
+    std::ifstream indexIn;
+    if(!rebuild_)
+    {
+      indexIn.open(indexFileName_.c_str(), std::ios::in | std::ios::binary);
+    }
+    if(indexIn.good())
+    {
+      StopWatch readWatch;
+      index.read(indexIn);
+      unsigned long lapse = readWatch.freeze();
+      std::cout << "Read index of " << index.messageCount() << " messages ("
+        << index.size() << " entries) from " << indexFileName_
+        << " in " << lapse << " msec." << std::endl;
+    }
+    else
+    {
+      StopWatch buildWatch;
+      index.build(decoder, source, interval_);
+      unsigned long lapse = buildWatch.freeze();
+      std::ofstream indexOut(indexFileName_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      index.write(indexOut);
+      if(!indexOut.good())
+      {
+        std::cerr << "ERROR: Can't write index file: " << indexFileName_ << std::endl;
+        return -1;
+      }
+      std::cout << "Indexed " << index.messageCount() << " messages ("
+        << index.size() << " entries) in " << lapse << " msec." << std::endl;
+    }
+
+    if(seek_)
+    {
+      StopWatch seekWatch;
+      if(!index.seek(seekMessage_, decoder, source))
+      {
+        std::cerr << "ERROR: Message " << seekMessage_ << " is past the end of the file." << std::endl;
+        return -1;
+      }
+      unsigned long lapse = seekWatch.freeze();
+      std::cout << "Positioned at message " << seekMessage_
+        << " (offset " << source.bytesConsumed() << ") in " << lapse << " msec." << std::endl;
+
+      MessageInterpreter interpreter(std::cout);
+      Codecs::GenericMessageBuilder builder(interpreter);
+      for(size_t nMessage = 0; nMessage < count_ && source.messageAvailable() > 0; ++nMessage)
+      {
+        decoder.decodeMessage(source, builder);
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+void
+FastFileIndexer::fini()
+{
+}
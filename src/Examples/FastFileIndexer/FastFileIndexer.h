@@ -0,0 +1,58 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef FASTFILEINDEXER_H
+#define FASTFILEINDEXER_H
+
+#include <Examples/CommandArgParser.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Build a Codecs::MessageIndex for a raw FAST file and use it to jump to a message.
+    ///
+    /// The first run decodes the entire file and writes the index next to it.
+    /// Later runs read the index and use it to position the decoder at any
+    /// message after decoding at most "interval" messages.
+    ///
+    /// Use the -? command line option for more information.
+    class FastFileIndexer : public CommandArgHandler
+    {
+    public:
+      FastFileIndexer();
+      ~FastFileIndexer();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string templateFileName_;
+      std::string fastFileName_;
+      std::string indexFileName_;
+      size_t interval_;
+      bool rebuild_;
+      bool strict_;
+      bool seek_;
+      unsigned long long seekMessage_;
+      size_t count_;
+
+      Codecs::TemplateRegistryPtr registry_;
+    };
+  }
+}
+#endif // FASTFILEINDEXER_H
@@ -0,0 +1,902 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "FieldBenchmark.h"
+#include <Common/Profiler.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/SegmentBody.h>
+#include <Codecs/FieldInstructionInt8.h>
+#include <Codecs/FieldInstructionUInt8.h>
+#include <Codecs/FieldInstructionInt16.h>
+#include <Codecs/FieldInstructionUInt16.h>
+#include <Codecs/FieldInstructionInt32.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt64.h>
+#include <Codecs/FieldInstructionUInt64.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionExponent.h>
+#include <Codecs/FieldInstructionMantissa.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUtf8.h>
+#include <Codecs/FieldInstructionByteVector.h>
+#include <Codecs/FieldInstructionGroup.h>
+#include <Codecs/FieldInstructionSequence.h>
+#include <Codecs/FieldOpConstant.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDefault.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/FieldOpTail.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceBuffer.h>
+#include <Messages/Message.h>
+#include <Messages/NullMessageBuilder.h>
+#include <Messages/FieldInt8.h>
+#include <Messages/FieldUInt8.h>
+#include <Messages/FieldInt16.h>
+#include <Messages/FieldUInt16.h>
+#include <Messages/FieldInt32.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldUInt64.h>
+#include <Messages/FieldDecimal.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldUtf8.h>
+#include <Messages/FieldByteVector.h>
+#include <Messages/FieldGroup.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  enum FieldType
+  {
+    INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64,
+    DECIMAL, ASCII, UTF8, BYTEVECTOR
+  };
+  const char * typeNames[] =
+  {
+    "int8", "uInt8", "int16", "uInt16", "int32", "uInt32", "int64", "uInt64",
+    "decimal", "string", "unicode", "byteVector"
+  };
+  const size_t typeCount = sizeof(typeNames) / sizeof(typeNames[0]);
+
+  enum Operator
+  {
+    NOP, CONSTANT, DEFAULT, COPY, DELTA, INCREMENT, TAIL
+  };
+  const char * operatorNames[] =
+  {
+    "none", "constant", "default", "copy", "delta", "increment", "tail"
+  };
+  const size_t operatorCount = sizeof(operatorNames) / sizeof(operatorNames[0]);
+
+  const template_id_t templateId = 1;
+  // Messages are encoded once then decoded repeatedly in sets of this size.
+  const size_t messageSetSize = 64;
+  // An optional field is missing from one message in this many.
+  const size_t absentInterval = 5;
+  // The initial value of decimal constants and defaults (see decimalMantissa())
+  const char decimalInitialValue[] = "10000.01";
+
+  bool isInteger(FieldType type)
+  {
+    return type <= UINT64;
+  }
+
+  bool isString(FieldType type)
+  {
+    return type >= ASCII;
+  }
+
+  bool isPresent(bool mandatory, size_t messageNumber)
+  {
+    return mandatory || messageNumber % absentInterval != absentInterval - 1;
+  }
+
+  Messages::FieldIdentityCPtr identity(const std::string & name)
+  {
+    return Messages::FieldIdentityCPtr(new Messages::FieldIdentity(name));
+  }
+
+  /// A series of values that gives each operator its usual work to do.
+  int64 integerValue(Operator op, size_t messageNumber)
+  {
+    switch(op)
+    {
+    case CONSTANT:
+      return 1;
+    case DEFAULT:
+      // usually the default value
+      return messageNumber % 4 == 0 ? 2 : 1;
+    case COPY:
+      // changes every fourth message
+      return 1 + (messageNumber / 4) % 50;
+    case DELTA:
+      // small changes
+      return 50 + (messageNumber * 7) % 13;
+    case INCREMENT:
+      return 1 + messageNumber;
+    default:
+      return (messageNumber * 37) % 100;
+    }
+  }
+
+  /// Large enough that the wider types need several bytes on the wire.
+  int64 integerBase(FieldType type)
+  {
+    switch(type)
+    {
+    case INT16:
+    case UINT16:
+      return 1000;
+    case INT32:
+    case UINT32:
+      return 1000000;
+    case INT64:
+    case UINT64:
+      return 10000000000LL;
+    default:
+      return 0;
+    }
+  }
+
+  exponent_t decimalExponent(Operator op, size_t messageNumber)
+  {
+    switch(op)
+    {
+    case CONSTANT:
+      return -2;
+    case DEFAULT:
+      return messageNumber % 4 == 0 ? -3 : -2;
+    case COPY:
+      return exponent_t(-2 - int((messageNumber / 4) % 2));
+    case DELTA:
+    case INCREMENT:
+      return exponent_t(-2 - int(messageNumber % 2));
+    default:
+      return exponent_t(-2 - int(messageNumber % 3));
+    }
+  }
+
+  mantissa_t decimalMantissa(Operator op, size_t messageNumber)
+  {
+    // 1000001 with an exponent of -2 is decimalInitialValue
+    return mantissa_t(1000000 + integerValue(op, messageNumber));
+  }
+
+  std::string stringValue(Operator op, size_t messageNumber)
+  {
+    std::string result;
+    switch(op)
+    {
+    case CONSTANT:
+      result = "CONSTANT";
+      break;
+    case DEFAULT:
+      result = messageNumber % 4 == 0 ? "OTHER" : "DEFAULT";
+      break;
+    case COPY:
+      result = "ESZ9 C";
+      result += char('A' + (messageNumber / 4) % 26);
+      break;
+    case DELTA:
+    case TAIL:
+      // a common prefix with the end changing
+      result = "SECURITY-";
+      result += char('A' + messageNumber % 26);
+      result += char('A' + (messageNumber / 3) % 26);
+      break;
+    default:
+      result = "SYM";
+      result += boost::lexical_cast<std::string>((messageNumber * 37) % 100);
+      break;
+    }
+    return result;
+  }
+
+  Codecs::FieldOpPtr createOperator(Operator op, const std::string & initialValue)
+  {
+    Codecs::FieldOpPtr result;
+    switch(op)
+    {
+    case CONSTANT:
+      result.reset(new Codecs::FieldOpConstant);
+      break;
+    case DEFAULT:
+      result.reset(new Codecs::FieldOpDefault);
+      break;
+    case COPY:
+      result.reset(new Codecs::FieldOpCopy);
+      break;
+    case DELTA:
+      result.reset(new Codecs::FieldOpDelta);
+      break;
+    case INCREMENT:
+      result.reset(new Codecs::FieldOpIncrement);
+      break;
+    case TAIL:
+      result.reset(new Codecs::FieldOpTail);
+      break;
+    default:
+      // no operator
+      return result;
+    }
+    if(op == CONSTANT || op == DEFAULT)
+    {
+      result->setValue(initialValue);
+    }
+    return result;
+  }
+
+  void setOperator(Codecs::FieldInstructionPtr & field, Operator op, const std::string & initialValue)
+  {
+    Codecs::FieldOpPtr fieldOp = createOperator(op, initialValue);
+    if(fieldOp)
+    {
+      field->setFieldOp(fieldOp);
+    }
+  }
+}
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Define one kind of field and supply its values.
+    class FieldMaker
+    {
+    public:
+      virtual ~FieldMaker()
+      {
+      }
+      /// @brief Create the instruction for one instance of the field.
+      virtual Codecs::FieldInstructionPtr instruction(const std::string & name)const = 0;
+      /// @brief Add the field's value for one message (unless it is absent)
+      virtual void addValue(Messages::FieldSet & fields, const std::string & name, size_t messageNumber)const = 0;
+    };
+  }
+}
+
+namespace
+{
+  class ScalarMaker : public FieldMaker
+  {
+  public:
+    ScalarMaker(FieldType type, Operator op, bool mandatory)
+      : type_(type)
+      , op_(op)
+      , mandatory_(mandatory)
+    {
+    }
+
+    virtual Codecs::FieldInstructionPtr instruction(const std::string & name)const
+    {
+      Codecs::FieldInstructionPtr field;
+      std::string initialValue;
+      switch(type_)
+      {
+      case INT8:
+        field.reset(new Codecs::FieldInstructionInt8(name, ""));
+        break;
+      case UINT8:
+        field.reset(new Codecs::FieldInstructionUInt8(name, ""));
+        break;
+      case INT16:
+        field.reset(new Codecs::FieldInstructionInt16(name, ""));
+        break;
+      case UINT16:
+        field.reset(new Codecs::FieldInstructionUInt16(name, ""));
+        break;
+      case INT32:
+        field.reset(new Codecs::FieldInstructionInt32(name, ""));
+        break;
+      case UINT32:
+        field.reset(new Codecs::FieldInstructionUInt32(name, ""));
+        break;
+      case INT64:
+        field.reset(new Codecs::FieldInstructionInt64(name, ""));
+        break;
+      case UINT64:
+        field.reset(new Codecs::FieldInstructionUInt64(name, ""));
+        break;
+      case DECIMAL:
+        field.reset(new Codecs::FieldInstructionDecimal(name, ""));
+        break;
+      case ASCII:
+        field.reset(new Codecs::FieldInstructionAscii(name, ""));
+        break;
+      case UTF8:
+        field.reset(new Codecs::FieldInstructionUtf8(name, ""));
+        break;
+      case BYTEVECTOR:
+        field.reset(new Codecs::FieldInstructionByteVector(name, ""));
+        break;
+      }
+      if(isInteger(type_))
+      {
+        initialValue = boost::lexical_cast<std::string>(integerBase(type_) + integerValue(CONSTANT, 0));
+      }
+      else if(type_ == DECIMAL)
+      {
+        initialValue = decimalInitialValue;
+      }
+      else
+      {
+        initialValue = stringValue(CONSTANT, 0);
+        if(op_ == DEFAULT)
+        {
+          initialValue = stringValue(DEFAULT, 1);
+        }
+      }
+      field->setPresence(mandatory_);
+      setOperator(field, op_, initialValue);
+      return field;
+    }
+
+    virtual void addValue(Messages::FieldSet & fields, const std::string & name, size_t messageNumber)const
+    {
+      if(!isPresent(mandatory_, messageNumber))
+      {
+        return;
+      }
+      int64 value = integerBase(type_) + integerValue(op_, messageNumber);
+      Messages::FieldCPtr field;
+      switch(type_)
+      {
+      case INT8:
+        field = Messages::FieldInt8::create(int8(value));
+        break;
+      case UINT8:
+        field = Messages::FieldUInt8::create(uchar(value));
+        break;
+      case INT16:
+        field = Messages::FieldInt16::create(int16(value));
+        break;
+      case UINT16:
+        field = Messages::FieldUInt16::create(uint16(value));
+        break;
+      case INT32:
+        field = Messages::FieldInt32::create(int32(value));
+        break;
+      case UINT32:
+        field = Messages::FieldUInt32::create(uint32(value));
+        break;
+      case INT64:
+        field = Messages::FieldInt64::create(int64(value));
+        break;
+      case UINT64:
+        field = Messages::FieldUInt64::create(uint64(value));
+        break;
+      case DECIMAL:
+        field = Messages::FieldDecimal::create(
+          decimalMantissa(op_, messageNumber),
+          decimalExponent(op_, messageNumber));
+        break;
+      case ASCII:
+        field = Messages::FieldAscii::create(stringValue(op_, messageNumber));
+        break;
+      case UTF8:
+        field = Messages::FieldUtf8::create(stringValue(op_, messageNumber));
+        break;
+      case BYTEVECTOR:
+        field = Messages::FieldByteVector::create(stringValue(op_, messageNumber));
+        break;
+      }
+      fields.addField(identity(name), field);
+    }
+
+  private:
+    FieldType type_;
+    Operator op_;
+    bool mandatory_;
+  };
+
+  /// A decimal with individual exponent and mantissa operators.
+  class DecimalMaker : public FieldMaker
+  {
+  public:
+    DecimalMaker(Operator exponentOp, Operator mantissaOp, bool mandatory)
+      : exponentOp_(exponentOp)
+      , mantissaOp_(mantissaOp)
+      , mandatory_(mandatory)
+    {
+    }
+
+    virtual Codecs::FieldInstructionPtr instruction(const std::string & name)const
+    {
+      Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionDecimal(name, ""));
+      field->setPresence(mandatory_);
+      Codecs::FieldInstructionPtr exponent(new Codecs::FieldInstructionExponent);
+      setOperator(exponent, exponentOp_,
+        boost::lexical_cast<std::string>(int(decimalExponent(CONSTANT, 0))));
+      field->setExponentInstruction(exponent);
+      Codecs::FieldInstructionPtr mantissa(new Codecs::FieldInstructionMantissa);
+      setOperator(mantissa, mantissaOp_,
+        boost::lexical_cast<std::string>(decimalMantissa(CONSTANT, 0)));
+      field->setMantissaInstruction(mantissa);
+      return field;
+    }
+
+    virtual void addValue(Messages::FieldSet & fields, const std::string & name, size_t messageNumber)const
+    {
+      if(isPresent(mandatory_, messageNumber))
+      {
+        fields.addField(identity(name), Messages::FieldDecimal::create(
+          decimalMantissa(mantissaOp_, messageNumber),
+          decimalExponent(exponentOp_, messageNumber)));
+      }
+    }
+
+  private:
+    Operator exponentOp_;
+    Operator mantissaOp_;
+    bool mandatory_;
+  };
+
+  /// The entries in groups and sequences: a price and a quantity.
+  void addEntryInstructions(Codecs::SegmentBody & body, const std::string & name)
+  {
+    Codecs::FieldInstructionPtr price(new Codecs::FieldInstructionDecimal(name + "Px", ""));
+    setOperator(price, DELTA, "");
+    body.addInstruction(price);
+    Codecs::FieldInstructionPtr quantity(new Codecs::FieldInstructionUInt32(name + "Qty", ""));
+    setOperator(quantity, COPY, "");
+    body.addInstruction(quantity);
+  }
+
+  Messages::FieldSetPtr entryValues(const std::string & name, size_t messageNumber)
+  {
+    Messages::FieldSetPtr entry(new Messages::FieldSet(2));
+    entry->addField(identity(name + "Px"), Messages::FieldDecimal::create(
+      decimalMantissa(DELTA, messageNumber),
+      decimalExponent(CONSTANT, messageNumber)));
+    entry->addField(identity(name + "Qty"), Messages::FieldUInt32::create(
+      uint32(integerValue(COPY, messageNumber))));
+    return entry;
+  }
+
+  class GroupMaker : public FieldMaker
+  {
+  public:
+    explicit GroupMaker(bool mandatory)
+      : mandatory_(mandatory)
+    {
+    }
+
+    virtual Codecs::FieldInstructionPtr instruction(const std::string & name)const
+    {
+      Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionGroup(name, ""));
+      field->setPresence(mandatory_);
+      Codecs::SegmentBodyPtr body(new Codecs::SegmentBody);
+      field->setSegmentBody(body);
+      addEntryInstructions(*body, name);
+      return field;
+    }
+
+    virtual void addValue(Messages::FieldSet & fields, const std::string & name, size_t messageNumber)const
+    {
+      if(isPresent(mandatory_, messageNumber))
+      {
+        fields.addField(identity(name), Messages::FieldGroup::create(entryValues(name, messageNumber)));
+      }
+    }
+
+  private:
+    bool mandatory_;
+  };
+
+  /// A sequence of price/quantity entries.  When nested each entry of the outer
+  /// sequence holds a side and a sequence of entries.
+  class SequenceMaker : public FieldMaker
+  {
+  public:
+    SequenceMaker(bool mandatory, bool nested)
+      : mandatory_(mandatory)
+      , nested_(nested)
+    {
+    }
+
+    static const size_t outerLength = 2;
+    static const size_t innerLength = 4;
+
+    virtual Codecs::FieldInstructionPtr instruction(const std::string & name)const
+    {
+      Codecs::FieldInstructionPtr field = sequence(name, mandatory_);
+      if(nested_)
+      {
+        Codecs::SegmentBodyPtr outer;
+        field->getSegmentBody(outer);
+        Codecs::FieldInstructionPtr side(new Codecs::FieldInstructionUInt32(name + "Side", ""));
+        setOperator(side, COPY, "");
+        outer->addInstruction(side);
+        Codecs::FieldInstructionPtr inner = sequence(name + "Levels", true);
+        Codecs::SegmentBodyPtr innerBody;
+        inner->getSegmentBody(innerBody);
+        addEntryInstructions(*innerBody, name);
+        outer->addInstruction(inner);
+      }
+      else
+      {
+        Codecs::SegmentBodyPtr body;
+        field->getSegmentBody(body);
+        addEntryInstructions(*body, name);
+      }
+      return field;
+    }
+
+    virtual void addValue(Messages::FieldSet & fields, const std::string & name, size_t messageNumber)const
+    {
+      if(!isPresent(mandatory_, messageNumber))
+      {
+        return;
+      }
+      Messages::SequencePtr entries = entrySequence(
+        name + (nested_ ? "LevelsCount" : "Count"), name, messageNumber);
+      if(nested_)
+      {
+        Messages::FieldIdentityCPtr length = identity(name + "Count");
+        Messages::SequencePtr outer(new Messages::Sequence(length, outerLength));
+        for(size_t nSide = 0; nSide < outerLength; ++nSide)
+        {
+          Messages::FieldSetPtr side(new Messages::FieldSet(2));
+          side->addField(identity(name + "Side"), Messages::FieldUInt32::create(uint32(nSide)));
+          side->addField(identity(name + "Levels"), Messages::FieldSequence::create(entries));
+          outer->addEntry(side);
+        }
+        entries = outer;
+      }
+      fields.addField(identity(name), Messages::FieldSequence::create(entries));
+    }
+
+  private:
+    static Codecs::FieldInstructionPtr sequence(const std::string & name, bool mandatory)
+    {
+      Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionSequence(name, ""));
+      field->setPresence(mandatory);
+      Codecs::SegmentBodyPtr body(new Codecs::SegmentBody);
+      body->allowLengthField();
+      body->setMandatoryLength(mandatory);
+      field->setSegmentBody(body);
+      Codecs::FieldInstructionPtr length(new Codecs::FieldInstructionLength(name + "Count", ""));
+      body->addLengthInstruction(length);
+      return field;
+    }
+
+    static Messages::SequencePtr entrySequence(
+      const std::string & lengthName,
+      const std::string & name,
+      size_t messageNumber)
+    {
+      Messages::FieldIdentityCPtr length = identity(lengthName);
+      Messages::SequencePtr result(new Messages::Sequence(length, innerLength));
+      for(size_t nEntry = 0; nEntry < innerLength; ++nEntry)
+      {
+        result->addEntry(entryValues(name, messageNumber + nEntry));
+      }
+      return result;
+    }
+
+  private:
+    bool mandatory_;
+    bool nested_;
+  };
+
+  /// An empty template: measures the cost of the message itself.
+  class NoFieldMaker : public FieldMaker
+  {
+  public:
+    virtual Codecs::FieldInstructionPtr instruction(const std::string & /*name*/)const
+    {
+      return Codecs::FieldInstructionPtr();
+    }
+
+    virtual void addValue(Messages::FieldSet & /*fields*/, const std::string & /*name*/, size_t /*messageNumber*/)const
+    {
+    }
+  };
+
+  typedef std::vector<Messages::MessagePtr> MessageSet;
+
+  void encodeSet(
+    Codecs::Encoder & encoder,
+    Codecs::DataDestination & destination,
+    const MessageSet & messages,
+    bool cold)
+  {
+    destination.clear();
+    encoder.reset();
+    for(size_t nMessage = 0; nMessage < messages.size(); ++nMessage)
+    {
+      if(cold)
+      {
+        encoder.reset();
+      }
+      encoder.encodeMessage(destination, templateId, *messages[nMessage]);
+    }
+  }
+
+  void decodeSet(
+    Codecs::Decoder & decoder,
+    const std::string & encoded,
+    size_t messageCount,
+    bool cold,
+    Messages::ValueMessageBuilder & builder)
+  {
+    Codecs::DataSourceBuffer source(
+      reinterpret_cast<const unsigned char *>(encoded.data()), encoded.size());
+    decoder.reset();
+    for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+    {
+      if(cold)
+      {
+        decoder.reset();
+      }
+      decoder.decodeMessage(source, builder);
+    }
+  }
+
+  uint64 timeEncoding(
+    Codecs::Encoder & encoder,
+    const MessageSet & messages,
+    bool cold,
+    size_t repeat)
+  {
+    Codecs::DataDestination destination;
+    // the first pass allocates the destination's buffers.
+    encodeSet(encoder, destination, messages, cold);
+    uint64 start = profilerTicks();
+    for(size_t nPass = 0; nPass < repeat; ++nPass)
+    {
+      encodeSet(encoder, destination, messages, cold);
+    }
+    return profilerTicks() - start;
+  }
+
+  uint64 timeDecoding(
+    Codecs::Decoder & decoder,
+    const std::string & encoded,
+    size_t messageCount,
+    bool cold,
+    size_t repeat)
+  {
+    Messages::NullMessageBuilder builder;
+    decodeSet(decoder, encoded, messageCount, cold, builder);
+    uint64 start = profilerTicks();
+    for(size_t nPass = 0; nPass < repeat; ++nPass)
+    {
+      decodeSet(decoder, encoded, messageCount, cold, builder);
+    }
+    uint64 lapse = profilerTicks() - start;
+    if(builder.messageCount() != (repeat + 1) * messageCount)
+    {
+      throw std::runtime_error("Decoded message count is wrong.");
+    }
+    return lapse;
+  }
+}
+
+FieldBenchmark::FieldBenchmark()
+: messageCount_(100000)
+, fieldsPerMessage_(10)
+, nanosecondsPerTick_(1.0)
+{
+}
+
+FieldBenchmark::~FieldBenchmark()
+{
+}
+
+bool
+FieldBenchmark::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+FieldBenchmark::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-n" && argc > 1)
+    {
+      messageCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-fields" && argc > 1)
+    {
+      fieldsPerMessage_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-only" && argc > 1)
+    {
+      filters_.push_back(argv[1]);
+      consumed = 2;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+FieldBenchmark::usage(std::ostream & out) const
+{
+  out << "  -n count      : Messages to decode and encode for each measurement (default 100000)" << std::endl;
+  out << "  -fields count : Instances of the field in each message (default 10)" << std::endl;
+  out << "  -only text    : Measure only the cases whose names contain text, i.e. -only \"uInt32 delta\"" << std::endl;
+  out << "                  May appear more than once." << std::endl;
+}
+
+bool
+FieldBenchmark::applyArgs()
+{
+  if(fieldsPerMessage_ == 0 || messageCount_ == 0)
+  {
+    std::cerr << "ERROR: -n and -fields must be greater than zero." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool
+FieldBenchmark::selected(const std::string & name)const
+{
+  if(filters_.empty())
+  {
+    return true;
+  }
+  for(size_t nFilter = 0; nFilter < filters_.size(); ++nFilter)
+  {
+    if(name.find(filters_[nFilter]) != std::string::npos)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int
+FieldBenchmark::run()
+{
+  try
+  {
+    nanosecondsPerTick_ = ProfileAccumulator::nanosecondsPerTick();
+    size_t fieldCount = fieldsPerMessage_;
+    fieldsPerMessage_ = 0;
+    std::cout << "Decoding and encoding " << messageCount_ << " messages for each case." << std::endl;
+    std::cout << "Results are nanoseconds and bytes per field (" << fieldCount
+      << " fields per message, including a share of the message cost)." << std::endl;
+    std::cout << "Warm: the dictionary carries values from message to message.  Cold: it is reset for every message."
+      << std::endl << std::endl;
+    std::cout << std::left << std::setw(50) << "field" << std::right
+      << std::setw(7) << "bytes"
+      << std::setw(12) << "dec warm" << std::setw(10) << "dec cold"
+      << std::setw(10) << "enc warm" << std::setw(10) << "enc cold" << std::endl;
+    // per message rather than per field.
+    runCase("(empty message)", NoFieldMaker());
+    fieldsPerMessage_ = fieldCount;
+
+    for(size_t presence = 0; presence < 2; ++presence)
+    {
+      bool mandatory = presence == 0;
+      std::string presenceName(mandatory ? " mandatory" : " optional");
+      for(size_t type = 0; type < typeCount; ++type)
+      {
+        for(size_t op = 0; op < operatorCount; ++op)
+        {
+          if((op == INCREMENT && !isInteger(FieldType(type)))
+            || (op == TAIL && !isString(FieldType(type))))
+          {
+            continue;
+          }
+          runCase(std::string(typeNames[type]) + " " + operatorNames[op] + presenceName,
+            ScalarMaker(FieldType(type), Operator(op), mandatory));
+        }
+      }
+      for(size_t exponentOp = NOP; exponentOp <= DELTA; ++exponentOp)
+      {
+        for(size_t mantissaOp = NOP; mantissaOp <= INCREMENT; ++mantissaOp)
+        {
+          runCase(std::string("decimal exponent ") + operatorNames[exponentOp]
+            + " mantissa " + operatorNames[mantissaOp] + presenceName,
+            DecimalMaker(Operator(exponentOp), Operator(mantissaOp), mandatory));
+        }
+      }
+      runCase("group of 2" + presenceName, GroupMaker(mandatory));
+      runCase("sequence of 4x2" + presenceName, SequenceMaker(mandatory, false));
+      runCase("nested sequence of 2x(1+4x2)" + presenceName, SequenceMaker(mandatory, true));
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+void
+FieldBenchmark::runCase(const std::string & name, const FieldMaker & maker)
+{
+  if(fieldsPerMessage_ != 0 && !selected(name))
+  {
+    return;
+  }
+  std::cout << std::left << std::setw(50) << name << std::right << std::flush;
+  try
+  {
+    Codecs::TemplatePtr target(new Codecs::Template);
+    target->setTemplateName("Benchmark");
+    target->setId(templateId);
+    std::vector<std::string> names;
+    for(size_t nField = 0; nField < fieldsPerMessage_; ++nField)
+    {
+      names.push_back("Field" + boost::lexical_cast<std::string>(nField));
+      Codecs::FieldInstructionPtr field = maker.instruction(names.back());
+      target->addInstruction(field);
+    }
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(target);
+    registry->finalize();
+
+    MessageSet messages;
+    for(size_t nMessage = 0; nMessage < messageSetSize; ++nMessage)
+    {
+      Messages::MessagePtr message(new Messages::Message(registry->maxFieldCount()));
+      for(size_t nField = 0; nField < names.size(); ++nField)
+      {
+        maker.addValue(*message, names[nField], nMessage);
+      }
+      messages.push_back(message);
+    }
+
+    Codecs::Encoder encoder(registry);
+    Codecs::Decoder decoder(registry);
+    Codecs::DataDestination destination;
+    std::string warm;
+    encodeSet(encoder, destination, messages, false);
+    destination.toString(warm);
+    std::string cold;
+    encodeSet(encoder, destination, messages, true);
+    destination.toString(cold);
+
+    size_t repeat = (messageCount_ + messageSetSize - 1) / messageSetSize;
+    double units = double(repeat * messageSetSize * std::max(fieldsPerMessage_, size_t(1)));
+    double results[4];
+    results[0] = double(timeDecoding(decoder, warm, messageSetSize, false, repeat));
+    results[1] = double(timeDecoding(decoder, cold, messageSetSize, true, repeat));
+    results[2] = double(timeEncoding(encoder, messages, false, repeat));
+    results[3] = double(timeEncoding(encoder, messages, true, repeat));
+
+    std::cout << std::setw(7) << std::fixed << std::setprecision(1)
+      << double(warm.size()) / (units / double(repeat));
+    for(size_t nResult = 0; nResult < 4; ++nResult)
+    {
+      std::cout << std::setw(nResult == 0 ? 12 : 10) << std::setprecision(1)
+        << results[nResult] * nanosecondsPerTick_ / units;
+    }
+    std::cout << std::endl;
+  }
+  catch (std::exception & ex)
+  {
+    std::cout << " failed: " << ex.what() << std::endl;
+  }
+}
+
+void
+FieldBenchmark::fini()
+{
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef FIELDBENCHMARK_H
+#define FIELDBENCHMARK_H
+
+#include <Examples/CommandArgParser.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    class FieldMaker;
+
+    /// @brief Measure the cost of decoding and encoding each kind of field.
+    ///
+    /// A one-template registry is built for every combination of field type,
+    /// field operator and presence, including decimals with separate exponent
+    /// and mantissa operators, groups and nested sequences.  Each template
+    /// holds several instances of the field so the cost of starting a message
+    /// is spread across them.  A set of messages with values suited to the
+    /// operator (repeated values for copy, small changes for delta, etc.) is
+    /// encoded once to provide the input for the decoding measurements.
+    ///
+    /// Each case is measured four ways:
+    ///   - warm: the dictionary is reset only at the start of each batch of
+    ///     messages so the operators see the previous values as they would in a live feed.
+    ///   - cold: the dictionary is reset before every message so every field is
+    ///     handled as if it were the first one seen.
+    /// for both decoding (into a Messages::NullMessageBuilder) and encoding.
+    ///
+    /// The results are in nanoseconds per field.  The first line reports the cost of an
+    /// empty message so it can be taken into account.
+    ///
+    /// Use the -? command line option for more information.
+    class FieldBenchmark : public CommandArgHandler
+    {
+    public:
+      FieldBenchmark();
+      ~FieldBenchmark();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+      bool selected(const std::string & name)const;
+      void runCase(const std::string & name, const FieldMaker & maker);
+
+    private:
+      CommandArgParser commandArgParser_;
+      size_t messageCount_;
+      size_t fieldsPerMessage_;
+      std::vector<std::string> filters_;
+      double nanosecondsPerTick_;
+    };
+  }
+}
+#endif // FIELDBENCHMARK_H
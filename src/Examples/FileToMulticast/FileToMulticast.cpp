@@ -23,6 +23,8 @@ FileToMulticast::FileToMulticast()
 , sendCount_(1)
 , sendMicroseconds_(500)
 , burst_(1)
+, batchSize_(1)
+, segmentation_(false)
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
@@ -84,6 +86,16 @@ FileToMulticast::parseSingleArg(int argc, char * argv[])
       burst_ = boost::lexical_cast<size_t>(argv[1]);
       consumed = 2;
     }
+    else if(opt == "-batch" && argc > 1)
+    {
+      batchSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-gso")
+    {
+      segmentation_ = true;
+      consumed = 1;
+    }
     else if(opt == "-c" && argc > 1)
     {
       sendCount_ = boost::lexical_cast<size_t>(argv[1]);
@@ -138,6 +150,9 @@ FileToMulticast::usage(std::ostream & out) const
   out << "  -b msg/burst  : Messages per burst(default = 1)" << std::endl;
   out << "  -c count      : How many times to send the file (passes)" << std::endl;
   out << "                  (default 1; 0 means forever.)" << std::endl;
+  out << "  -batch n      : Send up to n messages per system call (default 1)." << std::endl;
+  out << "                  Each burst is sent before waiting for the next one." << std::endl;
+  out << "  -gso          : Use UDP segmentation offload for batches when possible (Linux)." << std::endl;
   out << "  -pausemessage : Wait for 'Enter' before every message." << std::endl;
   out << "  -pausepass    : Wait for 'Enter' before every pass." << std::endl;
   out << "  -v            : Noise to the console while it runs" << std::endl;
@@ -254,6 +269,8 @@ FileToMulticast::run()
   try
   {
     sender_->initializeSender();
+    sender_->setBatchSize(batchSize_);
+    sender_->setSegmentation(segmentation_);
     if(verbose_)
     {
       std::cout << "Sending " << messageIndex_.size() << " messages. "
@@ -313,6 +330,7 @@ FileToMulticast::sendBurst()
         nPass_ += 1;
         if(nPass_ >= sendCount_ && sendCount_ != 0)
         {
+          sender_->flush();
           ioService_.stopService();
           return;
         }
@@ -346,8 +364,9 @@ FileToMulticast::sendBurst()
       assert(messageLength <= bufferSize_);
       size_t bytesRead = fread(buffer_.get(), 1, messageLength, dataFile_);
       assert (bytesRead == messageLength);
-      sender_->send(boost::asio::buffer(buffer_.get(), messageLength));
+      sender_->queue(buffer_.get(), messageLength);
     }
+    sender_->flush();
   }
   catch (std::exception& e)
   {
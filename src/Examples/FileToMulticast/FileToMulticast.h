@@ -55,6 +55,8 @@ namespace QuickFAST{
       size_t sendCount_;
       size_t sendMicroseconds_;
       size_t burst_;
+      size_t batchSize_;
+      bool segmentation_;
       bool pauseEveryPass_;
       bool pauseEveryMessage_;
       bool verbose_;
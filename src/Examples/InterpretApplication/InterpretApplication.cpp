@@ -126,6 +126,21 @@ InterpretApplication::parseSingleArg(int argc, char * argv[])
       configuration_->setFastFileName(argv[1]);
       consumed = 2;
     }
+    else if(opt == "-map")
+    {
+      configuration_->setMapFastFile(true);
+      consumed = 1;
+    }
+    else if(opt == "-journal" && argc > 1)
+    {
+      configuration_->setJournalFileName(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-journalwait")
+    {
+      configuration_->setJournalBackpressure(true);
+      consumed = 1;
+    }
     else if(opt == "-buffer" && argc > 1)
     {
       configuration_->setReceiverType(Application::DecoderConfiguration::BUFFER_RECEIVER);
@@ -298,6 +313,20 @@ InterpretApplication::parseSingleArg(int argc, char * argv[])
         }
       }
     }
+    else if(opt == "-pseq" && argc > 2) // n size      : sequence number is 'size' bytes at offset n (fixed) or field n (FAST)
+    {
+      configuration_->setPacketHeaderSequence(
+        boost::lexical_cast<size_t>(argv[1]),
+        boost::lexical_cast<size_t>(argv[2]));
+      consumed = 3;
+    }
+    else if(opt == "-reorder" && argc > 2) // window ms : hold up to 'window' out-of-order packets for 'ms' milliseconds
+    {
+      configuration_->setReorder(
+        boost::lexical_cast<size_t>(argv[1]),
+        boost::lexical_cast<unsigned long>(argv[2]));
+      consumed = 3;
+    }
     else if(opt == "-privateioservice")
     {
       configuration_->setPrivateIOService(true);
@@ -393,6 +422,7 @@ InterpretApplication::usage(std::ostream & out) const
   out << "  -ofix                : Write the output as newline separated FIX records." << std::endl;
   out << std::endl;
   out << "  -file file           : Input from raw FAST message file." << std::endl;
+  out << "  -map                 : Memory map the -file rather than reading it." << std::endl;
   out << "  -buffer file         : Input from raw FAST message file into a buffer; decode from buffer." << std::endl;
   out << "  -pcap file           : Input from PCap FAST message file." << std::endl;
   out << "  -pcapsource [64|32]    : Word size of the machine where the PCap data was captured." << std::endl;
@@ -407,6 +437,9 @@ InterpretApplication::usage(std::ostream & out) const
   out << "                           0.0.0.0 means pick any NIC." << std::endl;
   out << "  -tcp host:port       : Input from TCP/IP.  Connect to \"host\" name or" << std::endl;
   out << "                         dotted IP on named or numbered port." << std::endl;
+  out << "  -journal file        : Record every received packet in a PCap file." << std::endl;
+  out << "  -journalwait         : If the journal falls behind, wait for it rather" << std::endl;
+  out << "                         than leaving packets out of the journal." << std::endl;
   out << std::endl;
   out << "  -threads n           : Number of threads to service incoming messages." << std::endl;
   out << "                         Valid for multicast or tcp" << std::endl;
@@ -448,6 +481,12 @@ InterpretApplication::usage(std::ostream & out) const
   out << "                         block size." << std::endl;
   out << "  -psuffix n           : 'n' bytes (fixed) or fields (FAST) follow" << std::endl;
   out << "                         block size." << std::endl;
+  out << "  -pseq n size         : Packet header contains a sequence number:" << std::endl;
+  out << "                         'size' bytes at offset 'n' (fixed) or field 'n'" << std::endl;
+  out << "                         (FAST, 'size' must be nonzero)." << std::endl;
+  out << "  -reorder window ms   : Deliver packets in sequence order.  Hold up to" << std::endl;
+  out << "                         'window' out-of-order packets; declare a gap after" << std::endl;
+  out << "                         'ms' milliseconds.  Requires -pseq." << std::endl;
   out << std::endl;
   out << "  -buffersize size     : Size of communication buffers." << std::endl;
   out << "                         For \"-datagram\" largest expected message." << std::endl;
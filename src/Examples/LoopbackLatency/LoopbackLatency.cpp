@@ -0,0 +1,561 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "LoopbackLatency.h"
+#include "SendTimeHeaderAnalyzer.h"
+#include "StageLatencyBuilder.h"
+#include <Examples/MessageGenerator.h>
+#include <Examples/StopWatch.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/MulticastDecoder.h>
+#include <Communication/MulticastReceiver.h>
+#include <Communication/MulticastSender.h>
+#include <Communication/BufferSlab.h>
+#include <Messages/Message.h>
+#include <Common/WorkingBuffer.h>
+#include <Common/Timestamp.h>
+#include <Common/StatisticsPublisher.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  struct Percentile
+  {
+    const char * name_;
+    double fraction_;
+  };
+  const Percentile percentiles[] =
+  {
+    {"p50", 0.50},
+    {"p90", 0.90},
+    {"p99", 0.99},
+    {"p99.9", 0.999}
+  };
+  const size_t percentileCount = sizeof(percentiles) / sizeof(percentiles[0]);
+
+  // how long to let the receiver's group membership settle before sending.
+  const unsigned long joinDelay = 100;
+}
+
+LoopbackLatency::LoopbackLatency()
+: role_(SEND_AND_RECEIVE)
+, receiverType_(MULTICAST_RECEIVER)
+, queueType_(HEAP_BUFFERS)
+, bufferCount_(2)
+, bufferSize_(1400)
+, threadCount_(1)
+, messageCount_(100000)
+, warmup_(1000)
+, distinct_(1000)
+, rate_(10000)
+, seed_(1)
+, idle_(1000)
+, multicastGroup_("239.255.0.1")
+, interface_("127.0.0.1")
+, port_(30001)
+, sent_(0)
+, sendErrors_(0)
+, sendLapse_(0)
+{
+}
+
+LoopbackLatency::~LoopbackLatency()
+{
+}
+
+bool
+LoopbackLatency::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+LoopbackLatency::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-role" && argc > 1)
+    {
+      std::string role(argv[1]);
+      consumed = 2;
+      if(role == "both")
+      {
+        role_ = SEND_AND_RECEIVE;
+      }
+      else if(role == "send")
+      {
+        role_ = SEND;
+      }
+      else if(role == "receive")
+      {
+        role_ = RECEIVE;
+      }
+      else
+      {
+        std::cerr << "Unknown role: " << role << std::endl;
+        consumed = 0;
+      }
+    }
+    else if(opt == "-receiver" && argc > 1)
+    {
+      std::string type(argv[1]);
+      consumed = 2;
+      if(type == "multicast")
+      {
+        receiverType_ = MULTICAST_RECEIVER;
+      }
+      else if(type == "decoder")
+      {
+        receiverType_ = MULTICAST_DECODER;
+      }
+      else
+      {
+        std::cerr << "Unknown receiver type: " << type << std::endl;
+        consumed = 0;
+      }
+    }
+    else if(opt == "-queue" && argc > 1)
+    {
+      std::string type(argv[1]);
+      consumed = 2;
+      if(type == "heap")
+      {
+        queueType_ = HEAP_BUFFERS;
+      }
+      else if(type == "slab")
+      {
+        queueType_ = SLAB_BUFFERS;
+      }
+      else
+      {
+        std::cerr << "Unknown queue type: " << type << std::endl;
+        consumed = 0;
+      }
+    }
+    else if(opt == "-buffers" && argc > 1)
+    {
+      bufferCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-buffersize" && argc > 1)
+    {
+      bufferSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-threads" && argc > 1)
+    {
+      threadCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-count" && argc > 1)
+    {
+      messageCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-warmup" && argc > 1)
+    {
+      warmup_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-distinct" && argc > 1)
+    {
+      distinct_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-rate" && argc > 1)
+    {
+      rate_ = boost::lexical_cast<uint32>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-seed" && argc > 1)
+    {
+      seed_ = boost::lexical_cast<uint64>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-idle" && argc > 1)
+    {
+      idle_ = boost::lexical_cast<unsigned long>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-a" && argc > 1)
+    {
+      multicastGroup_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-i" && argc > 1)
+    {
+      interface_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-p" && argc > 1)
+    {
+      port_ = boost::lexical_cast<unsigned short>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-statistics" && argc > 1)
+    {
+      statisticsName_ = argv[1];
+      consumed = 2;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+LoopbackLatency::usage(std::ostream & out) const
+{
+  out << "  -t file        : Template file (required)." << std::endl;
+  out << "  -role r        : both: publish and receive in this process (default)." << std::endl;
+  out << "                   send: publish only." << std::endl;
+  out << "                   receive: receive only (start before the publisher)." << std::endl;
+  out << "  -receiver type : multicast: MulticastReceiver and MessagePerPacketAssembler (default)." << std::endl;
+  out << "                   decoder: Codecs::MulticastDecoder." << std::endl;
+  out << "  -queue type    : Where the buffers in the receiver's queue come from." << std::endl;
+  out << "                   heap: each LinkedBuffer is allocated separately (default)." << std::endl;
+  out << "                   slab: one BufferSlab (multicast receiver only)." << std::endl;
+  out << "  -buffers n     : Receive buffers (default 2)." << std::endl;
+  out << "  -buffersize n  : Size of each receive buffer (default 1400)." << std::endl;
+  out << "  -threads n     : Threads servicing the receiver (default 1)." << std::endl;
+  out << "  -count n       : Messages to send or expect (default 100000)." << std::endl;
+  out << "  -warmup n      : Leave the first n messages received out of the report (default 1000)." << std::endl;
+  out << "  -distinct n    : Different messages to generate and send in rotation (default 1000)." << std::endl;
+  out << "  -rate n        : Messages per second; 0 means as fast as possible (default 10000)." << std::endl;
+  out << "  -seed n        : Seed for the generated messages (default 1)." << std::endl;
+  out << "  -idle ms       : Stop receiving when nothing arrives for this long (default 1000)." << std::endl;
+  out << "  -a address     : Multicast group (default 239.255.0.1)." << std::endl;
+  out << "  -i address     : Interface on which to send and receive (default 127.0.0.1)." << std::endl;
+  out << "  -p port        : Port (default 30001)." << std::endl;
+  out << "  -statistics name : Publish the receiver's statistics to this shared memory" << std::endl;
+  out << "                   segment once a second (see StatisticsMonitor)." << std::endl;
+}
+
+bool
+LoopbackLatency::applyArgs()
+{
+  bool ok = true;
+  if(templateFileName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+  }
+  if(queueType_ == SLAB_BUFFERS && receiverType_ != MULTICAST_RECEIVER)
+  {
+    ok = false;
+    std::cerr << "ERROR: -queue slab requires -receiver multicast." << std::endl;
+  }
+  if(bufferCount_ == 0 || threadCount_ == 0 || messageCount_ == 0 || distinct_ == 0)
+  {
+    ok = false;
+    std::cerr << "ERROR: -buffers, -threads, -count and -distinct must be greater than zero." << std::endl;
+  }
+  if(!ok)
+  {
+    commandArgParser_.usage(std::cerr);
+  }
+  return ok;
+}
+
+int
+LoopbackLatency::run()
+{
+  int result = 0;
+  try
+  {
+    std::ifstream templateFile(templateFileName_.c_str(), std::ios::in
+#ifdef _WIN32
+      | std::ios::binary
+#endif
+      );
+    if(!templateFile.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return -1;
+    }
+    Codecs::XMLTemplateParser parser;
+    Codecs::TemplateRegistryPtr registry = parser.parse(templateFile);
+
+    if(role_ == SEND)
+    {
+      encodePackets(registry);
+      send();
+      writeSendReport(std::cout);
+      return sendErrors_ == 0 ? 0 : -1;
+    }
+
+    SendTimeHeaderAnalyzer sendTimeHeader;
+    Codecs::NoHeaderAnalyzer packetHeader;
+    StageLatencyBuilder builder(sendTimeHeader, warmup_);
+
+    // Declared before the receiver so it outlives the statistics registered in it.
+    Common::StatisticsRegistry statistics;
+    Common::StatisticsPublisher publisher(statistics);
+    Common::StatisticsRegistry * publishedStatistics = statisticsName_.empty() ? 0 : &statistics;
+
+    boost::scoped_ptr<Communication::BufferSlab> slab;
+    boost::scoped_ptr<Communication::MulticastReceiver> receiver;
+    boost::scoped_ptr<Codecs::MessagePerPacketAssembler> assembler;
+    boost::scoped_ptr<Codecs::MulticastDecoder> decoder;
+    if(receiverType_ == MULTICAST_RECEIVER)
+    {
+      receiver.reset(new Communication::MulticastReceiver(multicastGroup_, interface_, port_));
+      assembler.reset(new Codecs::MessagePerPacketAssembler(
+        registry,
+        packetHeader,
+        sendTimeHeader,
+        builder));
+      assembler->setReset(true);
+      assembler->setStatistics(publishedStatistics, "loopback.assembler.");
+      receiver->setStatistics(publishedStatistics, "loopback.receiver.");
+      size_t ownBuffers = bufferCount_;
+      if(queueType_ == SLAB_BUFFERS)
+      {
+        slab.reset(new Communication::BufferSlab(bufferSize_, bufferCount_));
+        slab->assign(*receiver, bufferCount_);
+        ownBuffers = 0;
+      }
+      receiver->start(*assembler, bufferSize_, ownBuffers);
+      receiver->runThreads(threadCount_, false);
+    }
+    else
+    {
+      decoder.reset(new Codecs::MulticastDecoder(registry, multicastGroup_, interface_, port_));
+      decoder->setReset(true);
+      decoder->setStatistics(publishedStatistics, "loopback.");
+      decoder->start(builder, packetHeader, sendTimeHeader, bufferSize_, bufferCount_);
+      decoder->run(threadCount_, false);
+    }
+    if(publishedStatistics != 0)
+    {
+      publisher.start(statisticsName_);
+    }
+
+    boost::scoped_ptr<boost::thread> sendThread;
+    if(role_ == SEND_AND_RECEIVE)
+    {
+      encodePackets(registry);
+      boost::this_thread::sleep(boost::posix_time::milliseconds(joinDelay));
+      sendThread.reset(new boost::thread(boost::bind(&LoopbackLatency::send, this)));
+    }
+    else
+    {
+      std::cout << "Waiting for messages on " << multicastGroup_ << ':' << port_ << std::endl;
+    }
+
+    size_t received = waitForMessages(builder, role_ == SEND_AND_RECEIVE);
+    if(sendThread)
+    {
+      sendThread->join();
+    }
+    if(receiver)
+    {
+      receiver->stop();
+      receiver->joinThreads();
+    }
+    else
+    {
+      decoder->stop();
+      decoder->joinThreads();
+    }
+
+    if(role_ == SEND_AND_RECEIVE)
+    {
+      writeSendReport(std::cout);
+    }
+    writeReceiveReport(std::cout, builder, received);
+    if(receiver)
+    {
+      std::cout << "      Receiver: " << receiver->packetsReceived() << " packets; "
+        << "no buffer available " << receiver->noBufferAvailable() << " times; "
+        << receiver->packetsWithErrors() << " errors." << std::endl;
+    }
+    else
+    {
+      std::cout << "      Receiver: " << decoder->receiver().packetsReceived() << " packets; "
+        << "no buffer available " << decoder->receiver().noBufferAvailable() << " times; "
+        << decoder->receiver().packetsWithErrors() << " errors." << std::endl;
+    }
+  }
+  catch (std::exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    result = -1;
+  }
+  return result;
+}
+
+void
+LoopbackLatency::encodePackets(Codecs::TemplateRegistryPtr registry)
+{
+  MessageGenerator generator(registry, seed_);
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  WorkingBuffer encoded;
+  packets_.clear();
+  packets_.reserve(distinct_);
+  for(size_t nMessage = 0; nMessage < distinct_; ++nMessage)
+  {
+    Messages::Message message(generator.maxFieldCount());
+    template_id_t id = generator.generate(message);
+    // every packet stands alone so a lost packet can't upset the receiver's dictionary
+    encoder.reset();
+    destination.clear();
+    encoder.encodeMessage(destination, id, message);
+    destination.toWorkingBuffer(encoded);
+    if(SendTimeHeaderAnalyzer::headerSize + encoded.size() > bufferSize_)
+    {
+      std::stringstream msg;
+      msg << "Message " << nMessage << " (template " << id << ") needs "
+        << SendTimeHeaderAnalyzer::headerSize + encoded.size()
+        << " bytes.  Increase -buffersize.";
+      throw std::runtime_error(msg.str());
+    }
+    packets_.push_back(Packet(SendTimeHeaderAnalyzer::headerSize));
+    packets_.back().insert(packets_.back().end(), encoded.begin(), encoded.end());
+  }
+}
+
+void
+LoopbackLatency::send()
+{
+  Communication::MulticastSender sender(multicastGroup_, port_);
+  sender.initializeSender();
+  sender.socket().set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::from_string(interface_)));
+  sender.socket().set_option(boost::asio::ip::multicast::enable_loopback(true));
+
+  uint64 interval = rate_ == 0 ? 0 : 1000000000ULL / rate_;
+  StopWatch timer;
+  uint64 next = Common::wallClockNanoseconds();
+  for(size_t nMessage = 0; nMessage < messageCount_; ++nMessage)
+  {
+    uint64 now = Common::wallClockNanoseconds();
+    while(now < next)
+    {
+      // sleep through most of a long wait, then spin for accuracy.
+      uint64 wait = next - now;
+      if(wait > 2000000)
+      {
+        boost::this_thread::sleep(boost::posix_time::microseconds(long((wait - 1000000) / 1000)));
+      }
+      now = Common::wallClockNanoseconds();
+    }
+    // A late publisher catches up rather than skipping messages.
+    next += interval;
+
+    Packet & packet = packets_[nMessage % packets_.size()];
+    SendTimeHeaderAnalyzer::write(Common::wallClockNanoseconds(), &packet[0]);
+    try
+    {
+      sender.send(boost::asio::buffer(&packet[0], packet.size()));
+    }
+    catch(const boost::system::system_error &)
+    {
+      ++sendErrors_;
+    }
+    ++sent_;
+  }
+  sendLapse_ = timer.freeze();
+  sender.stop();
+}
+
+size_t
+LoopbackLatency::waitForMessages(StageLatencyBuilder & builder, bool sending)
+{
+  size_t received = 0;
+  uint64 lastProgress = Common::wallClockNanoseconds();
+  uint64 idle = uint64(idle_) * 1000000ULL;
+  while(received < messageCount_)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    uint64 now = Common::wallClockNanoseconds();
+    size_t completed = builder.completed();
+    if(completed != received)
+    {
+      received = completed;
+      lastProgress = now;
+    }
+    else if(now - lastProgress > idle)
+    {
+      // a publisher in another process may not have started yet.
+      bool started = sending || received != 0;
+      // in this process, keep waiting while the publisher is still publishing.
+      bool publishing = sending && sent_ < messageCount_;
+      if(started && !publishing)
+      {
+        break;
+      }
+    }
+  }
+  return received;
+}
+
+void
+LoopbackLatency::writeSendReport(std::ostream & out)const
+{
+  double seconds = double(sendLapse_ == 0 ? 1 : sendLapse_) / 1000.;
+  out << "Sent " << sent_ << " messages in " << sendLapse_ << " milliseconds. ["
+    << std::fixed << std::setprecision(0) << double(sent_) / seconds << " messages/second] "
+    << sendErrors_ << " send errors." << std::endl;
+}
+
+void
+LoopbackLatency::writeReceiveReport(std::ostream & out, const StageLatencyBuilder & builder, size_t received)const
+{
+  out << "Received " << received << " messages";
+  if(role_ == SEND_AND_RECEIVE)
+  {
+    out << "; " << (sent_ > received ? sent_ - received : 0) << " lost";
+  }
+  out << "; " << builder.decodingErrors() << " decoding errors." << std::endl;
+  if(builder.skewed() != 0)
+  {
+    out << "      " << builder.skewed()
+      << " messages arrived before they were sent.  Check the publisher's clock." << std::endl;
+  }
+  out << "      One-way latency in nanoseconds (after " << warmup_ << " warm-up messages):" << std::endl;
+  out << "      " << std::setw(10) << "stage" << std::setw(12) << "count";
+  for(size_t nPercentile = 0; nPercentile < percentileCount; ++nPercentile)
+  {
+    out << std::setw(10) << percentiles[nPercentile].name_;
+  }
+  out << std::setw(12) << "max" << std::endl;
+  for(size_t nStage = 0; nStage < StageLatencyBuilder::STAGE_COUNT; ++nStage)
+  {
+    StageLatencyBuilder::Stage stage = StageLatencyBuilder::Stage(nStage);
+    const Common::LatencyHistogram & histogram = builder.histogram(stage);
+    out << "      " << std::setw(10) << StageLatencyBuilder::stageName(stage)
+      << std::setw(12) << histogram.count();
+    for(size_t nPercentile = 0; nPercentile < percentileCount; ++nPercentile)
+    {
+      out << std::setw(10) << histogram.percentile(percentiles[nPercentile].fraction_);
+    }
+    out << std::setw(12) << histogram.maximum() << std::endl;
+  }
+}
+
+void
+LoopbackLatency::fini()
+{
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef LOOPBACKLATENCY_H
+#define LOOPBACKLATENCY_H
+
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Examples/CommandArgParser.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    class StageLatencyBuilder;
+
+    /// @brief Measure the one-way latency from publisher to decoded message.
+    ///
+    /// A publisher sends FAST messages with a MulticastSender and a receiver
+    /// decodes them on the same host, normally via the loopback interface.  Both
+    /// ends may run in this process (the default), or in two processes using
+    /// -role send and -role receive.
+    ///
+    /// Each message is preceded by an eight byte message header holding the time
+    /// it was sent (big-endian nanoseconds since the epoch; see Common::wallClockNanoseconds()).
+    /// The receiver reads it with a message header analyzer, so any template file
+    /// can be used.  Each message is encoded with a freshly reset dictionary and the
+    /// receiver resets its decoder for every packet, so a lost packet costs one sample
+    /// and nothing more.
+    ///
+    /// The latency is reported by stage:
+    ///   - socket: send() until the receiver has the packet (kernel receive timestamp when available).
+    ///   - queue: waiting in the receiver's LinkedBuffer queue until the assembler starts on it.
+    ///   - decode: message header, Decoder and builder.
+    ///   - total: send() until the builder has the whole message.
+    ///
+    /// The receiver type, buffer count, thread count and buffer queue are
+    /// selected on the command line so changes to the communication layer can be
+    /// compared directly.
+    ///
+    /// Use the -? command line option for more information.
+    class LoopbackLatency : public CommandArgHandler
+    {
+    public:
+      LoopbackLatency();
+      ~LoopbackLatency();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      enum Role
+      {
+        SEND_AND_RECEIVE,
+        SEND,
+        RECEIVE
+      };
+      enum ReceiverType
+      {
+        MULTICAST_RECEIVER,
+        MULTICAST_DECODER
+      };
+      enum QueueType
+      {
+        HEAP_BUFFERS,
+        SLAB_BUFFERS
+      };
+      typedef std::vector<unsigned char> Packet;
+
+      void encodePackets(Codecs::TemplateRegistryPtr registry);
+      void send();
+      size_t waitForMessages(StageLatencyBuilder & builder, bool sending);
+      void writeSendReport(std::ostream & out)const;
+      void writeReceiveReport(std::ostream & out, const StageLatencyBuilder & builder, size_t received)const;
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string templateFileName_;
+      Role role_;
+      ReceiverType receiverType_;
+      QueueType queueType_;
+      size_t bufferCount_;
+      size_t bufferSize_;
+      size_t threadCount_;
+      size_t messageCount_;
+      size_t warmup_;
+      size_t distinct_;
+      uint32 rate_;
+      uint64 seed_;
+      unsigned long idle_;
+      std::string multicastGroup_;
+      std::string interface_;
+      unsigned short port_;
+      std::string statisticsName_;
+
+      std::vector<Packet> packets_;
+      size_t sent_;
+      size_t sendErrors_;
+      unsigned long sendLapse_;
+    };
+  }
+}
+#endif // LOOPBACKLATENCY_H
@@ -0,0 +1,80 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef SENDTIMEHEADERANALYZER_H
+#define SENDTIMEHEADERANALYZER_H
+#include <Codecs/HeaderAnalyzer.h>
+#include <Codecs/DataSource.h>
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief A message header that holds the time the message was sent.
+    ///
+    /// The header is eight bytes: nanoseconds since the epoch, big-endian.
+    /// It carries no block size.
+    class SendTimeHeaderAnalyzer : public Codecs::HeaderAnalyzer
+    {
+    public:
+      /// @brief The size of the header in bytes.
+      static const size_t headerSize = 8;
+
+      SendTimeHeaderAnalyzer()
+        : bytesRead_(0)
+        , partial_(0)
+        , sendTime_(0)
+      {
+      }
+
+      /// @brief Write a header
+      /// @param sendTime is nanoseconds since the epoch.
+      /// @param header receives headerSize bytes.
+      static void write(uint64 sendTime, unsigned char * header)
+      {
+        for(size_t nByte = headerSize; nByte > 0; --nByte)
+        {
+          header[nByte - 1] = static_cast<unsigned char>(sendTime & 0xFF);
+          sendTime >>= 8;
+        }
+      }
+
+      /// @brief The send time from the most recent complete header.
+      uint64 sendTime()const
+      {
+        return sendTime_;
+      }
+
+      virtual bool analyzeHeader(Codecs::DataSource & source, size_t & /*blockSize*/, bool & skip)
+      {
+        while(bytesRead_ < headerSize)
+        {
+          uchar byte = 0;
+          if(!source.getByte(byte))
+          {
+            return false;
+          }
+          partial_ = (partial_ << 8) | byte;
+          ++bytesRead_;
+        }
+        sendTime_ = partial_;
+        partial_ = 0;
+        bytesRead_ = 0;
+        skip = false;
+        return true;
+      }
+
+      virtual void reset()
+      {
+        bytesRead_ = 0;
+        partial_ = 0;
+      }
+
+    private:
+      size_t bytesRead_;
+      uint64 partial_;
+      uint64 sendTime_;
+    };
+  }
+}
+#endif // SENDTIMEHEADERANALYZER_H
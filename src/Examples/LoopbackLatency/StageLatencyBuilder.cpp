@@ -0,0 +1,90 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "StageLatencyBuilder.h"
+#include "SendTimeHeaderAnalyzer.h"
+#include <Common/Timestamp.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  const char * stageNames[StageLatencyBuilder::STAGE_COUNT] =
+  {
+    "socket",
+    "queue",
+    "decode",
+    "total"
+  };
+}
+
+StageLatencyBuilder::StageLatencyBuilder(const SendTimeHeaderAnalyzer & header, size_t warmup)
+  : header_(header)
+  , warmup_(warmup)
+  , completed_(0)
+  , skewed_(0)
+  , decodingErrors_(0)
+  , receiveTime_(0)
+  , decodeStartTime_(0)
+{
+}
+
+StageLatencyBuilder::~StageLatencyBuilder()
+{
+}
+
+const char *
+StageLatencyBuilder::stageName(Stage stage)
+{
+  if(stage < 0 || stage >= STAGE_COUNT)
+  {
+    return "unknown";
+  }
+  return stageNames[stage];
+}
+
+void
+StageLatencyBuilder::setReceiveTimes(uint64 receiveTime, uint64 decodeStartTime)
+{
+  receiveTime_ = receiveTime;
+  decodeStartTime_ = decodeStartTime;
+}
+
+bool
+StageLatencyBuilder::endMessage(Messages::ValueMessageBuilder & messageBuilder)
+{
+  uint64 now = Common::wallClockNanoseconds();
+  bool result = PerformanceBuilder::endMessage(messageBuilder);
+  ++completed_;
+  if(completed_ <= warmup_)
+  {
+    return result;
+  }
+  uint64 sendTime = header_.sendTime();
+  if(now < sendTime)
+  {
+    ++skewed_;
+    return result;
+  }
+  histograms_[TOTAL].record(now - sendTime);
+  if(receiveTime_ >= sendTime && decodeStartTime_ >= receiveTime_)
+  {
+    histograms_[SOCKET].record(receiveTime_ - sendTime);
+    histograms_[QUEUE].record(decodeStartTime_ - receiveTime_);
+  }
+  if(now >= decodeStartTime_)
+  {
+    histograms_[DECODE].record(now - decodeStartTime_);
+  }
+  return result;
+}
+
+bool
+StageLatencyBuilder::reportDecodingError(const std::string & /*errorMessage*/)
+{
+  ++decodingErrors_;
+  return true;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef STAGELATENCYBUILDER_H
+#define STAGELATENCYBUILDER_H
+#include <Examples/MessagePerformance.h>
+#include <Common/LatencyHistogram.h>
+namespace QuickFAST{
+  namespace Examples{
+    class SendTimeHeaderAnalyzer;
+
+    /// @brief Count fields like PerformanceBuilder, and time each message's trip from the publisher.
+    ///
+    /// The send time comes from the message header; the receive and decode start
+    /// times come from the assembler (see ValueMessageBuilder::setReceiveTimes()).
+    /// The time the message is complete is taken in endMessage().  All of them are
+    /// wall clock nanoseconds so the publisher may be in another process on the same host.
+    class StageLatencyBuilder : public PerformanceBuilder
+    {
+    public:
+      /// @brief The parts of the trip.
+      enum Stage
+      {
+        SOCKET,
+        QUEUE,
+        DECODE,
+        TOTAL,
+        STAGE_COUNT
+      };
+
+      /// @brief Construct
+      /// @param header is the message header analyzer that finds the send times.
+      /// @param warmup is the number of messages to leave out of the histograms.
+      StageLatencyBuilder(const SendTimeHeaderAnalyzer & header, size_t warmup);
+      virtual ~StageLatencyBuilder();
+
+      /// @brief The name of a stage for reports.
+      static const char * stageName(Stage stage);
+
+      /// @brief The times recorded for one stage in nanoseconds.
+      const Common::LatencyHistogram & histogram(Stage stage)const
+      {
+        return histograms_[stage];
+      }
+
+      /// @brief How many messages have been completely decoded.
+      size_t completed()const
+      {
+        return completed_;
+      }
+
+      /// @brief How many messages appeared to arrive before they were sent.
+      ///
+      /// Nonzero if the publisher's clock is ahead of the receiver's.
+      size_t skewed()const
+      {
+        return skewed_;
+      }
+
+      /// @brief How many decoding errors were reported.
+      size_t decodingErrors()const
+      {
+        return decodingErrors_;
+      }
+
+      virtual void setReceiveTimes(uint64 receiveTime, uint64 decodeStartTime);
+      virtual bool endMessage(Messages::ValueMessageBuilder & messageBuilder);
+      virtual bool reportDecodingError(const std::string & errorMessage);
+
+    private:
+      const SendTimeHeaderAnalyzer & header_;
+      size_t warmup_;
+      size_t completed_;
+      size_t skewed_;
+      size_t decodingErrors_;
+      uint64 receiveTime_;
+      uint64 decodeStartTime_;
+      Common::LatencyHistogram histograms_[STAGE_COUNT];
+    };
+  }
+}
+#endif // STAGELATENCYBUILDER_H
@@ -0,0 +1,312 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "MulticastSendRate.h"
+#include <Examples/StopWatch.h>
+#include <Communication/MulticastSender.h>
+#include <Common/Timestamp.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  /// how long the receiver waits for stragglers after the last datagram is sent.
+  const uint64 drainNanoseconds = 200000000;
+
+  /// @brief Count the datagrams that are actually delivered.
+  ///
+  /// A datagram the kernel accepts can still be dropped before it reaches a socket
+  /// (a full receive buffer, for example), so the sender's rate alone can be misleading.
+  /// This joins the group on its own thread and counts what arrives.
+  class DeliveryCounter
+  {
+  public:
+    DeliveryCounter(
+      boost::asio::io_service & ioService,
+      const std::string & group,
+      const std::string & interfaceAddress,
+      unsigned short portNumber)
+      : socket_(ioService)
+      , sent_(false)
+      , received_(0)
+      , lastReceived_(0)
+    {
+      boost::asio::ip::udp::endpoint listenEndpoint(boost::asio::ip::address_v4::any(), portNumber);
+      socket_.open(listenEndpoint.protocol());
+      socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+      socket_.set_option(boost::asio::socket_base::receive_buffer_size(8 * 1024 * 1024));
+      socket_.bind(listenEndpoint);
+      socket_.set_option(boost::asio::ip::multicast::join_group(
+        boost::asio::ip::address_v4::from_string(group),
+        boost::asio::ip::address_v4::from_string(interfaceAddress)));
+      socket_.non_blocking(true);
+    }
+
+    void start()
+    {
+      thread_.reset(new boost::thread(boost::bind(&DeliveryCounter::receive, this)));
+    }
+
+    /// @brief Wait for the last datagrams to arrive.
+    /// @returns the number of datagrams received.
+    size_t finish()
+    {
+      sent_ = true;
+      thread_->join();
+      return received_;
+    }
+
+    /// @brief When did the last datagram arrive (Common::monotonicNanoseconds())
+    uint64 lastReceived() const
+    {
+      return lastReceived_;
+    }
+
+  private:
+    void receive()
+    {
+      std::vector<unsigned char> buffer(65536);
+      uint64 idleSince = 0;
+      for(;;)
+      {
+        boost::system::error_code error;
+        socket_.receive(boost::asio::buffer(buffer), 0, error);
+        if(!error)
+        {
+          ++received_;
+          lastReceived_ = Common::monotonicNanoseconds();
+          idleSince = 0;
+        }
+        else if(error == boost::asio::error::would_block)
+        {
+          if(sent_)
+          {
+            uint64 now = Common::monotonicNanoseconds();
+            if(idleSince == 0)
+            {
+              idleSince = now;
+            }
+            else if(now - idleSince > drainNanoseconds)
+            {
+              return;
+            }
+          }
+          boost::this_thread::yield();
+        }
+        else
+        {
+          std::cerr << "Receive failed: " << error.message() << std::endl;
+          return;
+        }
+      }
+    }
+
+  private:
+    boost::asio::ip::udp::socket socket_;
+    boost::scoped_ptr<boost::thread> thread_;
+    volatile bool sent_;
+    size_t received_;
+    uint64 lastReceived_;
+  };
+}
+
+MulticastSendRate::MulticastSendRate()
+: sendAddress_("239.255.0.1")
+, interfaceAddress_("127.0.0.1")
+, portNumber_(30001)
+, packetSize_(100)
+, packetCount_(1000000)
+, segmentation_(false)
+{
+}
+
+MulticastSendRate::~MulticastSendRate()
+{
+}
+
+bool
+MulticastSendRate::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+MulticastSendRate::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-a" && argc > 1)
+    {
+      sendAddress_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-p" && argc > 1)
+    {
+      portNumber_ = boost::lexical_cast<unsigned short>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-i" && argc > 1)
+    {
+      interfaceAddress_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-s" && argc > 1)
+    {
+      packetSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-n" && argc > 1)
+    {
+      packetCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-batch" && argc > 1)
+    {
+      std::string list(argv[1]);
+      std::replace(list.begin(), list.end(), ',', ' ');
+      std::istringstream sizes(list);
+      size_t size;
+      while(sizes >> size)
+      {
+        batchSizes_.push_back(size);
+      }
+      consumed = 2;
+    }
+    else if(opt == "-gso")
+    {
+      segmentation_ = true;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+MulticastSendRate::usage(std::ostream & out) const
+{
+  out << "  -a dotted_ip  : Multicast send address (default is 239.255.0.1)" << std::endl;
+  out << "  -p port       : Multicast port number (default 30001)" << std::endl;
+  out << "  -i dotted_ip  : Outbound interface; also used to receive (default 127.0.0.1)" << std::endl;
+  out << "  -s bytes      : Datagram size (default 100)" << std::endl;
+  out << "  -n count      : Datagrams to send for each measurement (default 1000000)" << std::endl;
+  out << "  -batch list   : Comma separated batch sizes to measure (default 1,8,32,64)" << std::endl;
+  out << "  -gso          : Also measure each batch size with UDP segmentation offload (Linux)." << std::endl;
+}
+
+bool
+MulticastSendRate::applyArgs()
+{
+  if(batchSizes_.empty())
+  {
+    batchSizes_.push_back(1);
+    batchSizes_.push_back(8);
+    batchSizes_.push_back(32);
+    batchSizes_.push_back(64);
+  }
+  if(packetSize_ == 0 || packetSize_ > 65000)
+  {
+    std::cerr << "ERROR: -s must be between 1 and 65000." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+MulticastSendRate::run()
+{
+  try
+  {
+    std::cout << "Sending " << packetCount_ << " datagrams of " << packetSize_ << " bytes to "
+      << sendAddress_ << ':' << portNumber_ << " via " << interfaceAddress_ << std::endl;
+    std::cout << "  batch  gso       msec      packets/sec  syscalls  speedup   delivered    delivered/sec" << std::endl;
+    double baseRate = 0.0;
+    for(size_t pass = 0; pass < (segmentation_ ? 2u : 1u); ++pass)
+    {
+      for(size_t nBatch = 0; nBatch < batchSizes_.size(); ++nBatch)
+      {
+        size_t sendCalls = 0;
+        size_t delivered = 0;
+        double deliveredRate = 0.0;
+        unsigned long lapse = sendAll(batchSizes_[nBatch], pass != 0, sendCalls, delivered, deliveredRate);
+        double rate = 1000. * double(packetCount_) / double(std::max(lapse, 1UL));
+        if(baseRate == 0.0)
+        {
+          baseRate = rate;
+        }
+        std::cout << std::setw(7) << batchSizes_[nBatch]
+          << std::setw(5) << (pass != 0 ? "yes" : "no")
+          << std::setw(11) << lapse
+          << std::setw(17) << std::fixed << std::setprecision(0) << rate
+          << std::setw(10) << sendCalls
+          << std::setw(9) << std::setprecision(2) << rate / baseRate
+          << std::setw(12) << delivered
+          << std::setw(17) << std::setprecision(0) << deliveredRate
+          << std::endl;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+unsigned long
+MulticastSendRate::sendAll(
+  size_t batchSize,
+  bool segmentation,
+  size_t & sendCalls,
+  size_t & delivered,
+  double & deliveredRate)
+{
+  boost::asio::io_service ioService;
+  DeliveryCounter counter(ioService, sendAddress_, interfaceAddress_, portNumber_);
+  Communication::MulticastSender sender(ioService, sendAddress_, portNumber_);
+  sender.initializeSender();
+  sender.socket().set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::from_string(interfaceAddress_)));
+  sender.socket().set_option(boost::asio::ip::multicast::enable_loopback(true));
+  sender.setBatchSize(batchSize);
+  sender.setSegmentation(segmentation);
+  std::vector<unsigned char> packet(packetSize_, 0x80);
+  counter.start();
+
+  uint64 start = Common::monotonicNanoseconds();
+  StopWatch watch;
+  for(size_t nPacket = 0; nPacket < packetCount_; ++nPacket)
+  {
+    // make each datagram different so nothing can be optimized away.
+    packet[0] = static_cast<unsigned char>(nPacket);
+    sender.queue(&packet[0], packet.size());
+  }
+  sender.flush();
+  unsigned long lapse = watch.freeze();
+  sendCalls = sender.sendCalls();
+
+  delivered = counter.finish();
+  deliveredRate = 0.0;
+  if(delivered != 0 && counter.lastReceived() > start)
+  {
+    deliveredRate = 1e9 * double(delivered) / double(counter.lastReceived() - start);
+  }
+  sender.stop();
+  return lapse;
+}
+
+void
+MulticastSendRate::fini()
+{
+}
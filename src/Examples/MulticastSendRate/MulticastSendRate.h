@@ -0,0 +1,67 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef MULTICASTSENDRATE_H
+#define MULTICASTSENDRATE_H
+
+#include <Examples/CommandArgParser.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Measure how many packets per second MulticastSender can send.
+    ///
+    /// The same number of datagrams is sent once for each batch size.  A batch
+    /// size of one is the same as calling send() for every datagram.
+    /// By default the datagrams are sent via the loopback interface so no
+    /// network is needed.
+    ///
+    /// A receiver on its own thread joins the group on the same interface and counts
+    /// the datagrams that arrive, since a datagram the kernel accepts may still be dropped.
+    ///
+    /// The report shows packets per second, system calls used, the speedup relative
+    /// to the first batch size, and how many datagrams were delivered and at what rate.
+    ///
+    /// Use the -? command line option for more information.
+    class MulticastSendRate : public CommandArgHandler
+    {
+    public:
+      MulticastSendRate();
+      ~MulticastSendRate();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+      unsigned long sendAll(
+        size_t batchSize,
+        bool segmentation,
+        size_t & sendCalls,
+        size_t & delivered,
+        double & deliveredRate);
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string sendAddress_;
+      std::string interfaceAddress_;
+      unsigned short portNumber_;
+      size_t packetSize_;
+      size_t packetCount_;
+      std::vector<size_t> batchSizes_;
+      bool segmentation_;
+    };
+  }
+}
+#endif // MULTICASTSENDRATE_H
@@ -0,0 +1,266 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "PCapFlowDecode.h"
+#include <Examples/MessagePerformance.h>
+#include <Examples/MessageInterpreter.h>
+#include <Examples/StopWatch.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+PCapFlowDecode::PCapFlowDecode()
+: maxThreads_(0)
+, merge_(false)
+, use32_(false)
+, use64_(false)
+, configurationArgs_(configuration_)
+{
+}
+
+PCapFlowDecode::~PCapFlowDecode()
+{
+}
+
+bool
+PCapFlowDecode::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  commandArgParser_.addHandler(&configurationArgs_);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+PCapFlowDecode::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-f" && argc > 1)
+    {
+      pcapFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-o" && argc > 1)
+    {
+      outputFileName_ = argv[1];
+      merge_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-threads" && argc > 1)
+    {
+      maxThreads_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-merge")
+    {
+      merge_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-flow" && argc > 1)
+    {
+      std::string flow(argv[1]);
+      std::string::size_type colon = flow.find(':');
+      if(colon == std::string::npos)
+      {
+        throw std::invalid_argument("expecting address:port");
+      }
+      flowFilters_.push_back(std::make_pair(
+        flow.substr(0, colon),
+        boost::lexical_cast<unsigned short>(flow.substr(colon + 1))));
+      consumed = 2;
+    }
+    else if(opt == "-32")
+    {
+      use32_ = true;
+      use64_ = false;
+      consumed = 1;
+    }
+    else if(opt == "-64")
+    {
+      use32_ = false;
+      use64_ = true;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+PCapFlowDecode::usage(std::ostream & out) const
+{
+  out << "  -t file       : Template file (required)." << std::endl;
+  out << "  -f file       : PCap file containing one or more multicast feeds (required)." << std::endl;
+  out << "                  Each destination address:port is decoded as a separate flow." << std::endl;
+  out << "  -threads n    : Measure 1 through n threads (default is the number of CPUs)." << std::endl;
+  out << "  -merge        : Merge the decoded messages into capture-timestamp order." << std::endl;
+  out << "  -o file       : Write the merged messages to a file (implies -merge)." << std::endl;
+  out << "  -flow a:p     : Only decode packets sent to address a, port p.  May be repeated." << std::endl;
+  out << "                  Address 0.0.0.0 matches any address." << std::endl;
+  out << "  -32           : Data file was captured on 32 bit system." << std::endl;
+  out << "  -64           : Data file was captured on 64 bit system." << std::endl;
+}
+
+bool
+PCapFlowDecode::applyArgs()
+{
+  bool ok = true;
+  try
+  {
+    if(templateFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+    }
+    if(pcapFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -f [pcapfile] option is required." << std::endl;
+    }
+    if(!ok)
+    {
+      commandArgParser_.usage(std::cerr);
+      return false;
+    }
+    std::ifstream templates(templateFileName_.c_str(), std::ios::in | std::ios::binary);
+    if(!templates.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return false;
+    }
+    Codecs::XMLTemplateParser parser;
+    registry_ = parser.parse(templates);
+
+    decoder_.reset(new Application::PCapFlowDecoder(registry_, configuration_));
+    decoder_->reader().set32bit(use32_);
+    decoder_->reader().set64bit(use64_);
+    for(size_t nFlow = 0; nFlow < flowFilters_.size(); ++nFlow)
+    {
+      decoder_->reader().addFlow(flowFilters_[nFlow].first, flowFilters_[nFlow].second);
+    }
+    if(decoder_->open(pcapFileName_) == 0)
+    {
+      std::cerr << "ERROR: No UDP packets found in " << pcapFileName_ << std::endl;
+      return false;
+    }
+
+    if(maxThreads_ == 0)
+    {
+      maxThreads_ = boost::thread::hardware_concurrency();
+      if(maxThreads_ == 0)
+      {
+        maxThreads_ = 1;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+int
+PCapFlowDecode::run()
+{
+  try
+  {
+    for(size_t nFlow = 0; nFlow < decoder_->flowCount(); ++nFlow)
+    {
+      std::cout << "Flow " << decoder_->flow(nFlow).name_ << ": "
+        << decoder_->flow(nFlow).packets_.size() << " packets." << std::endl;
+    }
+    if(decoder_->reader().filteredPackets() != 0)
+    {
+      std::cout << decoder_->reader().filteredPackets() << " packets skipped by -flow filters." << std::endl;
+    }
+    std::cout << "threads   messages       msec      msg/sec  speedup" << std::endl;
+    double baseRate = 0.0;
+    for(size_t threadCount = 1; threadCount <= maxThreads_; ++threadCount)
+    {
+      unsigned long lapse = 0;
+      size_t messageCount = decodeAll(threadCount, lapse);
+      double rate = 1000. * double(messageCount) / double(std::max(lapse, 1UL));
+      if(threadCount == 1)
+      {
+        baseRate = rate;
+      }
+      std::cout << std::setw(7) << threadCount
+        << std::setw(11) << messageCount
+        << std::setw(11) << lapse
+        << std::setw(13) << std::fixed << std::setprecision(0) << rate
+        << std::setw(9) << std::setprecision(2) << (baseRate > 0.0 ? rate / baseRate : 0.0)
+        << std::endl;
+    }
+    if(!outputFileName_.empty())
+    {
+      std::ofstream output(outputFileName_.c_str());
+      if(!output.good())
+      {
+        std::cerr << "ERROR: Can't open output file: " << outputFileName_ << std::endl;
+        return -1;
+      }
+      MessageInterpreter interpreter(output);
+      decoder_->decodeMerged(interpreter, maxThreads_);
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+size_t
+PCapFlowDecode::decodeAll(size_t threadCount, unsigned long & lapse)
+{
+  size_t messageCount = 0;
+  if(merge_)
+  {
+    std::ostringstream discard;
+    MessageInterpreter interpreter(discard, true);
+    StopWatch watch;
+    messageCount = decoder_->decodeMerged(interpreter, threadCount);
+    lapse = watch.freeze();
+  }
+  else
+  {
+    std::vector<boost::shared_ptr<PerformanceBuilder> > builderPtrs;
+    std::vector<Messages::ValueMessageBuilder *> builders;
+    for(size_t nFlow = 0; nFlow < decoder_->flowCount(); ++nFlow)
+    {
+      builderPtrs.push_back(boost::shared_ptr<PerformanceBuilder>(new PerformanceBuilder));
+      builders.push_back(builderPtrs.back().get());
+    }
+    StopWatch watch;
+    decoder_->decode(builders, threadCount);
+    lapse = watch.freeze();
+    for(size_t nFlow = 0; nFlow < builderPtrs.size(); ++nFlow)
+    {
+      messageCount += builderPtrs[nFlow]->msgCount();
+    }
+  }
+  return messageCount;
+}
+
+void
+PCapFlowDecode::fini()
+{
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef PCAPFLOWDECODE_H
+#define PCAPFLOWDECODE_H
+
+#include <Examples/CommandArgParser.h>
+#include <Examples/DecoderConfigurationArgs.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Application/PCapFlowDecoder.h>
+#include <Application/DecoderConfiguration.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Decode the flows in a PCap file in parallel using Application::PCapFlowDecoder.
+    ///
+    /// Each destination address and port in the capture is decoded as a separate flow
+    /// on one of N threads.  The file is decoded using 1, 2, ... N threads and the report
+    /// shows messages per second and the speedup relative to a single thread.
+    ///
+    /// With -merge the messages are merged back into capture-timestamp order, and the
+    /// time to merge is included in the measurement.  With -o the merged messages
+    /// are also written to a file.
+    ///
+    /// Use the -? command line option for more information.
+    class PCapFlowDecode : public CommandArgHandler
+    {
+    public:
+      PCapFlowDecode();
+      ~PCapFlowDecode();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+      size_t decodeAll(size_t threadCount, unsigned long & lapse);
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string templateFileName_;
+      std::string pcapFileName_;
+      std::string outputFileName_;
+      size_t maxThreads_;
+      bool merge_;
+      bool use32_;
+      bool use64_;
+      std::vector<std::pair<std::string, unsigned short> > flowFilters_;
+      Application::DecoderConfiguration configuration_;
+      DecoderConfigurationArgs configurationArgs_;
+
+      Codecs::TemplateRegistryPtr registry_;
+      boost::scoped_ptr<Application::PCapFlowDecoder> decoder_;
+    };
+  }
+}
+#endif // PCAPFLOWDECODE_H
@@ -5,6 +5,8 @@
 #include <Examples/ExamplesPch.h>
 #include "PCapToMulticast.h"
 #include <Examples/StopWatch.h>
+#include <Examples/ReplayScheduler.h>
+#include <Communication/MulticastSender.h>
 #include <Common/Types.h>
 using namespace QuickFAST;
 using namespace Examples;
@@ -30,7 +32,11 @@ PCapToMulticast::PCapToMulticast()
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
-, socket_(ioService_)
+, replay_(false)
+, replaySpeed_(1.0)
+, redirect_(false)
+, batchSize_(1)
+, segmentation_(false)
 , strand_(ioService_)
 , timer_(ioService_)
 , nPass_(0)
@@ -119,6 +125,39 @@ PCapToMulticast::parseSingleArg(int argc, char * argv[])
       pcapReader_.set64bit(true);
       consumed = 1;
     }
+    else if(opt == "-replay" && argc > 1)
+    {
+      std::string speed(argv[1]);
+      replay_ = true;
+      if(speed == "max")
+      {
+        replaySpeed_ = 0.0;
+      }
+      else
+      {
+        if(!speed.empty() && (speed[speed.size() - 1] == 'x' || speed[speed.size() - 1] == 'X'))
+        {
+          speed.resize(speed.size() - 1);
+        }
+        replaySpeed_ = boost::lexical_cast<double>(speed);
+      }
+      consumed = 2;
+    }
+    else if(opt == "-batch" && argc > 1)
+    {
+      batchSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-gso")
+    {
+      segmentation_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-redirect")
+    {
+      redirect_ = true;
+      consumed = 1;
+    }
     else if(opt == "-v")
     {
       verbose_ = !verbose_;
@@ -144,6 +183,13 @@ PCapToMulticast::usage(std::ostream & out) const
   out << "  -b msg/burst  : Messages per burst(default = 1)" << std::endl;
   out << "  -c count      : How many times to send the file (passes)" << std::endl;
   out << "                  (default 1; 0 means forever.)" << std::endl;
+  out << "  -replay speed : Send packets with the spacing recorded in the capture timestamps" << std::endl;
+  out << "                  multiplied by speed (i.e. 1, 10x, 0.5).  'max' means no delay." << std::endl;
+  out << "                  Each packet goes to its original group and port.  -r and -b are ignored." << std::endl;
+  out << "  -redirect     : With -replay, send every packet to -a and -p instead." << std::endl;
+  out << "  -batch n      : Send up to n packets per system call (default 1)." << std::endl;
+  out << "                  Packets are never held back past their send time." << std::endl;
+  out << "  -gso          : Use UDP segmentation offload for batches when possible (Linux)." << std::endl;
   out << "  -pausemessage : Wait for 'Enter' before every message." << std::endl;
   out << "  -pausepass    : Wait for 'Enter' before every pass." << std::endl;
   out << "  -32           : Data file was captured on 32 bit system." << std::endl;
@@ -167,7 +213,10 @@ PCapToMulticast::applyArgs()
 
     multicastAddress_ = boost::asio::ip::address::from_string(sendAddress_);
     endpoint_ = boost::asio::ip::udp::endpoint(multicastAddress_, portNumber_);
-    socket_.open(endpoint_.protocol());
+    sender_.reset(new Communication::MulticastSender(ioService_, sendAddress_, portNumber_));
+    sender_->initializeSender();
+    sender_->setBatchSize(batchSize_);
+    sender_->setSegmentation(segmentation_);
     std::cout << "Opening multicast group: " << endpoint_.address().to_string() << ':' << endpoint_.port() << std::endl;
   }
   catch (std::exception& e)
@@ -188,10 +237,17 @@ PCapToMulticast::run()
       std::cout << " Configuring multicast: " << multicastAddress_ << '|' << sendAddress_ << ':' << portNumber_ << std::endl;
     }
 
-    strand_.dispatch(
-        strand_.wrap(boost::bind(&PCapToMulticast::sendBurst, this)));
     StopWatch lapse;
-    this->ioService_.run();
+    if(replay_)
+    {
+      replay();
+    }
+    else
+    {
+      strand_.dispatch(
+          strand_.wrap(boost::bind(&PCapToMulticast::sendBurst, this)));
+      this->ioService_.run();
+    }
     unsigned long sendLapse = lapse.freeze();
     std::cout << "sent "
       << totalMessageCount_
@@ -243,6 +299,7 @@ PCapToMulticast::sendBurst()
         nPass_ += 1;
         if(nPass_ >= sendCount_ && sendCount_ != 0)
         {
+          sender_->flush();
           ioService_.stop();
           return;
         }
@@ -287,8 +344,9 @@ PCapToMulticast::sendBurst()
       {
         waitForEnter();
       }
-      socket_.send_to(boost::asio::buffer(msgBuffer, bytesRead), endpoint_);
+      sender_->queue(msgBuffer, bytesRead);
     }
+    sender_->flush();
   }
   catch (std::exception& e)
   {
@@ -297,6 +355,75 @@ PCapToMulticast::sendBurst()
   }
 }
 
+void
+PCapToMulticast::replay()
+{
+  ReplayScheduler scheduler(replaySpeed_);
+  uint64 captureLapse = 0;
+  uint64 replayLapse = 0;
+  for(nPass_ = 0; sendCount_ == 0 || nPass_ < sendCount_; ++nPass_)
+  {
+    if(verbose_)
+    {
+      std::cout << "Begin pass #" << nPass_ << " of " << sendCount_ << std::endl;
+    }
+    if(pauseEveryPass_)
+    {
+      waitForEnter();
+    }
+    pcapReader_.rewind();
+    nMsg_ = 0;
+    uint64 firstTimestamp = 0;
+    uint64 lastTimestamp = 0;
+    uint64 passStart = Common::monotonicNanoseconds();
+    const unsigned char * msgBuffer = 0;
+    size_t bytesRead = 0;
+    while(pcapReader_.read(msgBuffer, bytesRead))
+    {
+      uint64 timestamp = pcapReader_.timestamp();
+      if(nMsg_ == 0)
+      {
+        firstTimestamp = timestamp;
+        scheduler.start(timestamp);
+      }
+      lastTimestamp = std::max(lastTimestamp, timestamp);
+      if(pauseEveryMessage_)
+      {
+        waitForEnter();
+      }
+      boost::asio::ip::udp::endpoint destination = endpoint_;
+      if(!redirect_)
+      {
+        destination = boost::asio::ip::udp::endpoint(
+          boost::asio::ip::address_v4(pcapReader_.destinationAddress()),
+          pcapReader_.destinationPort());
+      }
+      if(!scheduler.due(timestamp))
+      {
+        // don't hold queued packets while waiting for this one.
+        sender_->flush();
+      }
+      scheduler.waitUntil(timestamp);
+      sender_->queue(msgBuffer, bytesRead, destination);
+      nMsg_ += 1;
+      totalMessageCount_ += 1;
+      if(verbose_)
+      {
+        std::cout << "Send message #" << nMsg_ << " to " << destination << std::endl;
+      }
+    }
+    sender_->flush();
+    captureLapse += lastTimestamp - firstTimestamp;
+    replayLapse += Common::monotonicNanoseconds() - passStart;
+  }
+  if(replaySpeed_ > 0.0)
+  {
+    std::cout << "Target replay time "
+      << std::fixed << std::setprecision(3) << double(captureLapse) / replaySpeed_ / 1000000.0
+      << " msec. Actual " << double(replayLapse) / 1000000.0 << " msec." << std::endl;
+    scheduler.report(std::cout);
+  }
+}
 
 void
 PCapToMulticast::fini()
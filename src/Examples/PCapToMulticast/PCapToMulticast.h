@@ -8,6 +8,7 @@
 #define PCAP_SUPPORT_IS_HEREx
 #include <Examples/CommandArgParser.h>
 #include <Communication/PCapReader.h>
+#include <Communication/MulticastSender_fwd.h>
 #include <boost/asio.hpp>
 #include <stdio.h>
 
@@ -20,6 +21,10 @@ namespace QuickFAST{
     /// to identify the message boundaries in a FAST encoded data file.
     /// It multicasts each message in a separate datagram.
     ///
+    /// With -replay, packets are sent with the same spacing as the capture timestamps
+    /// (optionally speeded up) to their original multicast group and port, and the
+    /// accuracy of the replay timing is reported.
+    ///
     /// Use the -? command line option for more information.
     ///
     /// This program is not really FAST-aware. It is just part of a testing
@@ -43,6 +48,7 @@ namespace QuickFAST{
 
     private:
       void sendBurst();
+      void replay();
 
     private:
       virtual int parseSingleArg(int argc, char * argv[]);
@@ -60,11 +66,15 @@ namespace QuickFAST{
       bool force32_;
       bool force64_;
       bool verbose_;
+      bool replay_;
+      double replaySpeed_;
+      bool redirect_;
+      size_t batchSize_;
+      bool segmentation_;
 
       boost::asio::io_service ioService_;
       boost::asio::ip::address multicastAddress_;
       boost::asio::ip::udp::endpoint endpoint_;
-      boost::asio::ip::udp::socket socket_;
       boost::asio::strand strand_;
       boost::asio::deadline_timer timer_;
 
@@ -74,6 +84,7 @@ namespace QuickFAST{
       size_t nPass_;
       size_t nMsg_;
       size_t totalMessageCount_;
+      Communication::MulticastSenderPtr sender_;
     };
   }
 }
@@ -7,11 +7,18 @@
 #include "PerformanceTest.h"
 #include <Codecs/DataSourceStream.h>
 #include <Codecs/DataSourceBufferedStream.h>
+#include <Codecs/DataSourceMapped.h>
+#include <Codecs/DataSourceReadAhead.h>
 #include <Codecs/SynchronousDecoder.h>
 #include <Codecs/TemplateRegistry.h>
+#include <Codecs/TemplateCache.h>
 #include <Codecs/GenericMessageBuilder.h>
+#include <Messages/AllocationPhaseBuilder.h>
+#include <Common/Timestamp.h>
 
 #include <Examples/MessagePerformance.h>
+#include <Examples/AllocationReport.h>
+#include <Examples/LatencyReport.h>
 #include <PerformanceTest/NullMessage.h>
 
 #include <Examples/StopWatch.h>
@@ -20,6 +27,38 @@
 using namespace QuickFAST;
 using namespace Examples;
 
+namespace
+{
+  /// @brief Time each message decoded by a SynchronousDecoder.
+  class LatencyTimer : public Codecs::DecodeObserver
+  {
+  public:
+    explicit LatencyTimer(LatencyReport & report)
+      : report_(report)
+      , offset_(0)
+      , start_(0)
+    {
+    }
+
+    virtual void messageStarting(const Codecs::DataSource & source)
+    {
+      offset_ = source.bytesConsumed();
+      start_ = profilerTicks();
+    }
+
+    virtual void messageDecoded(template_id_t templateId, size_t messageNumber)
+    {
+      uint64 ticks = profilerTicks() - start_;
+      report_.record(templateId, ticks, messageNumber, offset_);
+    }
+
+  private:
+    LatencyReport & report_;
+    uint64 offset_;
+    uint64 start_;
+  };
+}
+
 PerformanceTest::PerformanceTest()
   : resetOnMessage_(false)
   , strict_(true)
@@ -31,6 +70,11 @@ PerformanceTest::PerformanceTest()
   , interpret_(false)
   , headerBytes_(0)
   , echo_(false)
+  , map_(false)
+  , blocked_(false)
+  , readAhead_(0)
+  , latency_(false)
+  , allocations_(false)
 {
 }
 
@@ -112,6 +156,48 @@ PerformanceTest::parseSingleArg(int argc, char * argv[])
       echo_ = true;
       consumed = 1;
     }
+    else if(opt == "-map")
+    {
+      map_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-blocked")
+    {
+      map_ = true;
+      blocked_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-latency")
+    {
+      latency_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-json" && argc > 1)
+    {
+      latency_ = true;
+      jsonFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-allocations")
+    {
+      allocations_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-cache" && argc > 1)
+    {
+      cacheFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-readahead")
+    {
+      readAhead_ = 3;
+      consumed = 1;
+      if(argc > 1 && argv[1][0] != '-')
+      {
+        readAhead_ = boost::lexical_cast<size_t>(argv[1]);
+        consumed = 2;
+      }
+    }
   }
   catch (std::exception & ex)
   {
@@ -135,6 +221,16 @@ PerformanceTest::usage(std::ostream & out) const
   out << "  -null       : Use null message to receive fields." << std::endl;
   out << "  -s          : Toggle 'strict decoding rules' (default true)." << std::endl;
   out << "  -hfix n     : Skip n byte header before each message" << std::endl;
+  out << "  -map        : Memory map the FAST Message file rather than reading it." << std::endl;
+  out << "  -blocked    : Each message in the FAST Message file is preceded by its size" << std::endl;
+  out << "                (stop bit encoded; i.e. TrafficGenerator -format blocked).  Implies -map." << std::endl;
+  out << "  -readahead [n] : Read the FAST Message file on a background thread into n buffers (default 3)." << std::endl;
+  out << "                 The file is read as a stream so it may be a pipe (i.e. -f /dev/stdin)." << std::endl;
+  out << "  -latency    : Time each message.  Report percentiles per template and the slowest messages." << std::endl;
+  out << "  -json file  : Write the -latency report to file as JSON." << std::endl;
+  out << "  -allocations : Report heap allocations per message for the assembler, decoder and builder." << std::endl;
+  out << "  -cache file : Write the parsed templates to a binary template cache, then time" << std::endl;
+  out << "                loading them back and decode with the loaded templates." << std::endl;
   out << std::endl;
   out << " THE FOLLOWING INVALIDATES THE PERFORMANCE TEST NUMBERS, OF COURSE." << std::endl;
   out << "  -e          : Echo input to standard out in hex; include message and field boundaries (for debugging)" << std::endl;
@@ -172,7 +268,7 @@ PerformanceTest::applyArgs()
       ok = false;
       std::cerr << "ERROR: -f [FASTfile] option is required." << std::endl;
     }
-    if(ok)
+    if(ok && !map_)
     {
       fastFile_.open(fastFileName_.c_str(), std::ios::in
 #ifdef _WIN32
@@ -236,7 +332,9 @@ PerformanceTest::run()
     std::cout << "Parsing templates" << std::endl;
     Codecs::XMLTemplateParser parser;
     StopWatch parseTimer;
+    uint64 parseStart = Common::wallClockNanoseconds();
     Codecs::TemplateRegistryPtr templateRegistry = parser.parse(templateFile_);
+    uint64 parseNanoseconds = Common::wallClockNanoseconds() - parseStart;
     unsigned long parseLapse = parseTimer.freeze();
     size_t templateCount = templateRegistry->size();
     (*performanceFile_) << "Parsed "
@@ -250,36 +348,92 @@ PerformanceTest::run()
       << std::fixed << std::setprecision(0)
       << 1000. * double(templateCount)/double(parseLapse) << " template/second.]"
       << std::endl;
+    if(!cacheFileName_.empty())
+    {
+      Codecs::TemplateCache::writeFile(*templateRegistry, cacheFileName_);
+      uint64 loadStart = Common::wallClockNanoseconds();
+      templateRegistry = Codecs::TemplateCache::readFile(cacheFileName_);
+      uint64 loadNanoseconds = Common::wallClockNanoseconds() - loadStart;
+      (*performanceFile_) << "Loaded "
+        << templateRegistry->size()
+        << " templates from cache in "
+        << std::fixed << std::setprecision(3)
+        << double(loadNanoseconds) / 1000000.
+        << " milliseconds. [XML parse took "
+        << double(parseNanoseconds) / 1000000.
+        << " milliseconds = "
+        << std::setprecision(1)
+        << double(parseNanoseconds) / double(loadNanoseconds ? loadNanoseconds : 1)
+        << " times longer.]"
+        << std::endl;
+    }
+    boost::scoped_ptr<LatencyReport> latency;
+    if(latency_)
+    {
+      latency.reset(new LatencyReport(ProfileAccumulator::nanosecondsPerTick()));
+    }
     for(size_t nPass = 0; nPass < count_; ++nPass)
     {
       if(count_ > 1)
       {
         std::cout << "Decoding input; pass " << nPass + 1 << " of " << count_ << std::endl;
       }
-      fastFile_.seekg(0, std::ios::beg);
-      Codecs::DataSourceBufferedStream source(fastFile_);
+      boost::scoped_ptr<Codecs::DataSource> source;
+      Codecs::DataSourceReadAhead * readAhead = 0;
+      if(map_)
+      {
+        source.reset(new Codecs::DataSourceMapped(fastFileName_, blocked_));
+      }
+      else if(readAhead_ != 0)
+      {
+        if(nPass > 0)
+        {
+          fastFile_.clear();
+          fastFile_.seekg(0, std::ios::beg);
+        }
+        readAhead = new Codecs::DataSourceReadAhead(fastFile_, 256 * 1024, readAhead_);
+        source.reset(readAhead);
+      }
+      else
+      {
+        fastFile_.seekg(0, std::ios::beg);
+        source.reset(new Codecs::DataSourceBufferedStream(fastFile_));
+      }
       if(echo_)
       {
-        source.setEcho(std::cout, Codecs::DataSource::HEX, true, true);
+        source->setEcho(std::cout, Codecs::DataSource::HEX, true, true);
       }
 
-      PerformanceBuilder builder;
+      PerformanceBuilder performanceBuilder;
+      // charge the builder's allocations separately from the decoder's
+      Messages::AllocationPhaseBuilder phaseBuilder(performanceBuilder);
+      Messages::ValueMessageBuilder & builder = allocations_
+        ? static_cast<Messages::ValueMessageBuilder &>(phaseBuilder)
+        : static_cast<Messages::ValueMessageBuilder &>(performanceBuilder);
       Codecs::SynchronousDecoder decoder(templateRegistry);
       decoder.setResetOnMessage(resetOnMessage_);
       decoder.setStrict(strict_);
       decoder.setLimit(head_);
       decoder.setHeaderBytes(headerBytes_);
+      boost::scoped_ptr<LatencyTimer> latencyTimer;
+      if(latency)
+      {
+        latencyTimer.reset(new LatencyTimer(*latency));
+        decoder.setObserver(latencyTimer.get());
+      }
+      Common::AllocationCounter::Snapshot allocationsBefore;
       StopWatch decodeTimer;
       {
         PROFILE_POINT("Main");
-        decoder.decode(source, builder);
+        decoder.decode(*source, builder);
       }//PROFILE_POINT
       unsigned long decodeLapse = decodeTimer.freeze();
-      size_t messageCount = builder.msgCount();//handler.getMessageCount();
-      size_t groupCount = builder.groupCount();
-      size_t fieldCount = builder.fieldCount();
-      size_t sequenceCount = builder.sequenceCount();
-      size_t sequenceEntryCount = builder.sequenceEntryCount();
+      Common::AllocationCounter::Snapshot allocations = Common::AllocationCounter::Snapshot().since(allocationsBefore);
+      size_t messageCount = performanceBuilder.msgCount();//handler.getMessageCount();
+      size_t groupCount = performanceBuilder.groupCount();
+      size_t fieldCount = performanceBuilder.fieldCount();
+      size_t sequenceCount = performanceBuilder.sequenceCount();
+      size_t sequenceEntryCount = performanceBuilder.sequenceEntryCount();
       (*performanceFile_)
 #ifdef _DEBUG
         << "[debug] "
@@ -317,6 +471,32 @@ PerformanceTest::run()
             << std::endl;
         }
       }
+      if(allocations_)
+      {
+        AllocationReport::writeText(*performanceFile_, allocations, messageCount);
+      }
+      if(readAhead != 0)
+      {
+        // many decoder waits means I/O bound; many reader waits means decode bound.
+        (*performanceFile_)
+          << "      Read ahead: " << readAhead->bytesDelivered() << " bytes;"
+          << " decoder waited " << readAhead->decoderWaits()
+          << " times; reader waited " << readAhead->readerWaits()
+          << " times." << std::endl;
+      }
+    }
+    if(latency)
+    {
+      latency->writeText(*performanceFile_);
+      if(!jsonFileName_.empty())
+      {
+        std::ofstream json(jsonFileName_.c_str());
+        latency->writeJson(json, fastFileName_);
+        if(!json.good())
+        {
+          std::cerr << "ERROR: Can't write JSON output file: " << jsonFileName_ << std::endl;
+        }
+      }
     }
   }
   catch (std::exception & e)
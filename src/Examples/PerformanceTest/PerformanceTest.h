@@ -54,6 +54,13 @@ namespace QuickFAST{
       size_t interpret_;
       size_t headerBytes_;
       bool echo_;
+      bool map_;
+      bool blocked_;
+      size_t readAhead_;
+      bool latency_;
+      std::string jsonFileName_;
+      bool allocations_;
+      std::string cacheFileName_;
 
       Codecs::XMLTemplateParser parser_;
       CommandArgParser commandArgParser_;
@@ -6,9 +6,15 @@
 #include <Examples/ExamplesPch.h>
 #include <PerformanceTest/PerformanceTest.h>
 
+#include <Common/AllocationCounter.h>
+#include <new>
+#include <cstdlib>
+
 using namespace QuickFAST;
 using namespace Examples;
 
+QUICKFAST_COUNT_ALLOCATIONS
+
 
 int main(int argc, char* argv[])
 {
@@ -0,0 +1,167 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "StatisticsMonitor.h"
+
+using namespace QuickFAST;
+using namespace Examples;
+
+StatisticsMonitor::StatisticsMonitor()
+: interval_(1000)
+, count_(0)
+, previousTime_(0)
+{
+}
+
+StatisticsMonitor::~StatisticsMonitor()
+{
+}
+
+bool
+StatisticsMonitor::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+StatisticsMonitor::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-s" && argc > 1)
+    {
+      segmentName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-interval" && argc > 1)
+    {
+      interval_ = boost::lexical_cast<unsigned long>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-count" && argc > 1)
+    {
+      count_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-filter" && argc > 1)
+    {
+      filter_ = argv[1];
+      consumed = 2;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+StatisticsMonitor::usage(std::ostream & out) const
+{
+  out << "  -s name        : Shared memory segment to read (required)." << std::endl;
+  out << "  -interval ms   : Time between displays (default 1000)." << std::endl;
+  out << "  -count n       : Stop after n displays; 0 means run until interrupted (default 0)." << std::endl;
+  out << "  -filter text   : Only display statistics whose names contain text." << std::endl;
+}
+
+bool
+StatisticsMonitor::applyArgs()
+{
+  bool ok = true;
+  if(segmentName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -s [segment] option is required." << std::endl;
+  }
+  if(interval_ == 0)
+  {
+    ok = false;
+    std::cerr << "ERROR: -interval must be greater than zero." << std::endl;
+  }
+  if(!ok)
+  {
+    commandArgParser_.usage(std::cerr);
+  }
+  return ok;
+}
+
+int
+StatisticsMonitor::run()
+{
+  if(!segment_.open(segmentName_))
+  {
+    std::cerr << "ERROR: Can't open statistics segment: " << segmentName_ << std::endl;
+    return -1;
+  }
+  std::vector<Common::Statistic> statistics;
+  for(size_t nDisplay = 0; count_ == 0 || nDisplay < count_; ++nDisplay)
+  {
+    if(nDisplay != 0)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(interval_));
+    }
+    uint64 publishTime = 0;
+    if(!segment_.read(statistics, publishTime))
+    {
+      std::cout << "No statistics available." << std::endl;
+    }
+    else if(publishTime == previousTime_)
+    {
+      // The publisher may have been restarted with a new segment.
+      std::cout << "No new statistics since the last display." << std::endl;
+      segment_.open(segmentName_);
+    }
+    else
+    {
+      display(std::cout, statistics, publishTime);
+    }
+  }
+  return 0;
+}
+
+void
+StatisticsMonitor::display(
+  std::ostream & out,
+  const std::vector<Common::Statistic> & statistics,
+  uint64 publishTime)
+{
+  double seconds = double(publishTime - previousTime_) / 1e9;
+  bool haveRates = previousTime_ != 0 && publishTime > previousTime_;
+  out << std::endl
+    << std::left << std::setw(48) << "Statistic"
+    << std::right << std::setw(16) << "Value"
+    << std::setw(16) << "Per second" << std::endl;
+  for(size_t nStatistic = 0; nStatistic < statistics.size(); ++nStatistic)
+  {
+    const Common::Statistic & statistic = statistics[nStatistic];
+    std::string name(statistic.name());
+    uint64 value = statistic.value();
+    if(filter_.empty() || name.find(filter_) != std::string::npos)
+    {
+      out << std::left << std::setw(48) << name
+        << std::right << std::setw(16) << value;
+      Values::const_iterator previous = previous_.find(name);
+      if(statistic.kind() == Common::Statistic::COUNTER && haveRates
+        && previous != previous_.end() && value >= previous->second)
+      {
+        out << std::setw(16) << std::fixed << std::setprecision(1)
+          << double(value - previous->second) / seconds;
+      }
+      out << std::endl;
+    }
+    previous_[name] = value;
+  }
+  previousTime_ = publishTime;
+}
+
+void
+StatisticsMonitor::fini()
+{
+}
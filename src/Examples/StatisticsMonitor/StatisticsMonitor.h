@@ -0,0 +1,61 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef STATISTICSMONITOR_H
+#define STATISTICSMONITOR_H
+
+#include <Common/StatisticsSegment.h>
+#include <Examples/CommandArgParser.h>
+
+namespace QuickFAST{
+  namespace Examples{
+
+    /// @brief Display the statistics published by another process.
+    ///
+    /// Reads a Common::StatisticsSegment created by a Common::StatisticsPublisher
+    /// (i.e. LoopbackLatency -statistics name) at regular intervals and writes each
+    /// statistic with the rate at which it is changing.  The monitored process
+    /// is not interrupted: reading the segment takes no lock the monitored process uses.
+    ///
+    /// Use the -? command line option for more information.
+    class StatisticsMonitor : public CommandArgHandler
+    {
+    public:
+      StatisticsMonitor();
+      ~StatisticsMonitor();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      typedef std::map<std::string, uint64> Values;
+      void display(std::ostream & out, const std::vector<Common::Statistic> & statistics, uint64 publishTime);
+
+    private:
+      CommandArgParser commandArgParser_;
+      std::string segmentName_;
+      unsigned long interval_;
+      size_t count_;
+      std::string filter_;
+
+      Common::StatisticsSegment segment_;
+      Values previous_;
+      uint64 previousTime_;
+    };
+  }
+}
+#endif // STATISTICSMONITOR_H
@@ -0,0 +1,416 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "TrafficGenerator.h"
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Communication/PacketJournal.h>
+#include <Messages/Message.h>
+#include <Common/WorkingBuffer.h>
+#include <Examples/StopWatch.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  // The time stamp of the first packet in a pcap file: 2010-01-01 00:00:00 UTC
+  // A fixed time keeps the output the same from run to run.
+  const uint64 pcapStartTime = 1262304000ULL * 1000000000ULL;
+
+  /// Interpret a size with an optional K, M or G suffix.
+  uint64 parseSize(const std::string & text)
+  {
+    uint64 multiplier = 1;
+    std::string digits(text);
+    if(!digits.empty())
+    {
+      switch(digits[digits.size() - 1])
+      {
+      case 'k': case 'K':
+        multiplier = 1024;
+        break;
+      case 'm': case 'M':
+        multiplier = 1024 * 1024;
+        break;
+      case 'g': case 'G':
+        multiplier = 1024 * 1024 * 1024;
+        break;
+      }
+      if(multiplier != 1)
+      {
+        digits.erase(digits.size() - 1);
+      }
+    }
+    return boost::lexical_cast<uint64>(digits) * multiplier;
+  }
+
+  /// Prefix a block with its size for DataSourceBlockedStream and DataSourceMapped.
+  size_t encodeBlockSize(size_t size, unsigned char * prefix)
+  {
+    unsigned char reversed[10];
+    size_t length = 0;
+    do
+    {
+      reversed[length++] = static_cast<unsigned char>(size & 0x7F);
+      size >>= 7;
+    } while(size != 0);
+    reversed[0] |= 0x80;
+    for(size_t pos = 0; pos < length; ++pos)
+    {
+      prefix[pos] = reversed[length - pos - 1];
+    }
+    return length;
+  }
+}
+
+TrafficGenerator::TrafficGenerator()
+  : format_(RAW)
+  , messageCount_(0)
+  , byteLimit_(0)
+  , symbolCount_(100)
+  , repeatProbability_(0.8)
+  , deltaStep_(5)
+  , minimumSequenceLength_(1)
+  , maximumSequenceLength_(5)
+  , absentProbability_(0.1)
+  , seed_(1)
+  , resetOnMessage_(false)
+  , address_("239.255.0.1")
+  , port_(30001)
+  , interval_(10000)
+{
+}
+
+TrafficGenerator::~TrafficGenerator()
+{
+}
+
+bool
+TrafficGenerator::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+TrafficGenerator::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-o" && argc > 1)
+    {
+      outputFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-format" && argc > 1)
+    {
+      std::string format(argv[1]);
+      consumed = 2;
+      if(format == "raw")
+      {
+        format_ = RAW;
+      }
+      else if(format == "blocked")
+      {
+        format_ = BLOCKED;
+      }
+      else if(format == "pcap")
+      {
+        format_ = PCAP;
+      }
+      else
+      {
+        std::cerr << "Unknown format: " << format << std::endl;
+        consumed = 0;
+      }
+    }
+    else if(opt == "-count" && argc > 1)
+    {
+      messageCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-size" && argc > 1)
+    {
+      byteLimit_ = parseSize(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-mix" && argc > 1)
+    {
+      mix_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-symbols" && argc > 1)
+    {
+      symbolCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-repeat" && argc > 1)
+    {
+      repeatProbability_ = boost::lexical_cast<double>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-step" && argc > 1)
+    {
+      deltaStep_ = boost::lexical_cast<uint32>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-seqlen" && argc > 1)
+    {
+      std::string range(argv[1]);
+      std::string::size_type comma = range.find(',');
+      minimumSequenceLength_ = boost::lexical_cast<size_t>(range.substr(0, comma));
+      maximumSequenceLength_ = comma == std::string::npos
+        ? minimumSequenceLength_
+        : boost::lexical_cast<size_t>(range.substr(comma + 1));
+      consumed = 2;
+    }
+    else if(opt == "-absent" && argc > 1)
+    {
+      absentProbability_ = boost::lexical_cast<double>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-seed" && argc > 1)
+    {
+      seed_ = boost::lexical_cast<uint64>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-r")
+    {
+      resetOnMessage_ = !resetOnMessage_;
+      consumed = 1;
+    }
+    else if(opt == "-a" && argc > 1)
+    {
+      address_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-p" && argc > 1)
+    {
+      port_ = boost::lexical_cast<unsigned short>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-interval" && argc > 1)
+    {
+      interval_ = boost::lexical_cast<uint64>(argv[1]);
+      consumed = 2;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+TrafficGenerator::usage(std::ostream & out) const
+{
+  out << "  -t file        : Template file (required)" << std::endl;
+  out << "  -o file        : Output file (required)" << std::endl;
+  out << "  -format type   : raw, blocked or pcap (default raw)" << std::endl;
+  out << "                     raw: messages one after another." << std::endl;
+  out << "                     blocked: each message is preceded by its size (stop bit encoded)." << std::endl;
+  out << "                     pcap: one message per UDP packet." << std::endl;
+  out << "  -count n       : Number of messages to generate." << std::endl;
+  out << "  -size bytes    : Stop when the output reaches this size.  May end with K, M or G." << std::endl;
+  out << "                   At least one of -count or -size is required." << std::endl;
+  out << "  -mix id:weight[,id:weight...] : Templates to use and their relative frequency." << std::endl;
+  out << "                   (default all templates equally)" << std::endl;
+  out << "  -symbols n     : Number of distinct values for copy fields (default 100)" << std::endl;
+  out << "  -repeat p      : Probability that a copy or default field repeats (default 0.8)" << std::endl;
+  out << "  -step n        : Largest change in a delta field from one message to the next (default 5)" << std::endl;
+  out << "  -seqlen min,max: Range of sequence lengths (default 1,5)" << std::endl;
+  out << "  -absent p      : Probability that an optional field is absent (default 0.1)" << std::endl;
+  out << "  -seed n        : Seed for the random values (default 1)" << std::endl;
+  out << "  -r             : Toggle 'reset encoder on every message' (default false)." << std::endl;
+  out << "                   Use this for pcap files that will be decoded one packet at a time." << std::endl;
+  out << "  -a address     : Destination address recorded in a pcap file (default 239.255.0.1)" << std::endl;
+  out << "  -p port        : Destination port recorded in a pcap file (default 30001)" << std::endl;
+  out << "  -interval ns   : Time between packets in a pcap file (default 10000)" << std::endl;
+}
+
+bool
+TrafficGenerator::applyArgs()
+{
+  bool ok = true;
+  if(templateFileName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+  }
+  if(outputFileName_.empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -o [outputfile] option is required." << std::endl;
+  }
+  if(messageCount_ == 0 && byteLimit_ == 0)
+  {
+    ok = false;
+    std::cerr << "ERROR: -count or -size is required." << std::endl;
+  }
+  if(!ok)
+  {
+    commandArgParser_.usage(std::cerr);
+  }
+  return ok;
+}
+
+void
+TrafficGenerator::applyMix(MessageGenerator & generator)const
+{
+  std::string::size_type pos = 0;
+  while(pos < mix_.size())
+  {
+    std::string::size_type comma = mix_.find(',', pos);
+    if(comma == std::string::npos)
+    {
+      comma = mix_.size();
+    }
+    std::string entry = mix_.substr(pos, comma - pos);
+    std::string::size_type colon = entry.find(':');
+    template_id_t id = boost::lexical_cast<template_id_t>(entry.substr(0, colon));
+    double weight = colon == std::string::npos
+      ? 1.0
+      : boost::lexical_cast<double>(entry.substr(colon + 1));
+    generator.addTemplate(id, weight);
+    pos = comma + 1;
+  }
+}
+
+int
+TrafficGenerator::run()
+{
+  int result = 0;
+  try
+  {
+    std::ifstream templateFile(templateFileName_.c_str(), std::ios::in
+#ifdef _WIN32
+      | std::ios::binary
+#endif
+      );
+    if(!templateFile.good())
+    {
+      std::cerr << "ERROR: Can't open template file: " << templateFileName_ << std::endl;
+      return -1;
+    }
+    Codecs::XMLTemplateParser parser;
+    Codecs::TemplateRegistryPtr registry = parser.parse(templateFile);
+
+    MessageGenerator generator(registry, seed_);
+    generator.setSymbolCount(symbolCount_);
+    generator.setRepeatProbability(repeatProbability_);
+    generator.setDeltaStep(deltaStep_);
+    generator.setSequenceLength(minimumSequenceLength_, maximumSequenceLength_);
+    generator.setAbsentProbability(absentProbability_);
+    applyMix(generator);
+
+    std::ofstream output;
+    Communication::PacketJournal journal(1024 * 1024, 8, Communication::PacketJournal::BACKPRESSURE);
+    if(format_ == PCAP)
+    {
+      journal.setDestination(address_, port_);
+      if(!journal.open(outputFileName_))
+      {
+        std::cerr << "ERROR: Can't create output file: " << outputFileName_ << std::endl;
+        return -1;
+      }
+    }
+    else
+    {
+      output.open(outputFileName_.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if(!output.good())
+      {
+        std::cerr << "ERROR: Can't create output file: " << outputFileName_ << std::endl;
+        return -1;
+      }
+    }
+
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    WorkingBuffer encoded;
+    size_t messages = 0;
+    uint64 bytes = 0;
+    StopWatch timer;
+    while((messageCount_ == 0 || messages < messageCount_)
+      && (byteLimit_ == 0 || bytes < byteLimit_))
+    {
+      Messages::Message message(generator.maxFieldCount());
+      template_id_t id = generator.generate(message);
+      if(resetOnMessage_)
+      {
+        encoder.reset();
+      }
+      destination.clear();
+      encoder.encodeMessage(destination, id, message);
+      destination.toWorkingBuffer(encoded);
+
+      if(format_ == PCAP)
+      {
+        journal.record(encoded.begin(), encoded.size(), pcapStartTime + messages * interval_);
+      }
+      else
+      {
+        if(format_ == BLOCKED)
+        {
+          unsigned char prefix[10];
+          size_t prefixSize = encodeBlockSize(encoded.size(), prefix);
+          output.write(reinterpret_cast<const char *>(prefix), prefixSize);
+          bytes += prefixSize;
+        }
+        output.write(reinterpret_cast<const char *>(encoded.begin()), encoded.size());
+      }
+      bytes += encoded.size();
+      ++messages;
+    }
+    if(format_ == PCAP)
+    {
+      journal.close();
+      if(journal.writeErrors() != 0)
+      {
+        std::cerr << "ERROR: " << journal.writeErrors() << " writes to " << outputFileName_ << " failed." << std::endl;
+        result = -1;
+      }
+    }
+    else
+    {
+      output.close();
+      if(output.fail())
+      {
+        std::cerr << "ERROR: Writing " << outputFileName_ << " failed." << std::endl;
+        result = -1;
+      }
+    }
+    unsigned long lapse = timer.freeze();
+    double seconds = double(lapse == 0 ? 1 : lapse) / 1000.0;
+    std::cout << "Generated " << messages << " messages, "
+      << bytes << " bytes of FAST data in "
+      << std::fixed << std::setprecision(3) << seconds << " seconds. ["
+      << std::setprecision(1) << double(bytes) / seconds / (1024.0 * 1024.0) << " MB/second, "
+      << std::setprecision(0) << double(messages) / seconds << " messages/second.]"
+      << std::endl;
+  }
+  catch (std::exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    result = -1;
+  }
+  return result;
+}
+
+void
+TrafficGenerator::fini()
+{
+}
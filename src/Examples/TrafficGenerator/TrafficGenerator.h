@@ -0,0 +1,80 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef TRAFFICGENERATOR_H
+#define TRAFFICGENERATOR_H
+
+#include <Examples/CommandArgParser.h>
+#include <Examples/MessageGenerator.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Write a file of synthetic FAST encoded messages for any set of templates.
+    ///
+    /// Messages are created by a MessageGenerator so the values suit each field's
+    /// operator (incrementing sequence numbers, prices that wander, symbols that repeat,
+    /// optional fields that are sometimes absent) and encoded with the Encoder.
+    /// The mix of templates, the size of the output and the character of the values
+    /// are set from the command line.  The same seed always produces the same file.
+    ///
+    /// The output may be written as:
+    ///   - raw: the messages one after another (PerformanceTest -f file)
+    ///   - blocked: each message preceded by its stop bit encoded size (PerformanceTest -blocked)
+    ///   - pcap: one message per UDP packet (PCapToMulticast or InterpretApplication -pcap)
+    ///
+    /// Use the -? command line option for more information.
+    class TrafficGenerator : public CommandArgHandler
+    {
+    public:
+      TrafficGenerator();
+      ~TrafficGenerator();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+      void applyMix(MessageGenerator & generator)const;
+
+    private:
+      enum Format
+      {
+        RAW,
+        BLOCKED,
+        PCAP
+      };
+
+      CommandArgParser commandArgParser_;
+      std::string templateFileName_;
+      std::string outputFileName_;
+      Format format_;
+      size_t messageCount_;
+      uint64 byteLimit_;
+      std::string mix_;
+      size_t symbolCount_;
+      double repeatProbability_;
+      uint32 deltaStep_;
+      size_t minimumSequenceLength_;
+      size_t maximumSequenceLength_;
+      double absentProbability_;
+      uint64 seed_;
+      bool resetOnMessage_;
+      std::string address_;
+      unsigned short port_;
+      uint64 interval_;
+    };
+  }
+}
+#endif // TRAFFICGENERATOR_H
@@ -0,0 +1,252 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "AllocationPhaseBuilder.h"
+#include <Common/AllocationCounter.h>
+
+using namespace QuickFAST;
+using namespace Messages;
+
+namespace
+{
+  // deep enough for any reasonable nesting of sequences and groups without growing.
+  const size_t expectedDepth = 16;
+}
+
+AllocationPhaseBuilder::AllocationPhaseBuilder(ValueMessageBuilder & target)
+{
+  builders_.reserve(expectedDepth);
+  builders_.push_back(&target);
+}
+
+AllocationPhaseBuilder::~AllocationPhaseBuilder()
+{
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::nest(ValueMessageBuilder & nested)
+{
+  builders_.push_back(&nested);
+  return *this;
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::unnest()
+{
+  ValueMessageBuilder & nested = current();
+  if(builders_.size() > 1)
+  {
+    builders_.pop_back();
+  }
+  return nested;
+}
+
+const std::string &
+AllocationPhaseBuilder::getApplicationType()const
+{
+  return current().getApplicationType();
+}
+
+const std::string &
+AllocationPhaseBuilder::getApplicationTypeNs()const
+{
+  return current().getApplicationTypeNs();
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int64 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint64 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int32 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint32 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int16 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint16 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int8 value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uchar value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const Decimal& value)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value);
+}
+
+void
+AllocationPhaseBuilder::addValue(FieldIdentityCPtr & identity, ValueType::Type type, const unsigned char * value, size_t length)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().addValue(identity, type, value, length);
+}
+
+void
+AllocationPhaseBuilder::setReceiveTimes(uint64 receiveTime, uint64 decodeStartTime)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  current().setReceiveTimes(receiveTime, decodeStartTime);
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::startMessage(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  // Messages do not nest.  Forget anything left by a message that failed to decode.
+  builders_.resize(1);
+  return nest(current().startMessage(applicationType, applicationTypeNamespace, size));
+}
+
+bool
+AllocationPhaseBuilder::endMessage(ValueMessageBuilder & /*messageBuilder*/)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  ValueMessageBuilder & messageBuilder = unnest();
+  return current().endMessage(messageBuilder);
+}
+
+bool
+AllocationPhaseBuilder::ignoreMessage(ValueMessageBuilder & /*messageBuilder*/)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  ValueMessageBuilder & messageBuilder = unnest();
+  return current().ignoreMessage(messageBuilder);
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::startSequence(
+  FieldIdentityCPtr & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t fieldCount,
+  FieldIdentityCPtr & lengthIdentity,
+  size_t length)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  return nest(current().startSequence(
+    identity,
+    applicationType,
+    applicationTypeNamespace,
+    fieldCount,
+    lengthIdentity,
+    length));
+}
+
+void
+AllocationPhaseBuilder::endSequence(
+  FieldIdentityCPtr & identity,
+  ValueMessageBuilder & /*sequenceBuilder*/)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  ValueMessageBuilder & sequenceBuilder = unnest();
+  current().endSequence(identity, sequenceBuilder);
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::startSequenceEntry(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  return nest(current().startSequenceEntry(applicationType, applicationTypeNamespace, size));
+}
+
+void
+AllocationPhaseBuilder::endSequenceEntry(ValueMessageBuilder & /*entry*/)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  ValueMessageBuilder & entry = unnest();
+  current().endSequenceEntry(entry);
+}
+
+ValueMessageBuilder &
+AllocationPhaseBuilder::startGroup(
+  FieldIdentityCPtr & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  return nest(current().startGroup(identity, applicationType, applicationTypeNamespace, size));
+}
+
+void
+AllocationPhaseBuilder::endGroup(
+  FieldIdentityCPtr & identity,
+  ValueMessageBuilder & /*groupBuilder*/)
+{
+  Common::AllocationPhase phase(Common::AllocationCounter::BUILDER);
+  ValueMessageBuilder & groupBuilder = unnest();
+  current().endGroup(identity, groupBuilder);
+}
+
+bool
+AllocationPhaseBuilder::wantLog(unsigned short level)
+{
+  return current().wantLog(level);
+}
+
+bool
+AllocationPhaseBuilder::logMessage(unsigned short level, const std::string & logMessage)
+{
+  return current().logMessage(level, logMessage);
+}
+
+bool
+AllocationPhaseBuilder::reportDecodingError(const std::string & errorMessage)
+{
+  return current().reportDecodingError(errorMessage);
+}
+
+bool
+AllocationPhaseBuilder::reportCommunicationError(const std::string & errorMessage)
+{
+  return current().reportCommunicationError(errorMessage);
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ALLOCATIONPHASEBUILDER_H
+#define ALLOCATIONPHASEBUILDER_H
+#include <Common/QuickFAST_Export.h>
+#include <Messages/ValueMessageBuilder.h>
+namespace QuickFAST{
+  namespace Messages{
+    /// @brief Charge the allocations made by a ValueMessageBuilder to the builder phase.
+    ///
+    /// Forwards every call to the builder it wraps (and to the nested builders
+    /// that builder returns for messages, sequences and groups) inside a
+    /// Common::AllocationPhase for Common::AllocationCounter::BUILDER.  Pass this
+    /// to the decoder in place of the application's builder to see how much
+    /// of the decoding allocation comes from building the message.
+    ///
+    /// The wrapper always returns itself as the nested builder and keeps
+    /// track of the real ones, so the application's builder sees exactly the
+    /// calls it would have seen without the wrapper.
+    class QuickFAST_Export AllocationPhaseBuilder : public ValueMessageBuilder
+    {
+    public:
+      /// @brief Wrap a builder
+      /// @param target receives the calls.
+      explicit AllocationPhaseBuilder(ValueMessageBuilder & target);
+      virtual ~AllocationPhaseBuilder();
+
+      ///////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int64 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint64 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int32 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint32 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int16 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uint16 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const int8 value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const uchar value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const Decimal& value);
+      virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const unsigned char * value, size_t length);
+      virtual void setReceiveTimes(uint64 receiveTime, uint64 decodeStartTime);
+
+      virtual ValueMessageBuilder & startMessage(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual bool endMessage(ValueMessageBuilder & messageBuilder);
+      virtual bool ignoreMessage(ValueMessageBuilder & messageBuilder);
+      virtual ValueMessageBuilder & startSequence(
+        FieldIdentityCPtr & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t fieldCount,
+        FieldIdentityCPtr & lengthIdentity,
+        size_t length);
+      virtual void endSequence(
+        FieldIdentityCPtr & identity,
+        ValueMessageBuilder & sequenceBuilder);
+      virtual ValueMessageBuilder & startSequenceEntry(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endSequenceEntry(ValueMessageBuilder & entry);
+      virtual ValueMessageBuilder & startGroup(
+        FieldIdentityCPtr & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endGroup(
+        FieldIdentityCPtr & identity,
+        ValueMessageBuilder & groupBuilder);
+
+      ///////////////////
+      // Implement Logger
+      virtual bool wantLog(unsigned short level);
+      virtual bool logMessage(unsigned short level, const std::string & logMessage);
+      virtual bool reportDecodingError(const std::string & errorMessage);
+      virtual bool reportCommunicationError(const std::string & errorMessage);
+
+    private:
+      AllocationPhaseBuilder(const AllocationPhaseBuilder &);
+      AllocationPhaseBuilder & operator=(const AllocationPhaseBuilder &);
+
+      ValueMessageBuilder & current()const
+      {
+        return *builders_.back();
+      }
+      ValueMessageBuilder & nest(ValueMessageBuilder & nested);
+      ValueMessageBuilder & unnest();
+
+    private:
+      // The application's builder followed by the nested builders in use.
+      std::vector<ValueMessageBuilder *> builders_;
+    };
+  }
+}
+#endif // ALLOCATIONPHASEBUILDER_H
@@ -0,0 +1,139 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef NULLMESSAGEBUILDER_H
+#define NULLMESSAGEBUILDER_H
+#include <Messages/ValueMessageBuilder.h>
+
+namespace QuickFAST
+{
+  namespace Messages
+  {
+    ///@brief a MessageBuilder that discards everything the decoder produces.
+    ///
+    /// Use it to skip over messages when only the decoder's dictionary state
+    /// matters, i.e. when fast-forwarding to a message of interest.
+    class NullMessageBuilder : public ValueMessageBuilder
+    {
+    public:
+      NullMessageBuilder()
+        : messageCount_(0)
+      {
+      }
+
+      virtual ~NullMessageBuilder()
+      {
+      }
+
+      /// @brief How many messages have been discarded.
+      size_t messageCount()const
+      {
+        return messageCount_;
+      }
+
+      ///////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const
+      {
+        return applicationType_;
+      }
+      virtual const std::string & getApplicationTypeNs()const
+      {
+        return applicationType_;
+      }
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const int64 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const uint64 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const int32 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const uint32 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const int16 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const uint16 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const int8 /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const uchar /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const Decimal& /*value*/){}
+      virtual void addValue(FieldIdentityCPtr & /*identity*/, ValueType::Type /*type*/, const unsigned char * /*value*/, size_t /*length*/){}
+
+      virtual ValueMessageBuilder & startMessage(
+        const std::string & /*applicationType*/,
+        const std::string & /*applicationTypeNamespace*/,
+        size_t /*size*/)
+      {
+        return *this;
+      }
+      virtual bool endMessage(ValueMessageBuilder & /*messageBuilder*/)
+      {
+        ++messageCount_;
+        return true;
+      }
+      virtual bool ignoreMessage(ValueMessageBuilder & /*messageBuilder*/)
+      {
+        ++messageCount_;
+        return true;
+      }
+      virtual ValueMessageBuilder & startSequence(
+        FieldIdentityCPtr & /*identity*/,
+        const std::string & /*applicationType*/,
+        const std::string & /*applicationTypeNamespace*/,
+        size_t /*fieldCount*/,
+        FieldIdentityCPtr & /*lengthIdentity*/,
+        size_t /*length*/)
+      {
+        return *this;
+      }
+      virtual void endSequence(
+        FieldIdentityCPtr & /*identity*/,
+        ValueMessageBuilder & /*sequenceBuilder*/)
+      {
+      }
+      virtual ValueMessageBuilder & startSequenceEntry(
+        const std::string & /*applicationType*/,
+        const std::string & /*applicationTypeNamespace*/,
+        size_t /*size*/)
+      {
+        return *this;
+      }
+      virtual void endSequenceEntry(ValueMessageBuilder & /*entry*/)
+      {
+      }
+      virtual ValueMessageBuilder & startGroup(
+        FieldIdentityCPtr & /*identity*/,
+        const std::string & /*applicationType*/,
+        const std::string & /*applicationTypeNamespace*/,
+        size_t /*size*/)
+      {
+        return *this;
+      }
+      virtual void endGroup(
+        FieldIdentityCPtr & /*identity*/,
+        ValueMessageBuilder & /*groupBuilder*/)
+      {
+      }
+
+      ///////////////////
+      // Implement Logger
+      virtual bool wantLog(unsigned short /*level*/)
+      {
+        return false;
+      }
+      virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+      {
+        return true;
+      }
+      virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+      {
+        return false;
+      }
+      virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+      {
+        return false;
+      }
+
+    private:
+      std::string applicationType_;
+      size_t messageCount_;
+    };
+  }
+}
+#endif // NULLMESSAGEBUILDER_H
@@ -90,6 +90,19 @@ namespace QuickFAST{
       /// @param length is the length of the string pointed to by value
       virtual void addValue(FieldIdentityCPtr & identity, ValueType::Type type, const unsigned char * value, size_t length) = 0;
 
+      /// @brief Learn when the data for the next message(s) arrived.
+      ///
+      /// Called by the assembler before decoding the data from each buffer,
+      /// so it applies to every message that starts in that buffer.
+      /// Times are nanoseconds since the epoch (see Common::wallClockNanoseconds()).
+      /// The default implementation ignores the times.
+      /// @param receiveTime is when the data was received (kernel, PCap or receiver
+      ///        completion time); zero if unknown.
+      /// @param decodeStartTime is when decoding started.
+      virtual void setReceiveTimes(uint64 /*receiveTime*/, uint64 /*decodeStartTime*/)
+      {
+      }
+
       /// @brief prepare to accept an entire message
       ///
       /// @param applicationType is the data type for the message
@@ -0,0 +1,99 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef VALUETEMPLATE_H
+#define VALUETEMPLATE_H
+#include <Codecs/MessageConsumer.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldOp.h>
+#include <Messages/Message.h>
+#include <Messages/Field.h>
+#include <algorithm>
+
+namespace QuickFAST{
+  namespace Tests{
+    /// Create a registry with one template: <template id="id"><uInt32 name="value"><op/></uInt32></template>
+    /// @param id is the template id.
+    /// @param fieldOp is the operator for "value" (none if empty).
+    inline Codecs::TemplateRegistryPtr createValueRegistry(
+      template_id_t id = 1,
+      Codecs::FieldOpPtr fieldOp = Codecs::FieldOpPtr())
+    {
+      Codecs::TemplatePtr templ(new Codecs::Template);
+      templ->setId(id);
+      Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionUInt32("value", ""));
+      if(fieldOp)
+      {
+        field->setFieldOp(fieldOp);
+      }
+      templ->addInstruction(field);
+      Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+      registry->addTemplate(templ);
+      registry->finalize();
+      return registry;
+    }
+
+    /// Consume messages decoded using createValueRegistry().
+    /// Counts messages and errors and collects the values in the order they arrive.
+    class ValueCounter : public Codecs::MessageConsumer
+    {
+    public:
+      ValueCounter()
+        : messageCount_(0)
+        , errorCount_(0)
+      {
+      }
+
+      virtual bool consumeMessage(Messages::Message & message)
+      {
+        Messages::FieldCPtr field;
+        if(message.getField("value", field))
+        {
+          values_.push_back(field->toUInt32());
+        }
+        ++messageCount_;
+        return true;
+      }
+      virtual bool wantLog(unsigned short /*level*/)
+      {
+        return false;
+      }
+      virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+      {
+        return true;
+      }
+      virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+      {
+        ++errorCount_;
+        return true;
+      }
+      virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+      {
+        ++errorCount_;
+        return true;
+      }
+      virtual void decodingStarted()
+      {
+      }
+      virtual void decodingStopped()
+      {
+      }
+
+      /// How many messages carried this value?
+      size_t count(uint32 value) const
+      {
+        return size_t(std::count(values_.begin(), values_.end(), value));
+      }
+
+      std::vector<uint32> values_;
+      size_t messageCount_;
+      size_t errorCount_;
+    };
+  }
+}
+#endif // VALUETEMPLATE_H
@@ -5,3 +5,9 @@
 #define BOOST_TEST_MODULE QuickFASTTest
 #include <boost/test/unit_test.hpp>
 
+
+// Count allocations so tests can check allocation budgets (see testAllocationBudget.cpp)
+#include <Common/AllocationCounter.h>
+#include <new>
+#include <cstdlib>
+QUICKFAST_COUNT_ALLOCATIONS
@@ -0,0 +1,345 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/AllocationCounter.h>
+#include <Codecs/SynchronousDecoder.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceBuffer.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/SegmentBody.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt64.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionSequence.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpDefault.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Messages/AllocationPhaseBuilder.h>
+#include <Messages/NullMessageBuilder.h>
+#include <Messages/Message.h>
+#include <Messages/Sequence.h>
+#include <Messages/FieldInt32.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldUInt64.h>
+#include <Messages/FieldDecimal.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldUtf8.h>
+#include <Messages/FieldByteVector.h>
+#include <Messages/FieldSequence.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  // Steady state decoding should not allocate at all.  Override with the
+  // QUICKFAST_ALLOCATION_BUDGET environment variable (allocations per message).
+  const double defaultDecoderBudget = 0.0;
+
+  const size_t warmupMessages = 100;
+  const size_t measuredMessages = 1000;
+
+  double decoderBudget()
+  {
+    const char * budget = std::getenv("QUICKFAST_ALLOCATION_BUDGET");
+    if(budget != 0 && *budget != 0)
+    {
+      return boost::lexical_cast<double>(budget);
+    }
+    return defaultDecoderBudget;
+  }
+
+  void addField(Codecs::SegmentBody & body, Codecs::FieldInstruction * instruction, Codecs::FieldOp * op, bool mandatory = true)
+  {
+    Codecs::FieldInstructionPtr field(instruction);
+    field->setPresence(mandatory);
+    if(op != 0)
+    {
+      Codecs::FieldOpPtr fieldOp(op);
+      field->setFieldOp(fieldOp);
+    }
+    body.addInstruction(field);
+  }
+
+  // A market data style template:
+  //  <template id="1">
+  //    <uInt32 name="SeqNum"><increment/></uInt32>
+  //    <string name="Symbol"><copy/></string>
+  //    <int64 name="Volume"><delta/></int64>
+  //    <uInt32 name="Flags" presence="optional"><default/></uInt32>
+  //    <sequence name="Entries">
+  //      <length name="NoEntries"/>
+  //      <decimal name="Px"><delta/></decimal>
+  //      <uInt32 name="Qty"><copy/></uInt32>
+  //    </sequence>
+  //  </template>
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(1);
+    addField(*templ, new Codecs::FieldInstructionUInt32("SeqNum", ""), new Codecs::FieldOpIncrement);
+    addField(*templ, new Codecs::FieldInstructionAscii("Symbol", ""), new Codecs::FieldOpCopy);
+    addField(*templ, new Codecs::FieldInstructionInt64("Volume", ""), new Codecs::FieldOpDelta);
+    addField(*templ, new Codecs::FieldInstructionUInt32("Flags", ""), new Codecs::FieldOpDefault, false);
+
+    Codecs::FieldInstructionPtr entries(new Codecs::FieldInstructionSequence("Entries", ""));
+    Codecs::SegmentBodyPtr body(new Codecs::SegmentBody);
+    body->allowLengthField();
+    body->setMandatoryLength(true);
+    Codecs::FieldInstructionPtr length(new Codecs::FieldInstructionLength("NoEntries", ""));
+    body->addLengthInstruction(length);
+    addField(*body, new Codecs::FieldInstructionDecimal("Px", ""), new Codecs::FieldOpDelta);
+    addField(*body, new Codecs::FieldInstructionUInt32("Qty", ""), new Codecs::FieldOpCopy);
+    entries->setSegmentBody(body);
+    templ->addInstruction(entries);
+
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+
+  Messages::FieldIdentityCPtr identity(const std::string & name)
+  {
+    return Messages::FieldIdentityCPtr(new Messages::FieldIdentity(name));
+  }
+
+  /// Encode a stream of messages; returns the offset of the first measured message.
+  size_t encodeMessages(Codecs::TemplateRegistryPtr registry, std::string & data)
+  {
+    static const char * symbols[] = {"IBM", "MSFT", "ORCL", "GOOG"};
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    size_t warmupSize = 0;
+    for(size_t nMessage = 0; nMessage < warmupMessages + measuredMessages; ++nMessage)
+    {
+      Messages::Message message(10);
+      message.addField(identity("SeqNum"), Messages::FieldUInt32::create(uint32(nMessage + 1)));
+      message.addField(identity("Symbol"), Messages::FieldAscii::create(symbols[(nMessage / 3) % 4]));
+      message.addField(identity("Volume"), Messages::FieldInt64::create(int64(100000 + nMessage * 17)));
+      if(nMessage % 4 == 0)
+      {
+        message.addField(identity("Flags"), Messages::FieldUInt32::create(uint32(nMessage % 7)));
+      }
+      Messages::FieldIdentityCPtr lengthIdentity = identity("NoEntries");
+      size_t entryCount = 1 + nMessage % 3;
+      Messages::SequencePtr sequence(new Messages::Sequence(lengthIdentity, entryCount));
+      for(size_t nEntry = 0; nEntry < entryCount; ++nEntry)
+      {
+        Messages::FieldSetPtr entry(new Messages::FieldSet(2));
+        entry->addField(identity("Px"), Messages::FieldDecimal::create(mantissa_t(10000 + (nMessage + nEntry) % 13), -2));
+        entry->addField(identity("Qty"), Messages::FieldUInt32::create(uint32(100 * (1 + nEntry))));
+        sequence->addEntry(entry);
+      }
+      message.addField(identity("Entries"), Messages::FieldSequence::create(sequence));
+
+      destination.clear();
+      encoder.encodeMessage(destination, 1, message);
+      std::string encoded;
+      destination.toString(encoded);
+      data += encoded;
+      if(nMessage + 1 == warmupMessages)
+      {
+        warmupSize = data.size();
+      }
+    }
+    return warmupSize;
+  }
+
+  /// Give every field of a template that the application supplies a value that varies by message.
+  /// Mandatory constants are supplied by the encoder.
+  void fillMessage(const Codecs::Template & templ, size_t nMessage, Messages::Message & message)
+  {
+    std::string text = "value" + boost::lexical_cast<std::string>(nMessage % 5);
+    for(size_t nField = 0; nField < templ.size(); ++nField)
+    {
+      const Codecs::FieldInstructionCPtr & instruction = templ.getInstruction(nField);
+      if(instruction->getFieldOp()->opType() == Codecs::FieldOp::CONSTANT)
+      {
+        continue;
+      }
+      const Messages::FieldIdentityCPtr & fieldIdentity = instruction->getIdentity();
+      switch(instruction->fieldInstructionType())
+      {
+      case ValueType::INT32:
+        message.addField(fieldIdentity, Messages::FieldInt32::create(int32(nMessage) - 500));
+        break;
+      case ValueType::UINT32:
+        message.addField(fieldIdentity, Messages::FieldUInt32::create(uint32(nMessage)));
+        break;
+      case ValueType::INT64:
+        message.addField(fieldIdentity, Messages::FieldInt64::create(int64(nMessage) - 5000000000LL));
+        break;
+      case ValueType::UINT64:
+        message.addField(fieldIdentity, Messages::FieldUInt64::create(uint64(nMessage) + 5000000000ULL));
+        break;
+      case ValueType::DECIMAL:
+        message.addField(fieldIdentity, Messages::FieldDecimal::create(mantissa_t(10000 + nMessage % 13), -2));
+        break;
+      case ValueType::ASCII:
+        message.addField(fieldIdentity, Messages::FieldAscii::create(text));
+        break;
+      case ValueType::UTF8:
+        message.addField(fieldIdentity, Messages::FieldUtf8::create(text));
+        break;
+      case ValueType::BYTEVECTOR:
+        message.addField(fieldIdentity, Messages::FieldByteVector::create(text));
+        break;
+      default:
+        BOOST_FAIL("No value for field " + instruction->getName());
+      }
+    }
+  }
+
+  /// Encode a stream of messages using the registry's first template; returns the offset of the first measured message.
+  size_t encodeTemplateMessages(Codecs::TemplateRegistryPtr registry, std::string & data)
+  {
+    Codecs::TemplateCPtr templ = registry->definedTemplate(0);
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    size_t warmupSize = 0;
+    for(size_t nMessage = 0; nMessage < warmupMessages + measuredMessages; ++nMessage)
+    {
+      Messages::Message message(registry->maxFieldCount());
+      fillMessage(*templ, nMessage, message);
+      destination.clear();
+      encoder.encodeMessage(destination, templ->getId(), message);
+      std::string encoded;
+      destination.toString(encoded);
+      data += encoded;
+      if(nMessage + 1 == warmupMessages)
+      {
+        warmupSize = data.size();
+      }
+    }
+    return warmupSize;
+  }
+
+  /// Decode the warmup messages then count the allocations made decoding the rest.
+  Common::AllocationCounter::Snapshot decodeAndCount(
+    Codecs::TemplateRegistryPtr registry,
+    const std::string & data,
+    size_t warmupSize,
+    Messages::ValueMessageBuilder & builder,
+    size_t & messageCount)
+  {
+    const uchar * bytes = reinterpret_cast<const uchar *>(data.data());
+    Codecs::DataSourceBuffer warmup(bytes, warmupSize);
+    Codecs::DataSourceBuffer measured(bytes + warmupSize, data.size() - warmupSize);
+
+    Codecs::SynchronousDecoder decoder(registry);
+    decoder.decode(warmup, builder);
+    BOOST_REQUIRE_EQUAL(decoder.messageCount(), warmupMessages);
+
+    Common::AllocationCounter::Snapshot before;
+    decoder.decode(measured, builder);
+    Common::AllocationCounter::Snapshot after;
+    messageCount = decoder.messageCount() - warmupMessages;
+    return after.since(before);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testAllocationCounter)
+{
+  BOOST_REQUIRE(Common::AllocationCounter::enabled());
+  BOOST_CHECK_EQUAL(Common::AllocationCounter::phase(), Common::AllocationCounter::OTHER);
+
+  Common::AllocationCounter::Snapshot before;
+  int * other = new int(1);
+  {
+    Common::AllocationPhase phase(Common::AllocationCounter::DECODER);
+    BOOST_CHECK_EQUAL(Common::AllocationCounter::phase(), Common::AllocationCounter::DECODER);
+    char * decoded = new char[100];
+    delete [] decoded;
+  }
+  BOOST_CHECK_EQUAL(Common::AllocationCounter::phase(), Common::AllocationCounter::OTHER);
+  delete other;
+  Common::AllocationCounter::Snapshot counts = Common::AllocationCounter::Snapshot().since(before);
+
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::OTHER].allocations_, 1u);
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::OTHER].bytes_, sizeof(int));
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::OTHER].deallocations_, 1u);
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::DECODER].allocations_, 1u);
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::DECODER].bytes_, 100u);
+  BOOST_CHECK_EQUAL(counts.phases_[Common::AllocationCounter::DECODER].deallocations_, 1u);
+  BOOST_CHECK_EQUAL(counts.total().allocations_, 2u);
+  BOOST_CHECK_EQUAL(std::string(Common::AllocationCounter::phaseName(Common::AllocationCounter::BUILDER)), "builder");
+}
+
+BOOST_AUTO_TEST_CASE(testSynchronousDecoderAllocationBudget)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  std::string data;
+  size_t warmupSize = encodeMessages(registry, data);
+  Messages::NullMessageBuilder builder;
+  size_t messageCount = 0;
+  Common::AllocationCounter::Snapshot counts = decodeAndCount(registry, data, warmupSize, builder, messageCount);
+  BOOST_REQUIRE_EQUAL(messageCount, measuredMessages);
+
+  double budget = decoderBudget();
+  double perMessage = double(counts.total().allocations_) / double(messageCount);
+  BOOST_TEST_MESSAGE("Steady state decoding: " << perMessage << " allocations per message; budget " << budget);
+  BOOST_CHECK_LE(perMessage, budget);
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateFileAllocationBudget)
+{
+  // every field type and operator, from the template file used by the round trip tests
+  std::string xml(std::getenv("QUICKFAST_ROOT"));
+  xml += "/src/Tests/resources/unittest_mandatory.xml";
+  std::ifstream templateStream(xml.c_str(), std::ifstream::binary);
+  BOOST_REQUIRE(templateStream.good());
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr registry = parser.parse(templateStream);
+  BOOST_REQUIRE(registry);
+
+  std::string data;
+  size_t warmupSize = encodeTemplateMessages(registry, data);
+  Messages::NullMessageBuilder builder;
+  size_t messageCount = 0;
+  Common::AllocationCounter::Snapshot counts = decodeAndCount(registry, data, warmupSize, builder, messageCount);
+  BOOST_REQUIRE_EQUAL(messageCount, measuredMessages);
+
+  double budget = decoderBudget();
+  double perMessage = double(counts.total().allocations_) / double(messageCount);
+  BOOST_TEST_MESSAGE("Steady state decoding " << xml << ": " << perMessage << " allocations per message; budget " << budget);
+  BOOST_CHECK_LE(perMessage, budget);
+}
+
+BOOST_AUTO_TEST_CASE(testAllocationPhaseBuilder)
+{
+  // The decoder's own allocations stay within budget when a real builder is used.
+  // The builder's allocations are charged to the builder.
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  std::string data;
+  size_t warmupSize = encodeMessages(registry, data);
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder messageBuilder(consumer);
+  Messages::AllocationPhaseBuilder builder(messageBuilder);
+  size_t messageCount = 0;
+  Common::AllocationCounter::Snapshot counts = decodeAndCount(registry, data, warmupSize, builder, messageCount);
+  BOOST_REQUIRE_EQUAL(messageCount, measuredMessages);
+
+  double perMessage = double(counts.phases_[Common::AllocationCounter::DECODER].allocations_) / double(messageCount);
+  BOOST_CHECK_LE(perMessage, decoderBudget());
+  BOOST_CHECK_GE(counts.phases_[Common::AllocationCounter::BUILDER].allocations_, messageCount);
+
+  // The wrapper delivers complete messages.
+  Messages::FieldCPtr field;
+  BOOST_REQUIRE(consumer.message().getField("SeqNum", field));
+  BOOST_CHECK_EQUAL(field->toUInt32(), uint32(warmupMessages + measuredMessages));
+  BOOST_REQUIRE(consumer.message().getField("Entries", field));
+  BOOST_CHECK_EQUAL(field->toSequence()->size(), size_t(1 + (warmupMessages + measuredMessages - 1) % 3));
+}
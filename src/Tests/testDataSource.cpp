@@ -0,0 +1,119 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/DataSource.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/SynchronousDecoder.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// @brief Deliver a string in fixed size buffers.
+  class ChunkedDataSource : public Codecs::DataSource
+  {
+  public:
+    ChunkedDataSource(const std::string & data, size_t chunkSize)
+      : data_(data)
+      , chunkSize_(chunkSize)
+      , position_(0)
+    {
+    }
+
+    virtual bool getBuffer(const uchar *& buffer, size_t & size)
+    {
+      if(position_ >= data_.size())
+      {
+        return false;
+      }
+      buffer = reinterpret_cast<const uchar *>(data_.data()) + position_;
+      size = std::min(chunkSize_, data_.size() - position_);
+      position_ += size;
+      return true;
+    }
+
+  private:
+    std::string data_;
+    size_t chunkSize_;
+    size_t position_;
+  };
+
+  /// @brief Remember where each message started.
+  class OffsetObserver : public Codecs::DecodeObserver
+  {
+  public:
+    virtual void messageStarting(const Codecs::DataSource & source)
+    {
+      offsets_.push_back(source.bytesConsumed());
+    }
+
+    virtual void messageDecoded(template_id_t templateId, size_t messageNumber)
+    {
+      BOOST_CHECK_EQUAL(templateId, 1u);
+      BOOST_CHECK_EQUAL(messageNumber + 1, offsets_.size());
+    }
+
+    std::vector<uint64> offsets_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceBytesConsumed)
+{
+  std::string data(1000, 'x');
+  ChunkedDataSource source(data, 64);
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 0u);
+  uchar byte = 0;
+  for(size_t pos = 0; pos < 130; ++pos)
+  {
+    BOOST_REQUIRE(source.getByte(byte));
+  }
+  // across buffer boundaries
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 130u);
+
+  // contiguous reads count too
+  const uchar * buffer = 0;
+  BOOST_REQUIRE(source.hasContiguous(10, buffer));
+  source.skipContiguous(10);
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 140u);
+
+  // reset() discards the rest of the buffer (bytes 140 through 191) without counting it
+  source.reset();
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 140u);
+  BOOST_REQUIRE(source.getByte(byte));
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 141u);
+
+  size_t remaining = 0;
+  while(source.getByte(byte))
+  {
+    ++remaining;
+  }
+  BOOST_CHECK_EQUAL(remaining, data.size() - 193u);
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), 141u + remaining);
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceMessageOffsets)
+{
+  // pmap, template id, value; then pmap, value
+  std::string data("\xC0\x81\x81\x80\x82\x80\x83");
+  Codecs::DataSourceString source(data);
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter collector;
+  Codecs::GenericMessageBuilder builder(collector);
+  OffsetObserver observer;
+  Codecs::SynchronousDecoder decoder(registry);
+  decoder.setObserver(&observer);
+  decoder.decode(source, builder);
+  BOOST_CHECK_EQUAL(collector.messageCount_, 3u);
+  BOOST_REQUIRE_EQUAL(observer.offsets_.size(), 3u);
+  BOOST_CHECK_EQUAL(observer.offsets_[0], 0u);
+  BOOST_CHECK_EQUAL(observer.offsets_[1], 3u);
+  BOOST_CHECK_EQUAL(observer.offsets_[2], 5u);
+  BOOST_CHECK_EQUAL(source.bytesConsumed(), data.size());
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/MappedFile.h>
+#include <Codecs/DataSourceMapped.h>
+#include <Codecs/SynchronousDecoder.h>
+#include <Codecs/StreamingAssembler.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Communication/RawFileReceiver.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// A FAST message using template 1: pmap, template id, value
+  std::string message(unsigned char value)
+  {
+    std::string result;
+    result += char(0xC0);
+    result += char(0x81);
+    result += char(0x80 | value);
+    return result;
+  }
+
+  void writeFile(const char * filename, const std::string & data)
+  {
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  const char rawFile[] = "testDataSourceMapped.fast";
+  const char blockedFile[] = "testDataSourceMapped.blocked";
+}
+
+BOOST_AUTO_TEST_CASE(testMappedFile)
+{
+  writeFile(rawFile, "hello");
+  Common::MappedFile file;
+  BOOST_REQUIRE(file.open(rawFile));
+  BOOST_REQUIRE_EQUAL(file.size(), 5u);
+  BOOST_CHECK(std::memcmp(file.data(), "hello", 5) == 0);
+  file.readAhead(0);
+  file.close();
+  BOOST_CHECK(file.data() == 0);
+  BOOST_CHECK_EQUAL(file.size(), 0u);
+  BOOST_CHECK(!file.open("testDataSourceMapped.missing"));
+  std::remove(rawFile);
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceMappedRaw)
+{
+  std::string data;
+  for(unsigned char value = 1; value <= 10; ++value)
+  {
+    data += message(value);
+  }
+  writeFile(rawFile, data);
+
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter collector;
+  Codecs::GenericMessageBuilder builder(collector);
+  {
+    Codecs::DataSourceMapped source(rawFile);
+    BOOST_CHECK_EQUAL(source.fileSize(), data.size());
+    Codecs::SynchronousDecoder decoder(registry);
+    decoder.decode(source, builder);
+  }
+  BOOST_CHECK_EQUAL(collector.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(collector.values_.size(), 10u);
+  for(uint32 value = 1; value <= 10; ++value)
+  {
+    BOOST_CHECK_EQUAL(collector.values_[value - 1], value);
+  }
+
+  BOOST_CHECK_THROW(Codecs::DataSourceMapped missing("testDataSourceMapped.missing"), std::invalid_argument);
+  std::remove(rawFile);
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceMappedSeek)
+{
+  std::string data;
+  for(unsigned char value = 1; value <= 4; ++value)
+  {
+    data += message(value);
+  }
+  writeFile(rawFile, data);
+
+  {
+    Codecs::DataSourceMapped source(rawFile);
+    uchar byte = 0;
+    BOOST_REQUIRE(source.getByte(byte));
+    BOOST_CHECK_EQUAL(source.bytesConsumed(), 1u);
+    // bytesConsumed() is the offset in the file, before and after seeking.
+    source.seek(6);
+    BOOST_CHECK_EQUAL(source.bytesConsumed(), 6u);
+    BOOST_REQUIRE(source.getByte(byte));
+    BOOST_CHECK_EQUAL(byte, 0xC0);
+    BOOST_REQUIRE(source.getByte(byte));
+    BOOST_REQUIRE(source.getByte(byte));
+    BOOST_CHECK_EQUAL(byte, 0x83);
+    BOOST_CHECK_EQUAL(source.bytesConsumed(), 9u);
+    source.seek(0);
+    BOOST_CHECK_EQUAL(source.bytesConsumed(), 0u);
+    source.seek(data.size());
+    BOOST_CHECK(!source.getByte(byte));
+    BOOST_CHECK_EQUAL(source.bytesConsumed(), data.size());
+    BOOST_CHECK_THROW(source.seek(data.size() + 1), std::invalid_argument);
+  }
+  std::remove(rawFile);
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceMappedBlocked)
+{
+  // block headers are stop bit encoded sizes.  An empty block is skipped
+  // and a message may span blocks.
+  std::string data;
+  data += char(0x83);
+  data += message(1);
+  data += char(0x80);
+  data += char(0x85);
+  data += message(2);
+  data += message(3).substr(0, 2);
+  data += char(0x81);
+  data += message(3).substr(2);
+  writeFile(blockedFile, data);
+
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter collector;
+  Codecs::GenericMessageBuilder builder(collector);
+  {
+    Codecs::DataSourceMapped source(blockedFile, true);
+    Codecs::SynchronousDecoder decoder(registry);
+    decoder.decode(source, builder);
+  }
+  BOOST_CHECK_EQUAL(collector.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(collector.values_.size(), 3u);
+  BOOST_CHECK_EQUAL(collector.values_[0], 1u);
+  BOOST_CHECK_EQUAL(collector.values_[1], 2u);
+  BOOST_CHECK_EQUAL(collector.values_[2], 3u);
+  std::remove(blockedFile);
+}
+
+BOOST_AUTO_TEST_CASE(testRawFileReceiverMapped)
+{
+  std::string data;
+  for(unsigned char value = 1; value <= 10; ++value)
+  {
+    data += message(value);
+  }
+  writeFile(rawFile, data);
+
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter collector;
+  Codecs::GenericMessageBuilder builder(collector);
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  Codecs::StreamingAssembler assembler(registry, headerAnalyzer, builder);
+  {
+    std::string filename(rawFile);
+    Communication::RawFileReceiver receiver(filename);
+    // buffers smaller than the file: the receiver points into the file rather than copying.
+    BOOST_REQUIRE(receiver.start(assembler, 4, 2));
+    receiver.run();
+  }
+  BOOST_CHECK_EQUAL(collector.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(collector.values_.size(), 10u);
+  for(uint32 value = 1; value <= 10; ++value)
+  {
+    BOOST_CHECK_EQUAL(collector.values_[value - 1], value);
+  }
+  std::remove(rawFile);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/DataSourceReadAhead.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  std::string testData(size_t size)
+  {
+    std::string result;
+    for(size_t pos = 0; pos < size; ++pos)
+    {
+      result += char((pos * 7 + pos / 256) & 0xFF);
+    }
+    return result;
+  }
+
+  /// @brief read everything from the source one byte at a time and check it
+  void checkSource(Codecs::DataSource & source, const std::string & expected)
+  {
+    size_t pos = 0;
+    uchar byte = 0;
+    while(source.getByte(byte))
+    {
+      BOOST_REQUIRE(pos < expected.size());
+      BOOST_REQUIRE_EQUAL(int(byte), int(uchar(expected[pos])));
+      ++pos;
+    }
+    BOOST_CHECK_EQUAL(pos, expected.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceReadAheadTriple)
+{
+  std::string data = testData(100000);
+  std::stringstream stream(data);
+  Codecs::DataSourceReadAhead source(stream, 1000, 3);
+  checkSource(source, data);
+  BOOST_CHECK_EQUAL(source.bytesDelivered(), data.size());
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceReadAheadDouble)
+{
+  // the last buffer is partially full
+  std::string data = testData(10001);
+  std::stringstream stream(data);
+  Codecs::DataSourceReadAhead source(stream, 100, 2);
+  checkSource(source, data);
+}
+
+BOOST_AUTO_TEST_CASE(testDataSourceReadAheadEdges)
+{
+  {
+    std::stringstream empty;
+    Codecs::DataSourceReadAhead source(empty, 100);
+    checkSource(source, std::string());
+  }
+  {
+    // exactly fills the buffers
+    std::string data = testData(300);
+    std::stringstream stream(data);
+    Codecs::DataSourceReadAhead source(stream, 100);
+    checkSource(source, data);
+  }
+  {
+    // destroyed while the reader is waiting for free buffers.
+    std::string data = testData(100000);
+    std::stringstream stream(data);
+    Codecs::DataSourceReadAhead source(stream, 100);
+    uchar byte = 0;
+    BOOST_CHECK(source.getByte(byte));
+  }
+  std::stringstream stream;
+  BOOST_CHECK_THROW(Codecs::DataSourceReadAhead source(stream, 100, 1), std::invalid_argument);
+}
@@ -0,0 +1,212 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/DictionarySnapshot.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Messages/Message.h>
+#include <Messages/Field.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// <template id="id"><uInt32 name="a"><OP dictionary="dictionary" key="key"/></uInt32>...</template>
+  Codecs::TemplateRegistryPtr createRegistry(
+    template_id_t id,
+    size_t fieldCount,
+    bool delta,
+    const std::string & dictionary = "",
+    const std::string & key = "")
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(id);
+    for(size_t nField = 0; nField < fieldCount; ++nField)
+    {
+      Codecs::FieldInstructionPtr field(
+        new Codecs::FieldInstructionUInt32(std::string(1, char('a' + nField)), ""));
+      Codecs::FieldOpPtr fieldOp;
+      if(delta)
+      {
+        fieldOp.reset(new Codecs::FieldOpDelta);
+      }
+      else
+      {
+        fieldOp.reset(new Codecs::FieldOpCopy);
+      }
+      if(!dictionary.empty())
+      {
+        fieldOp->setDictionaryName(dictionary);
+      }
+      if(!key.empty())
+      {
+        fieldOp->setKey(key);
+      }
+      field->setFieldOp(fieldOp);
+      templ->addInstruction(field);
+    }
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+
+  /// Decode count messages and return the value of field "a" in the last one
+  uint32 decodeValues(Codecs::Decoder & decoder, Codecs::DataSource & source, size_t count)
+  {
+    uint32 result = 0;
+    for(size_t nMessage = 0; nMessage < count; ++nMessage)
+    {
+      Codecs::SingleMessageConsumer consumer;
+      Codecs::GenericMessageBuilder builder(consumer);
+      decoder.decodeMessage(source, builder);
+      Messages::FieldCPtr field;
+      BOOST_REQUIRE(consumer.message().getField("a", field));
+      result = field->toUInt32();
+    }
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateRegistryFingerprint)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry(1, 2, true);
+  // the same templates built separately (i.e. in another process) match.
+  BOOST_CHECK_EQUAL(registry->fingerprint(), createRegistry(1, 2, true)->fingerprint());
+  // any difference in the templates is detected
+  BOOST_CHECK(registry->fingerprint() != createRegistry(2, 2, true)->fingerprint());
+  BOOST_CHECK(registry->fingerprint() != createRegistry(1, 3, true)->fingerprint());
+  BOOST_CHECK(registry->fingerprint() != createRegistry(1, 2, false)->fingerprint());
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateRegistryFingerprintDictionary)
+{
+  // the same field layout sharing state through a different dictionary entry is detected
+  Codecs::TemplateRegistryPtr registry = createRegistry(1, 1, true, "", "");
+  Codecs::TemplateRegistryPtr keyed = createRegistry(1, 1, true, "", "other");
+  Codecs::TemplateRegistryPtr named = createRegistry(1, 1, true, "template", "");
+  BOOST_CHECK_EQUAL(registry->dictionarySize(), keyed->dictionarySize());
+  BOOST_CHECK_EQUAL(registry->dictionarySize(), named->dictionarySize());
+  BOOST_CHECK(registry->fingerprint() != keyed->fingerprint());
+  BOOST_CHECK(registry->fingerprint() != named->fingerprint());
+  BOOST_CHECK(keyed->fingerprint() != named->fingerprint());
+}
+
+BOOST_AUTO_TEST_CASE(testDictionarySnapshotFailover)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry(1, 1, true);
+  // one message that sets the template ID, then messages that each add one to the value
+  std::string data("\xC0\x81\x81");
+  for(size_t nMessage = 1; nMessage < 20; ++nMessage)
+  {
+    data += "\x80\x81";
+  }
+  Codecs::DataSourceString primarySource(data);
+  Codecs::Decoder primary(registry);
+  BOOST_CHECK_EQUAL(decodeValues(primary, primarySource, 10), 10u);
+
+  Codecs::DictionarySnapshot snapshot(registry);
+  BOOST_CHECK(!snapshot.isValid());
+  primary.saveDictionary(snapshot);
+  BOOST_CHECK(snapshot.isValid());
+  BOOST_CHECK_EQUAL(snapshot.templateId(), 1u);
+
+  // the standby picks up where the primary left off.
+  std::string serialized;
+  snapshot.write(serialized);
+  Codecs::DictionarySnapshot received(registry);
+  received.read(serialized);
+  Codecs::Decoder standby(registry);
+  standby.restoreDictionary(received);
+  Codecs::DataSourceString standbySource(data.substr(3 + 9 * 2));
+  BOOST_CHECK_EQUAL(decodeValues(standby, standbySource, 10), 20u);
+
+  // the same snapshot object can be reused for the next capture.
+  standby.saveDictionary(snapshot);
+  primary.restoreDictionary(snapshot);
+  Codecs::DataSourceString tail("\x80\x85");
+  BOOST_CHECK_EQUAL(decodeValues(primary, tail, 1), 25u);
+}
+
+BOOST_AUTO_TEST_CASE(testDictionarySnapshotEncoder)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry(3, 6, false);
+  Codecs::Encoder original(registry);
+  original.setTemplateId(3);
+  original.setDictionaryValue(0, uint64(300));
+  original.setDictionaryValue(1, int64(-1));
+  original.setDictionaryValue(2, reinterpret_cast<const unsigned char *>("IBM"), 3);
+  original.setDictionaryValueNull(3);
+  // entries 4 and 5 are undefined
+
+  Codecs::DictionarySnapshot snapshot(registry);
+  original.saveDictionary(snapshot);
+  std::string serialized;
+  snapshot.write(serialized);
+  // header(4+1+8+1+1) uint(1+2) int(1+1) string(1+1+3) null(1) undefined(1+1)
+  BOOST_CHECK_EQUAL(serialized.size(), 28u);
+
+  Codecs::DictionarySnapshot received(registry);
+  received.read(serialized);
+  Codecs::Encoder restored(registry);
+  restored.setDictionaryValue(4, uint64(99));
+  restored.restoreDictionary(received);
+  BOOST_CHECK_EQUAL(restored.getTemplateId(), 3u);
+  uint64 unsignedValue = 0;
+  BOOST_CHECK(restored.getDictionaryValue(0, unsignedValue) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(unsignedValue, 300u);
+  int64 signedValue = 0;
+  BOOST_CHECK(restored.getDictionaryValue(1, signedValue) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(signedValue, -1);
+  const unsigned char * stringValue = 0;
+  size_t length = 0;
+  BOOST_CHECK(restored.getDictionaryValue(2, stringValue, length) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(stringValue), length), "IBM");
+  BOOST_CHECK(restored.getDictionaryValue(3, signedValue) == Codecs::Context::NULL_VALUE);
+  BOOST_CHECK(restored.getDictionaryValue(4, signedValue) == Codecs::Context::UNDEFINED_VALUE);
+  BOOST_CHECK(restored.getDictionaryValue(5, signedValue) == Codecs::Context::UNDEFINED_VALUE);
+}
+
+BOOST_AUTO_TEST_CASE(testDictionarySnapshotMismatch)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry(1, 2, true);
+  Codecs::TemplateRegistryPtr other = createRegistry(1, 2, false);
+  Codecs::Decoder decoder(registry);
+  decoder.setTemplateId(1);
+
+  // a snapshot allocated for other templates can neither capture nor restore
+  Codecs::DictionarySnapshot wrong(other);
+  BOOST_CHECK_THROW(decoder.saveDictionary(wrong), std::runtime_error);
+  BOOST_CHECK_THROW(decoder.restoreDictionary(wrong), std::runtime_error);
+
+  // an empty snapshot is not restored
+  Codecs::DictionarySnapshot empty(registry);
+  BOOST_CHECK_THROW(decoder.restoreDictionary(empty), std::runtime_error);
+
+  // serialized state from other templates is rejected when read
+  Codecs::DictionarySnapshot snapshot(registry);
+  decoder.saveDictionary(snapshot);
+  std::string serialized;
+  snapshot.write(serialized);
+  BOOST_CHECK_THROW(wrong.read(serialized), std::runtime_error);
+  BOOST_CHECK(!wrong.isValid());
+  // as is damaged data
+  BOOST_CHECK_THROW(snapshot.read(serialized.substr(0, serialized.size() - 1)), std::runtime_error);
+  BOOST_CHECK_THROW(snapshot.read(serialized + '\0'), std::runtime_error);
+  std::string badMagic(serialized);
+  badMagic[0] = 'X';
+  BOOST_CHECK_THROW(snapshot.read(badMagic), std::runtime_error);
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/FeedArbitrator.h>
+#include <Codecs/FixedSizeHeaderAnalyzer.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Communication/MulticastReceiver.h>
+#include <Tests/ValueTemplate.h>
+#include <set>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const unsigned short feedPort = 30107;
+  const char feedAGroup[] = "239.255.0.1";
+  const char feedBGroup[] = "239.255.0.2";
+  const uint32 packetCount = 20;
+
+  /// A packet is a four byte big-endian sequence number followed by one FAST message.
+  std::string buildPacket(uint32 sequence)
+  {
+    std::string packet;
+    packet += char((sequence >> 24) & 0xFF);
+    packet += char((sequence >> 16) & 0xFF);
+    packet += char((sequence >> 8) & 0xFF);
+    packet += char(sequence & 0xFF);
+    packet += char(0xC0);                       // pmap: template id present
+    packet += char(0x81);                       // template id 1
+    packet += char(0x80 | (sequence & 0x7F));   // value = sequence
+    return packet;
+  }
+
+  void sendFeed(
+    boost::asio::io_service & ioService,
+    const char * group,
+    const std::set<uint32> & dropped)
+  {
+    boost::asio::ip::udp::socket socket(ioService, boost::asio::ip::udp::v4());
+    socket.set_option(boost::asio::ip::multicast::outbound_interface(
+      boost::asio::ip::address_v4::loopback()));
+    socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+    boost::asio::ip::udp::endpoint destination(
+      boost::asio::ip::address::from_string(group), feedPort);
+    for(uint32 sequence = 1; sequence <= packetCount; ++sequence)
+    {
+      if(dropped.find(sequence) == dropped.end())
+      {
+        std::string packet = buildPacket(sequence);
+        socket.send_to(boost::asio::buffer(packet.data(), packet.size()), destination);
+      }
+    }
+  }
+
+  void pollUntil(Communication::Receiver & receiver, const size_t & counter, size_t target)
+  {
+    boost::posix_time::ptime deadline =
+      boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(5);
+    while(counter < target && boost::posix_time::microsec_clock::universal_time() < deadline)
+    {
+      if(receiver.poll() == 0)
+      {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFeedArbitratorLoopback)
+{
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter counter;
+  Codecs::GenericMessageBuilder builder(counter);
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, true, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  Codecs::MessagePerPacketAssembler assembler(
+    registry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+
+  Codecs::FixedSizeHeaderAnalyzer sequenceAnalyzer(0, true, 4);
+  sequenceAnalyzer.setSequenceNumberLocation(0, 4);
+  BOOST_CHECK_THROW(sequenceAnalyzer.setSequenceNumberLocation(2, 4), std::invalid_argument);
+
+  boost::asio::io_service ioService;
+  Communication::MulticastReceiver feedA(ioService, feedAGroup, "127.0.0.1", feedPort);
+  Communication::MulticastReceiver feedB(ioService, feedBGroup, "127.0.0.1", feedPort);
+  Codecs::FeedArbitrator arbitrator(registry, sequenceAnalyzer, assembler, 64);
+  BOOST_REQUIRE(arbitrator.start(feedA, feedB, 1400, 32));
+
+  // A loses 5 and 6; B loses 10.
+  std::set<uint32> droppedA;
+  droppedA.insert(5);
+  droppedA.insert(6);
+  std::set<uint32> droppedB;
+  droppedB.insert(10);
+
+  sendFeed(ioService, feedAGroup, droppedA);
+  pollUntil(feedA, counter.messageCount_, packetCount - droppedA.size());
+  sendFeed(ioService, feedBGroup, droppedB);
+  pollUntil(feedB, counter.messageCount_, packetCount);
+  // give any unexpected extra copies a chance to show up.
+  for(size_t nPoll = 0; nPoll < 10; ++nPoll)
+  {
+    feedA.poll();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+  }
+
+  feedA.stop();
+  feedB.stop();
+  feedA.poll();
+
+  BOOST_CHECK_EQUAL(counter.errorCount_, 0u);
+  BOOST_CHECK_EQUAL(counter.messageCount_, size_t(packetCount));
+  for(uint32 sequence = 1; sequence <= packetCount; ++sequence)
+  {
+    BOOST_CHECK_EQUAL(counter.count(sequence), 1u);
+  }
+  BOOST_CHECK_EQUAL(arbitrator.packetsWon(Codecs::FeedArbitrator::FEED_A), size_t(packetCount - 2));
+  BOOST_CHECK_EQUAL(arbitrator.packetsWon(Codecs::FeedArbitrator::FEED_B), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicatesDropped(Codecs::FeedArbitrator::FEED_A), 0u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicatesDropped(Codecs::FeedArbitrator::FEED_B), size_t(packetCount - 3));
+  BOOST_CHECK_EQUAL(arbitrator.unsequencedPackets(Codecs::FeedArbitrator::FEED_A), 0u);
+  BOOST_CHECK_EQUAL(arbitrator.highestSequence(), packetCount);
+}
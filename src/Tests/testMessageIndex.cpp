@@ -0,0 +1,171 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/MessageIndex.h>
+#include <Codecs/DataSourceMapped.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DictionarySnapshot.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// <template id="1"><uInt32 name="value"><delta/></uInt32></template>
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    return Tests::createValueRegistry(1, Codecs::FieldOpPtr(new Codecs::FieldOpDelta));
+  }
+
+  /// Every message adds one to the previous value.
+  /// Message 50 is an SCP reset which sets the value back to zero.
+  /// The template ID is only present when it changes, so it comes from the dictionary too.
+  std::string createData()
+  {
+    std::string result;
+    for(size_t nMessage = 0; nMessage < 100; ++nMessage)
+    {
+      if(nMessage == 0 || nMessage == 51)
+      {
+        result += "\xC0\x81\x81";
+      }
+      else if(nMessage == 50)
+      {
+        result += "\xC0\xF8";
+      }
+      else
+      {
+        result += "\x80\x81";
+      }
+    }
+    return result;
+  }
+
+  uint32 expectedValue(size_t messageNumber)
+  {
+    return messageNumber < 50 ? uint32(messageNumber + 1) : uint32(messageNumber - 50);
+  }
+
+  uint32 decodeOne(Codecs::Decoder & decoder, Codecs::DataSource & source)
+  {
+    Tests::ValueCounter collector;
+    Codecs::GenericMessageBuilder builder(collector);
+    decoder.decodeMessage(source, builder);
+    BOOST_REQUIRE_EQUAL(collector.values_.size(), 1u);
+    return collector.values_[0];
+  }
+
+  const char dataFile[] = "testMessageIndex.fast";
+}
+
+BOOST_AUTO_TEST_CASE(testContextDictionarySnapshot)
+{
+  // four copy fields give four dictionary entries
+  Codecs::TemplatePtr templ(new Codecs::Template);
+  templ->setId(2);
+  for(char name = 'a'; name < 'e'; ++name)
+  {
+    Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionUInt32(std::string(1, name), ""));
+    field->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpCopy));
+    templ->addInstruction(field);
+  }
+  Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+  registry->addTemplate(templ);
+  registry->finalize();
+  BOOST_REQUIRE_EQUAL(registry->dictionarySize(), 4u);
+
+  Codecs::Decoder original(registry);
+  original.setTemplateId(2);
+  original.setDictionaryValue(0, int64(-5));
+  original.setDictionaryValue(1, Decimal(12345, -2));
+  original.setDictionaryValue(2, reinterpret_cast<const unsigned char *>("hello"), 5);
+  original.setDictionaryValueNull(3);
+  Codecs::DictionarySnapshot snapshot(registry);
+  original.saveDictionary(snapshot);
+  std::string serialized;
+  snapshot.write(serialized);
+
+  Codecs::DictionarySnapshot received(registry);
+  received.read(serialized);
+  Codecs::Decoder restored(registry);
+  restored.restoreDictionary(received);
+  BOOST_CHECK_EQUAL(restored.getTemplateId(), 2u);
+  int64 signedValue = 0;
+  BOOST_CHECK(restored.getDictionaryValue(0, signedValue) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(signedValue, -5);
+  Decimal decimalValue;
+  BOOST_CHECK(restored.getDictionaryValue(1, decimalValue) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK(decimalValue == Decimal(12345, -2));
+  const unsigned char * stringValue = 0;
+  size_t length = 0;
+  BOOST_CHECK(restored.getDictionaryValue(2, stringValue, length) == Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(stringValue), length), "hello");
+  BOOST_CHECK(restored.getDictionaryValue(3, signedValue) == Codecs::Context::NULL_VALUE);
+
+  // a snapshot from different templates is rejected.
+  Codecs::DictionarySnapshot other(createRegistry());
+  BOOST_CHECK_THROW(other.read(serialized), std::runtime_error);
+  BOOST_CHECK_THROW(received.read(serialized.substr(0, 12)), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testMessageIndex)
+{
+  std::string data = createData();
+  {
+    std::ofstream file(dataFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  {
+    Codecs::TemplateRegistryPtr registry = createRegistry();
+    Codecs::DataSourceMapped source(dataFile);
+    Codecs::Decoder decoder(registry);
+    Codecs::MessageIndex index;
+    BOOST_CHECK_EQUAL(index.build(decoder, source, 16), 100u);
+    BOOST_CHECK_EQUAL(index.messageCount(), 100u);
+
+    // every 16 messages plus the message following the reset
+    BOOST_REQUIRE_EQUAL(index.size(), 8u);
+    BOOST_CHECK_EQUAL(index.entry(3).messageNumber_, 48u);
+    BOOST_CHECK_EQUAL(index.entry(4).messageNumber_, 51u);
+    BOOST_CHECK_EQUAL(index.entry(4).offset_, 3u + 49u * 2u + 2u);
+    BOOST_CHECK_EQUAL(index.find(50)->messageNumber_, 48u);
+
+    size_t targets[] = {0, 1, 15, 16, 40, 49, 50, 51, 52, 75, 99};
+    for(size_t nTarget = 0; nTarget < sizeof(targets)/sizeof(targets[0]); ++nTarget)
+    {
+      size_t target = targets[nTarget];
+      Codecs::Decoder seeker(registry);
+      BOOST_REQUIRE(index.seek(target, seeker, source));
+      if(target != 50)
+      {
+        BOOST_CHECK_EQUAL(decodeOne(seeker, source), expectedValue(target));
+      }
+    }
+    BOOST_CHECK(!index.seek(100, decoder, source));
+
+    // persist the index
+    std::stringstream indexFile;
+    index.write(indexFile);
+    Codecs::MessageIndex loaded;
+    loaded.read(indexFile);
+    BOOST_CHECK_EQUAL(loaded.messageCount(), 100u);
+    BOOST_CHECK_EQUAL(loaded.size(), index.size());
+    Codecs::Decoder seeker(registry);
+    BOOST_REQUIRE(loaded.seek(77, seeker, source));
+    BOOST_CHECK_EQUAL(decodeOne(seeker, source), expectedValue(77));
+    BOOST_CHECK_EQUAL(decodeOne(seeker, source), expectedValue(78));
+
+    std::stringstream garbage("not an index");
+    BOOST_CHECK_THROW(loaded.read(garbage), std::runtime_error);
+  }
+  std::remove(dataFile);
+}
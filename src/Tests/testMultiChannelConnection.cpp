@@ -0,0 +1,270 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Application/MultiChannelConnection.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/TemplateCache.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Communication/Receiver.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char channelFile[] =
+    "# two channels with a fixed packet header\n"
+    "template  templates.xml\n"
+    "interface 127.0.0.1   # loopback\n"
+    "buffersize 1500\n"
+    "buffers 4\n"
+    "pfix 2\n"
+    "pprefix 4\n"
+    "\n"
+    "channel A 239.255.0.11:30108\n"
+    "buffers 6\n"
+    "pnone\n"
+    "channel B 239.255.0.12:30109\n";
+
+  /// Check that a channel's messages arrive one at a time and in order.
+  class SerialChecker : public Tests::ValueCounter
+  {
+  public:
+    SerialChecker()
+      : overlaps_(0)
+      , outOfOrder_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      boost::mutex::scoped_try_lock inside(insideMutex_);
+      if(!inside.owns_lock())
+      {
+        // another thread is delivering a message for this channel right now.
+        boost::mutex::scoped_lock lock(countMutex_);
+        ++overlaps_;
+      }
+      Messages::FieldCPtr field;
+      if(!message.getField("value", field) || field->toUInt32() != messageCount_)
+      {
+        ++outOfOrder_;
+      }
+      // give any other thread a chance to collide with this one.
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+      return Tests::ValueCounter::consumeMessage(message);
+    }
+
+    size_t overlaps_;
+    size_t outOfOrder_;
+  private:
+    boost::mutex insideMutex_;
+    boost::mutex countMutex_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(testMultiChannelReadChannels)
+{
+  std::istringstream in(channelFile);
+  std::vector<Application::DecoderConfiguration> channels;
+  BOOST_CHECK_EQUAL(Application::MultiChannelConnection::readChannels(in, channels), 2u);
+  BOOST_REQUIRE_EQUAL(channels.size(), 2u);
+
+  std::string name;
+  BOOST_CHECK(channels[0].getExtra("channel", name));
+  BOOST_CHECK_EQUAL(name, "A");
+  BOOST_CHECK_EQUAL(channels[0].templateFileName(), "templates.xml");
+  BOOST_CHECK_EQUAL(channels[0].multicastGroupIP(), "239.255.0.11");
+  BOOST_CHECK_EQUAL(channels[0].portNumber(), 30108);
+  BOOST_CHECK_EQUAL(channels[0].listenInterfaceIP(), "127.0.0.1");
+  BOOST_CHECK_EQUAL(channels[0].bufferSize(), 1500u);
+  BOOST_CHECK_EQUAL(channels[0].bufferCount(), 4u);
+  BOOST_CHECK(channels[0].packetHeaderType() == Application::DecoderConfiguration::FIXED_HEADER);
+  BOOST_CHECK_EQUAL(channels[0].packetHeaderMessageSizeBytes(), 2u);
+  BOOST_CHECK_EQUAL(channels[0].packetHeaderPrefixCount(), 4u);
+
+  BOOST_CHECK(channels[1].getExtra("channel", name));
+  BOOST_CHECK_EQUAL(name, "B");
+  BOOST_CHECK_EQUAL(channels[1].portNumber(), 30109);
+  BOOST_CHECK_EQUAL(channels[1].bufferCount(), 6u);
+  BOOST_CHECK(channels[1].packetHeaderType() == Application::DecoderConfiguration::NO_HEADER);
+
+  std::istringstream bad("channel C 239.255.0.13\n");
+  BOOST_CHECK_THROW(Application::MultiChannelConnection::readChannels(bad, channels), std::invalid_argument);
+  std::istringstream unknown("frobnicate 3\n");
+  BOOST_CHECK_THROW(Application::MultiChannelConnection::readChannels(unknown, channels), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(testMultiChannelTemplateFiles)
+{
+  Codecs::TemplateCache::writeFile(*Tests::createValueRegistry(1), "testMultiChannelA.qftc");
+  Codecs::TemplateCache::writeFile(*Tests::createValueRegistry(2), "testMultiChannelB.qftc");
+  std::istringstream in(
+    "interface 127.0.0.1\n"
+    "template testMultiChannelA.qftc\n"
+    "channel A 239.255.0.31:30112\n"
+    "template testMultiChannelB.qftc\n"
+    "channel B 239.255.0.32:30112\n"
+    "template testMultiChannelA.qftc\n"
+    "channel C 239.255.0.33:30112\n");
+  Tests::ValueCounter counter;
+  Codecs::GenericMessageBuilder builder(counter);
+  Application::MultiChannelConnection connection;
+  connection.configure(in, builder);
+  std::remove("testMultiChannelA.qftc");
+  std::remove("testMultiChannelB.qftc");
+  BOOST_REQUIRE_EQUAL(connection.channelCount(), 3u);
+
+  // each channel decodes with the templates it named; a file is loaded once.
+  Codecs::TemplateRegistryCPtr a = connection.assembler(0).decoder().getTemplateRegistry();
+  Codecs::TemplateRegistryCPtr b = connection.assembler(1).decoder().getTemplateRegistry();
+  BOOST_CHECK_EQUAL(a->fingerprint(), Tests::createValueRegistry(1)->fingerprint());
+  BOOST_CHECK_EQUAL(b->fingerprint(), Tests::createValueRegistry(2)->fingerprint());
+  BOOST_CHECK(connection.assembler(2).decoder().getTemplateRegistry() == a);
+
+  // without a registry or a template file there is nothing to decode with.
+  Application::DecoderConfiguration configuration;
+  BOOST_CHECK_THROW(connection.addChannel(configuration, builder), UsageError);
+}
+
+BOOST_AUTO_TEST_CASE(testMultiChannelLoopback)
+{
+  Codecs::TemplateRegistryPtr registry(Tests::createValueRegistry());
+  const size_t channelCount = 4;
+  const size_t messagesPerChannel = 10;
+  Application::MultiChannelConnection connection(registry);
+  std::vector<boost::shared_ptr<Tests::ValueCounter> > counters;
+  std::vector<boost::shared_ptr<Codecs::GenericMessageBuilder> > builders;
+  for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+  {
+    Application::DecoderConfiguration configuration;
+    configuration.setMulticastGroupIP("239.255.0." + boost::lexical_cast<std::string>(20 + nChannel));
+    configuration.setListenInterfaceIP("127.0.0.1");
+    configuration.setPortNumber(30110);
+    configuration.setBufferCount(messagesPerChannel);
+    counters.push_back(boost::shared_ptr<Tests::ValueCounter>(new Tests::ValueCounter));
+    builders.push_back(boost::shared_ptr<Codecs::GenericMessageBuilder>(
+      new Codecs::GenericMessageBuilder(*counters.back())));
+    BOOST_CHECK_EQUAL(connection.addChannel(configuration, *builders.back()), nChannel);
+  }
+  connection.start();
+
+  boost::asio::ip::udp::socket socket(connection.ioService(), boost::asio::ip::udp::v4());
+  socket.set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::loopback()));
+  socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  for(size_t nMessage = 0; nMessage < messagesPerChannel; ++nMessage)
+  {
+    for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+    {
+      // pmap, template id 1, value
+      const unsigned char message[] = {0xC0, 0x81, (unsigned char)(0x80 | nMessage)};
+      boost::asio::ip::udp::endpoint destination(
+        boost::asio::ip::address::from_string("239.255.0." + boost::lexical_cast<std::string>(20 + nChannel)),
+        30110);
+      socket.send_to(boost::asio::buffer(message, sizeof(message)), destination);
+    }
+  }
+
+  // single thread services every channel
+  boost::posix_time::ptime deadline =
+    boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(5);
+  size_t total = 0;
+  while(total < channelCount * messagesPerChannel &&
+    boost::posix_time::microsec_clock::universal_time() < deadline)
+  {
+    if(connection.poll() == 0)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    total = 0;
+    for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+    {
+      total += counters[nChannel]->messageCount_;
+    }
+  }
+  connection.stop();
+
+  for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+  {
+    BOOST_CHECK_EQUAL(counters[nChannel]->messageCount_, messagesPerChannel);
+    BOOST_CHECK_EQUAL(counters[nChannel]->errorCount_, 0u);
+    BOOST_CHECK_EQUAL(connection.assembler(nChannel).messageCount(), messagesPerChannel);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMultiChannelThreads)
+{
+  Codecs::TemplateRegistryPtr registry(Tests::createValueRegistry());
+
+  const size_t channelCount = 4;
+  const size_t messagesPerChannel = 10;
+  Application::MultiChannelConnection connection(registry);
+  std::vector<boost::shared_ptr<SerialChecker> > counters;
+  std::vector<boost::shared_ptr<Codecs::GenericMessageBuilder> > builders;
+  for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+  {
+    Application::DecoderConfiguration configuration;
+    configuration.setMulticastGroupIP("239.255.0." + boost::lexical_cast<std::string>(24 + nChannel));
+    configuration.setListenInterfaceIP("127.0.0.1");
+    configuration.setPortNumber(30111);
+    configuration.setBufferCount(messagesPerChannel);
+    counters.push_back(boost::shared_ptr<SerialChecker>(new SerialChecker));
+    builders.push_back(boost::shared_ptr<Codecs::GenericMessageBuilder>(
+      new Codecs::GenericMessageBuilder(*counters.back())));
+    connection.addChannel(configuration, *builders.back());
+  }
+  connection.start();
+  // three threads share the channels; each channel is decoded by one thread at a time.
+  connection.runThreads(3, false);
+
+  boost::asio::ip::udp::socket socket(connection.ioService(), boost::asio::ip::udp::v4());
+  socket.set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::loopback()));
+  socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  for(size_t nMessage = 0; nMessage < messagesPerChannel; ++nMessage)
+  {
+    for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+    {
+      const unsigned char message[] = {0xC0, 0x81, (unsigned char)(0x80 | nMessage)};
+      boost::asio::ip::udp::endpoint destination(
+        boost::asio::ip::address::from_string("239.255.0." + boost::lexical_cast<std::string>(24 + nChannel)),
+        30111);
+      socket.send_to(boost::asio::buffer(message, sizeof(message)), destination);
+    }
+  }
+
+  boost::posix_time::ptime deadline =
+    boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(5);
+  size_t total = 0;
+  while(total < channelCount * messagesPerChannel &&
+    boost::posix_time::microsec_clock::universal_time() < deadline)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    // receiver statistics may be read while the threads are running.
+    total = 0;
+    for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+    {
+      total += connection.receiver(nChannel).packetsProcessed();
+    }
+  }
+  connection.stop();
+  connection.joinThreads();
+
+  // the threads are gone; the consumers can be examined.
+  for(size_t nChannel = 0; nChannel < channelCount; ++nChannel)
+  {
+    BOOST_CHECK_EQUAL(counters[nChannel]->messageCount_, messagesPerChannel);
+    BOOST_CHECK_EQUAL(counters[nChannel]->errorCount_, 0u);
+    BOOST_CHECK_EQUAL(counters[nChannel]->overlaps_, 0u);
+    BOOST_CHECK_EQUAL(counters[nChannel]->outOfOrder_, 0u);
+    BOOST_CHECK_EQUAL(connection.assembler(nChannel).messageCount(), messagesPerChannel);
+  }
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/MulticastSender.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Receive datagrams from the loopback interface until the expected number
+  /// arrive or time runs out.
+  size_t receiveAll(
+    boost::asio::ip::udp::socket & socket,
+    std::vector<std::string> & received,
+    size_t expected)
+  {
+    boost::posix_time::ptime deadline =
+      boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(5);
+    unsigned char buffer[2000];
+    while(received.size() < expected && boost::posix_time::microsec_clock::universal_time() < deadline)
+    {
+      if(socket.available() == 0)
+      {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        continue;
+      }
+      size_t bytes = socket.receive(boost::asio::buffer(buffer, sizeof(buffer)));
+      received.push_back(std::string(reinterpret_cast<const char *>(buffer), bytes));
+    }
+    return received.size();
+  }
+
+  std::string datagram(size_t number, size_t size)
+  {
+    std::string result(size, char('a' + number % 26));
+    result[0] = char(number);
+    return result;
+  }
+
+  void testBatch(bool segmentation)
+  {
+    const std::string group("239.255.0.31");
+    const unsigned short port = 30113;
+    boost::asio::io_service ioService;
+    boost::asio::ip::udp::socket listener(ioService);
+    boost::asio::ip::udp::endpoint listenEndpoint(boost::asio::ip::address_v4::any(), port);
+    listener.open(listenEndpoint.protocol());
+    listener.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+    listener.bind(listenEndpoint);
+    listener.set_option(boost::asio::ip::multicast::join_group(
+      boost::asio::ip::address_v4::from_string(group),
+      boost::asio::ip::address_v4::loopback()));
+
+    Communication::MulticastSender sender(ioService, group, port);
+    sender.initializeSender();
+    sender.socket().set_option(boost::asio::ip::multicast::outbound_interface(
+      boost::asio::ip::address_v4::loopback()));
+    sender.socket().set_option(boost::asio::ip::multicast::enable_loopback(true));
+    sender.setBatchSize(8);
+    sender.setSegmentation(segmentation);
+
+    // equal sized datagrams (candidates for segmentation) followed by a short one and odd sizes.
+    std::vector<std::string> sent;
+    for(size_t nDatagram = 0; nDatagram < 6; ++nDatagram)
+    {
+      sent.push_back(datagram(nDatagram, 100));
+    }
+    sent.push_back(datagram(6, 40));
+    sent.push_back(datagram(7, 300));
+    sent.push_back(datagram(8, 10));
+    sent.push_back(datagram(9, 10));
+
+    size_t flushed = 0;
+    for(size_t nDatagram = 0; nDatagram < sent.size(); ++nDatagram)
+    {
+      flushed += sender.queue(sent[nDatagram].data(), sent[nDatagram].size());
+    }
+    // the batch filled once.
+    BOOST_CHECK_EQUAL(flushed, 8u);
+    BOOST_CHECK_EQUAL(sender.queued(), 2u);
+    BOOST_CHECK_EQUAL(sender.flush(), 2u);
+    BOOST_CHECK_EQUAL(sender.queued(), 0u);
+    BOOST_CHECK_EQUAL(sender.flush(), 0u);
+
+    std::vector<std::string> received;
+    BOOST_REQUIRE_EQUAL(receiveAll(listener, received, sent.size()), sent.size());
+    for(size_t nDatagram = 0; nDatagram < sent.size(); ++nDatagram)
+    {
+      BOOST_CHECK(received[nDatagram] == sent[nDatagram]);
+    }
+#if defined(__linux__)
+    // fewer system calls than datagrams
+    BOOST_CHECK(sender.sendCalls() < sent.size());
+#endif // __linux__
+    BOOST_TEST_MESSAGE("segmentation " << (sender.segmentation() ? "used" : "not available"));
+    sender.stop();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastSenderBatch)
+{
+  testBatch(false);
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastSenderSegmentation)
+{
+  // falls back to unsegmented sends if the kernel does not support UDP GSO.
+  testBatch(true);
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastSenderFlushError)
+{
+  const std::string group("239.255.0.32");
+  const unsigned short port = 30114;
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket listener(ioService);
+  boost::asio::ip::udp::endpoint listenEndpoint(boost::asio::ip::address_v4::any(), port);
+  listener.open(listenEndpoint.protocol());
+  listener.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+  listener.bind(listenEndpoint);
+  listener.set_option(boost::asio::ip::multicast::join_group(
+    boost::asio::ip::address_v4::from_string(group),
+    boost::asio::ip::address_v4::loopback()));
+
+  Communication::MulticastSender sender(ioService, group, port);
+  sender.initializeSender();
+  sender.socket().set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::loopback()));
+  sender.socket().set_option(boost::asio::ip::multicast::enable_loopback(true));
+  sender.setBatchSize(8);
+
+  // an IPv6 destination can not be reached through the IPv4 socket.
+  boost::asio::ip::udp::endpoint unreachable(boost::asio::ip::address_v6::loopback(), port);
+  std::vector<std::string> sent;
+  for(size_t nDatagram = 0; nDatagram < 4; ++nDatagram)
+  {
+    sent.push_back(datagram(nDatagram, 50));
+  }
+  sender.queue(sent[0].data(), sent[0].size());
+  sender.queue(sent[1].data(), sent[1].size());
+  sender.queue(sent[2].data(), sent[2].size(), unreachable);
+  sender.queue(sent[3].data(), sent[3].size());
+  BOOST_CHECK_THROW(sender.flush(), boost::system::system_error);
+  // the datagrams that were sent are gone; the failed one and the rest are still queued.
+  BOOST_CHECK_EQUAL(sender.queued(), 2u);
+  BOOST_CHECK_THROW(sender.flush(), boost::system::system_error);
+  BOOST_CHECK_EQUAL(sender.queued(), 2u);
+
+  std::vector<std::string> received;
+  BOOST_REQUIRE_EQUAL(receiveAll(listener, received, 2), 2u);
+  BOOST_CHECK(received[0] == sent[0]);
+  BOOST_CHECK(received[1] == sent[1]);
+  // nothing is sent twice.
+  boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+  BOOST_CHECK_EQUAL(listener.available(), 0u);
+  sender.stop();
+}
@@ -0,0 +1,409 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/PCapReader.h>
+#include <Communication/PCapFileReceiver.h>
+#include <Application/PCapFlowDecoder.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  void appendLittle(std::string & out, uint32 value, size_t bytes)
+  {
+    for(size_t nByte = 0; nByte < bytes; ++nByte)
+    {
+      out += char((value >> (8 * nByte)) & 0xFF);
+    }
+  }
+
+  void appendBig(std::string & out, uint32 value, size_t bytes)
+  {
+    while(bytes > 0)
+    {
+      --bytes;
+      out += char((value >> (8 * bytes)) & 0xFF);
+    }
+  }
+
+  /// An ethernet frame containing an IPv4/UDP packet.
+  std::string frame(uint32 destination, uint16 port, const std::string & payload)
+  {
+    std::string result;
+    result.append(12, '\x01');                // mac addresses
+    appendBig(result, 0x0800, 2);             // IPv4
+    result += char(0x45);                     // version 4, 5 word header
+    result += char(0);
+    appendBig(result, uint32(20 + 8 + payload.size()), 2);
+    appendBig(result, 0, 4);                  // id, flags, fragment
+    result += char(1);                        // ttl
+    result += char(17);                       // UDP
+    appendBig(result, 0, 2);                  // checksum
+    appendBig(result, 0x0A000001, 4);         // source 10.0.0.1
+    appendBig(result, destination, 4);
+    appendBig(result, 5000, 2);               // source port
+    appendBig(result, port, 2);
+    appendBig(result, uint32(8 + payload.size()), 2);
+    appendBig(result, 0, 2);
+    result += payload;
+    appendBig(result, 0, 4);                  // ethernet frame check sequence
+    return result;
+  }
+
+  /// Build a classic (little-endian) PCap file of ethernet/IPv4/UDP packets.
+  class PCapWriter
+  {
+  public:
+    /// @param nanoseconds selects the nanosecond timestamp magic number.
+    explicit PCapWriter(bool nanoseconds = false)
+    {
+      appendLittle(file_, nanoseconds ? 0xa1b23c4d : 0xa1b2c3d4, 4); // magic
+      appendLittle(file_, 2, 2);          // version 2.4
+      appendLittle(file_, 4, 2);
+      appendLittle(file_, 0, 4);          // thiszone
+      appendLittle(file_, 0, 4);          // sigfigs
+      appendLittle(file_, 65535, 4);      // snaplen
+      appendLittle(file_, 1, 4);          // ethernet
+    }
+
+    void addPacket(
+      uint32 seconds,
+      uint32 fraction,
+      uint32 destination,
+      uint16 port,
+      const std::string & payload)
+    {
+      std::string packet = frame(destination, port, payload);
+      appendLittle(file_, seconds, 4);
+      appendLittle(file_, fraction, 4);
+      appendLittle(file_, uint32(packet.size()), 4);  // caplen
+      appendLittle(file_, uint32(packet.size()), 4);  // len
+      file_ += packet;
+    }
+
+    void write(const char * filename) const
+    {
+      std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+      out.write(file_.data(), file_.size());
+    }
+
+  protected:
+    PCapWriter(int /*noHeader*/)
+    {
+    }
+
+    std::string file_;
+  };
+
+  /// Build a big-endian PCapNG file of ethernet/IPv4/UDP packets.
+  class PCapNGWriter : public PCapWriter
+  {
+  public:
+    PCapNGWriter()
+      : PCapWriter(0)
+    {
+      std::string body;
+      appendBig(body, 0x1A2B3C4D, 4);     // byte order magic
+      appendBig(body, 1, 2);              // version 1.0
+      appendBig(body, 0, 2);
+      appendBig(body, 0xFFFFFFFF, 4);     // section length unknown
+      appendBig(body, 0xFFFFFFFF, 4);
+      addBlock(0x0A0D0D0A, body);
+    }
+
+    /// @param resolution is the if_tsresol option value.  Zero means no option (microseconds)
+    void addInterface(uchar resolution)
+    {
+      std::string body;
+      appendBig(body, 1, 2);              // ethernet
+      appendBig(body, 0, 2);
+      appendBig(body, 65535, 4);          // snaplen
+      if(resolution != 0)
+      {
+        appendBig(body, 9, 2);            // if_tsresol
+        appendBig(body, 1, 2);
+        body += char(resolution);
+        body.append(3, '\0');
+        appendBig(body, 0, 4);            // opt_endofopt
+      }
+      addBlock(1, body);
+    }
+
+    void addStatistics()
+    {
+      std::string body;
+      appendBig(body, 0, 4);              // interface
+      appendBig(body, 0, 4);              // timestamp
+      appendBig(body, 0, 4);
+      addBlock(5, body);
+    }
+
+    void addPacket(
+      uint32 interfaceId,
+      uint64 units,
+      uint32 destination,
+      uint16 port,
+      const std::string & payload)
+    {
+      std::string packet = frame(destination, port, payload);
+      std::string body;
+      appendBig(body, interfaceId, 4);
+      appendBig(body, uint32(units >> 32), 4);
+      appendBig(body, uint32(units), 4);
+      appendBig(body, uint32(packet.size()), 4);
+      appendBig(body, uint32(packet.size()), 4);
+      body += packet;
+      body.append((4 - packet.size() % 4) % 4, '\0');
+      addBlock(6, body);
+    }
+
+  private:
+    void addBlock(uint32 type, const std::string & body)
+    {
+      uint32 totalLength = uint32(12 + body.size());
+      appendBig(file_, type, 4);
+      appendBig(file_, totalLength, 4);
+      file_ += body;
+      appendBig(file_, totalLength, 4);
+    }
+  };
+
+  std::string message(uint32 value)
+  {
+    // pmap, template id 1, value
+    std::string result;
+    result += char(0xC0);
+    result += char(0x81);
+    result += char(0x80 | value);
+    return result;
+  }
+
+  const char pcapFile[] = "testPCapReader.pcap";
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderClassic)
+{
+  PCapWriter writer;
+  writer.addPacket(1000, 1, 0xEFFF0001, 30001, message(1));
+  writer.addPacket(1000, 2, 0xEFFF0002, 30002, message(2));
+  writer.addPacket(1001, 999999, 0xEFFF0001, 30001, message(3));
+  writer.write(pcapFile);
+
+  Communication::PCapReader reader;
+  reader.set32bit(true);
+  BOOST_REQUIRE(reader.open(pcapFile));
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(size, 3u);
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  BOOST_CHECK_EQUAL(reader.destinationAddress(), 0xEFFF0001u);
+  BOOST_CHECK_EQUAL(reader.destinationPort(), 30001u);
+  BOOST_CHECK_EQUAL(reader.timestamp(), 1000000001000ULL);
+
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x82);
+  BOOST_CHECK_EQUAL(reader.destinationAddress(), 0xEFFF0002u);
+  BOOST_CHECK_EQUAL(reader.destinationPort(), 30002u);
+
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x83);
+  BOOST_CHECK_EQUAL(reader.timestamp(), 1001999999000ULL);
+
+  BOOST_CHECK(!reader.read(buffer, size));
+
+  // pointers stay valid until the file is closed; rewind starts over.
+  BOOST_REQUIRE(reader.rewind());
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  reader.close();
+  BOOST_CHECK(!reader.good());
+  std::remove(pcapFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapFileReceiver)
+{
+  PCapWriter writer;
+  for(uint32 value = 1; value <= 5; ++value)
+  {
+    writer.addPacket(2000 + value, 0, 0xEFFF0001, 30001, message(value));
+  }
+  writer.write(pcapFile);
+
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter counter;
+  Codecs::GenericMessageBuilder builder(counter);
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  Codecs::MessagePerPacketAssembler assembler(
+    registry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+
+  {
+    Communication::PCapFileReceiver receiver(pcapFile, 32);
+    // smaller buffers than the packets: the receiver points into the file rather than copying.
+    BOOST_REQUIRE(receiver.start(assembler, 1, 2));
+    receiver.run();
+  }
+  BOOST_CHECK_EQUAL(counter.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(counter.messageCount_, 5u);
+  for(uint32 value = 1; value <= 5; ++value)
+  {
+    BOOST_CHECK_EQUAL(counter.values_[value - 1], value);
+  }
+  std::remove(pcapFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderNanosecond)
+{
+  PCapWriter writer(true);
+  writer.addPacket(1000, 123456789, 0xEFFF0001, 30001, message(1));
+  writer.write(pcapFile);
+
+  Communication::PCapReader reader;
+  reader.set32bit(true);
+  BOOST_REQUIRE(reader.open(pcapFile));
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  BOOST_CHECK_EQUAL(reader.timestamp(), 1000123456789ULL);
+  BOOST_CHECK(!reader.read(buffer, size));
+  reader.close();
+  std::remove(pcapFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderNG)
+{
+  PCapNGWriter writer;
+  writer.addInterface(0);        // microseconds
+  writer.addInterface(9);        // nanoseconds
+  writer.addPacket(0, 1000000001ULL, 0xEFFF0001, 30001, message(1));
+  writer.addStatistics();
+  writer.addPacket(1, 1000123456789ULL, 0xEFFF0002, 30002, message(2) + "x");
+  writer.write(pcapFile);
+
+  Communication::PCapReader reader;
+  BOOST_REQUIRE(reader.open(pcapFile));
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(size, 3u);
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  BOOST_CHECK_EQUAL(reader.destinationAddress(), 0xEFFF0001u);
+  BOOST_CHECK_EQUAL(reader.timestamp(), 1000000001000ULL);
+
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(size, 4u);
+  BOOST_CHECK_EQUAL(buffer[2], 0x82);
+  BOOST_CHECK_EQUAL(reader.destinationPort(), 30002u);
+  BOOST_CHECK_EQUAL(reader.timestamp(), 1000123456789ULL);
+
+  BOOST_CHECK(!reader.read(buffer, size));
+  BOOST_REQUIRE(reader.rewind());
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  reader.close();
+  std::remove(pcapFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderFlowFilter)
+{
+  PCapWriter writer;
+  writer.addPacket(1000, 1, 0xEFFF0001, 30001, message(1));
+  writer.addPacket(1000, 2, 0xEFFF0002, 30002, message(2));
+  writer.addPacket(1000, 3, 0xEFFF0003, 30003, message(3));
+  writer.addPacket(1000, 4, 0xEFFF0001, 30001, message(4));
+  writer.write(pcapFile);
+
+  Communication::PCapReader reader;
+  reader.set32bit(true);
+  reader.addFlow("239.255.0.1", 30001);
+  reader.addFlow(0, 30003);
+  BOOST_CHECK_THROW(reader.addFlow("239.255.0", 30001), std::invalid_argument);
+  BOOST_CHECK_THROW(reader.addFlow("239.256.0.1", 30001), std::invalid_argument);
+  BOOST_REQUIRE(reader.open(pcapFile));
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x81);
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x83);
+  BOOST_REQUIRE(reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(buffer[2], 0x84);
+  BOOST_CHECK(!reader.read(buffer, size));
+  BOOST_CHECK_EQUAL(reader.filteredPackets(), 1u);
+
+  reader.clearFlows();
+  BOOST_REQUIRE(reader.rewind());
+  size_t count = 0;
+  while(reader.read(buffer, size))
+  {
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 4u);
+  reader.close();
+  std::remove(pcapFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapFlowDecoder)
+{
+  // three flows with interleaved timestamps.  The value is the order of capture.
+  PCapWriter writer;
+  writer.addPacket(3000, 1, 0xEFFF0001, 30001, message(1));
+  writer.addPacket(3000, 2, 0xEFFF0002, 30002, message(2));
+  writer.addPacket(3000, 3, 0xEFFF0002, 30002, message(3));
+  writer.addPacket(3000, 4, 0xEFFF0003, 30003, message(4));
+  writer.addPacket(3000, 5, 0xEFFF0001, 30001, message(5));
+  writer.addPacket(3000, 6, 0xEFFF0003, 30003, message(6));
+  writer.addPacket(3000, 7, 0xEFFF0002, 30002, message(7));
+  writer.write(pcapFile);
+
+  Application::PCapFlowDecoder decoder(Tests::createValueRegistry());
+  decoder.reader().set32bit(true);
+  BOOST_REQUIRE_EQUAL(decoder.open(pcapFile), 3u);
+  BOOST_CHECK_EQUAL(decoder.flow(0).name_, "239.255.0.1:30001");
+  BOOST_CHECK_EQUAL(decoder.flow(1).packets_.size(), 3u);
+  BOOST_CHECK_EQUAL(decoder.flow(2).packets_[0].timestamp_, 3000000004000ULL);
+
+  // each flow to its own builder
+  Tests::ValueCounter counters[3];
+  Codecs::GenericMessageBuilder builder0(counters[0]);
+  Codecs::GenericMessageBuilder builder1(counters[1]);
+  Codecs::GenericMessageBuilder builder2(counters[2]);
+  std::vector<Messages::ValueMessageBuilder *> builders;
+  builders.push_back(&builder0);
+  builders.push_back(&builder1);
+  builders.push_back(&builder2);
+  decoder.decode(builders, 3);
+  BOOST_REQUIRE_EQUAL(counters[1].values_.size(), 3u);
+  BOOST_CHECK_EQUAL(counters[1].values_[0], 2u);
+  BOOST_CHECK_EQUAL(counters[1].values_[1], 3u);
+  BOOST_CHECK_EQUAL(counters[1].values_[2], 7u);
+  BOOST_CHECK_EQUAL(counters[0].messageCount_ + counters[2].messageCount_, 4u);
+
+  // merged back into capture order.
+  for(size_t threadCount = 1; threadCount <= 4; ++threadCount)
+  {
+    Tests::ValueCounter merged;
+    BOOST_CHECK_EQUAL(decoder.decodeMerged(merged, threadCount), 7u);
+    BOOST_CHECK_EQUAL(merged.errorCount_, 0u);
+    BOOST_REQUIRE_EQUAL(merged.values_.size(), 7u);
+    for(uint32 value = 1; value <= 7; ++value)
+    {
+      BOOST_CHECK_EQUAL(merged.values_[value - 1], value);
+    }
+  }
+  decoder.reader().close();
+  std::remove(pcapFile);
+}
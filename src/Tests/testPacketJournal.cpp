@@ -0,0 +1,127 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/PacketJournal.h>
+#include <Communication/PCapReader.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char journalFile[] = "testPacketJournal.pcap";
+
+  std::string packet(size_t number, size_t size)
+  {
+    std::string result;
+    for(size_t nByte = 0; nByte < size; ++nByte)
+    {
+      result += char(number + nByte);
+    }
+    return result;
+  }
+
+  // sizes chosen so records straddle buffer boundaries
+  size_t packetSize(size_t number)
+  {
+    return 1 + (number * 37) % 1400;
+  }
+
+  const uint64 baseTime = 1255900000ULL * 1000000000ULL + 123456789ULL;
+}
+
+BOOST_AUTO_TEST_CASE(testPacketJournal)
+{
+  const size_t packetCount = 500;
+  {
+    // small buffers so the writer thread does most of the work.
+    Communication::PacketJournal journal(4096, 4, Communication::PacketJournal::BACKPRESSURE);
+    BOOST_CHECK_EQUAL(journal.bufferSize(), 4096u);
+    journal.setDestination("239.1.2.3", 30001);
+    BOOST_REQUIRE(journal.open(journalFile, true));
+    for(size_t nPacket = 0; nPacket < packetCount; ++nPacket)
+    {
+      std::string data = packet(nPacket, packetSize(nPacket));
+      BOOST_CHECK(journal.record(
+        reinterpret_cast<const unsigned char *>(data.data()), data.size(), baseTime + nPacket * 1000));
+    }
+    journal.close();
+    BOOST_CHECK_EQUAL(journal.packetsRecorded(), packetCount);
+    BOOST_CHECK_EQUAL(journal.packetsDropped(), 0u);
+    BOOST_CHECK(journal.buffersWritten() > 10u);
+    BOOST_CHECK_EQUAL(journal.writeErrors(), 0u);
+  }
+
+  Communication::PCapReader reader;
+  reader.set32bit(true);
+  reader.addFlow("239.1.2.3", 30001);
+  BOOST_REQUIRE(reader.open(journalFile));
+  size_t nPacket = 0;
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  while(reader.read(buffer, size))
+  {
+    BOOST_REQUIRE(nPacket < packetCount);
+    BOOST_CHECK_EQUAL(size, packetSize(nPacket));
+    BOOST_CHECK(std::string(reinterpret_cast<const char *>(buffer), size) == packet(nPacket, packetSize(nPacket)));
+    BOOST_CHECK_EQUAL(reader.timestamp(), baseTime + nPacket * 1000);
+    ++nPacket;
+  }
+  BOOST_CHECK_EQUAL(nPacket, packetCount);
+  BOOST_CHECK_EQUAL(reader.filteredPackets(), 0u);
+  reader.close();
+  std::remove(journalFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPacketJournalLargePacket)
+{
+  // larger than a UDP datagram, i.e. from a TCPReceiver
+  std::string data = packet(7, 100000);
+  {
+    Communication::PacketJournal journal(64 * 1024, 4);
+    BOOST_REQUIRE(journal.open(journalFile));
+    BOOST_CHECK(journal.record(reinterpret_cast<const unsigned char *>(data.data()), data.size(), baseTime));
+    journal.close();
+  }
+  Communication::PCapReader reader;
+  reader.set32bit(true);
+  BOOST_REQUIRE(reader.open(journalFile));
+  std::string joined;
+  size_t records = 0;
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  while(reader.read(buffer, size))
+  {
+    joined.append(reinterpret_cast<const char *>(buffer), size);
+    ++records;
+  }
+  BOOST_CHECK_EQUAL(records, 2u);
+  BOOST_CHECK(joined == data);
+  reader.close();
+  std::remove(journalFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPacketJournalDrop)
+{
+  Communication::PacketJournal journal(4096, 2, Communication::PacketJournal::DROP);
+  std::string data = packet(1, 100);
+  const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data.data());
+  // not open yet
+  BOOST_CHECK(!journal.record(bytes, data.size(), 0));
+  BOOST_CHECK_EQUAL(journal.packetsDropped(), 1u);
+
+  BOOST_REQUIRE(journal.open(journalFile));
+  BOOST_CHECK(journal.record(bytes, data.size(), 0));
+  // can never fit in the ring
+  std::string huge = packet(2, 5000);
+  BOOST_CHECK(!journal.record(reinterpret_cast<const unsigned char *>(huge.data()), huge.size(), 0));
+  BOOST_CHECK_EQUAL(journal.packetsDropped(), 2u);
+  journal.close();
+  BOOST_CHECK_EQUAL(journal.packetsRecorded(), 1u);
+  BOOST_CHECK_THROW(Communication::PacketJournal(4096, 1), std::invalid_argument);
+  std::remove(journalFile);
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/PacketSequencer.h>
+#include <Codecs/FixedSizeHeaderAnalyzer.h>
+#include <Codecs/FastEncodedHeaderAnalyzer.h>
+#include <Codecs/DataSourceString.h>
+#include <Communication/LinkedBuffer.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  Communication::LinkedBuffer buffers[20];
+}
+
+BOOST_AUTO_TEST_CASE(testPacketSequencerInOrder)
+{
+  Codecs::PacketSequencer sequencer(4, 1000);
+  size_t missing = 0;
+  for(uint32 seq = 100; seq < 105; ++seq)
+  {
+    BOOST_CHECK(sequencer.accept(seq, &buffers[seq - 100], missing));
+    BOOST_CHECK_EQUAL(missing, 0u);
+    BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[seq - 100]);
+    BOOST_CHECK(sequencer.nextReady() == 0);
+  }
+  // duplicate of a packet already delivered
+  BOOST_CHECK(!sequencer.accept(102, &buffers[10], missing));
+  BOOST_CHECK_EQUAL(sequencer.duplicates(), 1u);
+  BOOST_CHECK_EQUAL(sequencer.gaps(), 0u);
+  BOOST_CHECK_EQUAL(sequencer.reordered(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testPacketSequencerReorder)
+{
+  Codecs::PacketSequencer sequencer(4, 1000);
+  size_t missing = 0;
+  BOOST_CHECK(sequencer.accept(1, &buffers[1], missing));
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[1]);
+  BOOST_CHECK(sequencer.nextReady() == 0);
+
+  // 3 and 4 arrive before 2
+  BOOST_CHECK(sequencer.accept(3, &buffers[3], missing));
+  BOOST_CHECK(sequencer.nextReady() == 0);
+  BOOST_CHECK(sequencer.accept(4, &buffers[4], missing));
+  BOOST_CHECK(sequencer.nextReady() == 0);
+  // duplicate of a held packet
+  BOOST_CHECK(!sequencer.accept(4, &buffers[14], missing));
+  BOOST_CHECK_EQUAL(sequencer.held(), 2u);
+  BOOST_CHECK_EQUAL(sequencer.expire(), 0u);
+
+  BOOST_CHECK(sequencer.accept(2, &buffers[2], missing));
+  BOOST_CHECK_EQUAL(missing, 0u);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[2]);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[3]);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[4]);
+  BOOST_CHECK(sequencer.nextReady() == 0);
+
+  BOOST_CHECK_EQUAL(sequencer.reordered(), 1u);
+  BOOST_CHECK_EQUAL(sequencer.duplicates(), 1u);
+  BOOST_CHECK_EQUAL(sequencer.gaps(), 0u);
+  BOOST_CHECK_EQUAL(sequencer.held(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testPacketSequencerGaps)
+{
+  Codecs::PacketSequencer sequencer(4, 0);
+  size_t missing = 0;
+  BOOST_CHECK(sequencer.accept(1, &buffers[1], missing));
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[1]);
+
+  // 2 is lost: timeout (zero) expires on the next check.
+  BOOST_CHECK(sequencer.accept(3, &buffers[3], missing));
+  BOOST_CHECK(sequencer.nextReady() == 0);
+  BOOST_CHECK_EQUAL(sequencer.expire(), 1u);
+  BOOST_CHECK_EQUAL(sequencer.lastGapStart(), 2u);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[3]);
+  BOOST_CHECK(sequencer.nextReady() == 0);
+
+  // 4 is lost and 5 held; 10 does not fit in the window so the gap is declared immediately.
+  BOOST_CHECK(sequencer.accept(5, &buffers[5], missing));
+  BOOST_CHECK(sequencer.accept(10, &buffers[10], missing));
+  BOOST_CHECK_EQUAL(missing, 5u); // 4, 6, 7, 8, 9
+  BOOST_CHECK_EQUAL(sequencer.lastGapStart(), 4u);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[5]);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[10]);
+  BOOST_CHECK(sequencer.nextReady() == 0);
+  BOOST_CHECK_EQUAL(sequencer.expected(), 11u);
+
+  // late arrival of a lost packet is discarded
+  BOOST_CHECK(!sequencer.accept(7, &buffers[7], missing));
+
+  // flush on shutdown releases everything held.
+  BOOST_CHECK(sequencer.accept(12, &buffers[12], missing));
+  BOOST_CHECK_EQUAL(sequencer.flush(), 1u);
+  BOOST_CHECK_EQUAL(sequencer.nextReady(), &buffers[12]);
+  BOOST_CHECK(sequencer.nextReady() == 0);
+
+  BOOST_CHECK_EQUAL(sequencer.gaps(), 3u);
+  BOOST_CHECK_EQUAL(sequencer.lostPackets(), 7u);
+  BOOST_CHECK_EQUAL(sequencer.duplicates(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(testHeaderAnalyzerSequenceNumbers)
+{
+  size_t blockSize = 0;
+  bool skip = false;
+  uint32 sequence = 0;
+
+  // fixed header: 2 byte prefix, 4 byte big-endian sequence number inside the suffix
+  Codecs::FixedSizeHeaderAnalyzer fixedAnalyzer(0, true, 2, 4);
+  BOOST_CHECK(!fixedAnalyzer.getSequenceNumber(sequence));
+  fixedAnalyzer.setSequenceNumberLocation(2, 4);
+  Codecs::DataSourceString fixedSource(std::string("\xAA\xBB\x01\x02\x03\x04", 6));
+  BOOST_CHECK(fixedAnalyzer.analyzeHeader(fixedSource, blockSize, skip));
+  BOOST_CHECK(fixedAnalyzer.getSequenceNumber(sequence));
+  BOOST_CHECK_EQUAL(sequence, 0x01020304u);
+
+  // FAST header: one prefix field, then the sequence number (field 1)
+  Codecs::FastEncodedHeaderAnalyzer fastAnalyzer(1, 1, false);
+  fastAnalyzer.setSequenceNumberField(1);
+  // prefix = 5, sequence = 0x81 (two bytes: 0x01 0x81)
+  Codecs::DataSourceString fastSource(std::string("\x85\x01\x81", 3));
+  BOOST_CHECK(fastAnalyzer.analyzeHeader(fastSource, blockSize, skip));
+  BOOST_CHECK(fastAnalyzer.getSequenceNumber(sequence));
+  BOOST_CHECK_EQUAL(sequence, 0x81u);
+  BOOST_CHECK_THROW(fastAnalyzer.setSequenceNumberField(2), std::invalid_argument);
+}
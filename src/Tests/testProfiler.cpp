@@ -0,0 +1,101 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/Profiler.h>
+#include <Common/LatencyHistogram.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  void profileLoop(ProfileAccumulator * accumulator, size_t count)
+  {
+    for(size_t nLoop = 0; nLoop < count; ++nLoop)
+    {
+      ProfileInstance instance(*accumulator);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLatencyHistogram)
+{
+  Common::LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.percentile(0.5), 0u);
+  for(uint64 value = 1; value <= 10000; ++value)
+  {
+    histogram.record(value);
+  }
+  BOOST_CHECK_EQUAL(histogram.count(), 10000u);
+  BOOST_CHECK_EQUAL(histogram.minimum(), 1u);
+  BOOST_CHECK_EQUAL(histogram.maximum(), 10000u);
+  BOOST_CHECK_CLOSE(histogram.mean(), 5000.5, 0.001);
+  // buckets are within 1/16 of the value
+  BOOST_CHECK_CLOSE(double(histogram.percentile(0.5)), 5000.0, 6.25);
+  BOOST_CHECK_CLOSE(double(histogram.percentile(0.99)), 9900.0, 6.25);
+  BOOST_CHECK(histogram.percentile(0.999) >= 9990u);
+  BOOST_CHECK_EQUAL(histogram.percentile(1.0), 10000u);
+
+  // every value falls inside the bucket it is counted in.
+  for(uint64 value = 1; value < (uint64(1) << 62); value = value * 3 + 1)
+  {
+    size_t index = Common::LatencyHistogram::bucketIndex(value);
+    BOOST_CHECK(value <= Common::LatencyHistogram::bucketLimit(index));
+    BOOST_CHECK(value > Common::LatencyHistogram::bucketLimit(index - 1));
+  }
+  BOOST_CHECK(Common::LatencyHistogram::bucketIndex(~uint64(0)) < Common::LatencyHistogram::bucketCount);
+
+  Common::LatencyHistogram other;
+  other.record(1000000);
+  histogram.merge(other);
+  BOOST_CHECK_EQUAL(histogram.count(), 10001u);
+  BOOST_CHECK_EQUAL(histogram.maximum(), 1000000u);
+}
+
+BOOST_AUTO_TEST_CASE(testProfilerThreads)
+{
+  static ProfileAccumulator accumulator("testProfilerThreads", __FILE__, __LINE__);
+  const size_t threadCount = 4;
+  const size_t loopCount = 10000;
+  boost::thread_group threads;
+  for(size_t nThread = 0; nThread < threadCount; ++nThread)
+  {
+    threads.create_thread(boost::bind(profileLoop, &accumulator, loopCount));
+  }
+  threads.join_all();
+  {
+    // recursion is tracked per thread
+    ProfileInstance outer(accumulator);
+    ProfileInstance inner(accumulator);
+  }
+
+  ProfileCounters counters;
+  accumulator.merge(counters);
+  BOOST_CHECK_EQUAL(counters.entries_, threadCount * loopCount + 2);
+  BOOST_CHECK_EQUAL(counters.exits_, threadCount * loopCount + 2);
+  BOOST_CHECK_EQUAL(counters.recursions_, 1u);
+  BOOST_CHECK_EQUAL(counters.histogram_.count(), threadCount * loopCount + 1);
+
+  std::stringstream out;
+  ProfileAccumulator::write(out);
+  BOOST_CHECK(out.str().find("p99.9") != std::string::npos);
+  BOOST_CHECK(out.str().find("testProfilerThreads") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testProfilerCalibration)
+{
+  static ProfileAccumulator accumulator("testProfilerCalibration", __FILE__, __LINE__);
+  {
+    ProfileInstance instance(accumulator);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+  }
+  ProfileCounters counters;
+  accumulator.merge(counters);
+  double nanoseconds = counters.sum_ * ProfileAccumulator::nanosecondsPerTick();
+  BOOST_CHECK(nanoseconds >= 19.0e6);
+  BOOST_CHECK(nanoseconds < 1.0e9);
+}
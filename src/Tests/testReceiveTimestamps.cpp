@@ -0,0 +1,98 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Communication/MulticastReceiver.h>
+#include <Communication/LinkedBuffer.h>
+#include <Common/Timestamp.h>
+#include <Tests/ValueTemplate.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Remember the times reported for each packet.
+  class TimedBuilder : public Codecs::GenericMessageBuilder
+  {
+  public:
+    TimedBuilder(Codecs::MessageConsumer & consumer)
+      : Codecs::GenericMessageBuilder(consumer)
+    {
+    }
+
+    virtual void setReceiveTimes(uint64 receiveTime, uint64 decodeStartTime)
+    {
+      receiveTimes_.push_back(receiveTime);
+      decodeStartTimes_.push_back(decodeStartTime);
+    }
+
+    std::vector<uint64> receiveTimes_;
+    std::vector<uint64> decodeStartTimes_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(testLinkedBufferReceiveTime)
+{
+  Communication::LinkedBuffer buffer(10);
+  BOOST_CHECK_EQUAL(buffer.receiveTime(), 0u);
+  buffer.setReceiveTime(1234567890123456789ULL);
+  BOOST_CHECK_EQUAL(buffer.receiveTime(), 1234567890123456789ULL);
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastReceiveTimestamps)
+{
+  Codecs::TemplateRegistryPtr registry = Tests::createValueRegistry();
+  Tests::ValueCounter counter;
+  TimedBuilder builder(counter);
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  Codecs::MessagePerPacketAssembler assembler(
+    registry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+
+  boost::asio::io_service ioService;
+  Communication::MulticastReceiver receiver(ioService, "239.255.0.30", "127.0.0.1", 30112);
+  receiver.start(assembler, 1400, 8);
+
+  const size_t packetCount = 5;
+  uint64 beforeSend = Common::wallClockNanoseconds();
+  boost::asio::ip::udp::socket socket(ioService, boost::asio::ip::udp::v4());
+  socket.set_option(boost::asio::ip::multicast::outbound_interface(
+    boost::asio::ip::address_v4::loopback()));
+  socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  boost::asio::ip::udp::endpoint destination(
+    boost::asio::ip::address::from_string("239.255.0.30"), 30112);
+  for(size_t nPacket = 0; nPacket < packetCount; ++nPacket)
+  {
+    const unsigned char message[] = {0xC0, 0x81, (unsigned char)(0x80 | nPacket)};
+    socket.send_to(boost::asio::buffer(message, sizeof(message)), destination);
+  }
+
+  boost::posix_time::ptime deadline =
+    boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(5);
+  while(counter.messageCount_ < packetCount && boost::posix_time::microsec_clock::universal_time() < deadline)
+  {
+    if(receiver.poll() == 0)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+  }
+  uint64 afterDecode = Common::wallClockNanoseconds();
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(counter.messageCount_, packetCount);
+  BOOST_CHECK_EQUAL(counter.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(builder.receiveTimes_.size(), packetCount);
+  for(size_t nPacket = 0; nPacket < packetCount; ++nPacket)
+  {
+    BOOST_CHECK(builder.receiveTimes_[nPacket] >= beforeSend);
+    BOOST_CHECK(builder.receiveTimes_[nPacket] <= builder.decodeStartTimes_[nPacket]);
+    BOOST_CHECK(builder.decodeStartTimes_[nPacket] <= afterDecode);
+  }
+}
@@ -0,0 +1,240 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/StatisticsPublisher.h>
+#include <Common/Timestamp.h>
+#include <Communication/LinkedBuffer.h>
+#include <Communication/BufferReceiver.h>
+#include <Codecs/StreamingAssembler.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Tests/ValueTemplate.h>
+#include <boost/bind.hpp>
+
+using namespace QuickFAST;
+
+namespace
+{
+  std::string segmentName(const char * test)
+  {
+    // unique per process so concurrent test runs don't collide.
+    return std::string("QuickFASTTest.") + test + "."
+      + boost::lexical_cast<std::string>(Common::wallClockNanoseconds());
+  }
+
+  // Publish the registry over and over while the reader checks every copy.
+  void publishRepeatedly(
+    Common::StatisticsSegment & segment,
+    Common::StatisticsRegistry & registry,
+    Common::Statistic & first,
+    Common::Statistic & second,
+    size_t count)
+  {
+    for(size_t nPublish = 0; nPublish < count; ++nPublish)
+    {
+      ++first;
+      ++second;
+      segment.publish(registry);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testStatisticsRegistry)
+{
+  // the values must be 64 bytes apart to stay out of each other's cache lines.
+  BOOST_CHECK_EQUAL(sizeof(Common::Statistic), 64u);
+
+  Common::StatisticsRegistry registry;
+  Common::Statistic packets;
+  Common::Statistic depth(Common::Statistic::GAUGE);
+  Common::Statistic largest(Common::Statistic::GAUGE);
+  registry.add(packets, "test.packets");
+  registry.add(depth, "test.queueDepth");
+  registry.add(largest, std::string(100, 'x'));
+  BOOST_CHECK_EQUAL(registry.size(), 3u);
+  BOOST_CHECK_EQUAL(std::string(largest.name()).size(), Common::Statistic::nameSize - 1);
+
+  ++packets;
+  packets += 4;
+  depth.set(7);
+  depth.set(3);
+  largest.raise(1400);
+  largest.raise(20);
+
+  std::vector<Common::Statistic> copies;
+  registry.copy(copies);
+  BOOST_REQUIRE_EQUAL(copies.size(), 3u);
+  BOOST_CHECK_EQUAL(std::string(copies[0].name()), "test.packets");
+  BOOST_CHECK_EQUAL(copies[0].kind(), Common::Statistic::COUNTER);
+  BOOST_CHECK_EQUAL(copies[0].value(), 5u);
+  BOOST_CHECK_EQUAL(std::string(copies[1].name()), "test.queueDepth");
+  BOOST_CHECK_EQUAL(copies[1].kind(), Common::Statistic::GAUGE);
+  BOOST_CHECK_EQUAL(copies[1].value(), 3u);
+  BOOST_CHECK_EQUAL(copies[2].value(), 1400u);
+
+  Common::Statistic limited[2];
+  BOOST_CHECK_EQUAL(registry.copy(limited, 2), 2u);
+
+  registry.remove(depth);
+  registry.remove(depth);
+  registry.copy(copies);
+  BOOST_REQUIRE_EQUAL(copies.size(), 2u);
+  BOOST_CHECK_EQUAL(std::string(copies[1].name()), std::string(Common::Statistic::nameSize - 1, 'x'));
+}
+
+BOOST_AUTO_TEST_CASE(testStatisticsSegment)
+{
+  std::string name = segmentName("segment");
+  Common::StatisticsRegistry registry;
+  Common::Statistic packets;
+  Common::Statistic bytes;
+  registry.add(packets, "packets");
+  registry.add(bytes, "bytes");
+
+  Common::StatisticsSegment writer;
+  BOOST_REQUIRE(writer.create(name, 16));
+  BOOST_CHECK_EQUAL(writer.capacity(), 16u);
+
+  Common::StatisticsSegment reader;
+  BOOST_REQUIRE(reader.open(name));
+  BOOST_CHECK_EQUAL(reader.capacity(), 16u);
+  std::vector<Common::Statistic> statistics;
+  uint64 publishTime = 0;
+  // nothing published yet.
+  BOOST_CHECK(!reader.read(statistics, publishTime));
+  BOOST_CHECK_THROW(reader.publish(registry), std::logic_error);
+
+  ++packets;
+  bytes += 1400;
+  BOOST_CHECK_EQUAL(writer.publish(registry), 2u);
+  BOOST_REQUIRE(reader.read(statistics, publishTime));
+  BOOST_CHECK(publishTime != 0);
+  BOOST_REQUIRE_EQUAL(statistics.size(), 2u);
+  BOOST_CHECK_EQUAL(std::string(statistics[0].name()), "packets");
+  BOOST_CHECK_EQUAL(statistics[0].value(), 1u);
+  BOOST_CHECK_EQUAL(statistics[1].value(), 1400u);
+
+  // Every copy the reader accepts must come from a single publication.
+  const size_t publishCount = 20000;
+  boost::thread publisher(boost::bind(
+    &publishRepeatedly, boost::ref(writer), boost::ref(registry),
+    boost::ref(packets), boost::ref(bytes), publishCount));
+  size_t inconsistent = 0;
+  size_t reads = 0;
+  uint64 last = 0;
+  while(last < publishCount + 1)
+  {
+    if(reader.read(statistics, publishTime))
+    {
+      ++reads;
+      BOOST_REQUIRE_EQUAL(statistics.size(), 2u);
+      uint64 packetCount = statistics[0].value();
+      if(statistics[1].value() != packetCount + 1399)
+      {
+        ++inconsistent;
+      }
+      last = packetCount;
+    }
+  }
+  publisher.join();
+  BOOST_CHECK_EQUAL(inconsistent, 0u);
+  BOOST_CHECK(reads > 0);
+
+  writer.close();
+  Common::StatisticsSegment late;
+  BOOST_CHECK(!late.open(name));
+}
+
+BOOST_AUTO_TEST_CASE(testStatisticsPublisher)
+{
+  std::string name = segmentName("publisher");
+  Common::StatisticsRegistry registry;
+  Common::Statistic messages;
+  registry.add(messages, "messages");
+
+  Common::StatisticsPublisher publisher(registry);
+  publisher.start(name, 4, 10);
+  // start() publishes immediately.
+  Common::StatisticsSegment reader;
+  BOOST_REQUIRE(reader.open(name));
+  std::vector<Common::Statistic> statistics;
+  uint64 firstTime = 0;
+  BOOST_REQUIRE(reader.read(statistics, firstTime));
+  BOOST_REQUIRE_EQUAL(statistics.size(), 1u);
+  BOOST_CHECK_EQUAL(statistics[0].value(), 0u);
+
+  messages += 42;
+  uint64 publishTime = firstTime;
+  for(size_t nTry = 0; nTry < 500 && (publishTime == firstTime || statistics[0].value() != 42); ++nTry)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    BOOST_REQUIRE(reader.read(statistics, publishTime));
+  }
+  BOOST_CHECK_EQUAL(statistics[0].value(), 42u);
+  BOOST_CHECK(publisher.publications() > 1);
+
+  publisher.stop();
+  Common::StatisticsSegment late;
+  BOOST_CHECK(!late.open(name));
+}
+
+BOOST_AUTO_TEST_CASE(testBufferQueueSize)
+{
+  Communication::LinkedBuffer buffers[4];
+  Communication::BufferQueue queue;
+  BOOST_CHECK_EQUAL(queue.size(), 0u);
+  queue.push(&buffers[0]);
+  queue.push(&buffers[1]);
+  BOOST_CHECK_EQUAL(queue.size(), 2u);
+
+  Communication::BufferQueue other;
+  buffers[2].link(&buffers[3]);
+  other.pushList(&buffers[2]);
+  BOOST_CHECK_EQUAL(other.size(), 2u);
+  queue.push(other);
+  BOOST_CHECK_EQUAL(queue.size(), 4u);
+  BOOST_CHECK_EQUAL(other.size(), 0u);
+
+  BOOST_CHECK(queue.pop() == &buffers[0]);
+  BOOST_CHECK_EQUAL(queue.size(), 3u);
+  queue.popList();
+  BOOST_CHECK_EQUAL(queue.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testAssemblerStatistics)
+{
+  Codecs::TemplateRegistryPtr templates = Tests::createValueRegistry(7);
+  Tests::ValueCounter collector;
+  Codecs::GenericMessageBuilder builder(collector);
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  Codecs::StreamingAssembler assembler(templates, headerAnalyzer, builder);
+  Common::StatisticsRegistry registry;
+  assembler.setStatistics(&registry);
+  // every template is registered before decoding starts.
+  std::vector<Common::Statistic> copies;
+  registry.copy(copies);
+  BOOST_REQUIRE_EQUAL(copies.size(), 3u);
+  BOOST_CHECK_EQUAL(std::string(copies[2].name()), "assembler.template.7");
+
+  // pmap, template id, value; then pmap, value
+  std::string data("\xC0\x87\x81\x80\x82\x80\x83");
+  {
+    Communication::BufferReceiver receiver;
+    BOOST_REQUIRE(receiver.start(assembler, 100, 1));
+    receiver.receiveBuffer(reinterpret_cast<const unsigned char *>(data.data()), data.size());
+  }
+  BOOST_CHECK_EQUAL(collector.messageCount_, 3u);
+  registry.copy(copies);
+  BOOST_REQUIRE_EQUAL(copies.size(), 3u);
+  BOOST_CHECK_EQUAL(std::string(copies[0].name()), "assembler.messagesDecoded");
+  BOOST_CHECK_EQUAL(copies[0].value(), 3u);
+  BOOST_CHECK_EQUAL(copies[2].value(), 3u);
+
+  assembler.setStatistics(0);
+  BOOST_CHECK_EQUAL(registry.size(), 0u);
+}
@@ -0,0 +1,260 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/TemplateCache.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/SegmentBody.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt32.h>
+#include <Codecs/FieldInstructionUInt64.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUtf8.h>
+#include <Codecs/FieldInstructionByteVector.h>
+#include <Codecs/FieldInstructionGroup.h>
+#include <Codecs/FieldInstructionSequence.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldOpConstant.h>
+#include <Codecs/FieldOpDefault.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/FieldOpTail.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Messages/Message.h>
+#include <Messages/Field.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  Codecs::FieldOpPtr op(Codecs::FieldOp * fieldOp, const char * value = 0)
+  {
+    Codecs::FieldOpPtr result(fieldOp);
+    if(value != 0)
+    {
+      result->setValue(value);
+    }
+    return result;
+  }
+
+  /// Builds the templates that would be parsed from a file that uses
+  /// every kind of field instruction.
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->setNamespace("test");
+
+    // <template name="Header" dictionary="template"> (no id: only for static references)
+    Codecs::TemplatePtr header(new Codecs::Template);
+    header->setTemplateName("Header");
+    header->setDictionaryName("template");
+    Codecs::FieldInstructionPtr seqNum(new Codecs::FieldInstructionUInt32("MsgSeqNum", ""));
+    seqNum->setId("34");
+    seqNum->setFieldOp(op(new Codecs::FieldOpIncrement));
+    header->addInstruction(seqNum);
+    registry->addTemplate(header);
+
+    // <template name="Quote" id="1" ns="test" reset="Y">
+    Codecs::TemplatePtr quote(new Codecs::Template);
+    quote->setTemplateName("Quote");
+    quote->setNamespace("test");
+    quote->setId(1);
+    quote->setReset(true);
+    quote->setApplicationType("QuoteType", "app");
+
+    Codecs::FieldInstructionPtr headerRef(new Codecs::FieldInstructionStaticTemplateRef("Header", ""));
+    quote->addInstruction(headerRef);
+
+    Codecs::FieldInstructionPtr symbol(new Codecs::FieldInstructionAscii("Symbol", "test"));
+    Codecs::FieldOpPtr symbolOp(op(new Codecs::FieldOpCopy));
+    symbolOp->setKey("sym");
+    symbolOp->setKeyNamespace("keys");
+    symbolOp->setDictionaryName("global");
+    symbol->setFieldOp(symbolOp);
+    quote->addInstruction(symbol);
+
+    Codecs::FieldInstructionPtr change(new Codecs::FieldInstructionInt32("Change", ""));
+    change->setPresence(false);
+    change->setIgnoreOverflow(true);
+    change->setFieldOp(op(new Codecs::FieldOpDelta));
+    quote->addInstruction(change);
+
+    Codecs::FieldInstructionPtr price(new Codecs::FieldInstructionDecimal("Price", ""));
+    price->setFieldOp(op(new Codecs::FieldOpDefault, "1.5"));
+    quote->addInstruction(price);
+
+    // <decimal name="Size" presence="optional"><exponent><constant value="2"/></exponent>
+    //   <mantissa><delta/></mantissa></decimal>
+    Codecs::FieldInstructionPtr size(new Codecs::FieldInstructionDecimal("Size", ""));
+    size->setPresence(false);
+    Codecs::FieldInstructionExponentPtr exponent(new Codecs::FieldInstructionExponent);
+    exponent->setFieldOp(op(new Codecs::FieldOpConstant, "2"));
+    size->setExponentInstruction(exponent);
+    Codecs::FieldInstructionMantissaPtr mantissa(new Codecs::FieldInstructionMantissa);
+    mantissa->setFieldOp(op(new Codecs::FieldOpDelta));
+    size->setMantissaInstruction(mantissa);
+    quote->addInstruction(size);
+
+    Codecs::FieldInstructionPtr text(new Codecs::FieldInstructionUtf8("Text", ""));
+    text->setFieldOp(op(new Codecs::FieldOpTail));
+    quote->addInstruction(text);
+
+    Codecs::FieldInstructionPtr data(new Codecs::FieldInstructionByteVector("Data", ""));
+    data->setPresence(false);
+    quote->addInstruction(data);
+
+    // <group name="Venue" presence="optional"><typeRef name="VenueType"/>...
+    Codecs::FieldInstructionPtr venue(new Codecs::FieldInstructionGroup("Venue", ""));
+    venue->setPresence(false);
+    Codecs::SegmentBodyPtr venueBody(new Codecs::SegmentBody);
+    venue->setSegmentBody(venueBody);
+    venueBody->setApplicationType("VenueType", "");
+    Codecs::FieldInstructionPtr venueId(new Codecs::FieldInstructionAscii("VenueId", ""));
+    venueId->setFieldOp(op(new Codecs::FieldOpConstant, "XNYS"));
+    venueBody->addInstruction(venueId);
+    quote->addInstruction(venue);
+
+    // <sequence name="Levels"><length name="NoLevels"><copy/></length>...
+    Codecs::FieldInstructionPtr levels(new Codecs::FieldInstructionSequence("Levels", ""));
+    Codecs::SegmentBodyPtr levelsBody(new Codecs::SegmentBody);
+    levels->setSegmentBody(levelsBody);
+    levelsBody->allowLengthField();
+    Codecs::FieldInstructionPtr noLevels(new Codecs::FieldInstructionLength("NoLevels", ""));
+    noLevels->setFieldOp(op(new Codecs::FieldOpCopy));
+    levelsBody->addLengthInstruction(noLevels);
+    Codecs::FieldInstructionPtr volume(new Codecs::FieldInstructionUInt64("Volume", ""));
+    Codecs::FieldOpPtr volumeOp(op(new Codecs::FieldOpIncrement, "100"));
+    volumeOp->setPMapBit(3);
+    volume->setFieldOp(volumeOp);
+    levelsBody->addInstruction(volume);
+    quote->addInstruction(levels);
+    registry->addTemplate(quote);
+
+    // <template name="Wrapper" id="2"><templateRef/></template>
+    Codecs::TemplatePtr wrapper(new Codecs::Template);
+    wrapper->setTemplateName("Wrapper");
+    wrapper->setId(2);
+    wrapper->setIgnore(true);
+    Codecs::FieldInstructionPtr dynamicRef(new Codecs::FieldInstructionDynamicTemplateRef);
+    wrapper->addInstruction(dynamicRef);
+    registry->addTemplate(wrapper);
+
+    // <template name="Counter" id="7"><uInt32 name="a"><delta/></uInt32></template>
+    Codecs::TemplatePtr counter(new Codecs::Template);
+    counter->setTemplateName("Counter");
+    counter->setId(7);
+    Codecs::FieldInstructionPtr a(new Codecs::FieldInstructionUInt32("a", ""));
+    a->setFieldOp(op(new Codecs::FieldOpDelta));
+    counter->addInstruction(a);
+    registry->addTemplate(counter);
+
+    registry->finalize();
+    return registry;
+  }
+
+  std::string display(const Codecs::TemplateRegistry & registry)
+  {
+    std::stringstream out;
+    registry.display(out);
+    return out.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateCacheRoundTrip)
+{
+  Codecs::TemplateRegistryPtr original = createRegistry();
+  std::string cache;
+  Codecs::TemplateCache::write(*original, cache);
+  BOOST_CHECK(Codecs::TemplateCache::isCache(
+    reinterpret_cast<const uchar *>(cache.data()), cache.size()));
+
+  Codecs::TemplateRegistryPtr loaded = Codecs::TemplateCache::read(cache);
+  BOOST_CHECK_EQUAL(loaded->fingerprint(), original->fingerprint());
+  BOOST_CHECK_EQUAL(display(*loaded), display(*original));
+  BOOST_CHECK_EQUAL(loaded->size(), original->size());
+  BOOST_CHECK_EQUAL(loaded->definedTemplateCount(), 4u);
+  BOOST_CHECK_EQUAL(loaded->dictionarySize(), original->dictionarySize());
+  BOOST_CHECK_EQUAL(loaded->presenceMapBits(), original->presenceMapBits());
+  BOOST_CHECK_EQUAL(loaded->maxFieldCount(), original->maxFieldCount());
+  BOOST_CHECK_EQUAL(loaded->getNamespace(), "test");
+
+  // details display() doesn't show.
+  Codecs::TemplateCPtr quote;
+  BOOST_REQUIRE(loaded->getTemplate(1, quote));
+  BOOST_CHECK(quote->getReset());
+  BOOST_CHECK_EQUAL(quote->getApplicationTypeNamespace(), "app");
+  Codecs::FieldInstructionCPtr symbol;
+  BOOST_REQUIRE(quote->getInstruction("test::Symbol", symbol));
+  BOOST_CHECK_EQUAL(symbol->getFieldOp()->getKey(), "sym");
+  BOOST_CHECK_EQUAL(symbol->getFieldOp()->getKeyNamespace(), "keys");
+  BOOST_CHECK_EQUAL(symbol->getFieldOp()->getDictionaryName(), "global");
+  BOOST_CHECK_EQUAL(symbol->getApplicationType(), "app.QuoteType");
+  Codecs::FieldInstructionCPtr change;
+  BOOST_REQUIRE(quote->getInstruction("Change", change));
+  BOOST_CHECK(change->getIgnoreOverflow());
+
+  // the loaded registry writes an identical cache.
+  std::string again;
+  Codecs::TemplateCache::write(*loaded, again);
+  BOOST_CHECK(again == cache);
+
+  // and decodes.
+  Codecs::Decoder decoder(loaded);
+  Codecs::DataSourceString source("\xC0\x87\x85");
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  decoder.decodeMessage(source, builder);
+  Messages::FieldCPtr field;
+  BOOST_REQUIRE(consumer.message().getField("a", field));
+  BOOST_CHECK_EQUAL(field->toUInt32(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateCacheFile)
+{
+  Codecs::TemplateRegistryPtr original = createRegistry();
+  std::string filename = "testTemplateCache.qftc";
+  Codecs::TemplateCache::writeFile(*original, filename);
+  Codecs::TemplateRegistryPtr loaded = Codecs::TemplateCache::readFile(filename);
+  BOOST_CHECK_EQUAL(loaded->fingerprint(), original->fingerprint());
+  std::remove(filename.c_str());
+  BOOST_CHECK_THROW(Codecs::TemplateCache::readFile(filename), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateCacheRejectsBadData)
+{
+  Codecs::TemplateRegistryPtr original = createRegistry();
+  std::string cache;
+  Codecs::TemplateCache::write(*original, cache);
+
+  // every truncation is detected rather than producing a partial registry.
+  for(size_t length = 0; length < cache.size(); ++length)
+  {
+    BOOST_CHECK_THROW(
+      Codecs::TemplateCache::read(reinterpret_cast<const uchar *>(cache.data()), length),
+      std::runtime_error);
+  }
+
+  std::string xml("<?xml version=\"1.0\"?><templates/>");
+  BOOST_CHECK(!Codecs::TemplateCache::isCache(
+    reinterpret_cast<const uchar *>(xml.data()), xml.size()));
+  BOOST_CHECK_THROW(Codecs::TemplateCache::read(xml), std::runtime_error);
+
+  std::string version(cache);
+  version[4] = char(99);
+  BOOST_CHECK_THROW(Codecs::TemplateCache::read(version), std::runtime_error);
+
+  // a cache for different templates (here: a different dictionary layout) is rejected.
+  std::string fingerprint(cache);
+  fingerprint[5] = char(fingerprint[5] ^ 0x01);
+  BOOST_CHECK_THROW(Codecs::TemplateCache::read(fingerprint), std::runtime_error);
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2009, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/Decoder.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Messages/Message.h>
+#include <Messages/Field.h>
+#include <Messages/FieldUInt32.h>
+#include <boost/bind.hpp>
+
+using namespace QuickFAST;
+
+namespace
+{
+  Codecs::TemplatePtr createTemplate(template_id_t id, const std::string & fieldName)
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(id);
+    Codecs::FieldInstructionPtr field(new Codecs::FieldInstructionUInt32(fieldName, ""));
+    field->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpDelta));
+    templ->addInstruction(field);
+    return templ;
+  }
+
+  /// Template 1 holds a delta field "a".  The second version of the templates defines
+  /// another template first so "a" moves to a different dictionary index.
+  Codecs::TemplateRegistryPtr createRegistry(bool second)
+  {
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    if(second)
+    {
+      registry->addTemplate(createTemplate(2, "z"));
+    }
+    registry->addTemplate(createTemplate(1, "a"));
+    registry->finalize();
+    return registry;
+  }
+
+  void encodeValue(Codecs::Encoder & encoder, template_id_t id, const std::string & fieldName, uint32 value, std::string & data)
+  {
+    Messages::Message message(1);
+    message.addField(
+      Messages::FieldIdentityCPtr(new Messages::FieldIdentity(fieldName)),
+      Messages::FieldUInt32::create(value));
+    Codecs::DataDestination destination;
+    encoder.encodeMessage(destination, id, message);
+    std::string encoded;
+    destination.toString(encoded);
+    data += encoded;
+  }
+
+  uint32 decodeValue(Codecs::Decoder & decoder, Codecs::DataSource & source)
+  {
+    Codecs::SingleMessageConsumer consumer;
+    Codecs::GenericMessageBuilder builder(consumer);
+    decoder.decodeMessage(source, builder);
+    Messages::FieldCPtr field;
+    if(!consumer.message().getField("a", field))
+    {
+      return 0;
+    }
+    return field->toUInt32();
+  }
+
+  // The continuous load: every message adds one to "a" no matter which templates are in use.
+  void decodeContinuously(
+    Codecs::Decoder & decoder,
+    Codecs::DataSource & source,
+    size_t count,
+    size_t & errors,
+    volatile bool & done)
+  {
+    for(size_t nMessage = 1; nMessage <= count; ++nMessage)
+    {
+      if(decodeValue(decoder, source) != nMessage)
+      {
+        ++errors;
+      }
+    }
+    done = true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateReloadUnderLoad)
+{
+  Codecs::TemplateRegistryPtr first = createRegistry(false);
+  Codecs::TemplateRegistryPtr second = createRegistry(true);
+  BOOST_CHECK(first->dictionaryKeys() != second->dictionaryKeys());
+
+  const size_t messageCount = 200000;
+  std::string data("\xC0\x81\x81");
+  for(size_t nMessage = 1; nMessage < messageCount; ++nMessage)
+  {
+    data += "\x80\x81";
+  }
+  Codecs::DataSourceString source(data);
+  Codecs::Decoder decoder(first);
+
+  // one replacement is pending when decoding starts, the rest arrive while it runs.
+  decoder.replaceTemplateRegistry(second, Codecs::Context::REPLACE_AT_MESSAGE);
+  size_t errors = 0;
+  volatile bool done = false;
+  boost::thread decodeThread(boost::bind(
+    &decodeContinuously, boost::ref(decoder), boost::ref(source),
+    messageCount, boost::ref(errors), boost::ref(done)));
+
+  size_t requests = 1;
+  while(!done)
+  {
+    decoder.replaceTemplateRegistry(
+      (requests % 2 == 0) ? second : first,
+      Codecs::Context::REPLACE_AT_MESSAGE);
+    ++requests;
+    (void)decoder.releaseRetiredRegistries();
+    boost::this_thread::yield();
+  }
+  decodeThread.join();
+
+  BOOST_CHECK_EQUAL(errors, 0u);
+  BOOST_CHECK(decoder.registryReplacements() > 0);
+  BOOST_CHECK(decoder.registryReplacements() <= requests);
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateReloadAtReset)
+{
+  Codecs::TemplateRegistryPtr first = createRegistry(false);
+  Codecs::TemplateRegistryPtr second = createRegistry(true);
+  std::string data("\xC0\x81\x81\x80\x81\x80\x81");
+  // SCP reset, then template 1 again
+  data += "\xC0\xF8";
+  data += "\xC0\x81\x81\x80\x81";
+  Codecs::DataSourceString source(data);
+  Codecs::Decoder decoder(first);
+
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 1u);
+  decoder.replaceTemplateRegistry(second);
+  BOOST_CHECK(decoder.replacementPending());
+  // message boundaries are not enough.
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 2u);
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 3u);
+  BOOST_CHECK(decoder.getTemplateRegistry() == first);
+  BOOST_CHECK_EQUAL(decoder.registryReplacements(), 0u);
+
+  (void)decodeValue(decoder, source);
+  BOOST_CHECK(!decoder.replacementPending());
+  BOOST_CHECK_EQUAL(decoder.registryReplacements(), 1u);
+  BOOST_CHECK(decoder.getTemplateRegistry() == second);
+
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 1u);
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 2u);
+  BOOST_CHECK_EQUAL(decoder.releaseRetiredRegistries(), 1u);
+  BOOST_CHECK_EQUAL(decoder.releaseRetiredRegistries(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testTemplateReloadEncoder)
+{
+  Codecs::TemplateRegistryPtr first = createRegistry(false);
+  Codecs::TemplateRegistryPtr second = createRegistry(true);
+  Codecs::Encoder encoder(first);
+  std::string data;
+  encodeValue(encoder, 1, "a", 1, data);
+  encoder.replaceTemplateRegistry(second, Codecs::Context::REPLACE_AT_MESSAGE);
+  // template 2 is only in the second registry.
+  encodeValue(encoder, 2, "z", 5, data);
+  encodeValue(encoder, 1, "a", 2, data);
+  BOOST_CHECK(encoder.getTemplateRegistry() == second);
+  BOOST_CHECK_EQUAL(encoder.registryReplacements(), 1u);
+
+  // a decoder making the same switch sees "a" carried across it.
+  Codecs::DataSourceString source(data);
+  Codecs::Decoder decoder(first);
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 1u);
+  decoder.replaceTemplateRegistry(second, Codecs::Context::REPLACE_AT_MESSAGE);
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 0u);
+  BOOST_CHECK_EQUAL(decodeValue(decoder, source), 2u);
+}